@@ -18,12 +18,25 @@
 #include <stdint.h>
 
 #if defined(__cplusplus)
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <new>
 #include <type_traits>
 #else
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#endif
+
+// LIBDIVIDE_MMAP enables libdivide_table_map(), which maps
+// serialized divider tables read-only (POSIX systems only).
+#if defined(LIBDIVIDE_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #if defined(LIBDIVIDE_SSE2)
@@ -35,6 +48,20 @@
 #if defined(LIBDIVIDE_NEON)
 #include <arm_neon.h>
 #endif
+#if defined(LIBDIVIDE_SVE)
+#include <arm_sve.h>
+#endif
+#if defined(LIBDIVIDE_RVV)
+#include <riscv_vector.h>
+#endif
+
+// LIBDIVIDE_DISPATCH selects the x86 vector kernels used by the
+// array functions at runtime. This requires GCC or Clang.
+#if defined(LIBDIVIDE_DISPATCH) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define LIBDIVIDE_DISPATCH_X86
+#include <immintrin.h>
+#endif
 
 #if defined(_MSC_VER)
 #include <intrin.h>
@@ -66,6 +93,45 @@
 
 #if defined(__GNUC__) || defined(__clang__)
 #define LIBDIVIDE_GCC_STYLE_ASM
+// GCC and Clang vector extensions, __attribute__((vector_size(N)))
+#define LIBDIVIDE_GNU_VECTORS
+#endif
+
+// LIBDIVIDE_SIMD_TS enables the divider overloads for
+// std::experimental::simd (Parallelism TS v2). It is undefined
+// again if the standard library does not provide it.
+#if defined(LIBDIVIDE_SIMD_TS)
+#if defined(__cplusplus) && \
+    (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) && \
+    defined(__has_include)
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#endif
+#endif
+#if !defined(__cpp_lib_experimental_parallel_simd)
+#undef LIBDIVIDE_SIMD_TS
+#endif
+#endif
+
+// LIBDIVIDE_PARALLEL enables libdivide::parallel::divide(), which
+// divides large arrays using a thread pool, a user supplied executor
+// or a C++17 execution policy.
+#if defined(__cplusplus) && defined(LIBDIVIDE_PARALLEL)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) && \
+    defined(__has_include)
+#if __has_include(<execution>)
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#if defined(__cpp_lib_execution)
+#define LIBDIVIDE_EXECUTION_POLICIES
+#endif
+#endif
+#endif
 #endif
 
 #if defined(__cplusplus) || defined(LIBDIVIDE_VC)
@@ -85,6 +151,77 @@
 #define LIBDIVIDE_INLINE inline
 #endif
 
+// The constexpr gen functions need C++14 relaxed constexpr. The divider
+// constructor is only constexpr if it can detect constant evaluation, at
+// runtime it uses the (faster) intrinsics of the C gen functions.
+#if defined(__cplusplus) && \
+    (__cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#define LIBDIVIDE_HAS_CONSTEXPR_GEN
+#if defined(__cpp_lib_is_constant_evaluated)
+#define LIBDIVIDE_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif __has_builtin(__builtin_is_constant_evaluated) || \
+    (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define LIBDIVIDE_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+#if defined(LIBDIVIDE_IS_CONSTANT_EVALUATED)
+#define LIBDIVIDE_HAS_CONSTEXPR_DIVIDER
+#define LIBDIVIDE_CONSTEXPR_DIVIDER constexpr
+#else
+#define LIBDIVIDE_CONSTEXPR_DIVIDER
+#endif
+
+// The x86 vector kernels are compiled if their instruction set
+// has been enabled, or for runtime dispatch. In the latter case
+// the kernels that are not supported by the compiler flags are
+// compiled using target attributes.
+#if defined(LIBDIVIDE_SSE2) || defined(LIBDIVIDE_DISPATCH_X86)
+#define LIBDIVIDE_SSE2_KERNELS
+#endif
+#if defined(LIBDIVIDE_AVX2) || defined(LIBDIVIDE_AVX512) || defined(LIBDIVIDE_DISPATCH_X86)
+#define LIBDIVIDE_AVX2_KERNELS
+#endif
+#if defined(LIBDIVIDE_AVX512) || defined(LIBDIVIDE_DISPATCH_X86)
+#define LIBDIVIDE_AVX512_KERNELS
+#endif
+
+#if defined(LIBDIVIDE_DISPATCH_X86)
+#define LIBDIVIDE_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define LIBDIVIDE_TARGET_PUSH(isa) \
+    LIBDIVIDE_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define LIBDIVIDE_TARGET_POP LIBDIVIDE_PRAGMA(clang attribute pop)
+#else
+#define LIBDIVIDE_TARGET_PUSH(isa) \
+    LIBDIVIDE_PRAGMA(GCC push_options) LIBDIVIDE_PRAGMA(GCC target(isa))
+#define LIBDIVIDE_TARGET_POP LIBDIVIDE_PRAGMA(GCC pop_options)
+#endif
+#endif
+
+#if defined(LIBDIVIDE_DISPATCH_X86) && !defined(__SSE2__)
+#define LIBDIVIDE_SSE2_BEGIN LIBDIVIDE_TARGET_PUSH("sse2")
+#define LIBDIVIDE_SSE2_END LIBDIVIDE_TARGET_POP
+#else
+#define LIBDIVIDE_SSE2_BEGIN
+#define LIBDIVIDE_SSE2_END
+#endif
+#if defined(LIBDIVIDE_DISPATCH_X86) && !defined(__AVX2__)
+#define LIBDIVIDE_AVX2_BEGIN LIBDIVIDE_TARGET_PUSH("avx2")
+#define LIBDIVIDE_AVX2_END LIBDIVIDE_TARGET_POP
+#else
+#define LIBDIVIDE_AVX2_BEGIN
+#define LIBDIVIDE_AVX2_END
+#endif
+#if defined(LIBDIVIDE_DISPATCH_X86) && !defined(__AVX512F__)
+#define LIBDIVIDE_AVX512_BEGIN LIBDIVIDE_TARGET_PUSH("avx512f")
+#define LIBDIVIDE_AVX512_END LIBDIVIDE_TARGET_POP
+#else
+#define LIBDIVIDE_AVX512_BEGIN
+#define LIBDIVIDE_AVX512_END
+#endif
+
 #define LIBDIVIDE_ERROR(msg)                                                                     \
     do {                                                                                         \
         fprintf(stderr, "libdivide.h:%d: %s(): Error: %s\n", __LINE__, LIBDIVIDE_FUNCTION, msg); \
@@ -114,6 +251,26 @@ namespace libdivide {
 // by up to 10% because of reduced memory bandwidth.
 #pragma pack(push, 1)
 
+struct libdivide_u16_t {
+    uint16_t magic;
+    uint8_t more;
+};
+
+struct libdivide_s16_t {
+    int16_t magic;
+    uint8_t more;
+};
+
+struct libdivide_u16_branchfree_t {
+    uint16_t magic;
+    uint8_t more;
+};
+
+struct libdivide_s16_branchfree_t {
+    int16_t magic;
+    uint8_t more;
+};
+
 struct libdivide_u32_t {
     uint32_t magic;
     uint8_t more;
@@ -154,8 +311,187 @@ struct libdivide_s64_branchfree_t {
     uint8_t more;
 };
 
+#if defined(HAS_INT128_T)
+// 128-bit shift values need 7 bits, so they are stored separately
+struct libdivide_u128_t {
+    __uint128_t magic;
+    uint8_t more;
+    uint8_t shift;
+};
+
+struct libdivide_s128_t {
+    __int128_t magic;
+    uint8_t more;
+    uint8_t shift;
+};
+
+struct libdivide_u128_branchfree_t {
+    __uint128_t magic;
+    uint8_t more;
+    uint8_t shift;
+};
+
+struct libdivide_s128_branchfree_t {
+    __int128_t magic;
+    uint8_t more;
+    uint8_t shift;
+};
+#endif
+
+// Divider and divisor, used to compute quotient and remainder
+struct libdivide_u32_divmod_t {
+    struct libdivide_u32_t denom;
+    uint32_t d;
+};
+
+struct libdivide_s32_divmod_t {
+    struct libdivide_s32_t denom;
+    int32_t d;
+};
+
+struct libdivide_u64_divmod_t {
+    struct libdivide_u64_t denom;
+    uint64_t d;
+};
+
+struct libdivide_s64_divmod_t {
+    struct libdivide_s64_t denom;
+    int64_t d;
+};
+
+struct libdivide_u32_branchfree_divmod_t {
+    struct libdivide_u32_branchfree_t denom;
+    uint32_t d;
+};
+
+struct libdivide_s32_branchfree_divmod_t {
+    struct libdivide_s32_branchfree_t denom;
+    int32_t d;
+};
+
+struct libdivide_u64_branchfree_divmod_t {
+    struct libdivide_u64_branchfree_t denom;
+    uint64_t d;
+};
+
+struct libdivide_s64_branchfree_divmod_t {
+    struct libdivide_s64_branchfree_t denom;
+    int64_t d;
+};
+
+// Divisibility test: n is divisible by d = d0 * 2^shift (d0 odd)
+// if rotr(n * inverse, shift) <= threshold, where inverse is the
+// multiplicative inverse of d0 and threshold = UINT_MAX / d.
+struct libdivide_u32_divisibility_t {
+    uint32_t inverse;
+    uint32_t threshold;
+    uint8_t shift;
+};
+
+struct libdivide_u64_divisibility_t {
+    uint64_t inverse;
+    uint64_t threshold;
+    uint8_t shift;
+};
+
+// Remainder only (Lemire's fastmod): M = ceil(2^64 / d), then
+// n % d is the high 32 bits of lo64(M * n) * d
+struct libdivide_u32_mod_t {
+    uint64_t M;
+    uint32_t d;
+};
+
+// 52-bit dividers for |numer| < 2^52 and |d| < 2^52, their magic
+// number is < 2^52 and more holds the shift (and for s52 the negative
+// divisor bit), see libdivide_u52_gen()
+struct libdivide_u52_t {
+    uint64_t magic;
+    uint8_t more;
+};
+
+struct libdivide_s52_t {
+    int64_t magic;
+    uint8_t more;
+};
+
+// Narrow 64-bit dividers for numerators < 2^32, divided using a
+// 32-bit * 32-bit = 64-bit multiply, see libdivide_u64_narrow_gen()
+struct libdivide_u64_narrow_t {
+    uint32_t magic;
+    uint8_t more;
+};
+
+// Exact division: if numer is a multiple of d = d0 * 2^shift (d0 odd)
+// then numer / d = (numer >> shift) * inverse, where inverse is the
+// multiplicative inverse of d0 modulo 2^32 (or 2^64). The quotient
+// is unspecified if numer is not a multiple of d.
+struct libdivide_u32_exact_t {
+    uint32_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_s32_exact_t {
+    int32_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_u64_exact_t {
+    uint64_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_s64_exact_t {
+    int64_t inverse;
+    uint8_t shift;
+};
+
 #pragma pack(pop)
 
+// Serialized divider tables, see libdivide_table_write(): a 64-byte
+// header followed by an array of libdivide_*_t structs in the byte
+// order of the writer. The structs are byte packed, so their layout
+// only changes with LIBDIVIDE_VERSION_MAJOR.
+#define LIBDIVIDE_TABLE_FORMAT 1
+#define LIBDIVIDE_TABLE_HEADER_SIZE 64
+#define LIBDIVIDE_TABLE_BYTE_ORDER 0x01020304u
+
+enum libdivide_table_type {
+    LIBDIVIDE_TABLE_U16 = 1,
+    LIBDIVIDE_TABLE_S16,
+    LIBDIVIDE_TABLE_U32,
+    LIBDIVIDE_TABLE_S32,
+    LIBDIVIDE_TABLE_U64,
+    LIBDIVIDE_TABLE_S64,
+    LIBDIVIDE_TABLE_U16_BRANCHFREE,
+    LIBDIVIDE_TABLE_S16_BRANCHFREE,
+    LIBDIVIDE_TABLE_U32_BRANCHFREE,
+    LIBDIVIDE_TABLE_S32_BRANCHFREE,
+    LIBDIVIDE_TABLE_U64_BRANCHFREE,
+    LIBDIVIDE_TABLE_S64_BRANCHFREE
+};
+
+struct libdivide_table_header {
+    char magic[8];           // "LIBDIVT"
+    uint32_t byte_order;     // LIBDIVIDE_TABLE_BYTE_ORDER
+    uint16_t format;         // LIBDIVIDE_TABLE_FORMAT
+    uint16_t version_major;  // LIBDIVIDE_VERSION_MAJOR
+    uint16_t version_minor;  // LIBDIVIDE_VERSION_MINOR
+    uint8_t type;            // enum libdivide_table_type
+    uint8_t entry_size;      // sizeof the libdivide_*_t struct
+    uint32_t reserved;
+    uint64_t count;          // number of dividers
+    uint8_t padding[32];
+};
+
+#if defined(LIBDIVIDE_MMAP)
+struct libdivide_table_mapping {
+    void *addr;
+    size_t size;
+    const void *dividers;
+    size_t count;
+};
+#endif
+
 // Explanation of the "more" field:
 //
 // * Bits 0-5 is the shift value (for shift path or mult path).
@@ -165,6 +501,17 @@ struct libdivide_s64_branchfree_t {
 //   create a bitmask with all bits set to 1 (if the divisor is negative)
 //   or 0 (if the divisor is positive).
 //
+// u16: [0-4] shift value
+//      [5] ignored
+//      [6] add indicator
+//      magic number of 0 indicates shift path
+//
+// s16: [0-4] shift value
+//      [5] ignored
+//      [6] add indicator
+//      [7] indicates negative divisor
+//      magic number of 0 indicates shift path
+//
 // u32: [0-4] shift value
 //      [5] ignored
 //      [6] add indicator
@@ -185,26 +532,82 @@ struct libdivide_s64_branchfree_t {
 //      [7] indicates negative divisor
 //      magic number of 0 indicates shift path
 //
-// In s32 and s64 branchfree modes, the magic number is negated according to
+// u128: [0-5] ignored (the shift value is in the "shift" field)
+//       [6] add indicator
+//       magic number of 0 indicates shift path
+//
+// s128: [0-5] ignored (the shift value is in the "shift" field)
+//       [6] add indicator
+//       [7] indicates negative divisor
+//       magic number of 0 indicates shift path
+//
+// In s16, s32, s64 and s128 branchfree modes, the magic number is negated according to
 // whether the divisor is negated. In branchfree strategy, it is not negated.
 
 enum {
+    LIBDIVIDE_16_SHIFT_MASK = 0x1F,
     LIBDIVIDE_32_SHIFT_MASK = 0x1F,
     LIBDIVIDE_64_SHIFT_MASK = 0x3F,
     LIBDIVIDE_ADD_MARKER = 0x40,
     LIBDIVIDE_NEGATIVE_DIVISOR = 0x80
 };
 
+// The path taken by the branchfull division, see libdivide_*_algorithm().
+// LIBDIVIDE_ALGORITHM_NEGATED is a flag that is combined with the path
+// of negative signed divisors.
+enum libdivide_algorithm {
+    LIBDIVIDE_ALGORITHM_SHIFT = 0,    // magic number of 0: shifts only
+    LIBDIVIDE_ALGORITHM_MUL = 1,      // high multiplication and shift
+    LIBDIVIDE_ALGORITHM_MUL_ADD = 2,  // add indicator: multiplication, add and shift
+    LIBDIVIDE_ALGORITHM_NEGATED = 4   // negative divisor
+};
+
+// LIBDIVIDE_STATS counts the calls of the 16-bit, 32-bit and 64-bit gen
+// functions: gen[LIBDIVIDE_TABLE_U32][LIBDIVIDE_ALGORITHM_MUL_ADD] is the
+// number of libdivide_u32_gen() calls that returned an add indicator
+// divider. The branchfree gen functions are counted using their
+// LIBDIVIDE_TABLE_*_BRANCHFREE type and the path of the corresponding
+// branchfull algorithm, e.g. unsigned branchfree dividers of divisors
+// that are not powers of 2 always use LIBDIVIDE_ALGORITHM_MUL_ADD.
+// The gen functions call LIBDIVIDE_GEN_HOOK(type, algorithm) which
+// may also be defined by the user, it expands to nothing by default.
+#if defined(LIBDIVIDE_STATS)
+struct libdivide_stats {
+    uint64_t gen[LIBDIVIDE_TABLE_S64_BRANCHFREE + 1][8];
+};
+#endif
+
+static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_s16_gen(int16_t d);
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen(uint16_t d);
 static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_s32_gen(int32_t d);
 static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_u32_gen(uint32_t d);
 static LIBDIVIDE_INLINE struct libdivide_s64_t libdivide_s64_gen(int64_t d);
 static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_u64_gen(uint64_t d);
 
+static LIBDIVIDE_INLINE struct libdivide_s16_branchfree_t libdivide_s16_branchfree_gen(int16_t d);
+static LIBDIVIDE_INLINE struct libdivide_u16_branchfree_t libdivide_u16_branchfree_gen(uint16_t d);
 static LIBDIVIDE_INLINE struct libdivide_s32_branchfree_t libdivide_s32_branchfree_gen(int32_t d);
 static LIBDIVIDE_INLINE struct libdivide_u32_branchfree_t libdivide_u32_branchfree_gen(uint32_t d);
 static LIBDIVIDE_INLINE struct libdivide_s64_branchfree_t libdivide_s64_branchfree_gen(int64_t d);
 static LIBDIVIDE_INLINE struct libdivide_u64_branchfree_t libdivide_u64_branchfree_gen(uint64_t d);
 
+static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_s16_gen_bounded(
+    int16_t d, int16_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen_bounded(
+    uint16_t d, uint16_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_s32_gen_bounded(
+    int32_t d, int32_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_u32_gen_bounded(
+    uint32_t d, uint32_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_s64_t libdivide_s64_gen_bounded(
+    int64_t d, int64_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_u64_gen_bounded(
+    uint64_t d, uint64_t max_numer);
+
+static LIBDIVIDE_INLINE int16_t libdivide_s16_do(
+    int16_t numer, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_do(
+    uint16_t numer, const struct libdivide_u16_t *denom);
 static LIBDIVIDE_INLINE int32_t libdivide_s32_do(
     int32_t numer, const struct libdivide_s32_t *denom);
 static LIBDIVIDE_INLINE uint32_t libdivide_u32_do(
@@ -214,6 +617,10 @@ static LIBDIVIDE_INLINE int64_t libdivide_s64_do(
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_do(
     uint64_t numer, const struct libdivide_u64_t *denom);
 
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_do(
+    int16_t numer, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_do(
+    uint16_t numer, const struct libdivide_u16_branchfree_t *denom);
 static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_do(
     int32_t numer, const struct libdivide_s32_branchfree_t *denom);
 static LIBDIVIDE_INLINE uint32_t libdivide_u32_branchfree_do(
@@ -223,11 +630,17 @@ static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_do(
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_do(
     uint64_t numer, const struct libdivide_u64_branchfree_t *denom);
 
+static LIBDIVIDE_INLINE int16_t libdivide_s16_recover(const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_recover(const struct libdivide_u16_t *denom);
 static LIBDIVIDE_INLINE int32_t libdivide_s32_recover(const struct libdivide_s32_t *denom);
 static LIBDIVIDE_INLINE uint32_t libdivide_u32_recover(const struct libdivide_u32_t *denom);
 static LIBDIVIDE_INLINE int64_t libdivide_s64_recover(const struct libdivide_s64_t *denom);
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_recover(const struct libdivide_u64_t *denom);
 
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_recover(
+    const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_recover(
+    const struct libdivide_u16_branchfree_t *denom);
 static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_recover(
     const struct libdivide_s32_branchfree_t *denom);
 static LIBDIVIDE_INLINE uint32_t libdivide_u32_branchfree_recover(
@@ -237,8 +650,206 @@ static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_recover(
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_recover(
     const struct libdivide_u64_branchfree_t *denom);
 
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_s16_algorithm(
+    const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_u16_algorithm(
+    const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_s32_algorithm(
+    const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_u32_algorithm(
+    const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_s64_algorithm(
+    const struct libdivide_s64_t *denom);
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_u64_algorithm(
+    const struct libdivide_u64_t *denom);
+
+#if defined(LIBDIVIDE_STATS)
+// In C++ the translation units share the counters (inline functions
+// have a single static local), in C each translation unit counts.
+#if defined(__cplusplus)
+#define LIBDIVIDE_STATS_INLINE inline
+#else
+#define LIBDIVIDE_STATS_INLINE static inline
+#endif
+LIBDIVIDE_STATS_INLINE struct libdivide_stats *libdivide_get_stats(void);
+LIBDIVIDE_STATS_INLINE void libdivide_reset_stats(void);
+#endif
+
+#if defined(HAS_INT128_T)
+static LIBDIVIDE_INLINE struct libdivide_s128_t libdivide_s128_gen(__int128_t d);
+static LIBDIVIDE_INLINE struct libdivide_u128_t libdivide_u128_gen(__uint128_t d);
+static LIBDIVIDE_INLINE struct libdivide_s128_branchfree_t libdivide_s128_branchfree_gen(
+    __int128_t d);
+static LIBDIVIDE_INLINE struct libdivide_u128_branchfree_t libdivide_u128_branchfree_gen(
+    __uint128_t d);
+
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_do(
+    __int128_t numer, const struct libdivide_s128_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_do(
+    __uint128_t numer, const struct libdivide_u128_t *denom);
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_branchfree_do(
+    __int128_t numer, const struct libdivide_s128_branchfree_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_branchfree_do(
+    __uint128_t numer, const struct libdivide_u128_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_recover(const struct libdivide_s128_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_recover(const struct libdivide_u128_t *denom);
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_branchfree_recover(
+    const struct libdivide_s128_branchfree_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_branchfree_recover(
+    const struct libdivide_u128_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_s128_algorithm(
+    const struct libdivide_s128_t *denom);
+static LIBDIVIDE_INLINE enum libdivide_algorithm libdivide_u128_algorithm(
+    const struct libdivide_u128_t *denom);
+#endif
+
+static LIBDIVIDE_INLINE struct libdivide_u32_divmod_t libdivide_u32_divmod_gen(uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_s32_divmod_t libdivide_s32_divmod_gen(int32_t d);
+static LIBDIVIDE_INLINE struct libdivide_u64_divmod_t libdivide_u64_divmod_gen(uint64_t d);
+static LIBDIVIDE_INLINE struct libdivide_s64_divmod_t libdivide_s64_divmod_gen(int64_t d);
+static LIBDIVIDE_INLINE struct libdivide_u32_branchfree_divmod_t
+libdivide_u32_branchfree_divmod_gen(uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_s32_branchfree_divmod_t
+libdivide_s32_branchfree_divmod_gen(int32_t d);
+static LIBDIVIDE_INLINE struct libdivide_u64_branchfree_divmod_t
+libdivide_u64_branchfree_divmod_gen(uint64_t d);
+static LIBDIVIDE_INLINE struct libdivide_s64_branchfree_divmod_t
+libdivide_s64_branchfree_divmod_gen(int64_t d);
+
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_divmod(
+    uint32_t numer, uint32_t *rem, const struct libdivide_u32_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_divmod(
+    int32_t numer, int32_t *rem, const struct libdivide_s32_divmod_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_divmod(
+    uint64_t numer, uint64_t *rem, const struct libdivide_u64_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_divmod(
+    int64_t numer, int64_t *rem, const struct libdivide_s64_divmod_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_branchfree_divmod(
+    uint32_t numer, uint32_t *rem, const struct libdivide_u32_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_divmod(
+    int32_t numer, int32_t *rem, const struct libdivide_s32_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_divmod(
+    uint64_t numer, uint64_t *rem, const struct libdivide_u64_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_divmod(
+    int64_t numer, int64_t *rem, const struct libdivide_s64_branchfree_divmod_t *denom);
+
+// Quotients rounded towards negative and positive infinity, the
+// remainder of the floored division (same sign as the divisor) and
+// the Euclidean remainder (never negative)
+static LIBDIVIDE_INLINE int32_t libdivide_s32_divide_floor(
+    int32_t numer, const struct libdivide_s32_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_divide_ceil(
+    int32_t numer, const struct libdivide_s32_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_mod_floor(
+    int32_t numer, const struct libdivide_s32_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_mod_euclid(
+    int32_t numer, const struct libdivide_s32_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_divide_floor(
+    int64_t numer, const struct libdivide_s64_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_divide_ceil(
+    int64_t numer, const struct libdivide_s64_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_mod_floor(
+    int64_t numer, const struct libdivide_s64_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_mod_euclid(
+    int64_t numer, const struct libdivide_s64_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_divide_floor(
+    int32_t numer, const struct libdivide_s32_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_divide_ceil(
+    int32_t numer, const struct libdivide_s32_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_mod_floor(
+    int32_t numer, const struct libdivide_s32_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_mod_euclid(
+    int32_t numer, const struct libdivide_s32_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_divide_floor(
+    int64_t numer, const struct libdivide_s64_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_divide_ceil(
+    int64_t numer, const struct libdivide_s64_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_mod_floor(
+    int64_t numer, const struct libdivide_s64_branchfree_divmod_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_mod_euclid(
+    int64_t numer, const struct libdivide_s64_branchfree_divmod_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u32_divisibility_t libdivide_u32_divisibility_gen(
+    uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_u64_divisibility_t libdivide_u64_divisibility_gen(
+    uint64_t d);
+
+static LIBDIVIDE_INLINE int libdivide_u32_is_divisible(
+    uint32_t numer, const struct libdivide_u32_divisibility_t *denom);
+static LIBDIVIDE_INLINE int libdivide_u64_is_divisible(
+    uint64_t numer, const struct libdivide_u64_divisibility_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u32_mod_t libdivide_u32_mod_gen(uint32_t d);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_mod_do(
+    uint32_t numer, const struct libdivide_u32_mod_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_mod_recover(const struct libdivide_u32_mod_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u52_t libdivide_u52_gen(uint64_t d);
+static LIBDIVIDE_INLINE struct libdivide_s52_t libdivide_s52_gen(int64_t d);
+static LIBDIVIDE_INLINE uint64_t libdivide_u52_do(
+    uint64_t numer, const struct libdivide_u52_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s52_do(
+    int64_t numer, const struct libdivide_s52_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u52_recover(const struct libdivide_u52_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s52_recover(const struct libdivide_s52_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u64_narrow_t libdivide_u64_narrow_gen(
+    uint64_t d, uint64_t max_numer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_narrow_do(
+    uint64_t numer, const struct libdivide_u64_narrow_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u32_exact_t libdivide_u32_exact_gen(uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_s32_exact_t libdivide_s32_exact_gen(int32_t d);
+static LIBDIVIDE_INLINE struct libdivide_u64_exact_t libdivide_u64_exact_gen(uint64_t d);
+static LIBDIVIDE_INLINE struct libdivide_s64_exact_t libdivide_s64_exact_gen(int64_t d);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_exact_do(
+    uint32_t numer, const struct libdivide_u32_exact_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_exact_do(
+    int32_t numer, const struct libdivide_s32_exact_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_exact_do(
+    uint64_t numer, const struct libdivide_u64_exact_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_exact_do(
+    int64_t numer, const struct libdivide_s64_exact_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_exact_recover(
+    const struct libdivide_u32_exact_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_exact_recover(
+    const struct libdivide_s32_exact_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_exact_recover(
+    const struct libdivide_u64_exact_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_exact_recover(
+    const struct libdivide_s64_exact_t *denom);
+
+static LIBDIVIDE_INLINE size_t libdivide_table_entry_size(enum libdivide_table_type type);
+static LIBDIVIDE_INLINE size_t libdivide_table_size(enum libdivide_table_type type, size_t count);
+static LIBDIVIDE_INLINE size_t libdivide_table_write(
+    void *buffer, enum libdivide_table_type type, const void *dividers, size_t count);
+static LIBDIVIDE_INLINE const void *libdivide_table_read(
+    const void *data, size_t size, enum libdivide_table_type type, size_t *count);
+static LIBDIVIDE_INLINE int libdivide_table_save(
+    const char *path, enum libdivide_table_type type, const void *dividers, size_t count);
+#if defined(LIBDIVIDE_MMAP)
+static LIBDIVIDE_INLINE int libdivide_table_map(
+    const char *path, enum libdivide_table_type type, struct libdivide_table_mapping *mapping);
+static LIBDIVIDE_INLINE void libdivide_table_unmap(struct libdivide_table_mapping *mapping);
+#endif
+
 //////// Internal Utility Functions
 
+static LIBDIVIDE_INLINE uint16_t libdivide_mullhi_u16(uint16_t x, uint16_t y) {
+    uint32_t xl = x, yl = y;
+    uint32_t rl = xl * yl;
+    return (uint16_t)(rl >> 16);
+}
+
+static LIBDIVIDE_INLINE int16_t libdivide_mullhi_s16(int16_t x, int16_t y) {
+    int32_t xl = x, yl = y;
+    int32_t rl = xl * yl;
+    // needs to be arithmetic shift
+    return (int16_t)(rl >> 16);
+}
+
 static LIBDIVIDE_INLINE uint32_t libdivide_mullhi_u32(uint32_t x, uint32_t y) {
     uint64_t xl = x, yl = y;
     uint64_t rl = xl * yl;
@@ -326,6 +937,11 @@ static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros32(uint32_t val) {
 #endif
 }
 
+// val must be != 0
+static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros16(uint16_t val) {
+    return libdivide_count_leading_zeros32(val) - 16;
+}
+
 static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros64(uint64_t val) {
 #if defined(__GNUC__) || __has_builtin(__builtin_clzll)
     // Fast way to count leading zeros
@@ -344,6 +960,128 @@ static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros64(uint64_t val) {
 #endif
 }
 
+// val must be != 0
+static LIBDIVIDE_INLINE int32_t libdivide_count_trailing_zeros32(uint32_t val) {
+#if defined(__GNUC__) || __has_builtin(__builtin_ctz)
+    return __builtin_ctz(val);
+#elif defined(LIBDIVIDE_VC)
+    unsigned long result;
+    _BitScanForward(&result, val);
+    return (int32_t)result;
+#else
+    int32_t result = 0;
+    while ((val & 1) == 0) {
+        val >>= 1;
+        result++;
+    }
+    return result;
+#endif
+}
+
+// val must be != 0
+static LIBDIVIDE_INLINE int32_t libdivide_count_trailing_zeros64(uint64_t val) {
+#if defined(__GNUC__) || __has_builtin(__builtin_ctzll)
+    return __builtin_ctzll(val);
+#elif defined(LIBDIVIDE_VC) && defined(_WIN64)
+    unsigned long result;
+    _BitScanForward64(&result, val);
+    return (int32_t)result;
+#else
+    uint32_t lo = val & 0xFFFFFFFF;
+    if (lo != 0) return libdivide_count_trailing_zeros32(lo);
+    return 32 + libdivide_count_trailing_zeros32((uint32_t)(val >> 32));
+#endif
+}
+
+// Multiplicative inverse of the odd d0 modulo 2^32 using Newton's
+// method: each iteration doubles the number of correct bits and
+// d0 * d0 == 1 (mod 8) provides the first 3.
+static LIBDIVIDE_INLINE uint32_t libdivide_inverse_u32(uint32_t d0) {
+    uint32_t inverse = d0;
+    for (int i = 0; i < 4; i++) {
+        inverse *= 2 - d0 * inverse;
+    }
+    return inverse;
+}
+
+// Multiplicative inverse of the odd d0 modulo 2^64
+static LIBDIVIDE_INLINE uint64_t libdivide_inverse_u64(uint64_t d0) {
+    uint64_t inverse = d0;
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - d0 * inverse;
+    }
+    return inverse;
+}
+
+#if defined(HAS_INT128_T)
+static LIBDIVIDE_INLINE __uint128_t libdivide_mullhi_u128(__uint128_t x, __uint128_t y) {
+    // full 256 bits are x0 * y0 + (x0 * y1 << 64) + (x1 * y0 << 64) + (x1 * y1 << 128)
+    uint64_t x0 = (uint64_t)x, x1 = (uint64_t)(x >> 64);
+    uint64_t y0 = (uint64_t)y, y1 = (uint64_t)(y >> 64);
+    __uint128_t x0y0 = (__uint128_t)x0 * y0;
+    __uint128_t x0y1 = (__uint128_t)x0 * y1;
+    __uint128_t x1y0 = (__uint128_t)x1 * y0;
+    __uint128_t x1y1 = (__uint128_t)x1 * y1;
+    // bits 64-191 of the product, the sum cannot overflow
+    __uint128_t mid = (x0y0 >> 64) + (uint64_t)x0y1 + (uint64_t)x1y0;
+    return x1y1 + (x0y1 >> 64) + (x1y0 >> 64) + (mid >> 64);
+}
+
+static LIBDIVIDE_INLINE __int128_t libdivide_mullhi_s128(__int128_t x, __int128_t y) {
+    // The signed high half is the unsigned one minus y if x < 0
+    // and minus x if y < 0 (x >> 127 is all ones if x < 0)
+    __uint128_t p = libdivide_mullhi_u128((__uint128_t)x, (__uint128_t)y);
+    p -= (__uint128_t)(x >> 127) & (__uint128_t)y;
+    p -= (__uint128_t)(y >> 127) & (__uint128_t)x;
+    return (__int128_t)p;
+}
+
+// val must be != 0
+static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros128(__uint128_t val) {
+    uint64_t hi = (uint64_t)(val >> 64);
+    if (hi != 0) return libdivide_count_leading_zeros64(hi);
+    return 64 + libdivide_count_leading_zeros64((uint64_t)val);
+}
+#endif
+
+// libdivide_32_div_16_to_16: divides a 32-bit uint {u1, u0} by a 16-bit
+// uint {v}. The result must fit in 16 bits.
+// Returns the quotient directly and the remainder in *r
+static LIBDIVIDE_INLINE uint16_t libdivide_32_div_16_to_16(
+    uint16_t u1, uint16_t u0, uint16_t v, uint16_t *r) {
+    uint32_t n = ((uint32_t)u1 << 16) | u0;
+    uint16_t result = (uint16_t)(n / v);
+    *r = (uint16_t)(n - result * (uint32_t)v);
+    return result;
+}
+
+#if defined(HAS_INT128_T)
+// libdivide_256_div_128_to_128: divides a 256-bit uint {u1, u0} by a
+// 128-bit uint {v}. The result must fit in 128 bits, i.e. u1 < v.
+// Returns the quotient directly and the remainder in *r.
+// Bitwise long division, only used by the gen and recover functions.
+static LIBDIVIDE_INLINE __uint128_t libdivide_256_div_128_to_128(
+    __uint128_t u1, __uint128_t u0, __uint128_t v, __uint128_t *r) {
+    LIBDIVIDE_ASSERT(u1 < v);
+    __uint128_t q = 0;
+    int i;
+    for (i = 0; i < 128; i++) {
+        // the remainder u1 < v is shifted left by one, the bit
+        // shifted out of it is needed to compare against v
+        int carry = (int)(u1 >> 127);
+        u1 = (u1 << 1) | (u0 >> 127);
+        u0 <<= 1;
+        q <<= 1;
+        if (carry || u1 >= v) {
+            u1 -= v;
+            q |= 1;
+        }
+    }
+    *r = u1;
+    return q;
+}
+#endif
+
 // libdivide_64_div_32_to_32: divides a 64-bit uint {u1, u0} by a 32-bit
 // uint {v}. The result must fit in 32 bits.
 // Returns the quotient directly and the remainder in *r
@@ -572,16 +1310,80 @@ static uint64_t libdivide_128_div_128_to_64(
 #endif
 }
 
-////////// UINT32
+////////// ALGORITHM
+
+// LIBDIVIDE_ALGORITHM() generates libdivide_*_algorithm() of the
+// branchfull dividers. Unsigned dividers never set the negative
+// divisor bit.
+#define LIBDIVIDE_ALGORITHM(ALGO)                          \
+    enum libdivide_algorithm libdivide_##ALGO##_algorithm( \
+        const struct libdivide_##ALGO##_t *denom) {        \
+        int algorithm;                                     \
+        if (!denom->magic) {                               \
+            algorithm = LIBDIVIDE_ALGORITHM_SHIFT;         \
+        } else if (denom->more & LIBDIVIDE_ADD_MARKER) {   \
+            algorithm = LIBDIVIDE_ALGORITHM_MUL_ADD;       \
+        } else {                                           \
+            algorithm = LIBDIVIDE_ALGORITHM_MUL;           \
+        }                                                  \
+        if (denom->more & LIBDIVIDE_NEGATIVE_DIVISOR) {    \
+            algorithm |= LIBDIVIDE_ALGORITHM_NEGATED;      \
+        }                                                  \
+        return (enum libdivide_algorithm)algorithm;        \
+    }
 
-static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_internal_u32_gen(
-    uint32_t d, int branchfree) {
+LIBDIVIDE_ALGORITHM(u16)
+LIBDIVIDE_ALGORITHM(s16)
+LIBDIVIDE_ALGORITHM(u32)
+LIBDIVIDE_ALGORITHM(s32)
+LIBDIVIDE_ALGORITHM(u64)
+LIBDIVIDE_ALGORITHM(s64)
+#if defined(HAS_INT128_T)
+LIBDIVIDE_ALGORITHM(u128)
+LIBDIVIDE_ALGORITHM(s128)
+#endif
+
+#if defined(LIBDIVIDE_STATS)
+struct libdivide_stats *libdivide_get_stats(void) {
+    static struct libdivide_stats stats;
+    return &stats;
+}
+
+// Not synchronized with concurrent gen calls
+void libdivide_reset_stats(void) {
+    memset(libdivide_get_stats(), 0, sizeof(struct libdivide_stats));
+}
+
+#if defined(__GNUC__)
+#define LIBDIVIDE_STATS_INC(counter) __atomic_fetch_add(&(counter), 1, __ATOMIC_RELAXED)
+#else
+#define LIBDIVIDE_STATS_INC(counter) ((counter)++)
+#endif
+#endif
+
+// Called by the gen functions with the enum libdivide_table_type of the
+// divider and its enum libdivide_algorithm. Both arguments are unused
+// by default, so the hook costs nothing unless LIBDIVIDE_STATS is
+// defined (or the user defines the hook).
+#ifndef LIBDIVIDE_GEN_HOOK
+#if defined(LIBDIVIDE_STATS)
+#define LIBDIVIDE_GEN_HOOK(type, algorithm) \
+    ((void)LIBDIVIDE_STATS_INC(libdivide_get_stats()->gen[type][algorithm]))
+#else
+#define LIBDIVIDE_GEN_HOOK(type, algorithm) ((void)0)
+#endif
+#endif
+
+////////// UINT16
+
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_internal_u16_gen(
+    uint16_t d, int branchfree) {
     if (d == 0) {
         LIBDIVIDE_ERROR("divider must be != 0");
     }
 
-    struct libdivide_u32_t result;
-    uint32_t floor_log_2_d = 31 - libdivide_count_leading_zeros32(d);
+    struct libdivide_u16_t result;
+    uint8_t floor_log_2_d = (uint8_t)(15 - libdivide_count_leading_zeros16(d));
 
     // Power of 2
     if ((d & (d - 1)) == 0) {
@@ -593,24 +1395,24 @@ static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_internal_u32_gen(
         result.more = (uint8_t)(floor_log_2_d - (branchfree != 0));
     } else {
         uint8_t more;
-        uint32_t rem, proposed_m;
-        proposed_m = libdivide_64_div_32_to_32(1U << floor_log_2_d, 0, d, &rem);
+        uint16_t rem, proposed_m;
+        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << floor_log_2_d, 0, d, &rem);
 
         LIBDIVIDE_ASSERT(rem > 0 && rem < d);
-        const uint32_t e = d - rem;
+        const uint16_t e = d - rem;
 
         // This power works if e < 2**floor_log_2_d.
-        if (!branchfree && (e < (1U << floor_log_2_d))) {
+        if (!branchfree && (e < ((uint16_t)1 << floor_log_2_d))) {
             // This power works
             more = floor_log_2_d;
         } else {
-            // We have to use the general 33-bit algorithm.  We need to compute
+            // We have to use the general 17-bit algorithm.  We need to compute
             // (2**power) / d. However, we already have (2**(power-1))/d and
             // its remainder.  By doubling both, and then correcting the
             // remainder, we can compute the larger division.
             // don't care about overflow here - in fact, we expect it
             proposed_m += proposed_m;
-            const uint32_t twice_rem = rem + rem;
+            const uint16_t twice_rem = rem + rem;
             if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
             more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
         }
@@ -625,29 +1427,52 @@ static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_internal_u32_gen(
     return result;
 }
 
-struct libdivide_u32_t libdivide_u32_gen(uint32_t d) {
-    return libdivide_internal_u32_gen(d, 0);
+struct libdivide_u16_t libdivide_u16_gen(uint16_t d) {
+    struct libdivide_u16_t result = libdivide_internal_u16_gen(d, 0);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U16, libdivide_u16_algorithm(&result));
+    return result;
 }
 
-struct libdivide_u32_branchfree_t libdivide_u32_branchfree_gen(uint32_t d) {
+struct libdivide_u16_branchfree_t libdivide_u16_branchfree_gen(uint16_t d) {
     if (d == 1) {
         LIBDIVIDE_ERROR("branchfree divider must be != 1");
     }
-    struct libdivide_u32_t tmp = libdivide_internal_u32_gen(d, 1);
-    struct libdivide_u32_branchfree_t ret = {
-        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_32_SHIFT_MASK)};
+    struct libdivide_u16_t tmp = libdivide_internal_u16_gen(d, 1);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U16_BRANCHFREE, libdivide_u16_algorithm(&tmp));
+    struct libdivide_u16_branchfree_t ret = {
+        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_16_SHIFT_MASK)};
     return ret;
 }
 
-uint32_t libdivide_u32_do(uint32_t numer, const struct libdivide_u32_t *denom) {
+// See libdivide_u32_gen_bounded()
+struct libdivide_u16_t libdivide_u16_gen_bounded(uint16_t d, uint16_t max_numer) {
+    struct libdivide_u16_t result = libdivide_internal_u16_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint8_t shift = result.more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t rem, proposed_m;
+        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << shift, 0, d, &rem);
+        const uint16_t e = d - rem;
+        const uint16_t n = (max_numer < d) ? d : max_numer;
+
+        // This power works if e * n < 2**(16 + shift)
+        if ((((uint32_t)e * n) >> 16) < (1U << shift)) {
+            result.magic = 1 + proposed_m;
+            result.more = shift;
+        }
+    }
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U16, libdivide_u16_algorithm(&result));
+    return result;
+}
+
+uint16_t libdivide_u16_do(uint16_t numer, const struct libdivide_u16_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
         return numer >> more;
     } else {
-        uint32_t q = libdivide_mullhi_u32(denom->magic, numer);
+        uint16_t q = libdivide_mullhi_u16(denom->magic, numer);
         if (more & LIBDIVIDE_ADD_MARKER) {
-            uint32_t t = ((numer - q) >> 1) + q;
-            return t >> (more & LIBDIVIDE_32_SHIFT_MASK);
+            uint16_t t = ((numer - q) >> 1) + q;
+            return t >> (more & LIBDIVIDE_16_SHIFT_MASK);
         } else {
             // All upper bits are 0,
             // don't need to mask them off.
@@ -656,261 +1481,89 @@ uint32_t libdivide_u32_do(uint32_t numer, const struct libdivide_u32_t *denom) {
     }
 }
 
-uint32_t libdivide_u32_branchfree_do(
-    uint32_t numer, const struct libdivide_u32_branchfree_t *denom) {
-    uint32_t q = libdivide_mullhi_u32(denom->magic, numer);
-    uint32_t t = ((numer - q) >> 1) + q;
+uint16_t libdivide_u16_branchfree_do(
+    uint16_t numer, const struct libdivide_u16_branchfree_t *denom) {
+    uint16_t q = libdivide_mullhi_u16(denom->magic, numer);
+    uint16_t t = ((numer - q) >> 1) + q;
     return t >> denom->more;
 }
 
-uint32_t libdivide_u32_recover(const struct libdivide_u32_t *denom) {
+uint16_t libdivide_u16_recover(const struct libdivide_u16_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
 
     if (!denom->magic) {
-        return 1U << shift;
+        return (uint16_t)1 << shift;
     } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
-        // We compute q = n/d = n*m / 2^(32 + shift)
-        // Therefore we have d = 2^(32 + shift) / m
+        // We compute q = n/d = n*m / 2^(16 + shift)
+        // Therefore we have d = 2^(16 + shift) / m
         // We need to ceil it.
         // We know d is not a power of 2, so m is not a power of 2,
         // so we can just add 1 to the floor
-        uint32_t hi_dividend = 1U << shift;
-        uint32_t rem_ignored;
-        return 1 + libdivide_64_div_32_to_32(hi_dividend, 0, denom->magic, &rem_ignored);
+        uint16_t hi_dividend = (uint16_t)1 << shift;
+        uint16_t rem_ignored;
+        return 1 + libdivide_32_div_16_to_16(hi_dividend, 0, denom->magic, &rem_ignored);
     } else {
-        // Here we wish to compute d = 2^(32+shift+1)/(m+2^32).
-        // Notice (m + 2^32) is a 33 bit number. Use 64 bit division for now
-        // Also note that shift may be as high as 31, so shift + 1 will
-        // overflow. So we have to compute it as 2^(32+shift)/(m+2^32), and
+        // Here we wish to compute d = 2^(16+shift+1)/(m+2^16).
+        // Notice (m + 2^16) is a 17 bit number. Use 32 bit division for now
+        // Also note that shift may be as high as 15, so shift + 1 will
+        // overflow. So we have to compute it as 2^(16+shift)/(m+2^16), and
         // then double the quotient and remainder.
-        uint64_t half_n = 1ULL << (32 + shift);
-        uint64_t d = (1ULL << 32) | denom->magic;
-        // Note that the quotient is guaranteed <= 32 bits, but the remainder
-        // may need 33!
-        uint32_t half_q = (uint32_t)(half_n / d);
-        uint64_t rem = half_n % d;
-        // We computed 2^(32+shift)/(m+2^32)
+        uint32_t half_n = (uint32_t)1 << (16 + shift);
+        uint32_t d = ((uint32_t)1 << 16) | denom->magic;
+        // Note that the quotient is guaranteed <= 16 bits, but the remainder
+        // may need 17!
+        uint16_t half_q = (uint16_t)(half_n / d);
+        uint32_t rem = half_n % d;
+        // We computed 2^(16+shift)/(m+2^16)
         // Need to double it, and then add 1 to the quotient if doubling th
         // remainder would increase the quotient.
-        // Note that rem<<1 cannot overflow, since rem < d and d is 33 bits
-        uint32_t full_q = half_q + half_q + ((rem << 1) >= d);
+        // Note that rem<<1 cannot overflow, since rem < d and d is 17 bits
+        uint16_t full_q = half_q + half_q + ((rem << 1) >= d);
 
         // We rounded down in gen (hence +1)
         return full_q + 1;
     }
 }
 
-uint32_t libdivide_u32_branchfree_recover(const struct libdivide_u32_branchfree_t *denom) {
+uint16_t libdivide_u16_branchfree_recover(const struct libdivide_u16_branchfree_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
 
     if (!denom->magic) {
-        return 1U << (shift + 1);
+        return (uint16_t)1 << (shift + 1);
     } else {
-        // Here we wish to compute d = 2^(32+shift+1)/(m+2^32).
-        // Notice (m + 2^32) is a 33 bit number. Use 64 bit division for now
-        // Also note that shift may be as high as 31, so shift + 1 will
-        // overflow. So we have to compute it as 2^(32+shift)/(m+2^32), and
+        // Here we wish to compute d = 2^(16+shift+1)/(m+2^16).
+        // Notice (m + 2^16) is a 17 bit number. Use 32 bit division for now
+        // Also note that shift may be as high as 15, so shift + 1 will
+        // overflow. So we have to compute it as 2^(16+shift)/(m+2^16), and
         // then double the quotient and remainder.
-        uint64_t half_n = 1ULL << (32 + shift);
-        uint64_t d = (1ULL << 32) | denom->magic;
-        // Note that the quotient is guaranteed <= 32 bits, but the remainder
-        // may need 33!
-        uint32_t half_q = (uint32_t)(half_n / d);
-        uint64_t rem = half_n % d;
-        // We computed 2^(32+shift)/(m+2^32)
+        uint32_t half_n = (uint32_t)1 << (16 + shift);
+        uint32_t d = ((uint32_t)1 << 16) | denom->magic;
+        // Note that the quotient is guaranteed <= 16 bits, but the remainder
+        // may need 17!
+        uint16_t half_q = (uint16_t)(half_n / d);
+        uint32_t rem = half_n % d;
+        // We computed 2^(16+shift)/(m+2^16)
         // Need to double it, and then add 1 to the quotient if doubling th
         // remainder would increase the quotient.
-        // Note that rem<<1 cannot overflow, since rem < d and d is 33 bits
-        uint32_t full_q = half_q + half_q + ((rem << 1) >= d);
+        // Note that rem<<1 cannot overflow, since rem < d and d is 17 bits
+        uint16_t full_q = half_q + half_q + ((rem << 1) >= d);
 
         // We rounded down in gen (hence +1)
         return full_q + 1;
     }
 }
 
-/////////// UINT64
-
-static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_internal_u64_gen(
-    uint64_t d, int branchfree) {
-    if (d == 0) {
-        LIBDIVIDE_ERROR("divider must be != 0");
-    }
-
-    struct libdivide_u64_t result;
-    uint32_t floor_log_2_d = 63 - libdivide_count_leading_zeros64(d);
-
-    // Power of 2
-    if ((d & (d - 1)) == 0) {
-        // We need to subtract 1 from the shift value in case of an unsigned
-        // branchfree divider because there is a hardcoded right shift by 1
-        // in its division algorithm. Because of this we also need to add back
-        // 1 in its recovery algorithm.
-        result.magic = 0;
-        result.more = (uint8_t)(floor_log_2_d - (branchfree != 0));
-    } else {
-        uint64_t proposed_m, rem;
-        uint8_t more;
-        // (1 << (64 + floor_log_2_d)) / d
-        proposed_m = libdivide_128_div_64_to_64(1ULL << floor_log_2_d, 0, d, &rem);
-
-        LIBDIVIDE_ASSERT(rem > 0 && rem < d);
-        const uint64_t e = d - rem;
-
-        // This power works if e < 2**floor_log_2_d.
-        if (!branchfree && e < (1ULL << floor_log_2_d)) {
-            // This power works
-            more = floor_log_2_d;
-        } else {
-            // We have to use the general 65-bit algorithm.  We need to compute
-            // (2**power) / d. However, we already have (2**(power-1))/d and
-            // its remainder. By doubling both, and then correcting the
-            // remainder, we can compute the larger division.
-            // don't care about overflow here - in fact, we expect it
-            proposed_m += proposed_m;
-            const uint64_t twice_rem = rem + rem;
-            if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
-            more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
-        }
-        result.magic = 1 + proposed_m;
-        result.more = more;
-        // result.more's shift should in general be ceil_log_2_d. But if we
-        // used the smaller power, we subtract one from the shift because we're
-        // using the smaller power. If we're using the larger power, we
-        // subtract one from the shift because it's taken care of by the add
-        // indicator. So floor_log_2_d happens to be correct in both cases,
-        // which is why we do it outside of the if statement.
-    }
-    return result;
-}
-
-struct libdivide_u64_t libdivide_u64_gen(uint64_t d) {
-    return libdivide_internal_u64_gen(d, 0);
-}
-
-struct libdivide_u64_branchfree_t libdivide_u64_branchfree_gen(uint64_t d) {
-    if (d == 1) {
-        LIBDIVIDE_ERROR("branchfree divider must be != 1");
-    }
-    struct libdivide_u64_t tmp = libdivide_internal_u64_gen(d, 1);
-    struct libdivide_u64_branchfree_t ret = {
-        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_64_SHIFT_MASK)};
-    return ret;
-}
-
-uint64_t libdivide_u64_do(uint64_t numer, const struct libdivide_u64_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return numer >> more;
-    } else {
-        uint64_t q = libdivide_mullhi_u64(denom->magic, numer);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            uint64_t t = ((numer - q) >> 1) + q;
-            return t >> (more & LIBDIVIDE_64_SHIFT_MASK);
-        } else {
-            // All upper bits are 0,
-            // don't need to mask them off.
-            return q >> more;
-        }
-    }
-}
-
-uint64_t libdivide_u64_branchfree_do(
-    uint64_t numer, const struct libdivide_u64_branchfree_t *denom) {
-    uint64_t q = libdivide_mullhi_u64(denom->magic, numer);
-    uint64_t t = ((numer - q) >> 1) + q;
-    return t >> denom->more;
-}
-
-uint64_t libdivide_u64_recover(const struct libdivide_u64_t *denom) {
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-
-    if (!denom->magic) {
-        return 1ULL << shift;
-    } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
-        // We compute q = n/d = n*m / 2^(64 + shift)
-        // Therefore we have d = 2^(64 + shift) / m
-        // We need to ceil it.
-        // We know d is not a power of 2, so m is not a power of 2,
-        // so we can just add 1 to the floor
-        uint64_t hi_dividend = 1ULL << shift;
-        uint64_t rem_ignored;
-        return 1 + libdivide_128_div_64_to_64(hi_dividend, 0, denom->magic, &rem_ignored);
-    } else {
-        // Here we wish to compute d = 2^(64+shift+1)/(m+2^64).
-        // Notice (m + 2^64) is a 65 bit number. This gets hairy. See
-        // libdivide_u32_recover for more on what we do here.
-        // TODO: do something better than 128 bit math
-
-        // Full n is a (potentially) 129 bit value
-        // half_n is a 128 bit value
-        // Compute the hi half of half_n. Low half is 0.
-        uint64_t half_n_hi = 1ULL << shift, half_n_lo = 0;
-        // d is a 65 bit value. The high bit is always set to 1.
-        const uint64_t d_hi = 1, d_lo = denom->magic;
-        // Note that the quotient is guaranteed <= 64 bits,
-        // but the remainder may need 65!
-        uint64_t r_hi, r_lo;
-        uint64_t half_q =
-            libdivide_128_div_128_to_64(half_n_hi, half_n_lo, d_hi, d_lo, &r_hi, &r_lo);
-        // We computed 2^(64+shift)/(m+2^64)
-        // Double the remainder ('dr') and check if that is larger than d
-        // Note that d is a 65 bit value, so r1 is small and so r1 + r1
-        // cannot overflow
-        uint64_t dr_lo = r_lo + r_lo;
-        uint64_t dr_hi = r_hi + r_hi + (dr_lo < r_lo);  // last term is carry
-        int dr_exceeds_d = (dr_hi > d_hi) || (dr_hi == d_hi && dr_lo >= d_lo);
-        uint64_t full_q = half_q + half_q + (dr_exceeds_d ? 1 : 0);
-        return full_q + 1;
-    }
-}
-
-uint64_t libdivide_u64_branchfree_recover(const struct libdivide_u64_branchfree_t *denom) {
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-
-    if (!denom->magic) {
-        return 1ULL << (shift + 1);
-    } else {
-        // Here we wish to compute d = 2^(64+shift+1)/(m+2^64).
-        // Notice (m + 2^64) is a 65 bit number. This gets hairy. See
-        // libdivide_u32_recover for more on what we do here.
-        // TODO: do something better than 128 bit math
-
-        // Full n is a (potentially) 129 bit value
-        // half_n is a 128 bit value
-        // Compute the hi half of half_n. Low half is 0.
-        uint64_t half_n_hi = 1ULL << shift, half_n_lo = 0;
-        // d is a 65 bit value. The high bit is always set to 1.
-        const uint64_t d_hi = 1, d_lo = denom->magic;
-        // Note that the quotient is guaranteed <= 64 bits,
-        // but the remainder may need 65!
-        uint64_t r_hi, r_lo;
-        uint64_t half_q =
-            libdivide_128_div_128_to_64(half_n_hi, half_n_lo, d_hi, d_lo, &r_hi, &r_lo);
-        // We computed 2^(64+shift)/(m+2^64)
-        // Double the remainder ('dr') and check if that is larger than d
-        // Note that d is a 65 bit value, so r1 is small and so r1 + r1
-        // cannot overflow
-        uint64_t dr_lo = r_lo + r_lo;
-        uint64_t dr_hi = r_hi + r_hi + (dr_lo < r_lo);  // last term is carry
-        int dr_exceeds_d = (dr_hi > d_hi) || (dr_hi == d_hi && dr_lo >= d_lo);
-        uint64_t full_q = half_q + half_q + (dr_exceeds_d ? 1 : 0);
-        return full_q + 1;
-    }
-}
-
-/////////// SINT32
+/////////// SINT16
 
-static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
-    int32_t d, int branchfree) {
+static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_internal_s16_gen(
+    int16_t d, int branchfree) {
     if (d == 0) {
         LIBDIVIDE_ERROR("divider must be != 0");
     }
 
-    struct libdivide_s32_t result;
+    struct libdivide_s16_t result;
 
     // If d is a power of 2, or negative a power of 2, we have to use a shift.
     // This is especially important because the magic algorithm fails for -1.
@@ -918,9 +1571,9 @@ static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
     // whether its absolute value has exactly one bit set. This works even for
     // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
     // and is a power of 2.
-    uint32_t ud = (uint32_t)d;
-    uint32_t absD = (d < 0) ? -ud : ud;
-    uint32_t floor_log_2_d = 31 - libdivide_count_leading_zeros32(absD);
+    uint16_t ud = (uint16_t)d;
+    uint16_t absD = (d < 0) ? -ud : ud;
+    uint8_t floor_log_2_d = (uint8_t)(15 - libdivide_count_leading_zeros16(absD));
     // check if exactly one bit is set,
     // don't care if absD is 0 since that's divide by zero
     if ((absD & (absD - 1)) == 0) {
@@ -931,29 +1584,30 @@ static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
         LIBDIVIDE_ASSERT(floor_log_2_d >= 1);
 
         uint8_t more;
-        // the dividend here is 2**(floor_log_2_d + 31), so the low 32 bit word
+        // the dividend here is 2**(floor_log_2_d + 15), so the low 16 bit word
         // is 0 and the high word is floor_log_2_d - 1
-        uint32_t rem, proposed_m;
-        proposed_m = libdivide_64_div_32_to_32(1U << (floor_log_2_d - 1), 0, absD, &rem);
-        const uint32_t e = absD - rem;
+        uint16_t rem, proposed_m;
+        proposed_m =
+            libdivide_32_div_16_to_16((uint16_t)1 << (floor_log_2_d - 1), 0, absD, &rem);
+        const uint16_t e = absD - rem;
 
         // We are going to start with a power of floor_log_2_d - 1.
         // This works if works if e < 2**floor_log_2_d.
-        if (!branchfree && e < (1U << floor_log_2_d)) {
+        if (!branchfree && e < ((uint16_t)1 << floor_log_2_d)) {
             // This power works
             more = floor_log_2_d - 1;
         } else {
             // We need to go one higher. This should not make proposed_m
             // overflow, but it will make it negative when interpreted as an
-            // int32_t.
+            // int16_t.
             proposed_m += proposed_m;
-            const uint32_t twice_rem = rem + rem;
+            const uint16_t twice_rem = rem + rem;
             if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
             more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
         }
 
         proposed_m += 1;
-        int32_t magic = (int32_t)proposed_m;
+        int16_t magic = (int16_t)proposed_m;
 
         // Mark if we are negative. Note we only negate the magic number in the
         // branchfull case.
@@ -970,59 +1624,91 @@ static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
     return result;
 }
 
-struct libdivide_s32_t libdivide_s32_gen(int32_t d) {
-    return libdivide_internal_s32_gen(d, 0);
+struct libdivide_s16_t libdivide_s16_gen(int16_t d) {
+    struct libdivide_s16_t result = libdivide_internal_s16_gen(d, 0);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S16, libdivide_s16_algorithm(&result));
+    return result;
 }
 
-struct libdivide_s32_branchfree_t libdivide_s32_branchfree_gen(int32_t d) {
-    struct libdivide_s32_t tmp = libdivide_internal_s32_gen(d, 1);
-    struct libdivide_s32_branchfree_t result = {tmp.magic, tmp.more};
+struct libdivide_s16_branchfree_t libdivide_s16_branchfree_gen(int16_t d) {
+    struct libdivide_s16_t tmp = libdivide_internal_s16_gen(d, 1);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S16_BRANCHFREE, libdivide_s16_algorithm(&tmp));
+    struct libdivide_s16_branchfree_t result = {tmp.magic, tmp.more};
     return result;
 }
 
-int32_t libdivide_s32_do(int32_t numer, const struct libdivide_s32_t *denom) {
+struct libdivide_s16_t libdivide_s16_gen_bounded(int16_t d, int16_t max_numer) {
+    if (max_numer < 0) {
+        LIBDIVIDE_ERROR("max_numer must be >= 0");
+    }
+
+    // See libdivide_u16_gen_bounded(), the bound max_numer + 1 also
+    // covers the numerator -(max_numer + 1), e.g. INT16_MIN.
+    struct libdivide_s16_t result = libdivide_internal_s16_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint16_t ud = (uint16_t)d;
+        uint16_t absD = (d < 0) ? -ud : ud;
+        uint8_t shift = (result.more & LIBDIVIDE_16_SHIFT_MASK) - 1;
+        uint16_t rem, proposed_m;
+        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << shift, 0, absD, &rem);
+        const uint16_t e = absD - rem;
+        uint16_t n = (uint16_t)max_numer + 1;
+        if (n < absD) n = absD;
+
+        // This power works if e * n < 2**(16 + shift)
+        if ((((uint32_t)e * n) >> 16) < (1U << shift)) {
+            int16_t magic = (int16_t)(proposed_m + 1);
+            result.magic = (d < 0) ? -magic : magic;
+            result.more = (uint8_t)(shift | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0));
+        }
+    }
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S16, libdivide_s16_algorithm(&result));
+    return result;
+}
+
+int16_t libdivide_s16_do(int16_t numer, const struct libdivide_s16_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
 
     if (!denom->magic) {
-        uint32_t sign = (int8_t)more >> 7;
-        uint32_t mask = (1U << shift) - 1;
-        uint32_t uq = numer + ((numer >> 31) & mask);
-        int32_t q = (int32_t)uq;
+        uint16_t sign = (int8_t)more >> 7;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        uint16_t uq = numer + ((numer >> 15) & mask);
+        int16_t q = (int16_t)uq;
         q >>= shift;
         q = (q ^ sign) - sign;
         return q;
     } else {
-        uint32_t uq = (uint32_t)libdivide_mullhi_s32(denom->magic, numer);
+        uint16_t uq = (uint16_t)libdivide_mullhi_s16(denom->magic, numer);
         if (more & LIBDIVIDE_ADD_MARKER) {
             // must be arithmetic shift and then sign extend
-            int32_t sign = (int8_t)more >> 7;
+            int16_t sign = (int8_t)more >> 7;
             // q += (more < 0 ? -numer : numer)
             // cast required to avoid UB
-            uq += ((uint32_t)numer ^ sign) - sign;
+            uq += ((uint16_t)numer ^ sign) - sign;
         }
-        int32_t q = (int32_t)uq;
+        int16_t q = (int16_t)uq;
         q >>= shift;
         q += (q < 0);
         return q;
     }
 }
 
-int32_t libdivide_s32_branchfree_do(int32_t numer, const struct libdivide_s32_branchfree_t *denom) {
+int16_t libdivide_s16_branchfree_do(int16_t numer, const struct libdivide_s16_branchfree_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
     // must be arithmetic shift and then sign extend
-    int32_t sign = (int8_t)more >> 7;
-    int32_t magic = denom->magic;
-    int32_t q = libdivide_mullhi_s32(magic, numer);
+    int16_t sign = (int8_t)more >> 7;
+    int16_t magic = denom->magic;
+    int16_t q = libdivide_mullhi_s16(magic, numer);
     q += numer;
 
     // If q is non-negative, we have nothing to do
     // If q is negative, we want to add either (2**shift)-1 if d is a power of
     // 2, or (2**shift) if it is not a power of 2
-    uint32_t is_power_of_2 = (magic == 0);
-    uint32_t q_sign = (uint32_t)(q >> 31);
-    q += q_sign & ((1U << shift) - is_power_of_2);
+    uint16_t is_power_of_2 = (magic == 0);
+    uint16_t q_sign = (uint16_t)(q >> 15);
+    q += q_sign & (((uint16_t)1 << shift) - is_power_of_2);
 
     // Now arithmetic right shift
     q >>= shift;
@@ -1032,15 +1718,15 @@ int32_t libdivide_s32_branchfree_do(int32_t numer, const struct libdivide_s32_br
     return q;
 }
 
-int32_t libdivide_s32_recover(const struct libdivide_s32_t *denom) {
+int16_t libdivide_s16_recover(const struct libdivide_s16_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
     if (!denom->magic) {
-        uint32_t absD = 1U << shift;
+        uint16_t absD = (uint16_t)1 << shift;
         if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
             absD = -absD;
         }
-        return (int32_t)absD;
+        return (int16_t)absD;
     } else {
         // Unsigned math is much easier
         // We negate the magic number only in the branchfull case, and we don't
@@ -1052,1499 +1738,9261 @@ int32_t libdivide_s32_recover(const struct libdivide_s32_t *denom) {
         int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
         int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
 
-        // Handle the power of 2 case (including branchfree)
-        if (denom->magic == 0) {
-            int32_t result = 1U << shift;
-            return negative_divisor ? -result : result;
-        }
-
-        uint32_t d = (uint32_t)(magic_was_negated ? -denom->magic : denom->magic);
-        uint64_t n = 1ULL << (32 + shift);  // this shift cannot exceed 30
-        uint32_t q = (uint32_t)(n / d);
-        int32_t result = (int32_t)q;
+        uint16_t d = (uint16_t)(magic_was_negated ? -denom->magic : denom->magic);
+        uint32_t n = (uint32_t)1 << (16 + shift);  // this shift cannot exceed 30
+        uint16_t q = (uint16_t)(n / d);
+        int16_t result = (int16_t)q;
         result += 1;
         return negative_divisor ? -result : result;
     }
 }
 
-int32_t libdivide_s32_branchfree_recover(const struct libdivide_s32_branchfree_t *denom) {
-    return libdivide_s32_recover((const struct libdivide_s32_t *)denom);
+int16_t libdivide_s16_branchfree_recover(const struct libdivide_s16_branchfree_t *denom) {
+    return libdivide_s16_recover((const struct libdivide_s16_t *)denom);
 }
 
-///////////// SINT64
+////////// UINT32
 
-static LIBDIVIDE_INLINE struct libdivide_s64_t libdivide_internal_s64_gen(
-    int64_t d, int branchfree) {
+static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_internal_u32_gen(
+    uint32_t d, int branchfree) {
     if (d == 0) {
         LIBDIVIDE_ERROR("divider must be != 0");
     }
 
-    struct libdivide_s64_t result;
+    struct libdivide_u32_t result;
+    uint32_t floor_log_2_d = 31 - libdivide_count_leading_zeros32(d);
 
-    // If d is a power of 2, or negative a power of 2, we have to use a shift.
-    // This is especially important because the magic algorithm fails for -1.
-    // To check if d is a power of 2 or its inverse, it suffices to check
-    // whether its absolute value has exactly one bit set.  This works even for
-    // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
-    // and is a power of 2.
-    uint64_t ud = (uint64_t)d;
-    uint64_t absD = (d < 0) ? -ud : ud;
-    uint32_t floor_log_2_d = 63 - libdivide_count_leading_zeros64(absD);
-    // check if exactly one bit is set,
-    // don't care if absD is 0 since that's divide by zero
-    if ((absD & (absD - 1)) == 0) {
-        // Branchfree and non-branchfree cases are the same
+    // Power of 2
+    if ((d & (d - 1)) == 0) {
+        // We need to subtract 1 from the shift value in case of an unsigned
+        // branchfree divider because there is a hardcoded right shift by 1
+        // in its division algorithm. Because of this we also need to add back
+        // 1 in its recovery algorithm.
         result.magic = 0;
-        result.more = floor_log_2_d | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0);
+        result.more = (uint8_t)(floor_log_2_d - (branchfree != 0));
     } else {
-        // the dividend here is 2**(floor_log_2_d + 63), so the low 64 bit word
-        // is 0 and the high word is floor_log_2_d - 1
         uint8_t more;
-        uint64_t rem, proposed_m;
-        proposed_m = libdivide_128_div_64_to_64(1ULL << (floor_log_2_d - 1), 0, absD, &rem);
-        const uint64_t e = absD - rem;
+        uint32_t rem, proposed_m;
+        proposed_m = libdivide_64_div_32_to_32(1U << floor_log_2_d, 0, d, &rem);
 
-        // We are going to start with a power of floor_log_2_d - 1.
-        // This works if works if e < 2**floor_log_2_d.
-        if (!branchfree && e < (1ULL << floor_log_2_d)) {
+        LIBDIVIDE_ASSERT(rem > 0 && rem < d);
+        const uint32_t e = d - rem;
+
+        // This power works if e < 2**floor_log_2_d.
+        if (!branchfree && (e < (1U << floor_log_2_d))) {
             // This power works
-            more = floor_log_2_d - 1;
+            more = floor_log_2_d;
         } else {
-            // We need to go one higher. This should not make proposed_m
-            // overflow, but it will make it negative when interpreted as an
-            // int32_t.
+            // We have to use the general 33-bit algorithm.  We need to compute
+            // (2**power) / d. However, we already have (2**(power-1))/d and
+            // its remainder.  By doubling both, and then correcting the
+            // remainder, we can compute the larger division.
+            // don't care about overflow here - in fact, we expect it
             proposed_m += proposed_m;
-            const uint64_t twice_rem = rem + rem;
-            if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
-            // note that we only set the LIBDIVIDE_NEGATIVE_DIVISOR bit if we
-            // also set ADD_MARKER this is an annoying optimization that
-            // enables algorithm #4 to avoid the mask. However we always set it
-            // in the branchfree case
+            const uint32_t twice_rem = rem + rem;
+            if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
             more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
         }
-        proposed_m += 1;
-        int64_t magic = (int64_t)proposed_m;
-
-        // Mark if we are negative
-        if (d < 0) {
-            more |= LIBDIVIDE_NEGATIVE_DIVISOR;
-            if (!branchfree) {
-                magic = -magic;
-            }
-        }
-
+        result.magic = 1 + proposed_m;
         result.more = more;
-        result.magic = magic;
+        // result.more's shift should in general be ceil_log_2_d. But if we
+        // used the smaller power, we subtract one from the shift because we're
+        // using the smaller power. If we're using the larger power, we
+        // subtract one from the shift because it's taken care of by the add
+        // indicator. So floor_log_2_d happens to be correct in both cases.
     }
     return result;
 }
 
-struct libdivide_s64_t libdivide_s64_gen(int64_t d) {
-    return libdivide_internal_s64_gen(d, 0);
+struct libdivide_u32_t libdivide_u32_gen(uint32_t d) {
+    struct libdivide_u32_t result = libdivide_internal_u32_gen(d, 0);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U32, libdivide_u32_algorithm(&result));
+    return result;
 }
 
-struct libdivide_s64_branchfree_t libdivide_s64_branchfree_gen(int64_t d) {
-    struct libdivide_s64_t tmp = libdivide_internal_s64_gen(d, 1);
-    struct libdivide_s64_branchfree_t ret = {tmp.magic, tmp.more};
+struct libdivide_u32_branchfree_t libdivide_u32_branchfree_gen(uint32_t d) {
+    if (d == 1) {
+        LIBDIVIDE_ERROR("branchfree divider must be != 1");
+    }
+    struct libdivide_u32_t tmp = libdivide_internal_u32_gen(d, 1);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U32_BRANCHFREE, libdivide_u32_algorithm(&tmp));
+    struct libdivide_u32_branchfree_t ret = {
+        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_32_SHIFT_MASK)};
     return ret;
 }
 
-int64_t libdivide_s64_do(int64_t numer, const struct libdivide_s64_t *denom) {
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+// libdivide_u32_gen_bounded() generates a divider for numerators
+// <= max_numer. If the full range divider requires the add indicator
+// (33-bit magic number), the smaller power of 2 often works for the
+// bounded numerators: with m = ceil(2**(32 + shift) / d) and
+// e = m * d - 2**(32 + shift), floor(n * m / 2**(32 + shift)) is exact
+// for all n <= N if e * N < 2**(32 + shift). This saves the add and
+// shift of the add indicator path in libdivide_u32_do(). The bound is
+// raised to d so that libdivide_u32_recover() remains exact.
+struct libdivide_u32_t libdivide_u32_gen_bounded(uint32_t d, uint32_t max_numer) {
+    struct libdivide_u32_t result = libdivide_internal_u32_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint8_t shift = result.more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t rem, proposed_m;
+        proposed_m = libdivide_64_div_32_to_32(1U << shift, 0, d, &rem);
+        const uint32_t e = d - rem;
+        const uint32_t n = (max_numer < d) ? d : max_numer;
 
-    if (!denom->magic) {  // shift path
-        uint64_t mask = (1ULL << shift) - 1;
-        uint64_t uq = numer + ((numer >> 63) & mask);
-        int64_t q = (int64_t)uq;
-        q >>= shift;
-        // must be arithmetic shift and then sign-extend
-        int64_t sign = (int8_t)more >> 7;
-        q = (q ^ sign) - sign;
-        return q;
+        // This power works if e * n < 2**(32 + shift)
+        if ((((uint64_t)e * n) >> 32) < (1ULL << shift)) {
+            result.magic = 1 + proposed_m;
+            result.more = shift;
+        }
+    }
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U32, libdivide_u32_algorithm(&result));
+    return result;
+}
+
+uint32_t libdivide_u32_do(uint32_t numer, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return numer >> more;
     } else {
-        uint64_t uq = (uint64_t)libdivide_mullhi_s64(denom->magic, numer);
+        uint32_t q = libdivide_mullhi_u32(denom->magic, numer);
         if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift and then sign extend
-            int64_t sign = (int8_t)more >> 7;
-            // q += (more < 0 ? -numer : numer)
-            // cast required to avoid UB
-            uq += ((uint64_t)numer ^ sign) - sign;
+            uint32_t t = ((numer - q) >> 1) + q;
+            return t >> (more & LIBDIVIDE_32_SHIFT_MASK);
+        } else {
+            // All upper bits are 0,
+            // don't need to mask them off.
+            return q >> more;
         }
-        int64_t q = (int64_t)uq;
-        q >>= shift;
-        q += (q < 0);
-        return q;
     }
 }
 
-int64_t libdivide_s64_branchfree_do(int64_t numer, const struct libdivide_s64_branchfree_t *denom) {
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift and then sign extend
-    int64_t sign = (int8_t)more >> 7;
-    int64_t magic = denom->magic;
-    int64_t q = libdivide_mullhi_s64(magic, numer);
-    q += numer;
+uint32_t libdivide_u32_branchfree_do(
+    uint32_t numer, const struct libdivide_u32_branchfree_t *denom) {
+    uint32_t q = libdivide_mullhi_u32(denom->magic, numer);
+    uint32_t t = ((numer - q) >> 1) + q;
+    return t >> denom->more;
+}
 
-    // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is a power of
-    // 2, or (2**shift) if it is not a power of 2.
-    uint64_t is_power_of_2 = (magic == 0);
-    uint64_t q_sign = (uint64_t)(q >> 63);
-    q += q_sign & ((1ULL << shift) - is_power_of_2);
+uint32_t libdivide_u32_recover(const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
 
-    // Arithmetic right shift
-    q >>= shift;
-    // Negate if needed
-    q = (q ^ sign) - sign;
+    if (!denom->magic) {
+        return 1U << shift;
+    } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
+        // We compute q = n/d = n*m / 2^(32 + shift)
+        // Therefore we have d = 2^(32 + shift) / m
+        // We need to ceil it.
+        // We know d is not a power of 2, so m is not a power of 2,
+        // so we can just add 1 to the floor
+        uint32_t hi_dividend = 1U << shift;
+        uint32_t rem_ignored;
+        return 1 + libdivide_64_div_32_to_32(hi_dividend, 0, denom->magic, &rem_ignored);
+    } else {
+        // Here we wish to compute d = 2^(32+shift+1)/(m+2^32).
+        // Notice (m + 2^32) is a 33 bit number. Use 64 bit division for now
+        // Also note that shift may be as high as 31, so shift + 1 will
+        // overflow. So we have to compute it as 2^(32+shift)/(m+2^32), and
+        // then double the quotient and remainder.
+        uint64_t half_n = 1ULL << (32 + shift);
+        uint64_t d = (1ULL << 32) | denom->magic;
+        // Note that the quotient is guaranteed <= 32 bits, but the remainder
+        // may need 33!
+        uint32_t half_q = (uint32_t)(half_n / d);
+        uint64_t rem = half_n % d;
+        // We computed 2^(32+shift)/(m+2^32)
+        // Need to double it, and then add 1 to the quotient if doubling th
+        // remainder would increase the quotient.
+        // Note that rem<<1 cannot overflow, since rem < d and d is 33 bits
+        uint32_t full_q = half_q + half_q + ((rem << 1) >= d);
 
-    return q;
+        // We rounded down in gen (hence +1)
+        return full_q + 1;
+    }
 }
 
-int64_t libdivide_s64_recover(const struct libdivide_s64_t *denom) {
+uint32_t libdivide_u32_branchfree_recover(const struct libdivide_u32_branchfree_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    if (denom->magic == 0) {  // shift path
-        uint64_t absD = 1ULL << shift;
-        if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
-            absD = -absD;
-        }
-        return (int64_t)absD;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+
+    if (!denom->magic) {
+        return 1U << (shift + 1);
     } else {
-        // Unsigned math is much easier
-        int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
-        int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
+        // Here we wish to compute d = 2^(32+shift+1)/(m+2^32).
+        // Notice (m + 2^32) is a 33 bit number. Use 64 bit division for now
+        // Also note that shift may be as high as 31, so shift + 1 will
+        // overflow. So we have to compute it as 2^(32+shift)/(m+2^32), and
+        // then double the quotient and remainder.
+        uint64_t half_n = 1ULL << (32 + shift);
+        uint64_t d = (1ULL << 32) | denom->magic;
+        // Note that the quotient is guaranteed <= 32 bits, but the remainder
+        // may need 33!
+        uint32_t half_q = (uint32_t)(half_n / d);
+        uint64_t rem = half_n % d;
+        // We computed 2^(32+shift)/(m+2^32)
+        // Need to double it, and then add 1 to the quotient if doubling th
+        // remainder would increase the quotient.
+        // Note that rem<<1 cannot overflow, since rem < d and d is 33 bits
+        uint32_t full_q = half_q + half_q + ((rem << 1) >= d);
 
-        uint64_t d = (uint64_t)(magic_was_negated ? -denom->magic : denom->magic);
-        uint64_t n_hi = 1ULL << shift, n_lo = 0;
-        uint64_t rem_ignored;
-        uint64_t q = libdivide_128_div_64_to_64(n_hi, n_lo, d, &rem_ignored);
-        int64_t result = (int64_t)(q + 1);
-        if (negative_divisor) {
-            result = -result;
-        }
-        return result;
+        // We rounded down in gen (hence +1)
+        return full_q + 1;
     }
 }
 
-int64_t libdivide_s64_branchfree_recover(const struct libdivide_s64_branchfree_t *denom) {
-    return libdivide_s64_recover((const struct libdivide_s64_t *)denom);
-}
-
-#if defined(LIBDIVIDE_NEON)
-
-static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_do_vec128(
-    uint32x4_t numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE int32x4_t libdivide_s32_do_vec128(
-    int32x4_t numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_do_vec128(
-    uint64x2_t numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_do_vec128(
-    int64x2_t numers, const struct libdivide_s64_t *denom);
+/////////// UINT64
 
-static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_branchfree_do_vec128(
-    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE int32x4_t libdivide_s32_branchfree_do_vec128(
-    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_branchfree_do_vec128(
-    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_branchfree_do_vec128(
-    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_internal_u64_gen(
+    uint64_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
 
-//////// Internal Utility Functions
+    struct libdivide_u64_t result;
+    uint32_t floor_log_2_d = 63 - libdivide_count_leading_zeros64(d);
 
-// Logical right shift by runtime value.
-// NEON implements right shift as left shits by negative values.
-static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_neon_srl(uint32x4_t v, uint8_t amt) {
-    int32_t wamt = static_cast<int32_t>(amt);
-    return vshlq_u32(v, vdupq_n_s32(-wamt));
-}
-
-static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_neon_srl(uint64x2_t v, uint8_t amt) {
-    int64_t wamt = static_cast<int64_t>(amt);
-    return vshlq_u64(v, vdupq_n_s64(-wamt));
-}
-
-// Arithmetic right shift by runtime value.
-static LIBDIVIDE_INLINE int32x4_t libdivide_s32_neon_sra(int32x4_t v, uint8_t amt) {
-    int32_t wamt = static_cast<int32_t>(amt);
-    return vshlq_s32(v, vdupq_n_s32(-wamt));
-}
-
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_neon_sra(int64x2_t v, uint8_t amt) {
-    int64_t wamt = static_cast<int64_t>(amt);
-    return vshlq_s64(v, vdupq_n_s64(-wamt));
-}
-
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_signbits(int64x2_t v) { return vshrq_n_s64(v, 63); }
+    // Power of 2
+    if ((d & (d - 1)) == 0) {
+        // We need to subtract 1 from the shift value in case of an unsigned
+        // branchfree divider because there is a hardcoded right shift by 1
+        // in its division algorithm. Because of this we also need to add back
+        // 1 in its recovery algorithm.
+        result.magic = 0;
+        result.more = (uint8_t)(floor_log_2_d - (branchfree != 0));
+    } else {
+        uint64_t proposed_m, rem;
+        uint8_t more;
+        // (1 << (64 + floor_log_2_d)) / d
+        proposed_m = libdivide_128_div_64_to_64(1ULL << floor_log_2_d, 0, d, &rem);
 
-static LIBDIVIDE_INLINE uint32x4_t libdivide_mullhi_u32_vec128(uint32x4_t a, uint32_t b) {
-    // Desire is [x0, x1, x2, x3]
-    uint32x4_t w1 = vreinterpretq_u32_u64(vmull_n_u32(vget_low_u32(a), b));  // [_, x0, _, x1]
-    uint32x4_t w2 = vreinterpretq_u32_u64(vmull_high_n_u32(a, b));           //[_, x2, _, x3]
-    return vuzp2q_u32(w1, w2);                                               // [x0, x1, x2, x3]
-}
+        LIBDIVIDE_ASSERT(rem > 0 && rem < d);
+        const uint64_t e = d - rem;
 
-static LIBDIVIDE_INLINE int32x4_t libdivide_mullhi_s32_vec128(int32x4_t a, int32_t b) {
-    int32x4_t w1 = vreinterpretq_s32_s64(vmull_n_s32(vget_low_s32(a), b));  // [_, x0, _, x1]
-    int32x4_t w2 = vreinterpretq_s32_s64(vmull_high_n_s32(a, b));           //[_, x2, _, x3]
-    return vuzp2q_s32(w1, w2);                                              // [x0, x1, x2, x3]
+        // This power works if e < 2**floor_log_2_d.
+        if (!branchfree && e < (1ULL << floor_log_2_d)) {
+            // This power works
+            more = floor_log_2_d;
+        } else {
+            // We have to use the general 65-bit algorithm.  We need to compute
+            // (2**power) / d. However, we already have (2**(power-1))/d and
+            // its remainder. By doubling both, and then correcting the
+            // remainder, we can compute the larger division.
+            // don't care about overflow here - in fact, we expect it
+            proposed_m += proposed_m;
+            const uint64_t twice_rem = rem + rem;
+            if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
+            more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
+        }
+        result.magic = 1 + proposed_m;
+        result.more = more;
+        // result.more's shift should in general be ceil_log_2_d. But if we
+        // used the smaller power, we subtract one from the shift because we're
+        // using the smaller power. If we're using the larger power, we
+        // subtract one from the shift because it's taken care of by the add
+        // indicator. So floor_log_2_d happens to be correct in both cases,
+        // which is why we do it outside of the if statement.
+    }
+    return result;
 }
 
-static LIBDIVIDE_INLINE uint64x2_t libdivide_mullhi_u64_vec128(uint64x2_t x, uint64_t sy) {
-    // full 128 bits product is:
-    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
-    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
-
-    // Get low and high words. x0 contains low 32 bits, x1 is high 32 bits.
-    uint64x2_t y = vdupq_n_u64(sy);
-    uint32x2_t x0 = vmovn_u64(x);
-    uint32x2_t y0 = vmovn_u64(y);
-    uint32x2_t x1 = vshrn_n_u64(x, 32);
-    uint32x2_t y1 = vshrn_n_u64(y, 32);
-
-    // Compute x0*y0.
-    uint64x2_t x0y0 = vmull_u32(x0, y0);
-    uint64x2_t x0y0_hi = vshrq_n_u64(x0y0, 32);
-
-    // Compute other intermediate products.
-    uint64x2_t temp = vmlal_u32(x0y0_hi, x1, y0);  // temp = x0y0_hi + x1*y0;
-    // We want to split temp into its low 32 bits and high 32 bits, both
-    // in the low half of 64 bit registers.
-    // Use shifts to avoid needing a reg for the mask.
-    uint64x2_t temp_lo = vshrq_n_u64(vshlq_n_u64(temp, 32), 32);  // temp_lo = temp & 0xFFFFFFFF;
-    uint64x2_t temp_hi = vshrq_n_u64(temp, 32);                   // temp_hi = temp >> 32;
-
-    temp_lo = vmlal_u32(temp_lo, x0, y1);  // temp_lo += x0*y0
-    temp_lo = vshrq_n_u64(temp_lo, 32);    // temp_lo >>= 32
-    temp_hi = vmlal_u32(temp_hi, x1, y1);  // temp_hi += x1*y1
-    uint64x2_t result = vaddq_u64(temp_hi, temp_lo);
+struct libdivide_u64_t libdivide_u64_gen(uint64_t d) {
+    struct libdivide_u64_t result = libdivide_internal_u64_gen(d, 0);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U64, libdivide_u64_algorithm(&result));
     return result;
 }
 
-static LIBDIVIDE_INLINE int64x2_t libdivide_mullhi_s64_vec128(int64x2_t x, int64_t sy) {
-    int64x2_t p = vreinterpretq_s64_u64(
-        libdivide_mullhi_u64_vec128(vreinterpretq_u64_s64(x), static_cast<uint64_t>(sy)));
-    int64x2_t y = vdupq_n_s64(sy);
-    int64x2_t t1 = vandq_s64(libdivide_s64_signbits(x), y);
-    int64x2_t t2 = vandq_s64(libdivide_s64_signbits(y), x);
-    p = vsubq_s64(p, t1);
-    p = vsubq_s64(p, t2);
-    return p;
+struct libdivide_u64_branchfree_t libdivide_u64_branchfree_gen(uint64_t d) {
+    if (d == 1) {
+        LIBDIVIDE_ERROR("branchfree divider must be != 1");
+    }
+    struct libdivide_u64_t tmp = libdivide_internal_u64_gen(d, 1);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U64_BRANCHFREE, libdivide_u64_algorithm(&tmp));
+    struct libdivide_u64_branchfree_t ret = {
+        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_64_SHIFT_MASK)};
+    return ret;
 }
 
-////////// UINT32
+// See libdivide_u32_gen_bounded()
+struct libdivide_u64_t libdivide_u64_gen_bounded(uint64_t d, uint64_t max_numer) {
+    struct libdivide_u64_t result = libdivide_internal_u64_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint8_t shift = result.more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t rem, proposed_m;
+        proposed_m = libdivide_128_div_64_to_64(1ULL << shift, 0, d, &rem);
+        const uint64_t e = d - rem;
+        const uint64_t n = (max_numer < d) ? d : max_numer;
 
-uint32x4_t libdivide_u32_do_vec128(uint32x4_t numers, const struct libdivide_u32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return libdivide_u32_neon_srl(numers, more);
-    } else {
-        uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            // Note we can use halving-subtract to avoid the shift.
-            uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
-            return libdivide_u32_neon_srl(t, shift);
-        } else {
-            return libdivide_u32_neon_srl(q, more);
+        // This power works if e * n < 2**(64 + shift)
+        if (libdivide_mullhi_u64(e, n) < (1ULL << shift)) {
+            result.magic = 1 + proposed_m;
+            result.more = shift;
         }
     }
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_U64, libdivide_u64_algorithm(&result));
+    return result;
 }
 
-uint32x4_t libdivide_u32_branchfree_do_vec128(
-    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom) {
-    uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
-    uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
-    return libdivide_u32_neon_srl(t, denom->more);
-}
-
-////////// UINT64
-
-uint64x2_t libdivide_u64_do_vec128(uint64x2_t numers, const struct libdivide_u64_t *denom) {
+uint64_t libdivide_u64_do(uint64_t numer, const struct libdivide_u64_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
-        return libdivide_u64_neon_srl(numers, more);
+        return numer >> more;
     } else {
-        uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
+        uint64_t q = libdivide_mullhi_u64(denom->magic, numer);
         if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            // No 64-bit halving subtracts in NEON :(
-            uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
-            return libdivide_u64_neon_srl(t, shift);
+            uint64_t t = ((numer - q) >> 1) + q;
+            return t >> (more & LIBDIVIDE_64_SHIFT_MASK);
         } else {
-            return libdivide_u64_neon_srl(q, more);
+            // All upper bits are 0,
+            // don't need to mask them off.
+            return q >> more;
         }
     }
 }
 
-uint64x2_t libdivide_u64_branchfree_do_vec128(
-    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom) {
-    uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
-    uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
-    return libdivide_u64_neon_srl(t, denom->more);
+uint64_t libdivide_u64_branchfree_do(
+    uint64_t numer, const struct libdivide_u64_branchfree_t *denom) {
+    uint64_t q = libdivide_mullhi_u64(denom->magic, numer);
+    uint64_t t = ((numer - q) >> 1) + q;
+    return t >> denom->more;
 }
 
-////////// SINT32
-
-int32x4_t libdivide_s32_do_vec128(int32x4_t numers, const struct libdivide_s32_t *denom) {
+uint64_t libdivide_u64_recover(const struct libdivide_u64_t *denom) {
     uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+
     if (!denom->magic) {
-        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        uint32_t mask = (1U << shift) - 1;
-        int32x4_t roundToZeroTweak = vdupq_n_s32((int)mask);
-        // q = numer + ((numer >> 31) & roundToZeroTweak);
-        int32x4_t q = vaddq_s32(numers, vandq_s32(vshrq_n_s32(numers, 31), roundToZeroTweak));
-        q = libdivide_s32_neon_sra(q, shift);
-        int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = vsubq_s32(veorq_s32(q, sign), sign);
-        return q;
+        return 1ULL << shift;
+    } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
+        // We compute q = n/d = n*m / 2^(64 + shift)
+        // Therefore we have d = 2^(64 + shift) / m
+        // We need to ceil it.
+        // We know d is not a power of 2, so m is not a power of 2,
+        // so we can just add 1 to the floor
+        uint64_t hi_dividend = 1ULL << shift;
+        uint64_t rem_ignored;
+        return 1 + libdivide_128_div_64_to_64(hi_dividend, 0, denom->magic, &rem_ignored);
     } else {
-        int32x4_t q = libdivide_mullhi_s32_vec128(numers, denom->magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = vaddq_s32(q, vsubq_s32(veorq_s32(numers, sign), sign));
-        }
-        // q >>= shift
-        q = libdivide_s32_neon_sra(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = vaddq_s32(
-            q, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(q), 31)));  // q += (q < 0)
-        return q;
+        // Here we wish to compute d = 2^(64+shift+1)/(m+2^64).
+        // Notice (m + 2^64) is a 65 bit number. This gets hairy. See
+        // libdivide_u32_recover for more on what we do here.
+        // TODO: do something better than 128 bit math
+
+        // Full n is a (potentially) 129 bit value
+        // half_n is a 128 bit value
+        // Compute the hi half of half_n. Low half is 0.
+        uint64_t half_n_hi = 1ULL << shift, half_n_lo = 0;
+        // d is a 65 bit value. The high bit is always set to 1.
+        const uint64_t d_hi = 1, d_lo = denom->magic;
+        // Note that the quotient is guaranteed <= 64 bits,
+        // but the remainder may need 65!
+        uint64_t r_hi, r_lo;
+        uint64_t half_q =
+            libdivide_128_div_128_to_64(half_n_hi, half_n_lo, d_hi, d_lo, &r_hi, &r_lo);
+        // We computed 2^(64+shift)/(m+2^64)
+        // Double the remainder ('dr') and check if that is larger than d
+        // Note that d is a 65 bit value, so r1 is small and so r1 + r1
+        // cannot overflow
+        uint64_t dr_lo = r_lo + r_lo;
+        uint64_t dr_hi = r_hi + r_hi + (dr_lo < r_lo);  // last term is carry
+        int dr_exceeds_d = (dr_hi > d_hi) || (dr_hi == d_hi && dr_lo >= d_lo);
+        uint64_t full_q = half_q + half_q + (dr_exceeds_d ? 1 : 0);
+        return full_q + 1;
     }
 }
 
-int32x4_t libdivide_s32_branchfree_do_vec128(
-    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom) {
-    int32_t magic = denom->magic;
+uint64_t libdivide_u64_branchfree_recover(const struct libdivide_u64_branchfree_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    // must be arithmetic shift
-    int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
-    int32x4_t q = libdivide_mullhi_s32_vec128(numers, magic);
-    q = vaddq_s32(q, numers);  // q += numers
-
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint32_t is_power_of_2 = (magic == 0);
-    int32x4_t q_sign = vshrq_n_s32(q, 31);  // q_sign = q >> 31
-    int32x4_t mask = vdupq_n_s32((1U << shift) - is_power_of_2);
-    q = vaddq_s32(q, vandq_s32(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s32_neon_sra(q, shift);       // q >>= shift
-    q = vsubq_s32(veorq_s32(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
-}
-
-////////// SINT64
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
 
-int64x2_t libdivide_s64_do_vec128(int64x2_t numers, const struct libdivide_s64_t *denom) {
-    uint8_t more = denom->more;
-    int64_t magic = denom->magic;
-    if (magic == 0) {  // shift path
-        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-        uint64_t mask = (1ULL << shift) - 1;
-        int64x2_t roundToZeroTweak = vdupq_n_s64(mask);  // TODO: no need to sign extend
-        // q = numer + ((numer >> 63) & roundToZeroTweak);
-        int64x2_t q =
-            vaddq_s64(numers, vandq_s64(libdivide_s64_signbits(numers), roundToZeroTweak));
-        q = libdivide_s64_neon_sra(q, shift);
-        // q = (q ^ sign) - sign;
-        int64x2_t sign = vreinterpretq_s64_s8(vdupq_n_s8((int8_t)more >> 7));
-        q = vsubq_s64(veorq_s64(q, sign), sign);
-        return q;
+    if (!denom->magic) {
+        return 1ULL << (shift + 1);
     } else {
-        int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: no need to widen
-            // q += ((numer ^ sign) - sign);
-            q = vaddq_s64(q, vsubq_s64(veorq_s64(numers, sign), sign));
-        }
-        // q >>= denom->mult_path.shift
-        q = libdivide_s64_neon_sra(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = vaddq_s64(
-            q, vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_s64(q), 63)));  // q += (q < 0)
-        return q;
+        // Here we wish to compute d = 2^(64+shift+1)/(m+2^64).
+        // Notice (m + 2^64) is a 65 bit number. This gets hairy. See
+        // libdivide_u32_recover for more on what we do here.
+        // TODO: do something better than 128 bit math
+
+        // Full n is a (potentially) 129 bit value
+        // half_n is a 128 bit value
+        // Compute the hi half of half_n. Low half is 0.
+        uint64_t half_n_hi = 1ULL << shift, half_n_lo = 0;
+        // d is a 65 bit value. The high bit is always set to 1.
+        const uint64_t d_hi = 1, d_lo = denom->magic;
+        // Note that the quotient is guaranteed <= 64 bits,
+        // but the remainder may need 65!
+        uint64_t r_hi, r_lo;
+        uint64_t half_q =
+            libdivide_128_div_128_to_64(half_n_hi, half_n_lo, d_hi, d_lo, &r_hi, &r_lo);
+        // We computed 2^(64+shift)/(m+2^64)
+        // Double the remainder ('dr') and check if that is larger than d
+        // Note that d is a 65 bit value, so r1 is small and so r1 + r1
+        // cannot overflow
+        uint64_t dr_lo = r_lo + r_lo;
+        uint64_t dr_hi = r_hi + r_hi + (dr_lo < r_lo);  // last term is carry
+        int dr_exceeds_d = (dr_hi > d_hi) || (dr_hi == d_hi && dr_lo >= d_lo);
+        uint64_t full_q = half_q + half_q + (dr_exceeds_d ? 1 : 0);
+        return full_q + 1;
     }
 }
 
-int64x2_t libdivide_s64_branchfree_do_vec128(
-    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom) {
-    int64_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift
-    int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: avoid sign extend
-
-    // libdivide_mullhi_s64(numers, magic);
-    int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
-    q = vaddq_s64(q, numers);  // q += numers
+/////////// SINT32
 
-    // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2.
-    uint32_t is_power_of_2 = (magic == 0);
-    int64x2_t q_sign = libdivide_s64_signbits(q);  // q_sign = q >> 63
-    int64x2_t mask = vdupq_n_s64((1ULL << shift) - is_power_of_2);
-    q = vaddq_s64(q, vandq_s64(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_neon_sra(q, shift);       // q >>= shift
-    q = vsubq_s64(veorq_s64(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
-}
+static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
+    int32_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
 
-#endif
+    struct libdivide_s32_t result;
 
-#if defined(LIBDIVIDE_AVX512)
+    // If d is a power of 2, or negative a power of 2, we have to use a shift.
+    // This is especially important because the magic algorithm fails for -1.
+    // To check if d is a power of 2 or its inverse, it suffices to check
+    // whether its absolute value has exactly one bit set. This works even for
+    // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
+    // and is a power of 2.
+    uint32_t ud = (uint32_t)d;
+    uint32_t absD = (d < 0) ? -ud : ud;
+    uint32_t floor_log_2_d = 31 - libdivide_count_leading_zeros32(absD);
+    // check if exactly one bit is set,
+    // don't care if absD is 0 since that's divide by zero
+    if ((absD & (absD - 1)) == 0) {
+        // Branchfree and normal paths are exactly the same
+        result.magic = 0;
+        result.more = floor_log_2_d | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0);
+    } else {
+        LIBDIVIDE_ASSERT(floor_log_2_d >= 1);
 
-static LIBDIVIDE_INLINE __m512i libdivide_u32_do_vec512(
-    __m512i numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s32_do_vec512(
-    __m512i numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_u64_do_vec512(
-    __m512i numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s64_do_vec512(
-    __m512i numers, const struct libdivide_s64_t *denom);
+        uint8_t more;
+        // the dividend here is 2**(floor_log_2_d + 31), so the low 32 bit word
+        // is 0 and the high word is floor_log_2_d - 1
+        uint32_t rem, proposed_m;
+        proposed_m = libdivide_64_div_32_to_32(1U << (floor_log_2_d - 1), 0, absD, &rem);
+        const uint32_t e = absD - rem;
 
-static LIBDIVIDE_INLINE __m512i libdivide_u32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_u64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s64_branchfree_t *denom);
+        // We are going to start with a power of floor_log_2_d - 1.
+        // This works if works if e < 2**floor_log_2_d.
+        if (!branchfree && e < (1U << floor_log_2_d)) {
+            // This power works
+            more = floor_log_2_d - 1;
+        } else {
+            // We need to go one higher. This should not make proposed_m
+            // overflow, but it will make it negative when interpreted as an
+            // int32_t.
+            proposed_m += proposed_m;
+            const uint32_t twice_rem = rem + rem;
+            if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
+            more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
+        }
 
-//////// Internal Utility Functions
+        proposed_m += 1;
+        int32_t magic = (int32_t)proposed_m;
 
-static LIBDIVIDE_INLINE __m512i libdivide_s64_signbits(__m512i v) {
-    ;
-    return _mm512_srai_epi64(v, 63);
-}
+        // Mark if we are negative. Note we only negate the magic number in the
+        // branchfull case.
+        if (d < 0) {
+            more |= LIBDIVIDE_NEGATIVE_DIVISOR;
+            if (!branchfree) {
+                magic = -magic;
+            }
+        }
 
-static LIBDIVIDE_INLINE __m512i libdivide_s64_shift_right_vec512(__m512i v, int amt) {
-    return _mm512_srai_epi64(v, amt);
+        result.more = more;
+        result.magic = magic;
+    }
+    return result;
 }
 
-// Here, b is assumed to contain one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u32_vec512(__m512i a, __m512i b) {
-    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
-    __m512i a1X3X = _mm512_srli_epi64(a, 32);
-    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
-    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epu32(a1X3X, b), mask);
-    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+struct libdivide_s32_t libdivide_s32_gen(int32_t d) {
+    struct libdivide_s32_t result = libdivide_internal_s32_gen(d, 0);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S32, libdivide_s32_algorithm(&result));
+    return result;
 }
 
-// b is one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s32_vec512(__m512i a, __m512i b) {
-    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
-    __m512i a1X3X = _mm512_srli_epi64(a, 32);
-    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
-    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epi32(a1X3X, b), mask);
-    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+struct libdivide_s32_branchfree_t libdivide_s32_branchfree_gen(int32_t d) {
+    struct libdivide_s32_t tmp = libdivide_internal_s32_gen(d, 1);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S32_BRANCHFREE, libdivide_s32_algorithm(&tmp));
+    struct libdivide_s32_branchfree_t result = {tmp.magic, tmp.more};
+    return result;
 }
 
-// Here, y is assumed to contain one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u64_vec512(__m512i x, __m512i y) {
-    // see m128i variant for comments.
-    __m512i x0y0 = _mm512_mul_epu32(x, y);
-    __m512i x0y0_hi = _mm512_srli_epi64(x0y0, 32);
-
-    __m512i x1 = _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
-    __m512i y1 = _mm512_shuffle_epi32(y, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
-
-    __m512i x0y1 = _mm512_mul_epu32(x, y1);
-    __m512i x1y0 = _mm512_mul_epu32(x1, y);
-    __m512i x1y1 = _mm512_mul_epu32(x1, y1);
-
-    __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
-    __m512i temp = _mm512_add_epi64(x1y0, x0y0_hi);
-    __m512i temp_lo = _mm512_and_si512(temp, mask);
-    __m512i temp_hi = _mm512_srli_epi64(temp, 32);
-
-    temp_lo = _mm512_srli_epi64(_mm512_add_epi64(temp_lo, x0y1), 32);
-    temp_hi = _mm512_add_epi64(x1y1, temp_hi);
-    return _mm512_add_epi64(temp_lo, temp_hi);
-}
+struct libdivide_s32_t libdivide_s32_gen_bounded(int32_t d, int32_t max_numer) {
+    if (max_numer < 0) {
+        LIBDIVIDE_ERROR("max_numer must be >= 0");
+    }
 
-// y is one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s64_vec512(__m512i x, __m512i y) {
-    __m512i p = libdivide_mullhi_u64_vec512(x, y);
-    __m512i t1 = _mm512_and_si512(libdivide_s64_signbits(x), y);
-    __m512i t2 = _mm512_and_si512(libdivide_s64_signbits(y), x);
-    p = _mm512_sub_epi64(p, t1);
-    p = _mm512_sub_epi64(p, t2);
-    return p;
+    // See libdivide_u32_gen_bounded(), the bound max_numer + 1 also
+    // covers the numerator -(max_numer + 1), e.g. INT32_MIN.
+    struct libdivide_s32_t result = libdivide_internal_s32_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint32_t ud = (uint32_t)d;
+        uint32_t absD = (d < 0) ? -ud : ud;
+        uint8_t shift = (result.more & LIBDIVIDE_32_SHIFT_MASK) - 1;
+        uint32_t rem, proposed_m;
+        proposed_m = libdivide_64_div_32_to_32(1U << shift, 0, absD, &rem);
+        const uint32_t e = absD - rem;
+        uint32_t n = (uint32_t)max_numer + 1;
+        if (n < absD) n = absD;
+
+        // This power works if e * n < 2**(32 + shift)
+        if ((((uint64_t)e * n) >> 32) < (1ULL << shift)) {
+            int32_t magic = (int32_t)(proposed_m + 1);
+            result.magic = (d < 0) ? -magic : magic;
+            result.more = (uint8_t)(shift | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0));
+        }
+    }
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S32, libdivide_s32_algorithm(&result));
+    return result;
 }
 
-////////// UINT32
-
-__m512i libdivide_u32_do_vec512(__m512i numers, const struct libdivide_u32_t *denom) {
+int32_t libdivide_s32_do(int32_t numer, const struct libdivide_s32_t *denom) {
     uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+
     if (!denom->magic) {
-        return _mm512_srli_epi32(numers, more);
+        uint32_t sign = (int8_t)more >> 7;
+        uint32_t mask = (1U << shift) - 1;
+        uint32_t uq = numer + ((numer >> 31) & mask);
+        int32_t q = (int32_t)uq;
+        q >>= shift;
+        q = (q ^ sign) - sign;
+        return q;
     } else {
-        __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
+        uint32_t uq = (uint32_t)libdivide_mullhi_s32(denom->magic, numer);
         if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
-            return _mm512_srli_epi32(t, shift);
-        } else {
-            return _mm512_srli_epi32(q, more);
+            // must be arithmetic shift and then sign extend
+            int32_t sign = (int8_t)more >> 7;
+            // q += (more < 0 ? -numer : numer)
+            // cast required to avoid UB
+            uq += ((uint32_t)numer ^ sign) - sign;
         }
+        int32_t q = (int32_t)uq;
+        q >>= shift;
+        q += (q < 0);
+        return q;
     }
 }
 
-__m512i libdivide_u32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u32_branchfree_t *denom) {
-    __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
-    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
-    return _mm512_srli_epi32(t, denom->more);
-}
-
-////////// UINT64
-
-__m512i libdivide_u64_do_vec512(__m512i numers, const struct libdivide_u64_t *denom) {
+int32_t libdivide_s32_branchfree_do(int32_t numer, const struct libdivide_s32_branchfree_t *denom) {
     uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm512_srli_epi64(numers, more);
-    } else {
-        __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
-            return _mm512_srli_epi64(t, shift);
-        } else {
-            return _mm512_srli_epi64(q, more);
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift and then sign extend
+    int32_t sign = (int8_t)more >> 7;
+    int32_t magic = denom->magic;
+    int32_t q = libdivide_mullhi_s32(magic, numer);
+    q += numer;
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is a power of
+    // 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    uint32_t q_sign = (uint32_t)(q >> 31);
+    q += q_sign & ((1U << shift) - is_power_of_2);
+
+    // Now arithmetic right shift
+    q >>= shift;
+    // Negate if needed
+    q = (q ^ sign) - sign;
+
+    return q;
+}
+
+int32_t libdivide_s32_recover(const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    if (!denom->magic) {
+        uint32_t absD = 1U << shift;
+        if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
+            absD = -absD;
+        }
+        return (int32_t)absD;
+    } else {
+        // Unsigned math is much easier
+        // We negate the magic number only in the branchfull case, and we don't
+        // know which case we're in. However we have enough information to
+        // determine the correct sign of the magic number. The divisor was
+        // negative if LIBDIVIDE_NEGATIVE_DIVISOR is set. If ADD_MARKER is set,
+        // the magic number's sign is opposite that of the divisor.
+        // We want to compute the positive magic number.
+        int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
+        int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
+
+        // Handle the power of 2 case (including branchfree)
+        if (denom->magic == 0) {
+            int32_t result = 1U << shift;
+            return negative_divisor ? -result : result;
         }
+
+        uint32_t d = (uint32_t)(magic_was_negated ? -denom->magic : denom->magic);
+        uint64_t n = 1ULL << (32 + shift);  // this shift cannot exceed 30
+        uint32_t q = (uint32_t)(n / d);
+        int32_t result = (int32_t)q;
+        result += 1;
+        return negative_divisor ? -result : result;
     }
 }
 
-__m512i libdivide_u64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u64_branchfree_t *denom) {
-    __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
-    __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
-    return _mm512_srli_epi64(t, denom->more);
+int32_t libdivide_s32_branchfree_recover(const struct libdivide_s32_branchfree_t *denom) {
+    return libdivide_s32_recover((const struct libdivide_s32_t *)denom);
 }
 
-////////// SINT32
+///////////// SINT64
 
-__m512i libdivide_s32_do_vec512(__m512i numers, const struct libdivide_s32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        uint32_t mask = (1U << shift) - 1;
-        __m512i roundToZeroTweak = _mm512_set1_epi32(mask);
-        // q = numer + ((numer >> 31) & roundToZeroTweak);
-        __m512i q = _mm512_add_epi32(
-            numers, _mm512_and_si512(_mm512_srai_epi32(numers, 31), roundToZeroTweak));
-        q = _mm512_srai_epi32(q, shift);
-        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);
-        return q;
+static LIBDIVIDE_INLINE struct libdivide_s64_t libdivide_internal_s64_gen(
+    int64_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_s64_t result;
+
+    // If d is a power of 2, or negative a power of 2, we have to use a shift.
+    // This is especially important because the magic algorithm fails for -1.
+    // To check if d is a power of 2 or its inverse, it suffices to check
+    // whether its absolute value has exactly one bit set.  This works even for
+    // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
+    // and is a power of 2.
+    uint64_t ud = (uint64_t)d;
+    uint64_t absD = (d < 0) ? -ud : ud;
+    uint32_t floor_log_2_d = 63 - libdivide_count_leading_zeros64(absD);
+    // check if exactly one bit is set,
+    // don't care if absD is 0 since that's divide by zero
+    if ((absD & (absD - 1)) == 0) {
+        // Branchfree and non-branchfree cases are the same
+        result.magic = 0;
+        result.more = floor_log_2_d | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0);
     } else {
-        __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm512_add_epi32(q, _mm512_sub_epi32(_mm512_xor_si512(numers, sign), sign));
+        // the dividend here is 2**(floor_log_2_d + 63), so the low 64 bit word
+        // is 0 and the high word is floor_log_2_d - 1
+        uint8_t more;
+        uint64_t rem, proposed_m;
+        proposed_m = libdivide_128_div_64_to_64(1ULL << (floor_log_2_d - 1), 0, absD, &rem);
+        const uint64_t e = absD - rem;
+
+        // We are going to start with a power of floor_log_2_d - 1.
+        // This works if works if e < 2**floor_log_2_d.
+        if (!branchfree && e < (1ULL << floor_log_2_d)) {
+            // This power works
+            more = floor_log_2_d - 1;
+        } else {
+            // We need to go one higher. This should not make proposed_m
+            // overflow, but it will make it negative when interpreted as an
+            // int32_t.
+            proposed_m += proposed_m;
+            const uint64_t twice_rem = rem + rem;
+            if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
+            // note that we only set the LIBDIVIDE_NEGATIVE_DIVISOR bit if we
+            // also set ADD_MARKER this is an annoying optimization that
+            // enables algorithm #4 to avoid the mask. However we always set it
+            // in the branchfree case
+            more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
         }
-        // q >>= shift
-        q = _mm512_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = _mm512_add_epi32(q, _mm512_srli_epi32(q, 31));  // q += (q < 0)
-        return q;
+        proposed_m += 1;
+        int64_t magic = (int64_t)proposed_m;
+
+        // Mark if we are negative
+        if (d < 0) {
+            more |= LIBDIVIDE_NEGATIVE_DIVISOR;
+            if (!branchfree) {
+                magic = -magic;
+            }
+        }
+
+        result.more = more;
+        result.magic = magic;
     }
+    return result;
 }
 
-__m512i libdivide_s32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s32_branchfree_t *denom) {
-    int32_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    // must be arithmetic shift
-    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-    __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(magic));
-    q = _mm512_add_epi32(q, numers);  // q += numers
+struct libdivide_s64_t libdivide_s64_gen(int64_t d) {
+    struct libdivide_s64_t result = libdivide_internal_s64_gen(d, 0);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S64, libdivide_s64_algorithm(&result));
+    return result;
+}
 
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint32_t is_power_of_2 = (magic == 0);
-    __m512i q_sign = _mm512_srai_epi32(q, 31);  // q_sign = q >> 31
-    __m512i mask = _mm512_set1_epi32((1U << shift) - is_power_of_2);
-    q = _mm512_add_epi32(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm512_srai_epi32(q, shift);                          // q >>= shift
-    q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+struct libdivide_s64_branchfree_t libdivide_s64_branchfree_gen(int64_t d) {
+    struct libdivide_s64_t tmp = libdivide_internal_s64_gen(d, 1);
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S64_BRANCHFREE, libdivide_s64_algorithm(&tmp));
+    struct libdivide_s64_branchfree_t ret = {tmp.magic, tmp.more};
+    return ret;
 }
 
-////////// SINT64
+struct libdivide_s64_t libdivide_s64_gen_bounded(int64_t d, int64_t max_numer) {
+    if (max_numer < 0) {
+        LIBDIVIDE_ERROR("max_numer must be >= 0");
+    }
 
-__m512i libdivide_s64_do_vec512(__m512i numers, const struct libdivide_s64_t *denom) {
+    // See libdivide_u64_gen_bounded(), the bound max_numer + 1 also
+    // covers the numerator -(max_numer + 1), e.g. INT64_MIN.
+    struct libdivide_s64_t result = libdivide_internal_s64_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint64_t ud = (uint64_t)d;
+        uint64_t absD = (d < 0) ? -ud : ud;
+        uint8_t shift = (result.more & LIBDIVIDE_64_SHIFT_MASK) - 1;
+        uint64_t rem, proposed_m;
+        proposed_m = libdivide_128_div_64_to_64(1ULL << shift, 0, absD, &rem);
+        const uint64_t e = absD - rem;
+        uint64_t n = (uint64_t)max_numer + 1;
+        if (n < absD) n = absD;
+
+        // This power works if e * n < 2**(64 + shift)
+        if (libdivide_mullhi_u64(e, n) < (1ULL << shift)) {
+            int64_t magic = (int64_t)(proposed_m + 1);
+            result.magic = (d < 0) ? -magic : magic;
+            result.more = (uint8_t)(shift | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0));
+        }
+    }
+    LIBDIVIDE_GEN_HOOK(LIBDIVIDE_TABLE_S64, libdivide_s64_algorithm(&result));
+    return result;
+}
+
+int64_t libdivide_s64_do(int64_t numer, const struct libdivide_s64_t *denom) {
     uint8_t more = denom->more;
-    int64_t magic = denom->magic;
-    if (magic == 0) {  // shift path
-        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+
+    if (!denom->magic) {  // shift path
         uint64_t mask = (1ULL << shift) - 1;
-        __m512i roundToZeroTweak = _mm512_set1_epi64(mask);
-        // q = numer + ((numer >> 63) & roundToZeroTweak);
-        __m512i q = _mm512_add_epi64(
-            numers, _mm512_and_si512(libdivide_s64_signbits(numers), roundToZeroTweak));
-        q = libdivide_s64_shift_right_vec512(q, shift);
-        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);
+        uint64_t uq = numer + ((numer >> 63) & mask);
+        int64_t q = (int64_t)uq;
+        q >>= shift;
+        // must be arithmetic shift and then sign-extend
+        int64_t sign = (int8_t)more >> 7;
+        q = (q ^ sign) - sign;
         return q;
     } else {
-        __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
+        uint64_t uq = (uint64_t)libdivide_mullhi_s64(denom->magic, numer);
         if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm512_add_epi64(q, _mm512_sub_epi64(_mm512_xor_si512(numers, sign), sign));
+            // must be arithmetic shift and then sign extend
+            int64_t sign = (int8_t)more >> 7;
+            // q += (more < 0 ? -numer : numer)
+            // cast required to avoid UB
+            uq += ((uint64_t)numer ^ sign) - sign;
         }
-        // q >>= denom->mult_path.shift
-        q = libdivide_s64_shift_right_vec512(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = _mm512_add_epi64(q, _mm512_srli_epi64(q, 63));  // q += (q < 0)
+        int64_t q = (int64_t)uq;
+        q >>= shift;
+        q += (q < 0);
         return q;
     }
 }
 
-__m512i libdivide_s64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s64_branchfree_t *denom) {
-    int64_t magic = denom->magic;
+int64_t libdivide_s64_branchfree_do(int64_t numer, const struct libdivide_s64_branchfree_t *denom) {
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift
-    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-
-    // libdivide_mullhi_s64(numers, magic);
-    __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
-    q = _mm512_add_epi64(q, numers);  // q += numers
+    // must be arithmetic shift and then sign extend
+    int64_t sign = (int8_t)more >> 7;
+    int64_t magic = denom->magic;
+    int64_t q = libdivide_mullhi_s64(magic, numer);
+    q += numer;
 
     // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2.
-    uint32_t is_power_of_2 = (magic == 0);
-    __m512i q_sign = libdivide_s64_signbits(q);  // q_sign = q >> 63
-    __m512i mask = _mm512_set1_epi64((1ULL << shift) - is_power_of_2);
-    q = _mm512_add_epi64(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_shift_right_vec512(q, shift);           // q >>= shift
-    q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
-}
-
-#endif
-
+    // If q is negative, we want to add either (2**shift)-1 if d is a power of
+    // 2, or (2**shift) if it is not a power of 2.
+    uint64_t is_power_of_2 = (magic == 0);
+    uint64_t q_sign = (uint64_t)(q >> 63);
+    q += q_sign & ((1ULL << shift) - is_power_of_2);
+
+    // Arithmetic right shift
+    q >>= shift;
+    // Negate if needed
+    q = (q ^ sign) - sign;
+
+    return q;
+}
+
+int64_t libdivide_s64_recover(const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    if (denom->magic == 0) {  // shift path
+        uint64_t absD = 1ULL << shift;
+        if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
+            absD = -absD;
+        }
+        return (int64_t)absD;
+    } else {
+        // Unsigned math is much easier
+        int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
+        int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
+
+        uint64_t d = (uint64_t)(magic_was_negated ? -denom->magic : denom->magic);
+        uint64_t n_hi = 1ULL << shift, n_lo = 0;
+        uint64_t rem_ignored;
+        uint64_t q = libdivide_128_div_64_to_64(n_hi, n_lo, d, &rem_ignored);
+        int64_t result = (int64_t)(q + 1);
+        if (negative_divisor) {
+            result = -result;
+        }
+        return result;
+    }
+}
+
+int64_t libdivide_s64_branchfree_recover(const struct libdivide_s64_branchfree_t *denom) {
+    return libdivide_s64_recover((const struct libdivide_s64_t *)denom);
+}
+
+#if defined(HAS_INT128_T)
+
+////////// UINT128
+
+static LIBDIVIDE_INLINE struct libdivide_u128_t libdivide_internal_u128_gen(
+    __uint128_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_u128_t result;
+    uint32_t floor_log_2_d = 127 - libdivide_count_leading_zeros128(d);
+
+    // Power of 2
+    if ((d & (d - 1)) == 0) {
+        // We need to subtract 1 from the shift value in case of an unsigned
+        // branchfree divider because there is a hardcoded right shift by 1
+        // in its division algorithm. Because of this we also need to add back
+        // 1 in its recovery algorithm.
+        result.magic = 0;
+        result.more = 0;
+        result.shift = (uint8_t)(floor_log_2_d - (branchfree != 0));
+    } else {
+        __uint128_t proposed_m, rem;
+        uint8_t more;
+        // (1 << (128 + floor_log_2_d)) / d
+        proposed_m = libdivide_256_div_128_to_128((__uint128_t)1 << floor_log_2_d, 0, d, &rem);
+
+        LIBDIVIDE_ASSERT(rem > 0 && rem < d);
+        const __uint128_t e = d - rem;
+
+        // This power works if e < 2**floor_log_2_d.
+        if (!branchfree && e < ((__uint128_t)1 << floor_log_2_d)) {
+            // This power works
+            more = 0;
+        } else {
+            // We have to use the general 129-bit algorithm.  We need to compute
+            // (2**power) / d. However, we already have (2**(power-1))/d and
+            // its remainder. By doubling both, and then correcting the
+            // remainder, we can compute the larger division.
+            // don't care about overflow here - in fact, we expect it
+            proposed_m += proposed_m;
+            const __uint128_t twice_rem = rem + rem;
+            if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
+            more = LIBDIVIDE_ADD_MARKER;
+        }
+        result.magic = 1 + proposed_m;
+        result.more = more;
+        result.shift = (uint8_t)floor_log_2_d;
+        // result.more's shift should in general be ceil_log_2_d. But if we
+        // used the smaller power, we subtract one from the shift because we're
+        // using the smaller power. If we're using the larger power, we
+        // subtract one from the shift because it's taken care of by the add
+        // indicator. So floor_log_2_d happens to be correct in both cases,
+        // which is why we do it outside of the if statement.
+    }
+    return result;
+}
+
+struct libdivide_u128_t libdivide_u128_gen(__uint128_t d) {
+    return libdivide_internal_u128_gen(d, 0);
+}
+
+struct libdivide_u128_branchfree_t libdivide_u128_branchfree_gen(__uint128_t d) {
+    if (d == 1) {
+        LIBDIVIDE_ERROR("branchfree divider must be != 1");
+    }
+    struct libdivide_u128_t tmp = libdivide_internal_u128_gen(d, 1);
+    struct libdivide_u128_branchfree_t ret = {tmp.magic, 0, tmp.shift};
+    return ret;
+}
+
+__uint128_t libdivide_u128_do(__uint128_t numer, const struct libdivide_u128_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return numer >> denom->shift;
+    } else {
+        __uint128_t q = libdivide_mullhi_u128(denom->magic, numer);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            __uint128_t t = ((numer - q) >> 1) + q;
+            return t >> denom->shift;
+        } else {
+            // All upper bits are 0,
+            // don't need to mask them off.
+            return q >> denom->shift;
+        }
+    }
+}
+
+__uint128_t libdivide_u128_branchfree_do(
+    __uint128_t numer, const struct libdivide_u128_branchfree_t *denom) {
+    __uint128_t q = libdivide_mullhi_u128(denom->magic, numer);
+    __uint128_t t = ((numer - q) >> 1) + q;
+    return t >> denom->shift;
+}
+
+// Computes floor(2^(129 + shift) / (2^128 + m)), the 129-bit magic
+// number of the add path being 2^128 + m. The dividend's bits below
+// bit 127 + shift + 2 are all 0, so long division starts with the
+// partial remainder 2^127. The remainder needs up to 130 bits, its
+// bits above 127 are kept in rem_hi.
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_recover_add(__uint128_t m, uint8_t shift) {
+    uint32_t rem_hi = 0;
+    __uint128_t rem_lo = (__uint128_t)1 << 127;
+    __uint128_t q = 0;
+    int i;
+    for (i = 0; i < shift + 2; i++) {
+        rem_hi = (rem_hi << 1) | (uint32_t)(rem_lo >> 127);
+        rem_lo <<= 1;
+        q <<= 1;
+        // rem >= 2^128 + m
+        if (rem_hi > 1 || (rem_hi == 1 && rem_lo >= m)) {
+            rem_hi -= 1 + (rem_lo < m);
+            rem_lo -= m;
+            q |= 1;
+        }
+    }
+    return q;
+}
+
+__uint128_t libdivide_u128_recover(const struct libdivide_u128_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = denom->shift;
+
+    if (!denom->magic) {
+        return (__uint128_t)1 << shift;
+    } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
+        // We compute q = n/d = n*m / 2^(128 + shift)
+        // Therefore we have d = 2^(128 + shift) / m
+        // We need to ceil it.
+        // We know d is not a power of 2, so m is not a power of 2,
+        // so we can just add 1 to the floor
+        __uint128_t rem_ignored;
+        return 1 + libdivide_256_div_128_to_128(
+                       (__uint128_t)1 << shift, 0, denom->magic, &rem_ignored);
+    } else {
+        // Here we wish to compute d = 2^(128+shift+1)/(m+2^128).
+        return libdivide_u128_recover_add(denom->magic, shift) + 1;
+    }
+}
+
+__uint128_t libdivide_u128_branchfree_recover(const struct libdivide_u128_branchfree_t *denom) {
+    uint8_t shift = denom->shift;
+
+    if (!denom->magic) {
+        return (__uint128_t)1 << (shift + 1);
+    } else {
+        // The branchfree magic number always uses the add path
+        return libdivide_u128_recover_add(denom->magic, shift) + 1;
+    }
+}
+
+///////////// SINT128
+
+static LIBDIVIDE_INLINE struct libdivide_s128_t libdivide_internal_s128_gen(
+    __int128_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_s128_t result;
+
+    // If d is a power of 2, or negative a power of 2, we have to use a shift.
+    // This is especially important because the magic algorithm fails for -1.
+    // To check if d is a power of 2 or its inverse, it suffices to check
+    // whether its absolute value has exactly one bit set.  This works even for
+    // INT128_MIN, because abs(INT128_MIN) == INT128_MIN, and INT128_MIN has one bit set
+    // and is a power of 2.
+    __uint128_t ud = (__uint128_t)d;
+    __uint128_t absD = (d < 0) ? -ud : ud;
+    uint32_t floor_log_2_d = 127 - libdivide_count_leading_zeros128(absD);
+    // check if exactly one bit is set,
+    // don't care if absD is 0 since that's divide by zero
+    if ((absD & (absD - 1)) == 0) {
+        // Branchfree and non-branchfree cases are the same
+        result.magic = 0;
+        result.more = d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0;
+        result.shift = (uint8_t)floor_log_2_d;
+    } else {
+        // the dividend here is 2**(floor_log_2_d + 127), so the low 128 bit word
+        // is 0 and the high word is floor_log_2_d - 1
+        uint8_t more, shift;
+        __uint128_t rem, proposed_m;
+        proposed_m = libdivide_256_div_128_to_128(
+            (__uint128_t)1 << (floor_log_2_d - 1), 0, absD, &rem);
+        const __uint128_t e = absD - rem;
+
+        // We are going to start with a power of floor_log_2_d - 1.
+        // This works if works if e < 2**floor_log_2_d.
+        if (!branchfree && e < ((__uint128_t)1 << floor_log_2_d)) {
+            // This power works
+            more = 0;
+            shift = (uint8_t)(floor_log_2_d - 1);
+        } else {
+            // We need to go one higher. This should not make proposed_m
+            // overflow, but it will make it negative when interpreted as an
+            // __int128_t.
+            proposed_m += proposed_m;
+            const __uint128_t twice_rem = rem + rem;
+            if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
+            more = LIBDIVIDE_ADD_MARKER;
+            shift = (uint8_t)floor_log_2_d;
+        }
+        proposed_m += 1;
+        __int128_t magic = (__int128_t)proposed_m;
+
+        // Mark if we are negative
+        if (d < 0) {
+            more |= LIBDIVIDE_NEGATIVE_DIVISOR;
+            if (!branchfree) {
+                magic = -magic;
+            }
+        }
+
+        result.more = more;
+        result.shift = shift;
+        result.magic = magic;
+    }
+    return result;
+}
+
+struct libdivide_s128_t libdivide_s128_gen(__int128_t d) {
+    return libdivide_internal_s128_gen(d, 0);
+}
+
+struct libdivide_s128_branchfree_t libdivide_s128_branchfree_gen(__int128_t d) {
+    struct libdivide_s128_t tmp = libdivide_internal_s128_gen(d, 1);
+    struct libdivide_s128_branchfree_t ret = {tmp.magic, tmp.more, tmp.shift};
+    return ret;
+}
+
+__int128_t libdivide_s128_do(__int128_t numer, const struct libdivide_s128_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = denom->shift;
+
+    if (!denom->magic) {  // shift path
+        __uint128_t mask = ((__uint128_t)1 << shift) - 1;
+        __uint128_t uq = (__uint128_t)numer + ((__uint128_t)(numer >> 127) & mask);
+        __int128_t q = (__int128_t)uq;
+        q >>= shift;
+        // must be arithmetic shift and then sign-extend
+        __int128_t sign = (int8_t)more >> 7;
+        q = (q ^ sign) - sign;
+        return q;
+    } else {
+        __uint128_t uq = (__uint128_t)libdivide_mullhi_s128(denom->magic, numer);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift and then sign extend
+            __int128_t sign = (int8_t)more >> 7;
+            // q += (more < 0 ? -numer : numer)
+            // cast required to avoid UB
+            uq += ((__uint128_t)numer ^ (__uint128_t)sign) - (__uint128_t)sign;
+        }
+        __int128_t q = (__int128_t)uq;
+        q >>= shift;
+        q += (q < 0);
+        return q;
+    }
+}
+
+__int128_t libdivide_s128_branchfree_do(
+    __int128_t numer, const struct libdivide_s128_branchfree_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = denom->shift;
+    // must be arithmetic shift and then sign extend
+    __int128_t sign = (int8_t)more >> 7;
+    __int128_t magic = denom->magic;
+    __int128_t q = libdivide_mullhi_s128(magic, numer);
+    q += numer;
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is a power of
+    // 2, or (2**shift) if it is not a power of 2.
+    __uint128_t is_power_of_2 = (magic == 0);
+    __uint128_t q_sign = (__uint128_t)(q >> 127);
+    q += q_sign & (((__uint128_t)1 << shift) - is_power_of_2);
+
+    // Arithmetic right shift
+    q >>= shift;
+    // Negate if needed
+    q = (q ^ sign) - sign;
+
+    return q;
+}
+
+__int128_t libdivide_s128_recover(const struct libdivide_s128_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = denom->shift;
+    if (denom->magic == 0) {  // shift path
+        __uint128_t absD = (__uint128_t)1 << shift;
+        if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
+            absD = -absD;
+        }
+        return (__int128_t)absD;
+    } else {
+        // Unsigned math is much easier
+        int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
+        int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
+
+        __uint128_t d = (__uint128_t)(magic_was_negated ? -denom->magic : denom->magic);
+        __uint128_t rem_ignored;
+        __uint128_t q =
+            libdivide_256_div_128_to_128((__uint128_t)1 << shift, 0, d, &rem_ignored);
+        __int128_t result = (__int128_t)(q + 1);
+        if (negative_divisor) {
+            result = -result;
+        }
+        return result;
+    }
+}
+
+__int128_t libdivide_s128_branchfree_recover(const struct libdivide_s128_branchfree_t *denom) {
+    return libdivide_s128_recover((const struct libdivide_s128_t *)denom);
+}
+
+#endif
+
+///////////// ARRAYS
+
+// The libdivide_*_do_array() functions divide count numerators and
+// store the quotients. quotients may be equal to numers (in-place
+// division), but the two arrays must not otherwise overlap. Neither
+// array needs to be aligned.
+
+// Generates libdivide_##ALGO##_do_array_scalar()
+#define LIBDIVIDE_DO_ARRAY_SCALAR(ALGO, T)                                               \
+    static inline void libdivide_##ALGO##_do_array_scalar(const T *numers, T *quotients, \
+        size_t count, const struct libdivide_##ALGO##_t *denom) {                        \
+        for (size_t i = 0; i < count; i++) {                                             \
+            quotients[i] = libdivide_##ALGO##_do(numers[i], denom);                      \
+        }                                                                                \
+    }
+
+// Generates libdivide_##ALGO##_do_##VEC##_x4() which divides the 4
+// independent vectors numers[0, 4) in place. The divider is copied to
+// a local so that it is loaded (and its branches are resolved) once
+// for the 4 vectors, which lets the compiler interleave their high
+// multiplies instead of waiting for the latency of each chain.
+#define LIBDIVIDE_DO_VEC_X4(ALGO, VEC, VEC_T)                               \
+    static LIBDIVIDE_INLINE void libdivide_##ALGO##_do_##VEC##_x4(         \
+        VEC_T *numers, const struct libdivide_##ALGO##_t *denom) {         \
+        const struct libdivide_##ALGO##_t d = *denom;                      \
+        VEC_T q0 = libdivide_##ALGO##_do_##VEC(numers[0], &d);             \
+        VEC_T q1 = libdivide_##ALGO##_do_##VEC(numers[1], &d);             \
+        VEC_T q2 = libdivide_##ALGO##_do_##VEC(numers[2], &d);             \
+        VEC_T q3 = libdivide_##ALGO##_do_##VEC(numers[3], &d);             \
+        numers[0] = q0;                                                    \
+        numers[1] = q1;                                                    \
+        numers[2] = q2;                                                    \
+        numers[3] = q3;                                                    \
+    }
+
+// Generates libdivide_##ALGO##_do_##VEC##_x4() and
+// libdivide_##ALGO##_do_array_##VEC(). The array function divides
+// 4 vectors per iteration using the x4 kernel, then finishes the
+// remaining elements one vector and finally one scalar at a time.
+#define LIBDIVIDE_DO_ARRAY_VEC(ALGO, T, VEC, VEC_T, LOADU, STOREU)                           \
+    LIBDIVIDE_DO_VEC_X4(ALGO, VEC, VEC_T)                                                    \
+    static inline void libdivide_##ALGO##_do_array_##VEC(const T *numers, T *quotients,      \
+        size_t count, const struct libdivide_##ALGO##_t *denom) {                            \
+        const size_t lanes = sizeof(VEC_T) / sizeof(T);                                      \
+        size_t i = 0;                                                                        \
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {                                     \
+            VEC_T q[4];                                                                      \
+            q[0] = LOADU(numers + i);                                                        \
+            q[1] = LOADU(numers + i + lanes);                                                \
+            q[2] = LOADU(numers + i + 2 * lanes);                                            \
+            q[3] = LOADU(numers + i + 3 * lanes);                                            \
+            libdivide_##ALGO##_do_##VEC##_x4(q, denom);                                      \
+            STOREU(quotients + i, q[0]);                                                     \
+            STOREU(quotients + i + lanes, q[1]);                                             \
+            STOREU(quotients + i + 2 * lanes, q[2]);                                         \
+            STOREU(quotients + i + 3 * lanes, q[3]);                                         \
+        }                                                                                    \
+        for (; i + lanes <= count; i += lanes) {                                             \
+            STOREU(quotients + i, libdivide_##ALGO##_do_##VEC(LOADU(numers + i), denom));    \
+        }                                                                                    \
+        for (; i < count; i++) {                                                             \
+            quotients[i] = libdivide_##ALGO##_do(numers[i], denom);                          \
+        }                                                                                    \
+    }
+
+// Unaligned load/store helpers for the x86 instantiations below
+#define LIBDIVIDE_LOADU_SI128(p) _mm_loadu_si128((const __m128i *)(p))
+#define LIBDIVIDE_STOREU_SI128(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define LIBDIVIDE_LOADU_SI256(p) _mm256_loadu_si256((const __m256i *)(p))
+#define LIBDIVIDE_STOREU_SI256(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define LIBDIVIDE_LOADU_SI512(p) _mm512_loadu_si512((const void *)(p))
+#define LIBDIVIDE_STOREU_SI512(p, v) _mm512_storeu_si512((void *)(p), (v))
+
+// Non-temporal (streaming) stores, the pointer must be aligned
+#define LIBDIVIDE_STREAM_SI128(p, v) _mm_stream_si128((__m128i *)(p), (v))
+#define LIBDIVIDE_STREAM_SI256(p, v) _mm256_stream_si256((__m256i *)(p), (v))
+#define LIBDIVIDE_STREAM_SI512(p, v) _mm512_stream_si512((__m512i *)(p), (v))
+
+// The libdivide_*_do_array_stream() functions are meant for arrays that
+// are much larger than the last level cache. If the arrays are at least
+// LIBDIVIDE_STREAM_THRESHOLD bytes the x86 kernels store the quotients
+// using non-temporal stores, which bypass the caches and avoid reading
+// the destination lines before they are written, and prefetch the
+// numerators LIBDIVIDE_PREFETCH_DISTANCE bytes ahead without polluting
+// the caches. Smaller arrays are divided by libdivide_*_do_array(), as
+// their quotients are likely to be read again while they are cached.
+#ifndef LIBDIVIDE_STREAM_THRESHOLD
+#define LIBDIVIDE_STREAM_THRESHOLD ((size_t)16 << 20)
+#endif
+#ifndef LIBDIVIDE_PREFETCH_DISTANCE
+#define LIBDIVIDE_PREFETCH_DISTANCE 1024
+#endif
+
+// The quotients are divided one at a time until they are aligned
+// for STREAM, each iteration of the main loop prefetches the cache
+// lines of the numerators of a later iteration.
+#define LIBDIVIDE_DO_ARRAY_STREAM_VEC(ALGO, T, VEC, VEC_T, LOADU, STREAM)                 \
+    static inline void libdivide_##ALGO##_do_array_stream_##VEC(const T *numers,          \
+        T *quotients, size_t count, const struct libdivide_##ALGO##_t *denom) {           \
+        const size_t lanes = sizeof(VEC_T) / sizeof(T);                                   \
+        const size_t ahead = LIBDIVIDE_PREFETCH_DISTANCE / sizeof(T);                     \
+        size_t i = 0;                                                                     \
+        if (count < LIBDIVIDE_STREAM_THRESHOLD / sizeof(T)) {                             \
+            libdivide_##ALGO##_do_array_##VEC(numers, quotients, count, denom);           \
+            return;                                                                       \
+        }                                                                                 \
+        for (; i < count && (uintptr_t)(quotients + i) % sizeof(VEC_T) != 0; i++) {       \
+            quotients[i] = libdivide_##ALGO##_do(numers[i], denom);                       \
+        }                                                                                 \
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {                                  \
+            VEC_T q[4];                                                                   \
+            if (i + ahead < count) {                                                      \
+                const char *p = (const char *)(numers + i + ahead);                       \
+                for (size_t k = 0; k < sizeof(q); k += 64) {                              \
+                    _mm_prefetch(p + k, _MM_HINT_NTA);                                    \
+                }                                                                         \
+            }                                                                             \
+            q[0] = LOADU(numers + i);                                                     \
+            q[1] = LOADU(numers + i + lanes);                                             \
+            q[2] = LOADU(numers + i + 2 * lanes);                                         \
+            q[3] = LOADU(numers + i + 3 * lanes);                                         \
+            libdivide_##ALGO##_do_##VEC##_x4(q, denom);                                   \
+            STREAM(quotients + i, q[0]);                                                  \
+            STREAM(quotients + i + lanes, q[1]);                                          \
+            STREAM(quotients + i + 2 * lanes, q[2]);                                      \
+            STREAM(quotients + i + 3 * lanes, q[3]);                                      \
+        }                                                                                 \
+        for (; i + lanes <= count; i += lanes) {                                          \
+            STREAM(quotients + i, libdivide_##ALGO##_do_##VEC(LOADU(numers + i), denom)); \
+        }                                                                                 \
+        for (; i < count; i++) {                                                          \
+            quotients[i] = libdivide_##ALGO##_do(numers[i], denom);                       \
+        }                                                                                 \
+        _mm_sfence();                                                                     \
+    }
+
+LIBDIVIDE_DO_ARRAY_SCALAR(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s16, int16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s64_branchfree, int64_t)
+
+///////////// DIVMOD
+
+// libdivide_*_divmod() computes the quotient and the remainder
+// (numer - quotient * d) using the divisor stored next to the
+// divider. The libdivide_*_divmod_array() functions store the
+// quotients and remainders to separate arrays.
+
+#define LIBDIVIDE_DIVMOD_SCALAR(ALGO, T, UT)                                                 \
+    struct libdivide_##ALGO##_divmod_t libdivide_##ALGO##_divmod_gen(T d) {                  \
+        struct libdivide_##ALGO##_divmod_t result;                                           \
+        result.denom = libdivide_##ALGO##_gen(d);                                            \
+        result.d = d;                                                                        \
+        return result;                                                                       \
+    }                                                                                        \
+    T libdivide_##ALGO##_divmod(                                                             \
+        T numer, T *rem, const struct libdivide_##ALGO##_divmod_t *denom) {                  \
+        T q = libdivide_##ALGO##_do(numer, &denom->denom);                                   \
+        *rem = (T)((UT)numer - (UT)q * (UT)denom->d);                                        \
+        return q;                                                                            \
+    }                                                                                        \
+    static inline void libdivide_##ALGO##_divmod_array_scalar(const T *numers, T *quotients, \
+        T *rems, size_t count, const struct libdivide_##ALGO##_divmod_t *denom) {            \
+        for (size_t i = 0; i < count; i++) {                                                 \
+            quotients[i] = libdivide_##ALGO##_divmod(numers[i], &rems[i], denom);            \
+        }                                                                                    \
+    }
+
+// Generates libdivide_##ALGO##_divmod_##VEC() and
+// libdivide_##ALGO##_divmod_array_##VEC(). MULLO(a, b) is the
+// low half of the lane-wise product.
+#define LIBDIVIDE_DIVMOD_VEC(ALGO, T, VEC, VEC_T, SET1, MULLO, SUB, LOADU, STOREU)                \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divmod_##VEC(                                \
+        VEC_T numers, VEC_T *rems, const struct libdivide_##ALGO##_divmod_t *denom) {             \
+        VEC_T q = libdivide_##ALGO##_do_##VEC(numers, &denom->denom);                             \
+        *rems = SUB(numers, MULLO(q, SET1(denom->d)));                                            \
+        return q;                                                                                 \
+    }                                                                                             \
+    static inline void libdivide_##ALGO##_divmod_array_##VEC(const T *numers, T *quotients,       \
+        T *rems, size_t count, const struct libdivide_##ALGO##_divmod_t *denom) {                 \
+        const size_t lanes = sizeof(VEC_T) / sizeof(T);                                           \
+        size_t i = 0;                                                                             \
+        for (; i + 2 * lanes <= count; i += 2 * lanes) {                                          \
+            VEC_T r0, r1;                                                                         \
+            VEC_T q0 = libdivide_##ALGO##_divmod_##VEC(LOADU(numers + i), &r0, denom);            \
+            VEC_T q1 = libdivide_##ALGO##_divmod_##VEC(LOADU(numers + i + lanes), &r1, denom);    \
+            STOREU(quotients + i, q0);                                                            \
+            STOREU(quotients + i + lanes, q1);                                                    \
+            STOREU(rems + i, r0);                                                                 \
+            STOREU(rems + i + lanes, r1);                                                         \
+        }                                                                                         \
+        for (; i + lanes <= count; i += lanes) {                                                  \
+            VEC_T r;                                                                              \
+            STOREU(quotients + i, libdivide_##ALGO##_divmod_##VEC(LOADU(numers + i), &r, denom)); \
+            STOREU(rems + i, r);                                                                  \
+        }                                                                                         \
+        for (; i < count; i++) {                                                                  \
+            quotients[i] = libdivide_##ALGO##_divmod(numers[i], &rems[i], denom);                 \
+        }                                                                                         \
+    }
+
+// Signed floor, ceiling and Euclidean variants of divmod. The
+// truncated quotient q and remainder r are adjusted by the mask
+// (r ^ dsign) - dsign, where dsign is all ones for negative divisors:
+// it is negative iff r != 0 and r has the opposite sign of d (floor),
+// and dsign - (r ^ dsign) is negative iff r != 0 and r has the sign of
+// d (ceil). r is never INT_MIN so the negation cannot overflow.
+#define LIBDIVIDE_ROUNDING_SCALAR(ALGO, T, UT)                           \
+    T libdivide_##ALGO##_divide_floor(                                   \
+        T numer, const struct libdivide_##ALGO##_divmod_t *denom) {      \
+        T rem;                                                           \
+        T q = libdivide_##ALGO##_divmod(numer, &rem, denom);             \
+        UT dsign = (UT)(denom->d < 0 ? -1 : 0);                          \
+        UT mask = (UT)((T)(((UT)rem ^ dsign) - dsign) < 0 ? -1 : 0);     \
+        return (T)((UT)q + mask);                                        \
+    }                                                                    \
+    T libdivide_##ALGO##_divide_ceil(                                    \
+        T numer, const struct libdivide_##ALGO##_divmod_t *denom) {      \
+        T rem;                                                           \
+        T q = libdivide_##ALGO##_divmod(numer, &rem, denom);             \
+        UT dsign = (UT)(denom->d < 0 ? -1 : 0);                          \
+        UT mask = (UT)((T)(dsign - ((UT)rem ^ dsign)) < 0 ? -1 : 0);     \
+        return (T)((UT)q - mask);                                        \
+    }                                                                    \
+    T libdivide_##ALGO##_mod_floor(                                      \
+        T numer, const struct libdivide_##ALGO##_divmod_t *denom) {      \
+        T rem;                                                           \
+        libdivide_##ALGO##_divmod(numer, &rem, denom);                   \
+        UT dsign = (UT)(denom->d < 0 ? -1 : 0);                          \
+        UT mask = (UT)((T)(((UT)rem ^ dsign) - dsign) < 0 ? -1 : 0);     \
+        return (T)((UT)rem + (mask & (UT)denom->d));                     \
+    }                                                                    \
+    T libdivide_##ALGO##_mod_euclid(                                     \
+        T numer, const struct libdivide_##ALGO##_divmod_t *denom) {      \
+        T rem;                                                           \
+        libdivide_##ALGO##_divmod(numer, &rem, denom);                   \
+        UT dsign = (UT)(denom->d < 0 ? -1 : 0);                          \
+        UT absD = ((UT)denom->d ^ dsign) - dsign;                        \
+        return (T)((UT)rem + (rem < 0 ? absD : 0));                      \
+    }
+
+// Vector versions of LIBDIVIDE_ROUNDING_SCALAR, SIGNBITS(v)
+// broadcasts the sign bit of each lane.
+#define LIBDIVIDE_ROUNDING_VEC(ALGO, T, UT, VEC, VEC_T, SET1, ADD, SUB, AND, XOR, SIGNBITS) \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divide_floor_##VEC(                    \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                    \
+        VEC_T rems;                                                                         \
+        VEC_T q = libdivide_##ALGO##_divmod_##VEC(numers, &rems, denom);                    \
+        VEC_T dsign = SET1((T)(denom->d < 0 ? -1 : 0));                                     \
+        return ADD(q, SIGNBITS(SUB(XOR(rems, dsign), dsign)));                              \
+    }                                                                                       \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divide_ceil_##VEC(                     \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                    \
+        VEC_T rems;                                                                         \
+        VEC_T q = libdivide_##ALGO##_divmod_##VEC(numers, &rems, denom);                    \
+        VEC_T dsign = SET1((T)(denom->d < 0 ? -1 : 0));                                     \
+        return SUB(q, SIGNBITS(SUB(dsign, XOR(rems, dsign))));                              \
+    }                                                                                       \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_mod_floor_##VEC(                       \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                    \
+        VEC_T rems;                                                                         \
+        libdivide_##ALGO##_divmod_##VEC(numers, &rems, denom);                              \
+        VEC_T dsign = SET1((T)(denom->d < 0 ? -1 : 0));                                     \
+        VEC_T mask = SIGNBITS(SUB(XOR(rems, dsign), dsign));                                \
+        return ADD(rems, AND(mask, SET1(denom->d)));                                        \
+    }                                                                                       \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_mod_euclid_##VEC(                      \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                    \
+        VEC_T rems;                                                                         \
+        libdivide_##ALGO##_divmod_##VEC(numers, &rems, denom);                              \
+        T absD = (T)(denom->d < 0 ? (UT)0 - (UT)denom->d : (UT)denom->d);                   \
+        return ADD(rems, AND(SIGNBITS(rems), SET1(absD)));                                  \
+    }
+
+LIBDIVIDE_DIVMOD_SCALAR(u32, uint32_t, uint32_t)
+LIBDIVIDE_DIVMOD_SCALAR(s32, int32_t, uint32_t)
+LIBDIVIDE_DIVMOD_SCALAR(u64, uint64_t, uint64_t)
+LIBDIVIDE_DIVMOD_SCALAR(s64, int64_t, uint64_t)
+LIBDIVIDE_DIVMOD_SCALAR(u32_branchfree, uint32_t, uint32_t)
+LIBDIVIDE_DIVMOD_SCALAR(s32_branchfree, int32_t, uint32_t)
+LIBDIVIDE_DIVMOD_SCALAR(u64_branchfree, uint64_t, uint64_t)
+LIBDIVIDE_DIVMOD_SCALAR(s64_branchfree, int64_t, uint64_t)
+
+LIBDIVIDE_ROUNDING_SCALAR(s32, int32_t, uint32_t)
+LIBDIVIDE_ROUNDING_SCALAR(s64, int64_t, uint64_t)
+LIBDIVIDE_ROUNDING_SCALAR(s32_branchfree, int32_t, uint32_t)
+LIBDIVIDE_ROUNDING_SCALAR(s64_branchfree, int64_t, uint64_t)
+
+///////////// DIVISIBILITY
+
+struct libdivide_u32_divisibility_t libdivide_u32_divisibility_gen(uint32_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_u32_divisibility_t result;
+    uint32_t shift = libdivide_count_trailing_zeros32(d);
+    result.inverse = libdivide_inverse_u32(d >> shift);
+    result.threshold = UINT32_MAX / d;
+    result.shift = (uint8_t)shift;
+    return result;
+}
+
+int libdivide_u32_is_divisible(uint32_t numer, const struct libdivide_u32_divisibility_t *denom) {
+    uint32_t shift = denom->shift;
+    uint32_t x = numer * denom->inverse;
+    x = (x >> shift) | (x << ((32 - shift) & 31));
+    return x <= denom->threshold;
+}
+
+struct libdivide_u64_divisibility_t libdivide_u64_divisibility_gen(uint64_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_u64_divisibility_t result;
+    uint32_t shift = libdivide_count_trailing_zeros64(d);
+    result.inverse = libdivide_inverse_u64(d >> shift);
+    result.threshold = UINT64_MAX / d;
+    result.shift = (uint8_t)shift;
+    return result;
+}
+
+int libdivide_u64_is_divisible(uint64_t numer, const struct libdivide_u64_divisibility_t *denom) {
+    uint32_t shift = denom->shift;
+    uint64_t x = numer * denom->inverse;
+    x = (x >> shift) | (x << ((64 - shift) & 63));
+    return x <= denom->threshold;
+}
+
+///////////// EXACT DIVISION
+
+// The exact dividers replace the high multiplication (and the fixups)
+// of the regular dividers by a single low multiplication, which is
+// much cheaper for 64-bit vector lanes. Negative divisors work since
+// the inverse of d0 < 0 is computed in two's complement arithmetic.
+
+struct libdivide_u32_exact_t libdivide_u32_exact_gen(uint32_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    struct libdivide_u32_exact_t result;
+    uint32_t shift = libdivide_count_trailing_zeros32(d);
+    result.inverse = libdivide_inverse_u32(d >> shift);
+    result.shift = (uint8_t)shift;
+    return result;
+}
+
+struct libdivide_s32_exact_t libdivide_s32_exact_gen(int32_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    struct libdivide_s32_exact_t result;
+    uint32_t shift = libdivide_count_trailing_zeros32((uint32_t)d);
+    result.inverse = (int32_t)libdivide_inverse_u32((uint32_t)(d >> shift));
+    result.shift = (uint8_t)shift;
+    return result;
+}
+
+struct libdivide_u64_exact_t libdivide_u64_exact_gen(uint64_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    struct libdivide_u64_exact_t result;
+    uint32_t shift = libdivide_count_trailing_zeros64(d);
+    result.inverse = libdivide_inverse_u64(d >> shift);
+    result.shift = (uint8_t)shift;
+    return result;
+}
+
+struct libdivide_s64_exact_t libdivide_s64_exact_gen(int64_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    struct libdivide_s64_exact_t result;
+    uint32_t shift = libdivide_count_trailing_zeros64((uint64_t)d);
+    result.inverse = (int64_t)libdivide_inverse_u64((uint64_t)(d >> shift));
+    result.shift = (uint8_t)shift;
+    return result;
+}
+
+uint32_t libdivide_u32_exact_do(uint32_t numer, const struct libdivide_u32_exact_t *denom) {
+    return (numer >> denom->shift) * denom->inverse;
+}
+
+int32_t libdivide_s32_exact_do(int32_t numer, const struct libdivide_s32_exact_t *denom) {
+    // numer is a multiple of 2^shift, the arithmetic shift is exact
+    return (int32_t)((uint32_t)(numer >> denom->shift) * (uint32_t)denom->inverse);
+}
+
+uint64_t libdivide_u64_exact_do(uint64_t numer, const struct libdivide_u64_exact_t *denom) {
+    return (numer >> denom->shift) * denom->inverse;
+}
+
+int64_t libdivide_s64_exact_do(int64_t numer, const struct libdivide_s64_exact_t *denom) {
+    return (int64_t)((uint64_t)(numer >> denom->shift) * (uint64_t)denom->inverse);
+}
+
+// d0 is the inverse of the inverse
+uint32_t libdivide_u32_exact_recover(const struct libdivide_u32_exact_t *denom) {
+    return libdivide_inverse_u32(denom->inverse) << denom->shift;
+}
+
+int32_t libdivide_s32_exact_recover(const struct libdivide_s32_exact_t *denom) {
+    return (int32_t)(libdivide_inverse_u32((uint32_t)denom->inverse) << denom->shift);
+}
+
+uint64_t libdivide_u64_exact_recover(const struct libdivide_u64_exact_t *denom) {
+    return libdivide_inverse_u64(denom->inverse) << denom->shift;
+}
+
+int64_t libdivide_s64_exact_recover(const struct libdivide_s64_exact_t *denom) {
+    return (int64_t)(libdivide_inverse_u64((uint64_t)denom->inverse) << denom->shift);
+}
+
+LIBDIVIDE_DO_ARRAY_SCALAR(u32_exact, uint32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s32_exact, int32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u64_exact, uint64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s64_exact, int64_t)
+
+///////////// FASTMOD
+
+// libdivide_u32_mod_do() computes numer % d using two multiplications
+// (three for the 64-bit product M * numer on 32-bit CPUs) and no
+// branches. Accordingly libdivide_u32_mod_do_array() stores remainders.
+
+struct libdivide_u32_mod_t libdivide_u32_mod_gen(uint32_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_u32_mod_t result;
+    // For d == 1 M wraps to 0, which correctly yields 0
+    result.M = UINT64_MAX / d + 1;
+    result.d = d;
+    return result;
+}
+
+uint32_t libdivide_u32_mod_do(uint32_t numer, const struct libdivide_u32_mod_t *denom) {
+    uint64_t lowbits = denom->M * numer;
+    // High 64 bits of the 64-bit * 32-bit product lowbits * d
+    uint64_t lo = (lowbits & 0xFFFFFFFF) * denom->d;
+    uint64_t hi = (lowbits >> 32) * denom->d;
+    return (uint32_t)((hi + (lo >> 32)) >> 32);
+}
+
+uint32_t libdivide_u32_mod_recover(const struct libdivide_u32_mod_t *denom) { return denom->d; }
+
+LIBDIVIDE_DO_ARRAY_SCALAR(u32_mod, uint32_t)
+
+///////////// 52-BIT
+
+// The 52-bit dividers require |numer| < 2^52 and 0 < |d| < 2^52,
+// which covers e.g. nanosecond timestamps and file offsets. Setting
+// N = 52 in Granlund and Montgomery's algorithm, with l = ceil(log2(d))
+// and magic = floor(2^52 * (2^l - d) / d) + 1 < 2^52, then
+//
+//   q = (((numer * magic) >> 52) + numer) >> l
+//
+// is exact for all such numerators without any fixup. The 52-bit high
+// multiply is a single vpmadd52huq instruction on AVX512 IFMA CPUs,
+// elsewhere it is the high half of (numer << 12) * magic.
+
+struct libdivide_u52_t libdivide_u52_gen(uint64_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    if (d >> 52) {
+        LIBDIVIDE_ERROR("divider must be < 2^52");
+    }
+
+    // For d == 1 (l = 0) the magic number is 1, whose 52-bit
+    // high product is 0 for all numerators
+    uint32_t l = (d == 1) ? 0 : 64 - libdivide_count_leading_zeros64(d - 1);
+    uint64_t t = (1ULL << l) - d;
+    uint64_t rem;
+    struct libdivide_u52_t result;
+    result.magic = libdivide_128_div_64_to_64(t >> 12, t << 52, d, &rem) + 1;
+    result.more = (uint8_t)l;
+    return result;
+}
+
+struct libdivide_s52_t libdivide_s52_gen(int64_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    uint64_t absD = (d < 0) ? -(uint64_t)d : (uint64_t)d;
+    if (absD >> 52) {
+        LIBDIVIDE_ERROR("divider must be > -2^52 and < 2^52");
+    }
+
+    struct libdivide_u52_t u = libdivide_u52_gen(absD);
+    struct libdivide_s52_t result;
+    result.magic = (int64_t)u.magic;
+    result.more = (uint8_t)(u.more | ((d < 0) ? LIBDIVIDE_NEGATIVE_DIVISOR : 0));
+    return result;
+}
+
+uint64_t libdivide_u52_do(uint64_t numer, const struct libdivide_u52_t *denom) {
+    uint64_t q = libdivide_mullhi_u64(numer << 12, denom->magic);
+    return (q + numer) >> denom->more;
+}
+
+int64_t libdivide_s52_do(int64_t numer, const struct libdivide_s52_t *denom) {
+    uint8_t more = denom->more;
+    // Divide |numer|, then negate if the signs differ
+    int64_t sign = numer >> 63;
+    uint64_t absN = (uint64_t)((numer ^ sign) - sign);
+    uint64_t q = libdivide_mullhi_u64(absN << 12, (uint64_t)denom->magic);
+    q = (q + absN) >> (more & LIBDIVIDE_64_SHIFT_MASK);
+    sign ^= (int8_t)more >> 7;
+    return ((int64_t)q ^ sign) - sign;
+}
+
+uint64_t libdivide_u52_recover(const struct libdivide_u52_t *denom) {
+    // d = floor(2^(52 + l) / (2^52 + magic - 1))
+    uint8_t l = denom->more;
+    uint64_t n_hi = (l >= 12) ? 1ULL << (l - 12) : 0;
+    uint64_t n_lo = (l >= 12) ? 0 : 1ULL << (52 + l);
+    uint64_t rem;
+    return libdivide_128_div_64_to_64(n_hi, n_lo, (1ULL << 52) + denom->magic - 1, &rem);
+}
+
+int64_t libdivide_s52_recover(const struct libdivide_s52_t *denom) {
+    struct libdivide_u52_t u;
+    u.magic = (uint64_t)denom->magic;
+    u.more = denom->more & LIBDIVIDE_64_SHIFT_MASK;
+    int64_t d = (int64_t)libdivide_u52_recover(&u);
+    return (denom->more & LIBDIVIDE_NEGATIVE_DIVISOR) ? -d : d;
+}
+
+LIBDIVIDE_DO_ARRAY_SCALAR(u52, uint64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s52, int64_t)
+
+///////////// NARROW 64-BIT
+
+// If the 64-bit numerators are < 2^32 (e.g. array indices) the
+// quotient of a divisor d < 2^32 is the 32-bit quotient of the low
+// halves: libdivide_u32_gen_bounded() generates the magic number and
+// its high multiply is the upper half of a 32-bit * 32-bit = 64-bit
+// product, which is a single instruction for 64-bit lanes on x86
+// (pmuludq) instead of the emulated 64-bit high multiply. Divisors
+// >= 2^32 yield 0 for all these numerators, they are shifted by 32.
+struct libdivide_u64_narrow_t libdivide_u64_narrow_gen(uint64_t d, uint64_t max_numer) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    if (max_numer >> 32) {
+        LIBDIVIDE_ERROR("max_numer must be < 2^32");
+    }
+    struct libdivide_u64_narrow_t result;
+    if (d >> 32) {
+        result.magic = 0;
+        result.more = 32;
+    } else {
+        struct libdivide_u32_t u32 = libdivide_u32_gen_bounded((uint32_t)d, (uint32_t)max_numer);
+        result.magic = u32.magic;
+        result.more = u32.more;
+    }
+    return result;
+}
+
+uint64_t libdivide_u64_narrow_do(uint64_t numer, const struct libdivide_u64_narrow_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return numer >> more;
+    } else {
+        uint64_t q = (numer * denom->magic) >> 32;
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            uint64_t t = ((numer - q) >> 1) + q;
+            return t >> (more & LIBDIVIDE_32_SHIFT_MASK);
+        } else {
+            return q >> more;
+        }
+    }
+}
+
+LIBDIVIDE_DO_ARRAY_SCALAR(u64_narrow, uint64_t)
+
+///////////// PER-LANE DIVISORS
+
+// The libdivide_*_do_array_lanes() functions divide each numerator by
+// its own divisor, quotients[i] = numers[i] / d[i], the dividers of d[i]
+// being stored as two arrays: magics[i] and mores[i]. The AVX2 and AVX512
+// kernels (e.g. libdivide_u32_do_lanes_vec256) take vectors of per-lane
+// magic numbers and "more" values, using variable shifts. The branchfull
+// kernels compute all the paths and select the result of each lane. The
+// unsigned branchfree dividers are not supported, they only differ from
+// the branchfull ones by excluding the divisor 1.
+
+#define LIBDIVIDE_DO_ARRAY_LANES_SCALAR(ALGO, T)                                 \
+    static inline void libdivide_##ALGO##_do_array_lanes_scalar(const T *numers, \
+        T *quotients, size_t count, const T *magics, const uint8_t *mores) {     \
+        for (size_t i = 0; i < count; i++) {                                     \
+            struct libdivide_##ALGO##_t denom = {magics[i], mores[i]};           \
+            quotients[i] = libdivide_##ALGO##_do(numers[i], &denom);             \
+        }                                                                        \
+    }
+
+// LOAD_MORES loads as many "more" bytes as there are lanes
+// and zero extends them to the lane width.
+#define LIBDIVIDE_DO_ARRAY_LANES_VEC(ALGO, T, VEC, VEC_T, LOADU, STOREU, LOAD_MORES) \
+    static inline void libdivide_##ALGO##_do_array_lanes_##VEC(const T *numers,      \
+        T *quotients, size_t count, const T *magics, const uint8_t *mores) {         \
+        const size_t lanes = sizeof(VEC_T) / sizeof(T);                              \
+        size_t i = 0;                                                                \
+        for (; i + lanes <= count; i += lanes) {                                     \
+            VEC_T q = libdivide_##ALGO##_do_lanes_##VEC(                             \
+                LOADU(numers + i), LOADU(magics + i), LOAD_MORES(mores + i));        \
+            STOREU(quotients + i, q);                                                \
+        }                                                                            \
+        libdivide_##ALGO##_do_array_lanes_scalar(                                    \
+            numers + i, quotients + i, count - i, magics + i, mores + i);            \
+    }
+
+// 4 "more" bytes as an int, for the 4 lanes of 64-bit AVX2 kernels
+#define LIBDIVIDE_MORES4(p)                                                        \
+    ((int)((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | ((uint32_t)(p)[2] << 16) | \
+           ((uint32_t)(p)[3] << 24)))
+
+LIBDIVIDE_DO_ARRAY_LANES_SCALAR(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_LANES_SCALAR(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_LANES_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_LANES_SCALAR(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_LANES_SCALAR(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_LANES_SCALAR(s64_branchfree, int64_t)
+
+///////////// PACKED DIVIDERS
+
+// libdivide_*_do_array_packed() computes quotients[i] = numers[i] /
+// d[indices[i]] for a table of the byte packed 32-bit dividers, i.e. a
+// plain array of the 5-byte libdivide_*_t structs. The AVX2 and AVX512
+// kernels use two 4-byte gathers per vector: the magic numbers at byte
+// offset 5 * indices[i] and the "more" values, the top byte of the
+// 4 bytes at 5 * indices[i] + 1. Hence only the 5 bytes of each divider
+// are read. The indices must be < 2^31 / 5, the gather instructions
+// sign extend the offsets.
+
+#define LIBDIVIDE_PACKED_SCALAR(ALGO, T)                                                        \
+    static inline void libdivide_##ALGO##_do_array_packed_scalar(const T *numers, T *quotients, \
+        size_t count, const struct libdivide_##ALGO##_t *table, const uint32_t *indices) {      \
+        for (size_t i = 0; i < count; i++)                                                      \
+            quotients[i] = libdivide_##ALGO##_do(numers[i], &table[indices[i]]);                \
+    }
+
+// GATHER loads the dividers of the lanes and splits them
+// into the magic numbers and the "more" values.
+#define LIBDIVIDE_DO_ARRAY_PACKED_VEC(ALGO, T, VEC, VEC_T, LOADU, STOREU)              \
+    static inline void libdivide_##ALGO##_do_array_packed_##VEC(const T *numers,       \
+        T *quotients, size_t count, const struct libdivide_##ALGO##_t *table,          \
+        const uint32_t *indices) {                                                     \
+        const size_t lanes = sizeof(VEC_T) / sizeof(T);                                \
+        size_t i = 0;                                                                  \
+        for (; i + lanes <= count; i += lanes) {                                       \
+            VEC_T magics, mores;                                                       \
+            libdivide_gather_packed_##VEC(table, LOADU(indices + i), &magics, &mores); \
+            STOREU(quotients + i, libdivide_##ALGO##_do_lanes_##VEC(                   \
+                                      LOADU(numers + i), magics, mores));              \
+        }                                                                              \
+        libdivide_##ALGO##_do_array_packed_scalar(                                     \
+            numers + i, quotients + i, count - i, table, indices + i);                 \
+    }
+
+LIBDIVIDE_PACKED_SCALAR(u32, uint32_t)
+LIBDIVIDE_PACKED_SCALAR(s32, int32_t)
+LIBDIVIDE_PACKED_SCALAR(s32_branchfree, int32_t)
+
+///////////// REDUCTIONS
+
+// The libdivide_*_sum_quotients() functions store the sum of the
+// quotients of count numerators to *sum without storing the quotients,
+// hence the numerators are read once and nothing is written. The sum
+// is computed modulo 2^64. The vector kernels divide 4 vectors per
+// iteration and add the quotients to 4 vectors of 64-bit sums:
+// ACCUMULATE(acc, q) widens the quotients of q and adds them to the
+// 64-bit lanes of acc. The x86 kernels add the signed 16-bit and 32-bit
+// quotients as unsigned integers biased by BIAS (2^15 or 2^31), the
+// bias of the vector elements is subtracted from the total.
+
+#define LIBDIVIDE_SUM_QUOTIENTS_SCALAR(ALGO, T, S)                              \
+    static inline void libdivide_##ALGO##_sum_quotients_scalar(const T *numers, \
+        size_t count, const struct libdivide_##ALGO##_t *denom, S *sum) {       \
+        uint64_t total = 0;                                                     \
+        for (size_t i = 0; i < count; i++) {                                    \
+            total += (uint64_t)libdivide_##ALGO##_do(numers[i], denom);         \
+        }                                                                       \
+        *sum = (S)total;                                                        \
+    }
+
+#define LIBDIVIDE_SUM_QUOTIENTS_VEC(ALGO, T, S, VEC, VEC_T, ACC_T, LOADU, ZERO, ACCUMULATE, BIAS) \
+    static inline void libdivide_##ALGO##_sum_quotients_##VEC(const T *numers,                    \
+        size_t count, const struct libdivide_##ALGO##_t *denom, S *sum) {                         \
+        const size_t lanes = sizeof(VEC_T) / sizeof(T);                                           \
+        ACC_T acc0 = ZERO, acc1 = ZERO, acc2 = ZERO, acc3 = ZERO;                                 \
+        uint64_t total;                                                                           \
+        size_t i = 0;                                                                             \
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {                                          \
+            VEC_T q[4];                                                                           \
+            q[0] = LOADU(numers + i);                                                             \
+            q[1] = LOADU(numers + i + lanes);                                                     \
+            q[2] = LOADU(numers + i + 2 * lanes);                                                 \
+            q[3] = LOADU(numers + i + 3 * lanes);                                                 \
+            libdivide_##ALGO##_do_##VEC##_x4(q, denom);                                           \
+            acc0 = ACCUMULATE(acc0, q[0]);                                                        \
+            acc1 = ACCUMULATE(acc1, q[1]);                                                        \
+            acc2 = ACCUMULATE(acc2, q[2]);                                                        \
+            acc3 = ACCUMULATE(acc3, q[3]);                                                        \
+        }                                                                                         \
+        for (; i + lanes <= count; i += lanes) {                                                  \
+            acc0 = ACCUMULATE(acc0, libdivide_##ALGO##_do_##VEC(LOADU(numers + i), denom));       \
+        }                                                                                         \
+        total = libdivide_reduce_sums_##VEC(acc0, acc1, acc2, acc3) - (uint64_t)i * (BIAS);       \
+        for (; i < count; i++) {                                                                  \
+            total += (uint64_t)libdivide_##ALGO##_do(numers[i], denom);                           \
+        }                                                                                         \
+        *sum = (S)total;                                                                          \
+    }
+
+// SVE and RVV divide blocks of LIBDIVIDE_REDUCE_BLOCK numerators into a
+// buffer on the stack, which stays in the L1 cache, and sum the block.
+#define LIBDIVIDE_REDUCE_BLOCK 256
+
+#define LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(ALGO, T, S, VEC)                                        \
+    static inline void libdivide_##ALGO##_sum_quotients_##VEC(const T *numers,                  \
+        size_t count, const struct libdivide_##ALGO##_t *denom, S *sum) {                       \
+        T block[LIBDIVIDE_REDUCE_BLOCK];                                                        \
+        uint64_t total = 0;                                                                     \
+        for (size_t i = 0; i < count; i += LIBDIVIDE_REDUCE_BLOCK) {                            \
+            size_t n = count - i < LIBDIVIDE_REDUCE_BLOCK ? count - i : LIBDIVIDE_REDUCE_BLOCK; \
+            libdivide_##ALGO##_do_array_##VEC(numers + i, block, n, denom);                     \
+            for (size_t j = 0; j < n; j++) {                                                    \
+                total += (uint64_t)block[j];                                                    \
+            }                                                                                   \
+        }                                                                                       \
+        *sum = (S)total;                                                                        \
+    }
+
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(u16, uint16_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(s16, int16_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(u16_branchfree, uint16_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(s16_branchfree, int16_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(u32, uint32_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(s32, int32_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(u64, uint64_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(s64, int64_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(u32_branchfree, uint32_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(s32_branchfree, int32_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(u64_branchfree, uint64_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS_SCALAR(s64_branchfree, int64_t, int64_t)
+
+///////////// GEN ARRAYS
+
+// The libdivide_*_gen_array() functions generate the dividers of count
+// divisors. With AVX512 the 32-bit dividers are generated 8 at a time:
+// the 64/32 bit division of the gen function is replaced by a double
+// precision division, which is exact up to one, followed by an integer
+// correction. There are no 64-bit vector kernels since a double does
+// not have enough precision for the 128/64 bit division.
+
+#define LIBDIVIDE_GEN_ARRAY_SCALAR(ALGO, T)                                       \
+    static inline void libdivide_##ALGO##_gen_array_scalar(                       \
+        const T *divisors, struct libdivide_##ALGO##_t *dividers, size_t count) { \
+        for (size_t i = 0; i < count; i++) {                                      \
+            dividers[i] = libdivide_##ALGO##_gen(divisors[i]);                    \
+        }                                                                         \
+    }
+
+LIBDIVIDE_GEN_ARRAY_SCALAR(u32, uint32_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u32_branchfree, uint32_t)
+
+static inline void libdivide_u64_gen_array(
+    const uint64_t *divisors, struct libdivide_u64_t *dividers, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dividers[i] = libdivide_u64_gen(divisors[i]);
+    }
+}
+
+static inline void libdivide_u64_branchfree_gen_array(
+    const uint64_t *divisors, struct libdivide_u64_branchfree_t *dividers, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dividers[i] = libdivide_u64_branchfree_gen(divisors[i]);
+    }
+}
+
+#if defined(LIBDIVIDE_NEON)
+
+static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_do_vec128(
+    uint16x8_t numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE int16x8_t libdivide_s16_do_vec128(
+    int16x8_t numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_branchfree_do_vec128(
+    uint16x8_t numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE int16x8_t libdivide_s16_branchfree_do_vec128(
+    int16x8_t numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_branchfree_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_branchfree_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_branchfree_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_branchfree_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom);
+
+//////// Internal Utility Functions
+
+// Logical right shift by runtime value.
+// NEON implements right shift as left shits by negative values.
+static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_neon_srl(uint16x8_t v, uint8_t amt) {
+    int16_t wamt = static_cast<int16_t>(amt);
+    return vshlq_u16(v, vdupq_n_s16(-wamt));
+}
+
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_neon_srl(uint32x4_t v, uint8_t amt) {
+    int32_t wamt = static_cast<int32_t>(amt);
+    return vshlq_u32(v, vdupq_n_s32(-wamt));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_neon_srl(uint64x2_t v, uint8_t amt) {
+    int64_t wamt = static_cast<int64_t>(amt);
+    return vshlq_u64(v, vdupq_n_s64(-wamt));
+}
+
+// Arithmetic right shift by runtime value.
+static LIBDIVIDE_INLINE int16x8_t libdivide_s16_neon_sra(int16x8_t v, uint8_t amt) {
+    int16_t wamt = static_cast<int16_t>(amt);
+    return vshlq_s16(v, vdupq_n_s16(-wamt));
+}
+
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_neon_sra(int32x4_t v, uint8_t amt) {
+    int32_t wamt = static_cast<int32_t>(amt);
+    return vshlq_s32(v, vdupq_n_s32(-wamt));
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_neon_sra(int64x2_t v, uint8_t amt) {
+    int64_t wamt = static_cast<int64_t>(amt);
+    return vshlq_s64(v, vdupq_n_s64(-wamt));
+}
+
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_signbits_vec128(int32x4_t v) {
+    return vshrq_n_s32(v, 31);
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_signbits_vec128(int64x2_t v) {
+    return vshrq_n_s64(v, 63);
+}
+
+static LIBDIVIDE_INLINE uint16x8_t libdivide_mullhi_u16_vec128(uint16x8_t a, uint16_t b) {
+    uint16x8_t w1 = vreinterpretq_u16_u32(vmull_n_u16(vget_low_u16(a), b));  // [_, x0, _, x1, ...]
+    uint16x8_t w2 = vreinterpretq_u16_u32(vmull_high_n_u16(a, b));           //[_, x4, _, x5, ...]
+    return vuzp2q_u16(w1, w2);                                               // [x0, x1, ..., x7]
+}
+
+static LIBDIVIDE_INLINE int16x8_t libdivide_mullhi_s16_vec128(int16x8_t a, int16_t b) {
+    int16x8_t w1 = vreinterpretq_s16_s32(vmull_n_s16(vget_low_s16(a), b));  // [_, x0, _, x1, ...]
+    int16x8_t w2 = vreinterpretq_s16_s32(vmull_high_n_s16(a, b));           //[_, x4, _, x5, ...]
+    return vuzp2q_s16(w1, w2);                                              // [x0, x1, ..., x7]
+}
+
+static LIBDIVIDE_INLINE uint32x4_t libdivide_mullhi_u32_vec128(uint32x4_t a, uint32_t b) {
+    // Desire is [x0, x1, x2, x3]
+    uint32x4_t w1 = vreinterpretq_u32_u64(vmull_n_u32(vget_low_u32(a), b));  // [_, x0, _, x1]
+    uint32x4_t w2 = vreinterpretq_u32_u64(vmull_high_n_u32(a, b));           //[_, x2, _, x3]
+    return vuzp2q_u32(w1, w2);                                               // [x0, x1, x2, x3]
+}
+
+static LIBDIVIDE_INLINE int32x4_t libdivide_mullhi_s32_vec128(int32x4_t a, int32_t b) {
+    int32x4_t w1 = vreinterpretq_s32_s64(vmull_n_s32(vget_low_s32(a), b));  // [_, x0, _, x1]
+    int32x4_t w2 = vreinterpretq_s32_s64(vmull_high_n_s32(a, b));           //[_, x2, _, x3]
+    return vuzp2q_s32(w1, w2);                                              // [x0, x1, x2, x3]
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_mullhi_u64_vec128(uint64x2_t x, uint64_t sy) {
+    // full 128 bits product is:
+    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
+    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
+
+    // Get low and high words. x0 contains low 32 bits, x1 is high 32 bits.
+    uint64x2_t y = vdupq_n_u64(sy);
+    uint32x2_t x0 = vmovn_u64(x);
+    uint32x2_t y0 = vmovn_u64(y);
+    uint32x2_t x1 = vshrn_n_u64(x, 32);
+    uint32x2_t y1 = vshrn_n_u64(y, 32);
+
+    // Compute x0*y0.
+    uint64x2_t x0y0 = vmull_u32(x0, y0);
+    uint64x2_t x0y0_hi = vshrq_n_u64(x0y0, 32);
+
+    // Compute other intermediate products.
+    uint64x2_t temp = vmlal_u32(x0y0_hi, x1, y0);  // temp = x0y0_hi + x1*y0;
+    // We want to split temp into its low 32 bits and high 32 bits, both
+    // in the low half of 64 bit registers.
+    // Use shifts to avoid needing a reg for the mask.
+    uint64x2_t temp_lo = vshrq_n_u64(vshlq_n_u64(temp, 32), 32);  // temp_lo = temp & 0xFFFFFFFF;
+    uint64x2_t temp_hi = vshrq_n_u64(temp, 32);                   // temp_hi = temp >> 32;
+
+    temp_lo = vmlal_u32(temp_lo, x0, y1);  // temp_lo += x0*y0
+    temp_lo = vshrq_n_u64(temp_lo, 32);    // temp_lo >>= 32
+    temp_hi = vmlal_u32(temp_hi, x1, y1);  // temp_hi += x1*y1
+    uint64x2_t result = vaddq_u64(temp_hi, temp_lo);
+    return result;
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_mullhi_s64_vec128(int64x2_t x, int64_t sy) {
+    int64x2_t p = vreinterpretq_s64_u64(
+        libdivide_mullhi_u64_vec128(vreinterpretq_u64_s64(x), static_cast<uint64_t>(sy)));
+    int64x2_t y = vdupq_n_s64(sy);
+    int64x2_t t1 = vandq_s64(libdivide_s64_signbits_vec128(x), y);
+    int64x2_t t2 = vandq_s64(libdivide_s64_signbits_vec128(y), x);
+    p = vsubq_s64(p, t1);
+    p = vsubq_s64(p, t2);
+    return p;
+}
+
+// Low 64 bits of the lane-wise 64-bit product
+static LIBDIVIDE_INLINE uint64x2_t libdivide_mullo_u64_vec128(uint64x2_t x, uint64x2_t y) {
+    uint32x2_t x0 = vmovn_u64(x);
+    uint32x2_t y0 = vmovn_u64(y);
+    uint32x2_t x1 = vshrn_n_u64(x, 32);
+    uint32x2_t y1 = vshrn_n_u64(y, 32);
+    uint64x2_t cross = vmlal_u32(vmull_u32(x1, y0), x0, y1);
+    return vaddq_u64(vmull_u32(x0, y0), vshlq_n_u64(cross, 32));
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_mullo_s64_vec128(int64x2_t x, int64x2_t y) {
+    return vreinterpretq_s64_u64(
+        libdivide_mullo_u64_vec128(vreinterpretq_u64_s64(x), vreinterpretq_u64_s64(y)));
+}
+
+////////// UINT16
+
+uint16x8_t libdivide_u16_do_vec128(uint16x8_t numers, const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u16_neon_srl(numers, more);
+    } else {
+        uint16x8_t q = libdivide_mullhi_u16_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint16_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            // Note we can use halving-subtract to avoid the shift.
+            uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+            uint16x8_t t = vaddq_u16(vhsubq_u16(numers, q), q);
+            return libdivide_u16_neon_srl(t, shift);
+        } else {
+            return libdivide_u16_neon_srl(q, more);
+        }
+    }
+}
+
+uint16x8_t libdivide_u16_branchfree_do_vec128(
+    uint16x8_t numers, const struct libdivide_u16_branchfree_t *denom) {
+    uint16x8_t q = libdivide_mullhi_u16_vec128(numers, denom->magic);
+    uint16x8_t t = vaddq_u16(vhsubq_u16(numers, q), q);
+    return libdivide_u16_neon_srl(t, denom->more);
+}
+
+////////// SINT16
+
+int16x8_t libdivide_s16_do_vec128(int16x8_t numers, const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        int16x8_t roundToZeroTweak = vdupq_n_s16((int16_t)mask);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        int16x8_t q = vaddq_s16(numers, vandq_s16(vshrq_n_s16(numers, 15), roundToZeroTweak));
+        q = libdivide_s16_neon_sra(q, shift);
+        int16x8_t sign = vdupq_n_s16((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = vsubq_s16(veorq_s16(q, sign), sign);
+        return q;
+    } else {
+        int16x8_t q = libdivide_mullhi_s16_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            int16x8_t sign = vdupq_n_s16((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = vaddq_s16(q, vsubq_s16(veorq_s16(numers, sign), sign));
+        }
+        // q >>= shift
+        q = libdivide_s16_neon_sra(q, more & LIBDIVIDE_16_SHIFT_MASK);
+        q = vaddq_s16(
+            q, vreinterpretq_s16_u16(vshrq_n_u16(vreinterpretq_u16_s16(q), 15)));  // q += (q < 0)
+        return q;
+    }
+}
+
+int16x8_t libdivide_s16_branchfree_do_vec128(
+    int16x8_t numers, const struct libdivide_s16_branchfree_t *denom) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    int16x8_t sign = vdupq_n_s16((int8_t)more >> 7);
+    int16x8_t q = libdivide_mullhi_s16_vec128(numers, magic);
+    q = vaddq_s16(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    int16x8_t q_sign = vshrq_n_s16(q, 15);  // q_sign = q >> 15
+    int16x8_t mask = vdupq_n_s16((int16_t)(((uint16_t)1 << shift) - is_power_of_2));
+    q = vaddq_s16(q, vandq_s16(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s16_neon_sra(q, shift);       // q >>= shift
+    q = vsubq_s16(veorq_s16(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// UINT32
+
+uint32x4_t libdivide_u32_do_vec128(uint32x4_t numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u32_neon_srl(numers, more);
+    } else {
+        uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            // Note we can use halving-subtract to avoid the shift.
+            uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
+            return libdivide_u32_neon_srl(t, shift);
+        } else {
+            return libdivide_u32_neon_srl(q, more);
+        }
+    }
+}
+
+uint32x4_t libdivide_u32_branchfree_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom) {
+    uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
+    uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
+    return libdivide_u32_neon_srl(t, denom->more);
+}
+
+////////// UINT64
+
+uint64x2_t libdivide_u64_do_vec128(uint64x2_t numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u64_neon_srl(numers, more);
+    } else {
+        uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            // No 64-bit halving subtracts in NEON :(
+            uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
+            return libdivide_u64_neon_srl(t, shift);
+        } else {
+            return libdivide_u64_neon_srl(q, more);
+        }
+    }
+}
+
+uint64x2_t libdivide_u64_branchfree_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom) {
+    uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
+    uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
+    return libdivide_u64_neon_srl(t, denom->more);
+}
+
+////////// SINT32
+
+int32x4_t libdivide_s32_do_vec128(int32x4_t numers, const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t mask = (1U << shift) - 1;
+        int32x4_t roundToZeroTweak = vdupq_n_s32((int)mask);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        int32x4_t q = vaddq_s32(numers, vandq_s32(vshrq_n_s32(numers, 31), roundToZeroTweak));
+        q = libdivide_s32_neon_sra(q, shift);
+        int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = vsubq_s32(veorq_s32(q, sign), sign);
+        return q;
+    } else {
+        int32x4_t q = libdivide_mullhi_s32_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = vaddq_s32(q, vsubq_s32(veorq_s32(numers, sign), sign));
+        }
+        // q >>= shift
+        q = libdivide_s32_neon_sra(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = vaddq_s32(
+            q, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(q), 31)));  // q += (q < 0)
+        return q;
+    }
+}
+
+int32x4_t libdivide_s32_branchfree_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
+    int32x4_t q = libdivide_mullhi_s32_vec128(numers, magic);
+    q = vaddq_s32(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    int32x4_t q_sign = vshrq_n_s32(q, 31);  // q_sign = q >> 31
+    int32x4_t mask = vdupq_n_s32((1U << shift) - is_power_of_2);
+    q = vaddq_s32(q, vandq_s32(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s32_neon_sra(q, shift);       // q >>= shift
+    q = vsubq_s32(veorq_s32(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT64
+
+int64x2_t libdivide_s64_do_vec128(int64x2_t numers, const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    int64_t magic = denom->magic;
+    if (magic == 0) {  // shift path
+        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t mask = (1ULL << shift) - 1;
+        int64x2_t roundToZeroTweak = vdupq_n_s64(mask);  // TODO: no need to sign extend
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        int64x2_t q =
+            vaddq_s64(numers, vandq_s64(libdivide_s64_signbits_vec128(numers), roundToZeroTweak));
+        q = libdivide_s64_neon_sra(q, shift);
+        // q = (q ^ sign) - sign;
+        int64x2_t sign = vreinterpretq_s64_s8(vdupq_n_s8((int8_t)more >> 7));
+        q = vsubq_s64(veorq_s64(q, sign), sign);
+        return q;
+    } else {
+        int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: no need to widen
+            // q += ((numer ^ sign) - sign);
+            q = vaddq_s64(q, vsubq_s64(veorq_s64(numers, sign), sign));
+        }
+        // q >>= denom->mult_path.shift
+        q = libdivide_s64_neon_sra(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = vaddq_s64(
+            q, vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_s64(q), 63)));  // q += (q < 0)
+        return q;
+    }
+}
+
+int64x2_t libdivide_s64_branchfree_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: avoid sign extend
+
+    // libdivide_mullhi_s64(numers, magic);
+    int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
+    q = vaddq_s64(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint32_t is_power_of_2 = (magic == 0);
+    int64x2_t q_sign = libdivide_s64_signbits_vec128(q);  // q_sign = q >> 63
+    int64x2_t mask = vdupq_n_s64((1ULL << shift) - is_power_of_2);
+    q = vaddq_s64(q, vandq_s64(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_neon_sra(q, shift);       // q >>= shift
+    q = vsubq_s64(veorq_s64(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u16, uint16_t, vec128, uint16x8_t, vld1q_u16, vst1q_u16)
+LIBDIVIDE_DO_ARRAY_VEC(s16, int16_t, vec128, int16x8_t, vld1q_s16, vst1q_s16)
+LIBDIVIDE_DO_ARRAY_VEC(u16_branchfree, uint16_t, vec128, uint16x8_t, vld1q_u16, vst1q_u16)
+LIBDIVIDE_DO_ARRAY_VEC(s16_branchfree, int16_t, vec128, int16x8_t, vld1q_s16, vst1q_s16)
+LIBDIVIDE_DO_ARRAY_VEC(u32, uint32_t, vec128, uint32x4_t, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DO_ARRAY_VEC(s32, int32_t, vec128, int32x4_t, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DO_ARRAY_VEC(u64, uint64_t, vec128, uint64x2_t, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DO_ARRAY_VEC(s64, int64_t, vec128, int64x2_t, vld1q_s64, vst1q_s64)
+LIBDIVIDE_DO_ARRAY_VEC(u32_branchfree, uint32_t, vec128, uint32x4_t, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DO_ARRAY_VEC(s32_branchfree, int32_t, vec128, int32x4_t, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DO_ARRAY_VEC(u64_branchfree, uint64_t, vec128, uint64x2_t, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DO_ARRAY_VEC(s64_branchfree, int64_t, vec128, int64x2_t, vld1q_s64, vst1q_s64)
+
+LIBDIVIDE_DIVMOD_VEC(u32, uint32_t, vec128, uint32x4_t,
+    vdupq_n_u32, vmulq_u32, vsubq_u32, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DIVMOD_VEC(s32, int32_t, vec128, int32x4_t,
+    vdupq_n_s32, vmulq_s32, vsubq_s32, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DIVMOD_VEC(u64, uint64_t, vec128, uint64x2_t,
+    vdupq_n_u64, libdivide_mullo_u64_vec128, vsubq_u64, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DIVMOD_VEC(s64, int64_t, vec128, int64x2_t,
+    vdupq_n_s64, libdivide_mullo_s64_vec128, vsubq_s64, vld1q_s64, vst1q_s64)
+LIBDIVIDE_DIVMOD_VEC(u32_branchfree, uint32_t, vec128, uint32x4_t,
+    vdupq_n_u32, vmulq_u32, vsubq_u32, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DIVMOD_VEC(s32_branchfree, int32_t, vec128, int32x4_t,
+    vdupq_n_s32, vmulq_s32, vsubq_s32, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DIVMOD_VEC(u64_branchfree, uint64_t, vec128, uint64x2_t,
+    vdupq_n_u64, libdivide_mullo_u64_vec128, vsubq_u64, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DIVMOD_VEC(s64_branchfree, int64_t, vec128, int64x2_t,
+    vdupq_n_s64, libdivide_mullo_s64_vec128, vsubq_s64, vld1q_s64, vst1q_s64)
+
+LIBDIVIDE_ROUNDING_VEC(s32, int32_t, uint32_t, vec128, int32x4_t,
+    vdupq_n_s32, vaddq_s32, vsubq_s32, vandq_s32, veorq_s32, libdivide_s32_signbits_vec128)
+LIBDIVIDE_ROUNDING_VEC(s64, int64_t, uint64_t, vec128, int64x2_t,
+    vdupq_n_s64, vaddq_s64, vsubq_s64, vandq_s64, veorq_s64, libdivide_s64_signbits_vec128)
+LIBDIVIDE_ROUNDING_VEC(s32_branchfree, int32_t, uint32_t, vec128, int32x4_t,
+    vdupq_n_s32, vaddq_s32, vsubq_s32, vandq_s32, veorq_s32, libdivide_s32_signbits_vec128)
+LIBDIVIDE_ROUNDING_VEC(s64_branchfree, int64_t, uint64_t, vec128, int64x2_t,
+    vdupq_n_s64, vaddq_s64, vsubq_s64, vandq_s64, veorq_s64, libdivide_s64_signbits_vec128)
+
+////////// DIVISIBILITY
+
+// Returns a mask with all bits set in the lanes that are divisible
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_is_divisible_vec128(
+    uint32x4_t numers, const struct libdivide_u32_divisibility_t *denom) {
+    int32_t shift = denom->shift;
+    uint32x4_t x = vmulq_u32(numers, vdupq_n_u32(denom->inverse));
+    // vshlq_u32() shifts right for negative counts and returns 0 for a count of 32
+    x = vorrq_u32(vshlq_u32(x, vdupq_n_s32(-shift)), vshlq_u32(x, vdupq_n_s32(32 - shift)));
+    return vcleq_u32(x, vdupq_n_u32(denom->threshold));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_is_divisible_vec128(
+    uint64x2_t numers, const struct libdivide_u64_divisibility_t *denom) {
+    int64_t shift = denom->shift;
+    uint64x2_t x = libdivide_mullo_u64_vec128(numers, vdupq_n_u64(denom->inverse));
+    x = vorrq_u64(vshlq_u64(x, vdupq_n_s64(-shift)), vshlq_u64(x, vdupq_n_s64(64 - shift)));
+    return vcleq_u64(x, vdupq_n_u64(denom->threshold));
+}
+
+////////// FASTMOD
+
+// Computes 2 remainders, see libdivide_u32_mod_do()
+static LIBDIVIDE_INLINE uint32x2_t libdivide_u32_mod_half_vec128(
+    uint32x2_t numers, uint32x2_t m_lo, uint32x2_t m_hi, uint32x2_t d) {
+    uint64x2_t lowbits =
+        vaddq_u64(vmull_u32(numers, m_lo), vshlq_n_u64(vmull_u32(numers, m_hi), 32));
+    uint64x2_t lo = vshrq_n_u64(vmull_u32(vmovn_u64(lowbits), d), 32);
+    uint64x2_t hi = vmull_u32(vshrn_n_u64(lowbits, 32), d);
+    return vshrn_n_u64(vaddq_u64(hi, lo), 32);
+}
+
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_mod_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_mod_t *denom) {
+    uint32x2_t m_lo = vdup_n_u32((uint32_t)denom->M);
+    uint32x2_t m_hi = vdup_n_u32((uint32_t)(denom->M >> 32));
+    uint32x2_t d = vdup_n_u32(denom->d);
+    return vcombine_u32(libdivide_u32_mod_half_vec128(vget_low_u32(numers), m_lo, m_hi, d),
+        libdivide_u32_mod_half_vec128(vget_high_u32(numers), m_lo, m_hi, d));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_mod, uint32_t, vec128, uint32x4_t, vld1q_u32, vst1q_u32)
+
+////////// EXACT DIVISION
+
+// See libdivide_u32_exact_do()
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_exact_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_exact_t *denom) {
+    return vmulq_u32(libdivide_u32_neon_srl(numers, denom->shift), vdupq_n_u32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_exact_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_exact_t *denom) {
+    return vmulq_s32(libdivide_s32_neon_sra(numers, denom->shift), vdupq_n_s32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_exact_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_exact_t *denom) {
+    return libdivide_mullo_u64_vec128(
+        libdivide_u64_neon_srl(numers, denom->shift), vdupq_n_u64(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_exact_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_exact_t *denom) {
+    return libdivide_mullo_s64_vec128(
+        libdivide_s64_neon_sra(numers, denom->shift), vdupq_n_s64(denom->inverse));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_exact, uint32_t, vec128, uint32x4_t, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DO_ARRAY_VEC(s32_exact, int32_t, vec128, int32x4_t, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DO_ARRAY_VEC(u64_exact, uint64_t, vec128, uint64x2_t, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DO_ARRAY_VEC(s64_exact, int64_t, vec128, int64x2_t, vld1q_s64, vst1q_s64)
+
+////////// 52-BIT
+
+// See libdivide_u52_do()
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u52_do_vec128(
+    uint64x2_t numers, const struct libdivide_u52_t *denom) {
+    uint64x2_t q = libdivide_mullhi_u64_vec128(vshlq_n_u64(numers, 12), denom->magic);
+    return libdivide_u64_neon_srl(vaddq_u64(q, numers), denom->more);
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_s52_do_vec128(
+    int64x2_t numers, const struct libdivide_s52_t *denom) {
+    uint8_t more = denom->more;
+    int64x2_t sign = libdivide_s64_signbits_vec128(numers);
+    uint64x2_t absN = vreinterpretq_u64_s64(vsubq_s64(veorq_s64(numers, sign), sign));
+    uint64x2_t q = libdivide_mullhi_u64_vec128(vshlq_n_u64(absN, 12), (uint64_t)denom->magic);
+    q = libdivide_u64_neon_srl(vaddq_u64(q, absN), more & LIBDIVIDE_64_SHIFT_MASK);
+    sign = veorq_s64(sign, vdupq_n_s64((int8_t)more >> 7));
+    return vsubq_s64(veorq_s64(vreinterpretq_s64_u64(q), sign), sign);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u52, uint64_t, vec128, uint64x2_t, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DO_ARRAY_VEC(s52, int64_t, vec128, int64x2_t, vld1q_s64, vst1q_s64)
+
+// Adds the quotients of q pairwise to the 64-bit sums of acc, the
+// signed quotients are widened using the signed pairwise additions.
+static LIBDIVIDE_INLINE uint64x2_t libdivide_sum_u16_vec128(uint64x2_t acc, uint16x8_t q) {
+    return vpadalq_u32(acc, vpaddlq_u16(q));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_sum_s16_vec128(uint64x2_t acc, int16x8_t q) {
+    return vreinterpretq_u64_s64(vpadalq_s32(vreinterpretq_s64_u64(acc), vpaddlq_s16(q)));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_sum_u32_vec128(uint64x2_t acc, uint32x4_t q) {
+    return vpadalq_u32(acc, q);
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_sum_s32_vec128(uint64x2_t acc, int32x4_t q) {
+    return vreinterpretq_u64_s64(vpadalq_s32(vreinterpretq_s64_u64(acc), q));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_sum_u64_vec128(uint64x2_t acc, uint64x2_t q) {
+    return vaddq_u64(acc, q);
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_sum_s64_vec128(uint64x2_t acc, int64x2_t q) {
+    return vaddq_u64(acc, vreinterpretq_u64_s64(q));
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_reduce_sums_vec128(
+    uint64x2_t acc0, uint64x2_t acc1, uint64x2_t acc2, uint64x2_t acc3) {
+    uint64x2_t acc = vaddq_u64(vaddq_u64(acc0, acc1), vaddq_u64(acc2, acc3));
+    return vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+}
+
+#define LIBDIVIDE_SUM_QUOTIENTS_VEC128(ALGO, T, S, VEC_T, LOADU, ACCUMULATE) \
+    LIBDIVIDE_SUM_QUOTIENTS_VEC(                                             \
+        ALGO, T, S, vec128, VEC_T, uint64x2_t, LOADU, vdupq_n_u64(0), ACCUMULATE, 0)
+
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    u16, uint16_t, uint64_t, uint16x8_t, vld1q_u16, libdivide_sum_u16_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    s16, int16_t, int64_t, int16x8_t, vld1q_s16, libdivide_sum_s16_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    u16_branchfree, uint16_t, uint64_t, uint16x8_t, vld1q_u16, libdivide_sum_u16_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    s16_branchfree, int16_t, int64_t, int16x8_t, vld1q_s16, libdivide_sum_s16_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    u32, uint32_t, uint64_t, uint32x4_t, vld1q_u32, libdivide_sum_u32_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    s32, int32_t, int64_t, int32x4_t, vld1q_s32, libdivide_sum_s32_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    u64, uint64_t, uint64_t, uint64x2_t, vld1q_u64, libdivide_sum_u64_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    s64, int64_t, int64_t, int64x2_t, vld1q_s64, libdivide_sum_s64_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    u32_branchfree, uint32_t, uint64_t, uint32x4_t, vld1q_u32, libdivide_sum_u32_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    s32_branchfree, int32_t, int64_t, int32x4_t, vld1q_s32, libdivide_sum_s32_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    u64_branchfree, uint64_t, uint64_t, uint64x2_t, vld1q_u64, libdivide_sum_u64_vec128)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(
+    s64_branchfree, int64_t, int64_t, int64x2_t, vld1q_s64, libdivide_sum_s64_vec128)
+
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+
+// The SVE kernels are vector length agnostic: a vector holds svcntb()
+// bytes, 16 to 256 depending on the CPU. Unlike NEON, SVE has native
+// high multiplications for all lane widths, including 64-bit lanes.
+// The kernels use all lanes, the array functions predicate the loads
+// and stores of their last iteration instead of a scalar tail loop.
+
+static LIBDIVIDE_INLINE svuint16_t libdivide_u16_do_sve(
+    svuint16_t numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE svint16_t libdivide_s16_do_sve(
+    svint16_t numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_do_sve(
+    svuint32_t numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_do_sve(
+    svint32_t numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_do_sve(
+    svuint64_t numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_do_sve(
+    svint64_t numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE svuint16_t libdivide_u16_branchfree_do_sve(
+    svuint16_t numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE svint16_t libdivide_s16_branchfree_do_sve(
+    svint16_t numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_branchfree_do_sve(
+    svuint32_t numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_branchfree_do_sve(
+    svint32_t numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_branchfree_do_sve(
+    svuint64_t numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_branchfree_do_sve(
+    svint64_t numers, const struct libdivide_s64_branchfree_t *denom);
+
+////////// UINT16
+
+svuint16_t libdivide_u16_do_sve(svuint16_t numers, const struct libdivide_u16_t *denom) {
+    svbool_t pg = svptrue_b16();
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return svlsr_n_u16_x(pg, numers, more);
+    } else {
+        svuint16_t q = svmulh_n_u16_x(pg, numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint16_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+            svuint16_t t = svadd_u16_x(pg, svlsr_n_u16_x(pg, svsub_u16_x(pg, numers, q), 1), q);
+            return svlsr_n_u16_x(pg, t, shift);
+        } else {
+            return svlsr_n_u16_x(pg, q, more);
+        }
+    }
+}
+
+svuint16_t libdivide_u16_branchfree_do_sve(
+    svuint16_t numers, const struct libdivide_u16_branchfree_t *denom) {
+    svbool_t pg = svptrue_b16();
+    svuint16_t q = svmulh_n_u16_x(pg, numers, denom->magic);
+    svuint16_t t = svadd_u16_x(pg, svlsr_n_u16_x(pg, svsub_u16_x(pg, numers, q), 1), q);
+    return svlsr_n_u16_x(pg, t, denom->more);
+}
+
+////////// SINT16
+
+svint16_t libdivide_s16_do_sve(svint16_t numers, const struct libdivide_s16_t *denom) {
+    svbool_t pg = svptrue_b16();
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    int16_t sign = (int8_t)more >> 7;
+    if (!denom->magic) {
+        int16_t mask = (int16_t)(((uint16_t)1 << shift) - 1);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        svint16_t q =
+            svadd_s16_x(pg, numers, svand_n_s16_x(pg, svasr_n_s16_x(pg, numers, 15), mask));
+        q = svasr_n_s16_x(pg, q, shift);
+        // q = (q ^ sign) - sign;
+        return svsub_n_s16_x(pg, sveor_n_s16_x(pg, q, sign), sign);
+    } else {
+        svint16_t q = svmulh_n_s16_x(pg, numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // q += ((numer ^ sign) - sign);
+            q = svadd_s16_x(pg, q, svsub_n_s16_x(pg, sveor_n_s16_x(pg, numers, sign), sign));
+        }
+        // q >>= shift
+        q = svasr_n_s16_x(pg, q, shift);
+        // q += (q < 0)
+        svuint16_t q_neg = svlsr_n_u16_x(pg, svreinterpret_u16_s16(q), 15);
+        return svadd_s16_x(pg, q, svreinterpret_s16_u16(q_neg));
+    }
+}
+
+svint16_t libdivide_s16_branchfree_do_sve(
+    svint16_t numers, const struct libdivide_s16_branchfree_t *denom) {
+    svbool_t pg = svptrue_b16();
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    int16_t sign = (int8_t)more >> 7;
+    svint16_t q = svmulh_n_s16_x(pg, numers, magic);
+    q = svadd_s16_x(pg, q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    int16_t mask = (int16_t)(((uint16_t)1 << shift) - is_power_of_2);
+    svint16_t q_sign = svasr_n_s16_x(pg, q, 15);             // q_sign = q >> 15
+    q = svadd_s16_x(pg, q, svand_n_s16_x(pg, q_sign, mask));  // q = q + (q_sign & mask)
+    q = svasr_n_s16_x(pg, q, shift);                          // q >>= shift
+    return svsub_n_s16_x(pg, sveor_n_s16_x(pg, q, sign), sign);  // q = (q ^ sign) - sign
+}
+
+////////// UINT32
+
+svuint32_t libdivide_u32_do_sve(svuint32_t numers, const struct libdivide_u32_t *denom) {
+    svbool_t pg = svptrue_b32();
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return svlsr_n_u32_x(pg, numers, more);
+    } else {
+        svuint32_t q = svmulh_n_u32_x(pg, numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            svuint32_t t = svadd_u32_x(pg, svlsr_n_u32_x(pg, svsub_u32_x(pg, numers, q), 1), q);
+            return svlsr_n_u32_x(pg, t, shift);
+        } else {
+            return svlsr_n_u32_x(pg, q, more);
+        }
+    }
+}
+
+svuint32_t libdivide_u32_branchfree_do_sve(
+    svuint32_t numers, const struct libdivide_u32_branchfree_t *denom) {
+    svbool_t pg = svptrue_b32();
+    svuint32_t q = svmulh_n_u32_x(pg, numers, denom->magic);
+    svuint32_t t = svadd_u32_x(pg, svlsr_n_u32_x(pg, svsub_u32_x(pg, numers, q), 1), q);
+    return svlsr_n_u32_x(pg, t, denom->more);
+}
+
+////////// UINT64
+
+svuint64_t libdivide_u64_do_sve(svuint64_t numers, const struct libdivide_u64_t *denom) {
+    svbool_t pg = svptrue_b64();
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return svlsr_n_u64_x(pg, numers, more);
+    } else {
+        svuint64_t q = svmulh_n_u64_x(pg, numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint64_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            svuint64_t t = svadd_u64_x(pg, svlsr_n_u64_x(pg, svsub_u64_x(pg, numers, q), 1), q);
+            return svlsr_n_u64_x(pg, t, shift);
+        } else {
+            return svlsr_n_u64_x(pg, q, more);
+        }
+    }
+}
+
+svuint64_t libdivide_u64_branchfree_do_sve(
+    svuint64_t numers, const struct libdivide_u64_branchfree_t *denom) {
+    svbool_t pg = svptrue_b64();
+    svuint64_t q = svmulh_n_u64_x(pg, numers, denom->magic);
+    svuint64_t t = svadd_u64_x(pg, svlsr_n_u64_x(pg, svsub_u64_x(pg, numers, q), 1), q);
+    return svlsr_n_u64_x(pg, t, denom->more);
+}
+
+////////// SINT32
+
+svint32_t libdivide_s32_do_sve(svint32_t numers, const struct libdivide_s32_t *denom) {
+    svbool_t pg = svptrue_b32();
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    int32_t sign = (int8_t)more >> 7;
+    if (!denom->magic) {
+        int32_t mask = (int32_t)((1U << shift) - 1);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        svint32_t q =
+            svadd_s32_x(pg, numers, svand_n_s32_x(pg, svasr_n_s32_x(pg, numers, 31), mask));
+        q = svasr_n_s32_x(pg, q, shift);
+        // q = (q ^ sign) - sign;
+        return svsub_n_s32_x(pg, sveor_n_s32_x(pg, q, sign), sign);
+    } else {
+        svint32_t q = svmulh_n_s32_x(pg, numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // q += ((numer ^ sign) - sign);
+            q = svadd_s32_x(pg, q, svsub_n_s32_x(pg, sveor_n_s32_x(pg, numers, sign), sign));
+        }
+        // q >>= shift
+        q = svasr_n_s32_x(pg, q, shift);
+        // q += (q < 0)
+        svuint32_t q_neg = svlsr_n_u32_x(pg, svreinterpret_u32_s32(q), 31);
+        return svadd_s32_x(pg, q, svreinterpret_s32_u32(q_neg));
+    }
+}
+
+svint32_t libdivide_s32_branchfree_do_sve(
+    svint32_t numers, const struct libdivide_s32_branchfree_t *denom) {
+    svbool_t pg = svptrue_b32();
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    int32_t sign = (int8_t)more >> 7;
+    svint32_t q = svmulh_n_s32_x(pg, numers, magic);
+    q = svadd_s32_x(pg, q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    int32_t mask = (int32_t)((1U << shift) - is_power_of_2);
+    svint32_t q_sign = svasr_n_s32_x(pg, q, 31);             // q_sign = q >> 31
+    q = svadd_s32_x(pg, q, svand_n_s32_x(pg, q_sign, mask));  // q = q + (q_sign & mask)
+    q = svasr_n_s32_x(pg, q, shift);                          // q >>= shift
+    return svsub_n_s32_x(pg, sveor_n_s32_x(pg, q, sign), sign);  // q = (q ^ sign) - sign
+}
+
+////////// SINT64
+
+svint64_t libdivide_s64_do_sve(svint64_t numers, const struct libdivide_s64_t *denom) {
+    svbool_t pg = svptrue_b64();
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    int64_t sign = (int8_t)more >> 7;
+    if (!denom->magic) {
+        int64_t mask = (int64_t)((1ULL << shift) - 1);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        svint64_t q =
+            svadd_s64_x(pg, numers, svand_n_s64_x(pg, svasr_n_s64_x(pg, numers, 63), mask));
+        q = svasr_n_s64_x(pg, q, shift);
+        // q = (q ^ sign) - sign;
+        return svsub_n_s64_x(pg, sveor_n_s64_x(pg, q, sign), sign);
+    } else {
+        svint64_t q = svmulh_n_s64_x(pg, numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // q += ((numer ^ sign) - sign);
+            q = svadd_s64_x(pg, q, svsub_n_s64_x(pg, sveor_n_s64_x(pg, numers, sign), sign));
+        }
+        // q >>= shift
+        q = svasr_n_s64_x(pg, q, shift);
+        // q += (q < 0)
+        svuint64_t q_neg = svlsr_n_u64_x(pg, svreinterpret_u64_s64(q), 63);
+        return svadd_s64_x(pg, q, svreinterpret_s64_u64(q_neg));
+    }
+}
+
+svint64_t libdivide_s64_branchfree_do_sve(
+    svint64_t numers, const struct libdivide_s64_branchfree_t *denom) {
+    svbool_t pg = svptrue_b64();
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    int64_t sign = (int8_t)more >> 7;
+    svint64_t q = svmulh_n_s64_x(pg, numers, magic);
+    q = svadd_s64_x(pg, q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint64_t is_power_of_2 = (magic == 0);
+    int64_t mask = (int64_t)((1ULL << shift) - is_power_of_2);
+    svint64_t q_sign = svasr_n_s64_x(pg, q, 63);             // q_sign = q >> 63
+    q = svadd_s64_x(pg, q, svand_n_s64_x(pg, q_sign, mask));  // q = q + (q_sign & mask)
+    q = svasr_n_s64_x(pg, q, shift);                          // q >>= shift
+    return svsub_n_s64_x(pg, sveor_n_s64_x(pg, q, sign), sign);  // q = (q ^ sign) - sign
+}
+
+////////// ARRAYS
+
+// Generates libdivide_##ALGO##_do_array_sve(). VEC_T is the SVE vector
+// type, SUFFIX the matching ACLE suffix (e.g. u32) and BITS the lane width.
+#define LIBDIVIDE_DO_ARRAY_SVE(ALGO, T, VEC_T, SUFFIX, BITS)                                \
+    static inline void libdivide_##ALGO##_do_array_sve(const T *numers, T *quotients,       \
+        size_t count, const struct libdivide_##ALGO##_t *denom) {                           \
+        const uint64_t lanes = svcntb() / sizeof(T);                                        \
+        for (uint64_t i = 0; i < count; i += lanes) {                                       \
+            svbool_t pg = svwhilelt_b##BITS##_u64(i, count);                                \
+            VEC_T q = libdivide_##ALGO##_do_sve(svld1_##SUFFIX(pg, numers + i), denom);     \
+            svst1_##SUFFIX(pg, quotients + i, q);                                           \
+        }                                                                                   \
+    }
+
+// Generates libdivide_##ALGO##_divmod_sve() and
+// libdivide_##ALGO##_divmod_array_sve()
+#define LIBDIVIDE_DIVMOD_ARRAY_SVE(ALGO, T, VEC_T, SUFFIX, BITS)                                    \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divmod_sve(                              \
+        VEC_T numers, VEC_T *rems, const struct libdivide_##ALGO##_divmod_t *denom) {         \
+        svbool_t pg = svptrue_b##BITS();                                                      \
+        VEC_T q = libdivide_##ALGO##_do_sve(numers, &denom->denom);                           \
+        *rems = svsub_##SUFFIX##_x(pg, numers, svmul_n_##SUFFIX##_x(pg, q, denom->d));        \
+        return q;                                                                             \
+    }                                                                                         \
+    static inline void libdivide_##ALGO##_divmod_array_sve(const T *numers, T *quotients,     \
+        T *rems, size_t count, const struct libdivide_##ALGO##_divmod_t *denom) {             \
+        const uint64_t lanes = svcntb() / sizeof(T);                                          \
+        for (uint64_t i = 0; i < count; i += lanes) {                                         \
+            svbool_t pg = svwhilelt_b##BITS##_u64(i, count);                                  \
+            VEC_T r;                                                                          \
+            VEC_T q = libdivide_##ALGO##_divmod_sve(svld1_##SUFFIX(pg, numers + i), &r, denom); \
+            svst1_##SUFFIX(pg, quotients + i, q);                                             \
+            svst1_##SUFFIX(pg, rems + i, r);                                                  \
+        }                                                                                     \
+    }
+
+LIBDIVIDE_DO_ARRAY_SVE(u16, uint16_t, svuint16_t, u16, 16)
+LIBDIVIDE_DO_ARRAY_SVE(s16, int16_t, svint16_t, s16, 16)
+LIBDIVIDE_DO_ARRAY_SVE(u16_branchfree, uint16_t, svuint16_t, u16, 16)
+LIBDIVIDE_DO_ARRAY_SVE(s16_branchfree, int16_t, svint16_t, s16, 16)
+LIBDIVIDE_DO_ARRAY_SVE(u32, uint32_t, svuint32_t, u32, 32)
+LIBDIVIDE_DO_ARRAY_SVE(s32, int32_t, svint32_t, s32, 32)
+LIBDIVIDE_DO_ARRAY_SVE(u64, uint64_t, svuint64_t, u64, 64)
+LIBDIVIDE_DO_ARRAY_SVE(s64, int64_t, svint64_t, s64, 64)
+LIBDIVIDE_DO_ARRAY_SVE(u32_branchfree, uint32_t, svuint32_t, u32, 32)
+LIBDIVIDE_DO_ARRAY_SVE(s32_branchfree, int32_t, svint32_t, s32, 32)
+LIBDIVIDE_DO_ARRAY_SVE(u64_branchfree, uint64_t, svuint64_t, u64, 64)
+LIBDIVIDE_DO_ARRAY_SVE(s64_branchfree, int64_t, svint64_t, s64, 64)
+
+LIBDIVIDE_DIVMOD_ARRAY_SVE(u32, uint32_t, svuint32_t, u32, 32)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(s32, int32_t, svint32_t, s32, 32)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(u64, uint64_t, svuint64_t, u64, 64)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(s64, int64_t, svint64_t, s64, 64)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(u32_branchfree, uint32_t, svuint32_t, u32, 32)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(s32_branchfree, int32_t, svint32_t, s32, 32)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(u64_branchfree, uint64_t, svuint64_t, u64, 64)
+LIBDIVIDE_DIVMOD_ARRAY_SVE(s64_branchfree, int64_t, svint64_t, s64, 64)
+
+// SVE versions of LIBDIVIDE_ROUNDING_SCALAR
+#define LIBDIVIDE_ROUNDING_VEC_SVE(ALGO, T, UT, VEC_T, SUFFIX, BITS)                          \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divide_floor_sve(                        \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                      \
+        svbool_t pg = svptrue_b##BITS();                                                      \
+        T dsign = (T)(denom->d < 0 ? -1 : 0);                                                 \
+        VEC_T rems;                                                                           \
+        VEC_T q = libdivide_##ALGO##_divmod_sve(numers, &rems, denom);                        \
+        VEC_T mask = svsub_n_##SUFFIX##_x(pg, sveor_n_##SUFFIX##_x(pg, rems, dsign), dsign);  \
+        return svadd_##SUFFIX##_x(pg, q, svasr_n_##SUFFIX##_x(pg, mask, BITS - 1));           \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divide_ceil_sve(                         \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                      \
+        svbool_t pg = svptrue_b##BITS();                                                      \
+        T dsign = (T)(denom->d < 0 ? -1 : 0);                                                 \
+        VEC_T rems;                                                                           \
+        VEC_T q = libdivide_##ALGO##_divmod_sve(numers, &rems, denom);                        \
+        VEC_T mask = svsubr_n_##SUFFIX##_x(pg, sveor_n_##SUFFIX##_x(pg, rems, dsign), dsign); \
+        return svsub_##SUFFIX##_x(pg, q, svasr_n_##SUFFIX##_x(pg, mask, BITS - 1));           \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_mod_floor_sve(                           \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                      \
+        svbool_t pg = svptrue_b##BITS();                                                      \
+        T dsign = (T)(denom->d < 0 ? -1 : 0);                                                 \
+        VEC_T rems;                                                                           \
+        libdivide_##ALGO##_divmod_sve(numers, &rems, denom);                                  \
+        VEC_T mask = svsub_n_##SUFFIX##_x(pg, sveor_n_##SUFFIX##_x(pg, rems, dsign), dsign);  \
+        mask = svasr_n_##SUFFIX##_x(pg, mask, BITS - 1);                                      \
+        return svadd_##SUFFIX##_x(pg, rems, svand_n_##SUFFIX##_x(pg, mask, denom->d));        \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_mod_euclid_sve(                          \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom) {                      \
+        svbool_t pg = svptrue_b##BITS();                                                      \
+        T absD = (T)(denom->d < 0 ? (UT)0 - (UT)denom->d : (UT)denom->d);                     \
+        VEC_T rems;                                                                           \
+        libdivide_##ALGO##_divmod_sve(numers, &rems, denom);                                  \
+        VEC_T mask = svasr_n_##SUFFIX##_x(pg, rems, BITS - 1);                                \
+        return svadd_##SUFFIX##_x(pg, rems, svand_n_##SUFFIX##_x(pg, mask, absD));            \
+    }
+
+LIBDIVIDE_ROUNDING_VEC_SVE(s32, int32_t, uint32_t, svint32_t, s32, 32)
+LIBDIVIDE_ROUNDING_VEC_SVE(s64, int64_t, uint64_t, svint64_t, s64, 64)
+LIBDIVIDE_ROUNDING_VEC_SVE(s32_branchfree, int32_t, uint32_t, svint32_t, s32, 32)
+LIBDIVIDE_ROUNDING_VEC_SVE(s64_branchfree, int64_t, uint64_t, svint64_t, s64, 64)
+
+////////// 52-BIT
+
+// See libdivide_u52_do()
+static LIBDIVIDE_INLINE svuint64_t libdivide_u52_do_sve(
+    svuint64_t numers, const struct libdivide_u52_t *denom) {
+    svbool_t pg = svptrue_b64();
+    svuint64_t q = svmulh_n_u64_x(pg, svlsl_n_u64_x(pg, numers, 12), denom->magic);
+    return svlsr_n_u64_x(pg, svadd_u64_x(pg, q, numers), denom->more);
+}
+
+static LIBDIVIDE_INLINE svint64_t libdivide_s52_do_sve(
+    svint64_t numers, const struct libdivide_s52_t *denom) {
+    svbool_t pg = svptrue_b64();
+    uint8_t more = denom->more;
+    svint64_t sign = svasr_n_s64_x(pg, numers, 63);
+    svuint64_t absN = svreinterpret_u64_s64(svabs_s64_x(pg, numers));
+    svuint64_t q = svmulh_n_u64_x(pg, svlsl_n_u64_x(pg, absN, 12), (uint64_t)denom->magic);
+    q = svlsr_n_u64_x(pg, svadd_u64_x(pg, q, absN), more & LIBDIVIDE_64_SHIFT_MASK);
+    sign = sveor_n_s64_x(pg, sign, (int8_t)more >> 7);
+    return svsub_s64_x(pg, sveor_s64_x(pg, svreinterpret_s64_u64(q), sign), sign);
+}
+
+LIBDIVIDE_DO_ARRAY_SVE(u52, uint64_t, svuint64_t, u64, 64)
+LIBDIVIDE_DO_ARRAY_SVE(s52, int64_t, svint64_t, s64, 64)
+
+////////// EXACT DIVISION
+
+// See libdivide_u32_exact_do()
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_exact_do_sve(
+    svuint32_t numers, const struct libdivide_u32_exact_t *denom) {
+    svbool_t pg = svptrue_b32();
+    return svmul_n_u32_x(pg, svlsr_n_u32_x(pg, numers, denom->shift), denom->inverse);
+}
+
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_exact_do_sve(
+    svint32_t numers, const struct libdivide_s32_exact_t *denom) {
+    svbool_t pg = svptrue_b32();
+    return svmul_n_s32_x(pg, svasr_n_s32_x(pg, numers, denom->shift), denom->inverse);
+}
+
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_exact_do_sve(
+    svuint64_t numers, const struct libdivide_u64_exact_t *denom) {
+    svbool_t pg = svptrue_b64();
+    return svmul_n_u64_x(pg, svlsr_n_u64_x(pg, numers, denom->shift), denom->inverse);
+}
+
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_exact_do_sve(
+    svint64_t numers, const struct libdivide_s64_exact_t *denom) {
+    svbool_t pg = svptrue_b64();
+    return svmul_n_s64_x(pg, svasr_n_s64_x(pg, numers, denom->shift), denom->inverse);
+}
+
+LIBDIVIDE_DO_ARRAY_SVE(u32_exact, uint32_t, svuint32_t, u32, 32)
+LIBDIVIDE_DO_ARRAY_SVE(s32_exact, int32_t, svint32_t, s32, 32)
+LIBDIVIDE_DO_ARRAY_SVE(u64_exact, uint64_t, svuint64_t, u64, 64)
+LIBDIVIDE_DO_ARRAY_SVE(s64_exact, int64_t, svint64_t, s64, 64)
+
+#endif
+
+#if defined(LIBDIVIDE_RVV)
+
+// The RVV kernels use LMUL = 1 vectors and divide the first vl lanes,
+// vl being set by __riscv_vsetvl_e*m1() or __riscv_vsetvlmax_e*m1().
+// RVV has native high multiplications for all lane widths.
+static LIBDIVIDE_INLINE vuint16m1_t libdivide_u16_do_rvv(
+    vuint16m1_t numers, const struct libdivide_u16_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vint16m1_t libdivide_s16_do_rvv(
+    vint16m1_t numers, const struct libdivide_s16_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vuint32m1_t libdivide_u32_do_rvv(
+    vuint32m1_t numers, const struct libdivide_u32_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vint32m1_t libdivide_s32_do_rvv(
+    vint32m1_t numers, const struct libdivide_s32_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vuint64m1_t libdivide_u64_do_rvv(
+    vuint64m1_t numers, const struct libdivide_u64_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vint64m1_t libdivide_s64_do_rvv(
+    vint64m1_t numers, const struct libdivide_s64_t *denom, size_t vl);
+
+static LIBDIVIDE_INLINE vuint16m1_t libdivide_u16_branchfree_do_rvv(
+    vuint16m1_t numers, const struct libdivide_u16_branchfree_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vint16m1_t libdivide_s16_branchfree_do_rvv(
+    vint16m1_t numers, const struct libdivide_s16_branchfree_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vuint32m1_t libdivide_u32_branchfree_do_rvv(
+    vuint32m1_t numers, const struct libdivide_u32_branchfree_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vint32m1_t libdivide_s32_branchfree_do_rvv(
+    vint32m1_t numers, const struct libdivide_s32_branchfree_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vuint64m1_t libdivide_u64_branchfree_do_rvv(
+    vuint64m1_t numers, const struct libdivide_u64_branchfree_t *denom, size_t vl);
+static LIBDIVIDE_INLINE vint64m1_t libdivide_s64_branchfree_do_rvv(
+    vint64m1_t numers, const struct libdivide_s64_branchfree_t *denom, size_t vl);
+
+////////// UINT16
+
+vuint16m1_t libdivide_u16_do_rvv(
+    vuint16m1_t numers, const struct libdivide_u16_t *denom, size_t vl) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return __riscv_vsrl_vx_u16m1(numers, more, vl);
+    } else {
+        vuint16m1_t q = __riscv_vmulhu_vx_u16m1(numers, denom->magic, vl);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint16_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+            vuint16m1_t t = __riscv_vsub_vv_u16m1(numers, q, vl);
+            t = __riscv_vadd_vv_u16m1(__riscv_vsrl_vx_u16m1(t, 1, vl), q, vl);
+            return __riscv_vsrl_vx_u16m1(t, shift, vl);
+        } else {
+            return __riscv_vsrl_vx_u16m1(q, more, vl);
+        }
+    }
+}
+
+vuint16m1_t libdivide_u16_branchfree_do_rvv(
+    vuint16m1_t numers, const struct libdivide_u16_branchfree_t *denom, size_t vl) {
+    vuint16m1_t q = __riscv_vmulhu_vx_u16m1(numers, denom->magic, vl);
+    vuint16m1_t t = __riscv_vsub_vv_u16m1(numers, q, vl);
+    t = __riscv_vadd_vv_u16m1(__riscv_vsrl_vx_u16m1(t, 1, vl), q, vl);
+    return __riscv_vsrl_vx_u16m1(t, denom->more, vl);
+}
+
+////////// SINT16
+
+vint16m1_t libdivide_s16_do_rvv(
+    vint16m1_t numers, const struct libdivide_s16_t *denom, size_t vl) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    int16_t sign = (int8_t)more >> 7;
+    if (!denom->magic) {
+        int16_t mask = (int16_t)(((uint16_t)1 << shift) - 1);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        vint16m1_t q = __riscv_vand_vx_i16m1(__riscv_vsra_vx_i16m1(numers, 15, vl), mask, vl);
+        q = __riscv_vsra_vx_i16m1(__riscv_vadd_vv_i16m1(numers, q, vl), shift, vl);
+        // q = (q ^ sign) - sign;
+        return __riscv_vsub_vx_i16m1(__riscv_vxor_vx_i16m1(q, sign, vl), sign, vl);
+    } else {
+        vint16m1_t q = __riscv_vmulh_vx_i16m1(numers, denom->magic, vl);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // q += ((numer ^ sign) - sign);
+            vint16m1_t n = __riscv_vsub_vx_i16m1(__riscv_vxor_vx_i16m1(numers, sign, vl), sign, vl);
+            q = __riscv_vadd_vv_i16m1(q, n, vl);
+        }
+        // q >>= shift
+        q = __riscv_vsra_vx_i16m1(q, shift, vl);
+        // q += (q < 0)
+        vuint16m1_t q_neg = __riscv_vsrl_vx_u16m1(__riscv_vreinterpret_v_i16m1_u16m1(q), 15, vl);
+        return __riscv_vadd_vv_i16m1(q, __riscv_vreinterpret_v_u16m1_i16m1(q_neg), vl);
+    }
+}
+
+vint16m1_t libdivide_s16_branchfree_do_rvv(
+    vint16m1_t numers, const struct libdivide_s16_branchfree_t *denom, size_t vl) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    int16_t sign = (int8_t)more >> 7;
+    vint16m1_t q = __riscv_vmulh_vx_i16m1(numers, magic, vl);
+    q = __riscv_vadd_vv_i16m1(q, numers, vl);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    int16_t mask = (int16_t)(((uint16_t)1 << shift) - is_power_of_2);
+    vint16m1_t q_sign = __riscv_vsra_vx_i16m1(q, 15, vl);  // q_sign = q >> 15
+    q = __riscv_vadd_vv_i16m1(q, __riscv_vand_vx_i16m1(q_sign, mask, vl), vl);
+    q = __riscv_vsra_vx_i16m1(q, shift, vl);  // q >>= shift
+    return __riscv_vsub_vx_i16m1(__riscv_vxor_vx_i16m1(q, sign, vl), sign, vl);  // (q ^ sign) - sign
+}
+
+////////// UINT32
+
+vuint32m1_t libdivide_u32_do_rvv(
+    vuint32m1_t numers, const struct libdivide_u32_t *denom, size_t vl) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return __riscv_vsrl_vx_u32m1(numers, more, vl);
+    } else {
+        vuint32m1_t q = __riscv_vmulhu_vx_u32m1(numers, denom->magic, vl);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            vuint32m1_t t = __riscv_vsub_vv_u32m1(numers, q, vl);
+            t = __riscv_vadd_vv_u32m1(__riscv_vsrl_vx_u32m1(t, 1, vl), q, vl);
+            return __riscv_vsrl_vx_u32m1(t, shift, vl);
+        } else {
+            return __riscv_vsrl_vx_u32m1(q, more, vl);
+        }
+    }
+}
+
+vuint32m1_t libdivide_u32_branchfree_do_rvv(
+    vuint32m1_t numers, const struct libdivide_u32_branchfree_t *denom, size_t vl) {
+    vuint32m1_t q = __riscv_vmulhu_vx_u32m1(numers, denom->magic, vl);
+    vuint32m1_t t = __riscv_vsub_vv_u32m1(numers, q, vl);
+    t = __riscv_vadd_vv_u32m1(__riscv_vsrl_vx_u32m1(t, 1, vl), q, vl);
+    return __riscv_vsrl_vx_u32m1(t, denom->more, vl);
+}
+
+////////// SINT32
+
+vint32m1_t libdivide_s32_do_rvv(
+    vint32m1_t numers, const struct libdivide_s32_t *denom, size_t vl) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    int32_t sign = (int8_t)more >> 7;
+    if (!denom->magic) {
+        int32_t mask = (int32_t)((1U << shift) - 1);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        vint32m1_t q = __riscv_vand_vx_i32m1(__riscv_vsra_vx_i32m1(numers, 31, vl), mask, vl);
+        q = __riscv_vsra_vx_i32m1(__riscv_vadd_vv_i32m1(numers, q, vl), shift, vl);
+        // q = (q ^ sign) - sign;
+        return __riscv_vsub_vx_i32m1(__riscv_vxor_vx_i32m1(q, sign, vl), sign, vl);
+    } else {
+        vint32m1_t q = __riscv_vmulh_vx_i32m1(numers, denom->magic, vl);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // q += ((numer ^ sign) - sign);
+            vint32m1_t n = __riscv_vsub_vx_i32m1(__riscv_vxor_vx_i32m1(numers, sign, vl), sign, vl);
+            q = __riscv_vadd_vv_i32m1(q, n, vl);
+        }
+        // q >>= shift
+        q = __riscv_vsra_vx_i32m1(q, shift, vl);
+        // q += (q < 0)
+        vuint32m1_t q_neg = __riscv_vsrl_vx_u32m1(__riscv_vreinterpret_v_i32m1_u32m1(q), 31, vl);
+        return __riscv_vadd_vv_i32m1(q, __riscv_vreinterpret_v_u32m1_i32m1(q_neg), vl);
+    }
+}
+
+vint32m1_t libdivide_s32_branchfree_do_rvv(
+    vint32m1_t numers, const struct libdivide_s32_branchfree_t *denom, size_t vl) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    int32_t sign = (int8_t)more >> 7;
+    vint32m1_t q = __riscv_vmulh_vx_i32m1(numers, magic, vl);
+    q = __riscv_vadd_vv_i32m1(q, numers, vl);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    int32_t mask = (int32_t)((1U << shift) - is_power_of_2);
+    vint32m1_t q_sign = __riscv_vsra_vx_i32m1(q, 31, vl);  // q_sign = q >> 31
+    q = __riscv_vadd_vv_i32m1(q, __riscv_vand_vx_i32m1(q_sign, mask, vl), vl);
+    q = __riscv_vsra_vx_i32m1(q, shift, vl);  // q >>= shift
+    return __riscv_vsub_vx_i32m1(__riscv_vxor_vx_i32m1(q, sign, vl), sign, vl);  // (q ^ sign) - sign
+}
+
+////////// UINT64
+
+vuint64m1_t libdivide_u64_do_rvv(
+    vuint64m1_t numers, const struct libdivide_u64_t *denom, size_t vl) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return __riscv_vsrl_vx_u64m1(numers, more, vl);
+    } else {
+        vuint64m1_t q = __riscv_vmulhu_vx_u64m1(numers, denom->magic, vl);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint64_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            vuint64m1_t t = __riscv_vsub_vv_u64m1(numers, q, vl);
+            t = __riscv_vadd_vv_u64m1(__riscv_vsrl_vx_u64m1(t, 1, vl), q, vl);
+            return __riscv_vsrl_vx_u64m1(t, shift, vl);
+        } else {
+            return __riscv_vsrl_vx_u64m1(q, more, vl);
+        }
+    }
+}
+
+vuint64m1_t libdivide_u64_branchfree_do_rvv(
+    vuint64m1_t numers, const struct libdivide_u64_branchfree_t *denom, size_t vl) {
+    vuint64m1_t q = __riscv_vmulhu_vx_u64m1(numers, denom->magic, vl);
+    vuint64m1_t t = __riscv_vsub_vv_u64m1(numers, q, vl);
+    t = __riscv_vadd_vv_u64m1(__riscv_vsrl_vx_u64m1(t, 1, vl), q, vl);
+    return __riscv_vsrl_vx_u64m1(t, denom->more, vl);
+}
+
+////////// SINT64
+
+vint64m1_t libdivide_s64_do_rvv(
+    vint64m1_t numers, const struct libdivide_s64_t *denom, size_t vl) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    int64_t sign = (int8_t)more >> 7;
+    if (!denom->magic) {
+        int64_t mask = (int64_t)((1ULL << shift) - 1);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        vint64m1_t q = __riscv_vand_vx_i64m1(__riscv_vsra_vx_i64m1(numers, 63, vl), mask, vl);
+        q = __riscv_vsra_vx_i64m1(__riscv_vadd_vv_i64m1(numers, q, vl), shift, vl);
+        // q = (q ^ sign) - sign;
+        return __riscv_vsub_vx_i64m1(__riscv_vxor_vx_i64m1(q, sign, vl), sign, vl);
+    } else {
+        vint64m1_t q = __riscv_vmulh_vx_i64m1(numers, denom->magic, vl);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // q += ((numer ^ sign) - sign);
+            vint64m1_t n = __riscv_vsub_vx_i64m1(__riscv_vxor_vx_i64m1(numers, sign, vl), sign, vl);
+            q = __riscv_vadd_vv_i64m1(q, n, vl);
+        }
+        // q >>= shift
+        q = __riscv_vsra_vx_i64m1(q, shift, vl);
+        // q += (q < 0)
+        vuint64m1_t q_neg = __riscv_vsrl_vx_u64m1(__riscv_vreinterpret_v_i64m1_u64m1(q), 63, vl);
+        return __riscv_vadd_vv_i64m1(q, __riscv_vreinterpret_v_u64m1_i64m1(q_neg), vl);
+    }
+}
+
+vint64m1_t libdivide_s64_branchfree_do_rvv(
+    vint64m1_t numers, const struct libdivide_s64_branchfree_t *denom, size_t vl) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    int64_t sign = (int8_t)more >> 7;
+    vint64m1_t q = __riscv_vmulh_vx_i64m1(numers, magic, vl);
+    q = __riscv_vadd_vv_i64m1(q, numers, vl);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint64_t is_power_of_2 = (magic == 0);
+    int64_t mask = (int64_t)((1ULL << shift) - is_power_of_2);
+    vint64m1_t q_sign = __riscv_vsra_vx_i64m1(q, 63, vl);  // q_sign = q >> 63
+    q = __riscv_vadd_vv_i64m1(q, __riscv_vand_vx_i64m1(q_sign, mask, vl), vl);
+    q = __riscv_vsra_vx_i64m1(q, shift, vl);  // q >>= shift
+    return __riscv_vsub_vx_i64m1(__riscv_vxor_vx_i64m1(q, sign, vl), sign, vl);  // (q ^ sign) - sign
+}
+
+////////// ARRAYS
+
+// Generates libdivide_##ALGO##_do_array_rvv(), each iteration divides
+// vl = min(count - i, VLMAX) elements hence there is no scalar tail.
+// SUFFIX is the RVV type suffix (e.g. u32m1) and BITS the lane width.
+#define LIBDIVIDE_DO_ARRAY_RVV(ALGO, T, VEC_T, SUFFIX, BITS)                          \
+    static inline void libdivide_##ALGO##_do_array_rvv(const T *numers, T *quotients, \
+        size_t count, const struct libdivide_##ALGO##_t *denom) {                     \
+        size_t vl;                                                                    \
+        for (size_t i = 0; i < count; i += vl) {                                      \
+            vl = __riscv_vsetvl_e##BITS##m1(count - i);                               \
+            VEC_T n = __riscv_vle##BITS##_v_##SUFFIX(numers + i, vl);                 \
+            VEC_T q = libdivide_##ALGO##_do_rvv(n, denom, vl);                        \
+            __riscv_vse##BITS##_v_##SUFFIX(quotients + i, q, vl);                     \
+        }                                                                             \
+    }
+
+// Generates libdivide_##ALGO##_divmod_rvv() and
+// libdivide_##ALGO##_divmod_array_rvv()
+#define LIBDIVIDE_DIVMOD_ARRAY_RVV(ALGO, T, VEC_T, SUFFIX, BITS)                              \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divmod_rvv(VEC_T numers, VEC_T *rems,    \
+        const struct libdivide_##ALGO##_divmod_t *denom, size_t vl) {                         \
+        VEC_T q = libdivide_##ALGO##_do_rvv(numers, &denom->denom, vl);                       \
+        *rems = __riscv_vsub_vv_##SUFFIX(numers, __riscv_vmul_vx_##SUFFIX(q, denom->d, vl), vl); \
+        return q;                                                                             \
+    }                                                                                         \
+    static inline void libdivide_##ALGO##_divmod_array_rvv(const T *numers, T *quotients,     \
+        T *rems, size_t count, const struct libdivide_##ALGO##_divmod_t *denom) {             \
+        size_t vl;                                                                            \
+        for (size_t i = 0; i < count; i += vl) {                                              \
+            vl = __riscv_vsetvl_e##BITS##m1(count - i);                                       \
+            VEC_T r;                                                                          \
+            VEC_T n = __riscv_vle##BITS##_v_##SUFFIX(numers + i, vl);                         \
+            VEC_T q = libdivide_##ALGO##_divmod_rvv(n, &r, denom, vl);                        \
+            __riscv_vse##BITS##_v_##SUFFIX(quotients + i, q, vl);                             \
+            __riscv_vse##BITS##_v_##SUFFIX(rems + i, r, vl);                                  \
+        }                                                                                     \
+    }
+
+LIBDIVIDE_DO_ARRAY_RVV(u16, uint16_t, vuint16m1_t, u16m1, 16)
+LIBDIVIDE_DO_ARRAY_RVV(s16, int16_t, vint16m1_t, i16m1, 16)
+LIBDIVIDE_DO_ARRAY_RVV(u16_branchfree, uint16_t, vuint16m1_t, u16m1, 16)
+LIBDIVIDE_DO_ARRAY_RVV(s16_branchfree, int16_t, vint16m1_t, i16m1, 16)
+LIBDIVIDE_DO_ARRAY_RVV(u32, uint32_t, vuint32m1_t, u32m1, 32)
+LIBDIVIDE_DO_ARRAY_RVV(s32, int32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_DO_ARRAY_RVV(u64, uint64_t, vuint64m1_t, u64m1, 64)
+LIBDIVIDE_DO_ARRAY_RVV(s64, int64_t, vint64m1_t, i64m1, 64)
+LIBDIVIDE_DO_ARRAY_RVV(u32_branchfree, uint32_t, vuint32m1_t, u32m1, 32)
+LIBDIVIDE_DO_ARRAY_RVV(s32_branchfree, int32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_DO_ARRAY_RVV(u64_branchfree, uint64_t, vuint64m1_t, u64m1, 64)
+LIBDIVIDE_DO_ARRAY_RVV(s64_branchfree, int64_t, vint64m1_t, i64m1, 64)
+
+LIBDIVIDE_DIVMOD_ARRAY_RVV(u32, uint32_t, vuint32m1_t, u32m1, 32)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(s32, int32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(u64, uint64_t, vuint64m1_t, u64m1, 64)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(s64, int64_t, vint64m1_t, i64m1, 64)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(u32_branchfree, uint32_t, vuint32m1_t, u32m1, 32)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(s32_branchfree, int32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(u64_branchfree, uint64_t, vuint64m1_t, u64m1, 64)
+LIBDIVIDE_DIVMOD_ARRAY_RVV(s64_branchfree, int64_t, vint64m1_t, i64m1, 64)
+
+// RVV versions of LIBDIVIDE_ROUNDING_SCALAR
+#define LIBDIVIDE_ROUNDING_VEC_RVV(ALGO, T, UT, VEC_T, SUFFIX, BITS)                             \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divide_floor_rvv(                           \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom, size_t vl) {              \
+        T dsign = (T)(denom->d < 0 ? -1 : 0);                                                    \
+        VEC_T rems;                                                                              \
+        VEC_T q = libdivide_##ALGO##_divmod_rvv(numers, &rems, denom, vl);                       \
+        VEC_T mask = __riscv_vxor_vx_##SUFFIX(rems, dsign, vl);                                  \
+        mask = __riscv_vsub_vx_##SUFFIX(mask, dsign, vl);                                        \
+        return __riscv_vadd_vv_##SUFFIX(q, __riscv_vsra_vx_##SUFFIX(mask, BITS - 1, vl), vl);    \
+    }                                                                                            \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_divide_ceil_rvv(                            \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom, size_t vl) {              \
+        T dsign = (T)(denom->d < 0 ? -1 : 0);                                                    \
+        VEC_T rems;                                                                              \
+        VEC_T q = libdivide_##ALGO##_divmod_rvv(numers, &rems, denom, vl);                       \
+        VEC_T mask = __riscv_vxor_vx_##SUFFIX(rems, dsign, vl);                                  \
+        mask = __riscv_vrsub_vx_##SUFFIX(mask, dsign, vl);                                       \
+        return __riscv_vsub_vv_##SUFFIX(q, __riscv_vsra_vx_##SUFFIX(mask, BITS - 1, vl), vl);    \
+    }                                                                                            \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_mod_floor_rvv(                              \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom, size_t vl) {              \
+        T dsign = (T)(denom->d < 0 ? -1 : 0);                                                    \
+        VEC_T rems;                                                                              \
+        libdivide_##ALGO##_divmod_rvv(numers, &rems, denom, vl);                                 \
+        VEC_T mask = __riscv_vxor_vx_##SUFFIX(rems, dsign, vl);                                  \
+        mask = __riscv_vsub_vx_##SUFFIX(mask, dsign, vl);                                        \
+        mask = __riscv_vsra_vx_##SUFFIX(mask, BITS - 1, vl);                                     \
+        return __riscv_vadd_vv_##SUFFIX(rems, __riscv_vand_vx_##SUFFIX(mask, denom->d, vl), vl); \
+    }                                                                                            \
+    static LIBDIVIDE_INLINE VEC_T libdivide_##ALGO##_mod_euclid_rvv(                             \
+        VEC_T numers, const struct libdivide_##ALGO##_divmod_t *denom, size_t vl) {              \
+        T absD = (T)(denom->d < 0 ? (UT)0 - (UT)denom->d : (UT)denom->d);                        \
+        VEC_T rems;                                                                              \
+        libdivide_##ALGO##_divmod_rvv(numers, &rems, denom, vl);                                 \
+        VEC_T mask = __riscv_vsra_vx_##SUFFIX(rems, BITS - 1, vl);                               \
+        return __riscv_vadd_vv_##SUFFIX(rems, __riscv_vand_vx_##SUFFIX(mask, absD, vl), vl);     \
+    }
+
+LIBDIVIDE_ROUNDING_VEC_RVV(s32, int32_t, uint32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_ROUNDING_VEC_RVV(s64, int64_t, uint64_t, vint64m1_t, i64m1, 64)
+LIBDIVIDE_ROUNDING_VEC_RVV(s32_branchfree, int32_t, uint32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_ROUNDING_VEC_RVV(s64_branchfree, int64_t, uint64_t, vint64m1_t, i64m1, 64)
+
+////////// EXACT DIVISION
+
+// See libdivide_u32_exact_do()
+static LIBDIVIDE_INLINE vuint32m1_t libdivide_u32_exact_do_rvv(
+    vuint32m1_t numers, const struct libdivide_u32_exact_t *denom, size_t vl) {
+    vuint32m1_t q = __riscv_vsrl_vx_u32m1(numers, denom->shift, vl);
+    return __riscv_vmul_vx_u32m1(q, denom->inverse, vl);
+}
+
+static LIBDIVIDE_INLINE vint32m1_t libdivide_s32_exact_do_rvv(
+    vint32m1_t numers, const struct libdivide_s32_exact_t *denom, size_t vl) {
+    vint32m1_t q = __riscv_vsra_vx_i32m1(numers, denom->shift, vl);
+    return __riscv_vmul_vx_i32m1(q, denom->inverse, vl);
+}
+
+static LIBDIVIDE_INLINE vuint64m1_t libdivide_u64_exact_do_rvv(
+    vuint64m1_t numers, const struct libdivide_u64_exact_t *denom, size_t vl) {
+    vuint64m1_t q = __riscv_vsrl_vx_u64m1(numers, denom->shift, vl);
+    return __riscv_vmul_vx_u64m1(q, denom->inverse, vl);
+}
+
+static LIBDIVIDE_INLINE vint64m1_t libdivide_s64_exact_do_rvv(
+    vint64m1_t numers, const struct libdivide_s64_exact_t *denom, size_t vl) {
+    vint64m1_t q = __riscv_vsra_vx_i64m1(numers, denom->shift, vl);
+    return __riscv_vmul_vx_i64m1(q, denom->inverse, vl);
+}
+
+LIBDIVIDE_DO_ARRAY_RVV(u32_exact, uint32_t, vuint32m1_t, u32m1, 32)
+LIBDIVIDE_DO_ARRAY_RVV(s32_exact, int32_t, vint32m1_t, i32m1, 32)
+LIBDIVIDE_DO_ARRAY_RVV(u64_exact, uint64_t, vuint64m1_t, u64m1, 64)
+LIBDIVIDE_DO_ARRAY_RVV(s64_exact, int64_t, vint64m1_t, i64m1, 64)
+
+#endif
+
+#if defined(LIBDIVIDE_AVX512_KERNELS)
+
+LIBDIVIDE_AVX512_BEGIN
+
+static LIBDIVIDE_INLINE __m512i libdivide_u16_do_vec512(
+    __m512i numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s16_do_vec512(
+    __m512i numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u32_do_vec512(
+    __m512i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_do_vec512(
+    __m512i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u64_do_vec512(
+    __m512i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_do_vec512(
+    __m512i numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE __m512i libdivide_u16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s64_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE __m512i libdivide_u32_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores);
+static LIBDIVIDE_INLINE __m512i libdivide_u64_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores);
+
+static LIBDIVIDE_INLINE void libdivide_gather_packed_vec512(
+    const void *table, __m512i indices, __m512i *magics, __m512i *mores);
+
+static LIBDIVIDE_INLINE __m512i libdivide_u32_do_masked_vec512(
+    __m512i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_do_masked_vec512(
+    __m512i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u64_do_masked_vec512(
+    __m512i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_do_masked_vec512(
+    __m512i numers, const struct libdivide_s64_t *denom);
+
+//////// Internal Utility Functions
+
+static LIBDIVIDE_INLINE __m512i libdivide_s32_signbits_vec512(__m512i v) {
+    return _mm512_srai_epi32(v, 31);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s64_signbits_vec512(__m512i v) {
+    ;
+    return _mm512_srai_epi64(v, 63);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s64_shift_right_vec512(__m512i v, int amt) {
+    return _mm512_srai_epi64(v, amt);
+}
+
+// Here, b is assumed to contain one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u32_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+    __m512i a1X3X = _mm512_srli_epi64(a, 32);
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epu32(a1X3X, b), mask);
+    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// b is one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s32_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
+    __m512i a1X3X = _mm512_srli_epi64(a, 32);
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epi32(a1X3X, b), mask);
+    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// Here, y is assumed to contain one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u64_vec512(__m512i x, __m512i y) {
+    // see m128i variant for comments.
+    __m512i x0y0 = _mm512_mul_epu32(x, y);
+    __m512i x0y0_hi = _mm512_srli_epi64(x0y0, 32);
+
+    __m512i x1 = _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
+    __m512i y1 = _mm512_shuffle_epi32(y, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
+
+    __m512i x0y1 = _mm512_mul_epu32(x, y1);
+    __m512i x1y0 = _mm512_mul_epu32(x1, y);
+    __m512i x1y1 = _mm512_mul_epu32(x1, y1);
+
+    __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
+    __m512i temp = _mm512_add_epi64(x1y0, x0y0_hi);
+    __m512i temp_lo = _mm512_and_si512(temp, mask);
+    __m512i temp_hi = _mm512_srli_epi64(temp, 32);
+
+    temp_lo = _mm512_srli_epi64(_mm512_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm512_add_epi64(x1y1, temp_hi);
+    return _mm512_add_epi64(temp_lo, temp_hi);
+}
+
+// y is one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s64_vec512(__m512i x, __m512i y) {
+    __m512i p = libdivide_mullhi_u64_vec512(x, y);
+    __m512i t1 = _mm512_and_si512(libdivide_s64_signbits_vec512(x), y);
+    __m512i t2 = _mm512_and_si512(libdivide_s64_signbits_vec512(y), x);
+    p = _mm512_sub_epi64(p, t1);
+    p = _mm512_sub_epi64(p, t2);
+    return p;
+}
+
+// Low 64 bits of the lane-wise 64-bit product
+static LIBDIVIDE_INLINE __m512i libdivide_mullo_u64_vec512(__m512i x, __m512i y) {
+#if defined(__AVX512DQ__)
+    return _mm512_mullo_epi64(x, y);
+#else
+    __m512i x1 = _mm512_srli_epi64(x, 32);
+    __m512i y1 = _mm512_srli_epi64(y, 32);
+    __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(x1, y), _mm512_mul_epu32(x, y1));
+    return _mm512_add_epi64(_mm512_mul_epu32(x, y), _mm512_slli_epi64(cross, 32));
+#endif
+}
+
+// 16-bit lanes require AVX512BW, the fallback below splits
+// the vector into two 256-bit halves instead.
+#if defined(__AVX512BW__)
+
+////////// UINT16
+
+__m512i libdivide_u16_do_vec512(__m512i numers, const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm512_srli_epi16(numers, more);
+    } else {
+        __m512i q = _mm512_mulhi_epu16(numers, _mm512_set1_epi16((short)denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint16_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+            __m512i t = _mm512_add_epi16(_mm512_srli_epi16(_mm512_sub_epi16(numers, q), 1), q);
+            return _mm512_srli_epi16(t, shift);
+        } else {
+            return _mm512_srli_epi16(q, more);
+        }
+    }
+}
+
+__m512i libdivide_u16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u16_branchfree_t *denom) {
+    __m512i q = _mm512_mulhi_epu16(numers, _mm512_set1_epi16((short)denom->magic));
+    __m512i t = _mm512_add_epi16(_mm512_srli_epi16(_mm512_sub_epi16(numers, q), 1), q);
+    return _mm512_srli_epi16(t, denom->more);
+}
+
+////////// SINT16
+
+__m512i libdivide_s16_do_vec512(__m512i numers, const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        __m512i roundToZeroTweak = _mm512_set1_epi16((short)mask);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        __m512i q = _mm512_add_epi16(
+            numers, _mm512_and_si512(_mm512_srai_epi16(numers, 15), roundToZeroTweak));
+        q = _mm512_srai_epi16(q, shift);
+        __m512i sign = _mm512_set1_epi16((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm512_sub_epi16(_mm512_xor_si512(q, sign), sign);
+        return q;
+    } else {
+        __m512i q = _mm512_mulhi_epi16(numers, _mm512_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m512i sign = _mm512_set1_epi16((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm512_add_epi16(q, _mm512_sub_epi16(_mm512_xor_si512(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm512_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
+        q = _mm512_add_epi16(q, _mm512_srli_epi16(q, 15));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m512i libdivide_s16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s16_branchfree_t *denom) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    __m512i sign = _mm512_set1_epi16((int8_t)more >> 7);
+    __m512i q = _mm512_mulhi_epi16(numers, _mm512_set1_epi16(magic));
+    q = _mm512_add_epi16(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    __m512i q_sign = _mm512_srai_epi16(q, 15);  // q_sign = q >> 15
+    __m512i mask = _mm512_set1_epi16((short)(((uint16_t)1 << shift) - is_power_of_2));
+    q = _mm512_add_epi16(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm512_srai_epi16(q, shift);                  // q >>= shift
+    q = _mm512_sub_epi16(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+#endif
+
+////////// UINT32
+
+__m512i libdivide_u32_do_vec512(__m512i numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm512_srli_epi32(numers, more);
+    } else {
+        __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
+            return _mm512_srli_epi32(t, shift);
+        } else {
+            return _mm512_srli_epi32(q, more);
+        }
+    }
+}
+
+__m512i libdivide_u32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u32_branchfree_t *denom) {
+    __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
+    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
+    return _mm512_srli_epi32(t, denom->more);
+}
+
+////////// UINT64
+
+__m512i libdivide_u64_do_vec512(__m512i numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm512_srli_epi64(numers, more);
+    } else {
+        __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+            return _mm512_srli_epi64(t, shift);
+        } else {
+            return _mm512_srli_epi64(q, more);
+        }
+    }
+}
+
+__m512i libdivide_u64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u64_branchfree_t *denom) {
+    __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
+    __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+    return _mm512_srli_epi64(t, denom->more);
+}
+
+////////// SINT32
+
+__m512i libdivide_s32_do_vec512(__m512i numers, const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t mask = (1U << shift) - 1;
+        __m512i roundToZeroTweak = _mm512_set1_epi32(mask);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        __m512i q = _mm512_add_epi32(
+            numers, _mm512_and_si512(_mm512_srai_epi32(numers, 31), roundToZeroTweak));
+        q = _mm512_srai_epi32(q, shift);
+        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);
+        return q;
+    } else {
+        __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm512_add_epi32(q, _mm512_sub_epi32(_mm512_xor_si512(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm512_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = _mm512_add_epi32(q, _mm512_srli_epi32(q, 31));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m512i libdivide_s32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s32_branchfree_t *denom) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+    __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(magic));
+    q = _mm512_add_epi32(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    __m512i q_sign = _mm512_srai_epi32(q, 31);  // q_sign = q >> 31
+    __m512i mask = _mm512_set1_epi32((1U << shift) - is_power_of_2);
+    q = _mm512_add_epi32(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm512_srai_epi32(q, shift);                          // q >>= shift
+    q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT64
+
+__m512i libdivide_s64_do_vec512(__m512i numers, const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    int64_t magic = denom->magic;
+    if (magic == 0) {  // shift path
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t mask = (1ULL << shift) - 1;
+        __m512i roundToZeroTweak = _mm512_set1_epi64(mask);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        __m512i q = _mm512_add_epi64(
+            numers, _mm512_and_si512(libdivide_s64_signbits_vec512(numers), roundToZeroTweak));
+        q = libdivide_s64_shift_right_vec512(q, shift);
+        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);
+        return q;
+    } else {
+        __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm512_add_epi64(q, _mm512_sub_epi64(_mm512_xor_si512(numers, sign), sign));
+        }
+        // q >>= denom->mult_path.shift
+        q = libdivide_s64_shift_right_vec512(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = _mm512_add_epi64(q, _mm512_srli_epi64(q, 63));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m512i libdivide_s64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s64_branchfree_t *denom) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+
+    // libdivide_mullhi_s64(numers, magic);
+    __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
+    q = _mm512_add_epi64(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint32_t is_power_of_2 = (magic == 0);
+    __m512i q_sign = libdivide_s64_signbits_vec512(q);  // q_sign = q >> 63
+    __m512i mask = _mm512_set1_epi64((1ULL << shift) - is_power_of_2);
+    q = _mm512_add_epi64(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_shift_right_vec512(q, shift);           // q >>= shift
+    q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u16, uint16_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s16, int16_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(u16_branchfree, uint16_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s16_branchfree, int16_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(u32, uint32_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s32, int32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(u64, uint64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s64, int64_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(u32_branchfree, uint32_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s32_branchfree, int32_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(u64_branchfree, uint64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s64_branchfree, int64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+
+LIBDIVIDE_DIVMOD_VEC(u32, uint32_t, vec512, __m512i,
+    _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(s32, int32_t, vec512, __m512i,
+    _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(u64, uint64_t, vec512, __m512i,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(s64, int64_t, vec512, __m512i,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(u32_branchfree, uint32_t, vec512, __m512i,
+    _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(s32_branchfree, int32_t, vec512, __m512i,
+    _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(u64_branchfree, uint64_t, vec512, __m512i,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DIVMOD_VEC(s64_branchfree, int64_t, vec512, __m512i,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512)
+
+LIBDIVIDE_ROUNDING_VEC(s32, int32_t, uint32_t, vec512, __m512i,
+    _mm512_set1_epi32, _mm512_add_epi32, _mm512_sub_epi32, _mm512_and_si512, _mm512_xor_si512,
+    libdivide_s32_signbits_vec512)
+LIBDIVIDE_ROUNDING_VEC(s64, int64_t, uint64_t, vec512, __m512i,
+    _mm512_set1_epi64, _mm512_add_epi64, _mm512_sub_epi64, _mm512_and_si512, _mm512_xor_si512,
+    libdivide_s64_signbits_vec512)
+LIBDIVIDE_ROUNDING_VEC(s32_branchfree, int32_t, uint32_t, vec512, __m512i,
+    _mm512_set1_epi32, _mm512_add_epi32, _mm512_sub_epi32, _mm512_and_si512, _mm512_xor_si512,
+    libdivide_s32_signbits_vec512)
+LIBDIVIDE_ROUNDING_VEC(s64_branchfree, int64_t, uint64_t, vec512, __m512i,
+    _mm512_set1_epi64, _mm512_add_epi64, _mm512_sub_epi64, _mm512_and_si512, _mm512_xor_si512,
+    libdivide_s64_signbits_vec512)
+
+////////// DIVISIBILITY
+
+// Returns a mask with the bits of the divisible lanes set
+static LIBDIVIDE_INLINE __mmask16 libdivide_u32_is_divisible_vec512(
+    __m512i numers, const struct libdivide_u32_divisibility_t *denom) {
+    __m512i x = _mm512_mullo_epi32(numers, _mm512_set1_epi32(denom->inverse));
+    x = _mm512_rorv_epi32(x, _mm512_set1_epi32(denom->shift));
+    return _mm512_cmple_epu32_mask(x, _mm512_set1_epi32(denom->threshold));
+}
+
+static LIBDIVIDE_INLINE __mmask8 libdivide_u64_is_divisible_vec512(
+    __m512i numers, const struct libdivide_u64_divisibility_t *denom) {
+    __m512i x = libdivide_mullo_u64_vec512(numers, _mm512_set1_epi64(denom->inverse));
+    x = _mm512_rorv_epi64(x, _mm512_set1_epi64(denom->shift));
+    return _mm512_cmple_epu64_mask(x, _mm512_set1_epi64(denom->threshold));
+}
+
+////////// EXACT DIVISION
+
+// See libdivide_u32_exact_do()
+static LIBDIVIDE_INLINE __m512i libdivide_u32_exact_do_vec512(
+    __m512i numers, const struct libdivide_u32_exact_t *denom) {
+    __m512i q = _mm512_srli_epi32(numers, denom->shift);
+    return _mm512_mullo_epi32(q, _mm512_set1_epi32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s32_exact_do_vec512(
+    __m512i numers, const struct libdivide_s32_exact_t *denom) {
+    __m512i q = _mm512_srai_epi32(numers, denom->shift);
+    return _mm512_mullo_epi32(q, _mm512_set1_epi32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u64_exact_do_vec512(
+    __m512i numers, const struct libdivide_u64_exact_t *denom) {
+    __m512i q = _mm512_srli_epi64(numers, denom->shift);
+    return libdivide_mullo_u64_vec512(q, _mm512_set1_epi64(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s64_exact_do_vec512(
+    __m512i numers, const struct libdivide_s64_exact_t *denom) {
+    __m512i q = _mm512_srai_epi64(numers, denom->shift);
+    return libdivide_mullo_u64_vec512(q, _mm512_set1_epi64(denom->inverse));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_exact, uint32_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s32_exact, int32_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(u64_exact, uint64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s64_exact, int64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+
+////////// FASTMOD
+
+// Computes the remainders of the even 32-bit lanes, which are
+// returned in the low halves of the 64-bit lanes.
+// See libdivide_u32_mod_do().
+static LIBDIVIDE_INLINE __m512i libdivide_u32_mod_half_vec512(
+    __m512i numers, __m512i m_lo, __m512i m_hi, __m512i d) {
+    __m512i lowbits = _mm512_add_epi64(
+        _mm512_mul_epu32(numers, m_lo), _mm512_slli_epi64(_mm512_mul_epu32(numers, m_hi), 32));
+    __m512i lo = _mm512_srli_epi64(_mm512_mul_epu32(lowbits, d), 32);
+    __m512i hi = _mm512_mul_epu32(_mm512_srli_epi64(lowbits, 32), d);
+    return _mm512_srli_epi64(_mm512_add_epi64(hi, lo), 32);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u32_mod_do_vec512(
+    __m512i numers, const struct libdivide_u32_mod_t *denom) {
+    __m512i m_lo = _mm512_set1_epi32((uint32_t)denom->M);
+    __m512i m_hi = _mm512_set1_epi32((uint32_t)(denom->M >> 32));
+    __m512i d = _mm512_set1_epi32(denom->d);
+    __m512i even = libdivide_u32_mod_half_vec512(numers, m_lo, m_hi, d);
+    __m512i odd = libdivide_u32_mod_half_vec512(_mm512_srli_epi64(numers, 32), m_lo, m_hi, d);
+    return _mm512_or_si512(even, _mm512_slli_epi64(odd, 32));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_mod, uint32_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+
+////////// 52-BIT
+
+// See libdivide_u52_do(). With AVX512 IFMA the numerator is added
+// to the 52-bit high product by the multiply instruction itself.
+static LIBDIVIDE_INLINE __m512i libdivide_u52_do_vec512(
+    __m512i numers, const struct libdivide_u52_t *denom) {
+    __m512i magic = _mm512_set1_epi64(denom->magic);
+#if defined(__AVX512IFMA__)
+    __m512i q = _mm512_madd52hi_epu64(numers, numers, magic);
+#else
+    __m512i q = libdivide_mullhi_u64_vec512(_mm512_slli_epi64(numers, 12), magic);
+    q = _mm512_add_epi64(q, numers);
+#endif
+    return _mm512_srli_epi64(q, denom->more);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s52_do_vec512(
+    __m512i numers, const struct libdivide_s52_t *denom) {
+    uint8_t more = denom->more;
+    __m512i magic = _mm512_set1_epi64(denom->magic);
+    __m512i sign = _mm512_srai_epi64(numers, 63);
+    __m512i absN = _mm512_abs_epi64(numers);
+#if defined(__AVX512IFMA__)
+    __m512i q = _mm512_madd52hi_epu64(absN, absN, magic);
+#else
+    __m512i q = libdivide_mullhi_u64_vec512(_mm512_slli_epi64(absN, 12), magic);
+    q = _mm512_add_epi64(q, absN);
+#endif
+    q = _mm512_srli_epi64(q, more & LIBDIVIDE_64_SHIFT_MASK);
+    sign = _mm512_xor_si512(sign, _mm512_set1_epi32((int8_t)more >> 7));
+    return _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u52, uint64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_VEC(s52, int64_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+
+////////// NARROW 64-BIT
+
+// See libdivide_u64_narrow_do()
+static LIBDIVIDE_INLINE __m512i libdivide_u64_narrow_do_vec512(
+    __m512i numers, const struct libdivide_u64_narrow_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm512_srli_epi64(numers, more);
+    }
+    __m512i q = _mm512_mul_epu32(numers, _mm512_set1_epi32(denom->magic));
+    q = _mm512_srli_epi64(q, 32);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+        return _mm512_srli_epi64(t, more & LIBDIVIDE_32_SHIFT_MASK);
+    }
+    return _mm512_srli_epi64(q, more);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u64_narrow, uint64_t, vec512, __m512i,
+    LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+
+////////// GEN
+
+// Generates the dividers of 8 divisors, see libdivide_internal_u32_gen().
+// Returns 0 without storing anything if one of the divisors is invalid
+// (0, or 1 for branchfree), the caller then uses the scalar gen function,
+// which reports the error.
+static LIBDIVIDE_INLINE int libdivide_internal_u32_gen_vec512(
+    const uint32_t *divisors, uint32_t *magics, uint8_t *mores, int branchfree) {
+    __m256i d32 = _mm256_loadu_si256((const __m256i *)divisors);
+    __m512i d = _mm512_cvtepu32_epi64(d32);
+    __m512i one = _mm512_set1_epi64(1);
+    __mmask8 invalid = _mm512_cmpeq_epi64_mask(d, _mm512_setzero_si512());
+    if (branchfree) invalid |= _mm512_cmpeq_epi64_mask(d, one);
+    if (invalid) return 0;
+
+    // d is exact as a double, its exponent is floor_log_2_d
+    __m512d dd = _mm512_cvtepu32_pd(d32);
+    __m512i floor_log_2_d =
+        _mm512_sub_epi64(_mm512_srli_epi64(_mm512_castpd_si512(dd), 52), _mm512_set1_epi64(1023));
+    __m512i pow = _mm512_sllv_epi64(one, floor_log_2_d);
+    __mmask8 power_of_2 = _mm512_cmpeq_epi64_mask(d, pow);
+
+    // n = 2^(32 + floor_log_2_d), built as a double from its exponent.
+    // The quotient is < 2^32, so the rounded double division is off by
+    // at most one, which the remainder corrects.
+    __m512i n_exp = _mm512_add_epi64(floor_log_2_d, _mm512_set1_epi64(32));
+    __m512d nd = _mm512_castsi512_pd(
+        _mm512_slli_epi64(_mm512_add_epi64(n_exp, _mm512_set1_epi64(1023)), 52));
+    __m512i q = _mm512_cvtepu32_epi64(_mm512_cvttpd_epu32(_mm512_div_pd(nd, dd)));
+    __m512i rem = _mm512_sub_epi64(_mm512_sllv_epi64(one, n_exp), _mm512_mul_epu32(q, d));
+    __mmask8 too_big = _mm512_cmplt_epi64_mask(rem, _mm512_setzero_si512());
+    q = _mm512_mask_sub_epi64(q, too_big, q, one);
+    rem = _mm512_mask_add_epi64(rem, too_big, rem, d);
+    __mmask8 too_small = _mm512_cmpge_epi64_mask(rem, d);
+    q = _mm512_mask_add_epi64(q, too_small, q, one);
+    rem = _mm512_mask_sub_epi64(rem, too_small, rem, d);
+
+    // The smaller power works if e = d - rem < 2^floor_log_2_d,
+    // otherwise we use the 33-bit magic number 2 * q + (2 * rem >= d)
+    __mmask8 add = 0xFF;
+    if (!branchfree) add = ~_mm512_cmplt_epi64_mask(_mm512_sub_epi64(d, rem), pow);
+    __m512i twice_q = _mm512_add_epi64(q, q);
+    __mmask8 round_up = _mm512_cmpge_epi64_mask(_mm512_add_epi64(rem, rem), d);
+    twice_q = _mm512_mask_add_epi64(twice_q, round_up, twice_q, one);
+    q = _mm512_mask_mov_epi64(q, add, twice_q);
+    __m512i magic = _mm512_maskz_add_epi64((__mmask8)~power_of_2, q, one);
+
+    __m512i more = floor_log_2_d;
+    if (branchfree) {
+        // Branchfree powers of 2 shift by one less, see libdivide_internal_u32_gen()
+        more = _mm512_mask_sub_epi64(more, power_of_2, more, one);
+    } else {
+        more = _mm512_mask_or_epi64(more, (__mmask8)(add & ~power_of_2), more,
+            _mm512_set1_epi64(LIBDIVIDE_ADD_MARKER));
+    }
+    _mm256_storeu_si256((__m256i *)magics, _mm512_cvtepi64_epi32(magic));
+    _mm_storel_epi64((__m128i *)mores, _mm512_cvtepi64_epi8(more));
+    return 1;
+}
+
+static inline void libdivide_internal_u32_gen_array_vec512(
+    const uint32_t *divisors, struct libdivide_u32_t *dividers, size_t count, int branchfree) {
+    size_t i = 0;
+    uint32_t magics[8];
+    uint8_t mores[16];
+    for (; i + 8 <= count &&
+           libdivide_internal_u32_gen_vec512(divisors + i, magics, mores, branchfree);
+         i += 8) {
+        for (size_t j = 0; j < 8; j++) {
+            struct libdivide_u32_t denom = {magics[j], mores[j]};
+            dividers[i + j] = denom;
+            // Counted like the gen functions: branchfree dividers use the
+            // path of the branchfull algorithm, i.e. the add indicator
+            if (branchfree && denom.magic) denom.more |= LIBDIVIDE_ADD_MARKER;
+            LIBDIVIDE_GEN_HOOK(branchfree ? LIBDIVIDE_TABLE_U32_BRANCHFREE : LIBDIVIDE_TABLE_U32,
+                libdivide_u32_algorithm(&denom));
+        }
+    }
+    // Remaining divisors, starting with the invalid ones if any
+    for (; i < count; i++) {
+        if (branchfree) {
+            struct libdivide_u32_branchfree_t tmp = libdivide_u32_branchfree_gen(divisors[i]);
+            dividers[i].magic = tmp.magic;
+            dividers[i].more = tmp.more;
+        } else {
+            dividers[i] = libdivide_u32_gen(divisors[i]);
+        }
+    }
+}
+
+static inline void libdivide_u32_gen_array_vec512(
+    const uint32_t *divisors, struct libdivide_u32_t *dividers, size_t count) {
+    libdivide_internal_u32_gen_array_vec512(divisors, dividers, count, 0);
+}
+
+static inline void libdivide_u32_branchfree_gen_array_vec512(
+    const uint32_t *divisors, struct libdivide_u32_branchfree_t *dividers, size_t count) {
+    // Same layout as struct libdivide_u32_t
+    libdivide_internal_u32_gen_array_vec512(
+        divisors, (struct libdivide_u32_t *)dividers, count, 1);
+}
+
+////////// PER-LANE DIVISORS
+
+// a * b high halves of the 32-bit lanes, b may differ per lane
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u32_lanes_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+    __m512i hi_product_1Z3Z =
+        _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    return _mm512_or_si512(hi_product_0Z2Z, _mm512_and_si512(hi_product_1Z3Z, mask));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s32_lanes_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
+    __m512i hi_product_1Z3Z =
+        _mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    return _mm512_or_si512(hi_product_0Z2Z, _mm512_and_si512(hi_product_1Z3Z, mask));
+}
+
+__m512i libdivide_u32_do_lanes_vec512(__m512i numers, __m512i magics, __m512i mores) {
+    __m512i shift = _mm512_and_si512(mores, _mm512_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    __m512i q = libdivide_mullhi_u32_lanes_vec512(numers, magics);
+    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
+    q = _mm512_mask_mov_epi32(
+        q, _mm512_test_epi32_mask(mores, _mm512_set1_epi32(LIBDIVIDE_ADD_MARKER)), t);
+    // magic number of 0 indicates shift path
+    q = _mm512_mask_mov_epi32(
+        q, _mm512_cmpeq_epi32_mask(magics, _mm512_setzero_si512()), numers);
+    return _mm512_srlv_epi32(q, shift);
+}
+
+__m512i libdivide_s32_do_lanes_vec512(__m512i numers, __m512i magics, __m512i mores) {
+    __m512i shift = _mm512_and_si512(mores, _mm512_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    __m512i sign = _mm512_srai_epi32(_mm512_slli_epi32(mores, 24), 31);
+
+    // shift path: q = (numer + ((numer >> 31) & (2**shift - 1))) >> shift
+    __m512i mask = _mm512_sub_epi32(_mm512_sllv_epi32(_mm512_set1_epi32(1), shift),
+        _mm512_set1_epi32(1));
+    __m512i p = _mm512_add_epi32(numers, _mm512_and_si512(_mm512_srai_epi32(numers, 31), mask));
+    p = _mm512_srav_epi32(p, shift);
+    p = _mm512_sub_epi32(_mm512_xor_si512(p, sign), sign);
+
+    // multiply path: q += ((numer ^ sign) - sign) if the add marker is set
+    __m512i q = libdivide_mullhi_s32_lanes_vec512(numers, magics);
+    q = _mm512_mask_add_epi32(q,
+        _mm512_test_epi32_mask(mores, _mm512_set1_epi32(LIBDIVIDE_ADD_MARKER)), q,
+        _mm512_sub_epi32(_mm512_xor_si512(numers, sign), sign));
+    q = _mm512_srav_epi32(q, shift);
+    q = _mm512_add_epi32(q, _mm512_srli_epi32(q, 31));  // q += (q < 0)
+
+    // magic number of 0 indicates shift path
+    return _mm512_mask_mov_epi32(q, _mm512_cmpeq_epi32_mask(magics, _mm512_setzero_si512()), p);
+}
+
+__m512i libdivide_s32_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores) {
+    __m512i shift = _mm512_and_si512(mores, _mm512_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    __m512i sign = _mm512_srai_epi32(_mm512_slli_epi32(mores, 24), 31);
+    __m512i q = _mm512_add_epi32(libdivide_mullhi_s32_lanes_vec512(numers, magics), numers);
+
+    // q += (q < 0) ? (2**shift) - is_power_of_2 : 0
+    __m512i one = _mm512_set1_epi32(1);
+    __m512i mask = _mm512_sllv_epi32(one, shift);
+    mask = _mm512_mask_sub_epi32(
+        mask, _mm512_cmpeq_epi32_mask(magics, _mm512_setzero_si512()), mask, one);
+    q = _mm512_add_epi32(q, _mm512_and_si512(_mm512_srai_epi32(q, 31), mask));
+    q = _mm512_srav_epi32(q, shift);
+    return _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);
+}
+
+__m512i libdivide_u64_do_lanes_vec512(__m512i numers, __m512i magics, __m512i mores) {
+    __m512i shift = _mm512_and_si512(mores, _mm512_set1_epi64(LIBDIVIDE_64_SHIFT_MASK));
+    __m512i q = libdivide_mullhi_u64_vec512(numers, magics);
+    __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+    q = _mm512_mask_mov_epi64(
+        q, _mm512_test_epi64_mask(mores, _mm512_set1_epi64(LIBDIVIDE_ADD_MARKER)), t);
+    // magic number of 0 indicates shift path
+    q = _mm512_mask_mov_epi64(
+        q, _mm512_cmpeq_epi64_mask(magics, _mm512_setzero_si512()), numers);
+    return _mm512_srlv_epi64(q, shift);
+}
+
+__m512i libdivide_s64_do_lanes_vec512(__m512i numers, __m512i magics, __m512i mores) {
+    __m512i shift = _mm512_and_si512(mores, _mm512_set1_epi64(LIBDIVIDE_64_SHIFT_MASK));
+    __m512i sign = _mm512_srai_epi64(_mm512_slli_epi64(mores, 56), 63);
+
+    // shift path: q = (numer + ((numer >> 63) & (2**shift - 1))) >> shift
+    __m512i mask = _mm512_sub_epi64(_mm512_sllv_epi64(_mm512_set1_epi64(1), shift),
+        _mm512_set1_epi64(1));
+    __m512i p = _mm512_add_epi64(numers, _mm512_and_si512(_mm512_srai_epi64(numers, 63), mask));
+    p = _mm512_srav_epi64(p, shift);
+    p = _mm512_sub_epi64(_mm512_xor_si512(p, sign), sign);
+
+    // multiply path: q += ((numer ^ sign) - sign) if the add marker is set
+    __m512i q = libdivide_mullhi_s64_vec512(numers, magics);
+    q = _mm512_mask_add_epi64(q,
+        _mm512_test_epi64_mask(mores, _mm512_set1_epi64(LIBDIVIDE_ADD_MARKER)), q,
+        _mm512_sub_epi64(_mm512_xor_si512(numers, sign), sign));
+    q = _mm512_srav_epi64(q, shift);
+    q = _mm512_add_epi64(q, _mm512_srli_epi64(q, 63));  // q += (q < 0)
+
+    // magic number of 0 indicates shift path
+    return _mm512_mask_mov_epi64(q, _mm512_cmpeq_epi64_mask(magics, _mm512_setzero_si512()), p);
+}
+
+__m512i libdivide_s64_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores) {
+    __m512i shift = _mm512_and_si512(mores, _mm512_set1_epi64(LIBDIVIDE_64_SHIFT_MASK));
+    __m512i sign = _mm512_srai_epi64(_mm512_slli_epi64(mores, 56), 63);
+    __m512i q = _mm512_add_epi64(libdivide_mullhi_s64_vec512(numers, magics), numers);
+
+    // q += (q < 0) ? (2**shift) - is_power_of_2 : 0
+    __m512i one = _mm512_set1_epi64(1);
+    __m512i mask = _mm512_sllv_epi64(one, shift);
+    mask = _mm512_mask_sub_epi64(
+        mask, _mm512_cmpeq_epi64_mask(magics, _mm512_setzero_si512()), mask, one);
+    q = _mm512_add_epi64(q, _mm512_and_si512(libdivide_s64_signbits_vec512(q), mask));
+    q = _mm512_srav_epi64(q, shift);
+    return _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);
+}
+
+// The masked kernels divide by a single branchfull divider without
+// branching on more: all the paths are computed and blended using mask
+// registers, like the per-lane kernels. This costs about the same as the
+// branchfree kernels and suits code where the divisor is unpredictable.
+__m512i libdivide_u32_do_masked_vec512(__m512i numers, const struct libdivide_u32_t *denom) {
+    return libdivide_u32_do_lanes_vec512(
+        numers, _mm512_set1_epi32((int32_t)denom->magic), _mm512_set1_epi32(denom->more));
+}
+
+__m512i libdivide_s32_do_masked_vec512(__m512i numers, const struct libdivide_s32_t *denom) {
+    return libdivide_s32_do_lanes_vec512(
+        numers, _mm512_set1_epi32(denom->magic), _mm512_set1_epi32(denom->more));
+}
+
+__m512i libdivide_u64_do_masked_vec512(__m512i numers, const struct libdivide_u64_t *denom) {
+    return libdivide_u64_do_lanes_vec512(
+        numers, _mm512_set1_epi64((int64_t)denom->magic), _mm512_set1_epi64(denom->more));
+}
+
+__m512i libdivide_s64_do_masked_vec512(__m512i numers, const struct libdivide_s64_t *denom) {
+    return libdivide_s64_do_lanes_vec512(
+        numers, _mm512_set1_epi64(denom->magic), _mm512_set1_epi64(denom->more));
+}
+
+#define LIBDIVIDE_MORES_EPI32_VEC512(p) _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(p)))
+#define LIBDIVIDE_MORES_EPI64_VEC512(p) _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i *)(p)))
+
+LIBDIVIDE_DO_ARRAY_LANES_VEC(u32, uint32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512, LIBDIVIDE_MORES_EPI32_VEC512)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s32, int32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512, LIBDIVIDE_MORES_EPI32_VEC512)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s32_branchfree, int32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512, LIBDIVIDE_MORES_EPI32_VEC512)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(u64, uint64_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512, LIBDIVIDE_MORES_EPI64_VEC512)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s64, int64_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512, LIBDIVIDE_MORES_EPI64_VEC512)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s64_branchfree, int64_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512,
+    LIBDIVIDE_STOREU_SI512, LIBDIVIDE_MORES_EPI64_VEC512)
+
+void libdivide_gather_packed_vec512(
+    const void *table, __m512i indices, __m512i *magics, __m512i *mores) {
+    __m512i offsets = _mm512_add_epi32(indices, _mm512_slli_epi32(indices, 2));
+    *magics = _mm512_i32gather_epi32(offsets, table, 1);
+    *mores = _mm512_srli_epi32(
+        _mm512_i32gather_epi32(offsets, (const char *)table + 1, 1), 24);
+}
+
+LIBDIVIDE_DO_ARRAY_PACKED_VEC(
+    u32, uint32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_PACKED_VEC(
+    s32, int32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+LIBDIVIDE_DO_ARRAY_PACKED_VEC(
+    s32_branchfree, int32_t, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STOREU_SI512)
+
+// Adds the 32-bit quotients of q to the 64-bit sums of acc
+static LIBDIVIDE_INLINE __m512i libdivide_sum_u32_vec512(__m512i acc, __m512i q) {
+    __m512i lo = _mm512_and_si512(q, _mm512_set1_epi64(0xFFFFFFFF));
+    return _mm512_add_epi64(acc, _mm512_add_epi64(lo, _mm512_srli_epi64(q, 32)));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_sum_s32_vec512(__m512i acc, __m512i q) {
+    return libdivide_sum_u32_vec512(acc, _mm512_xor_si512(q, _mm512_set1_epi32(INT32_MIN)));
+}
+
+// Adds the 16-bit quotients pairwise to 32-bit lanes first
+static LIBDIVIDE_INLINE __m512i libdivide_sum_u16_vec512(__m512i acc, __m512i q) {
+    __m512i lo = _mm512_and_si512(q, _mm512_set1_epi32(0xFFFF));
+    return libdivide_sum_u32_vec512(acc, _mm512_add_epi32(lo, _mm512_srli_epi32(q, 16)));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_sum_s16_vec512(__m512i acc, __m512i q) {
+    return libdivide_sum_u16_vec512(acc, _mm512_xor_si512(q, _mm512_set1_epi16(INT16_MIN)));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_sum_u64_vec512(__m512i acc, __m512i q) {
+    return _mm512_add_epi64(acc, q);
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_reduce_sums_vec512(
+    __m512i acc0, __m512i acc1, __m512i acc2, __m512i acc3) {
+    uint64_t sums[8];
+    __m512i acc = _mm512_add_epi64(_mm512_add_epi64(acc0, acc1), _mm512_add_epi64(acc2, acc3));
+    _mm512_storeu_si512((void *)sums, acc);
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]) + (sums[4] + sums[5]) + (sums[6] + sums[7]);
+}
+
+#define LIBDIVIDE_SUM_QUOTIENTS_VEC512(ALGO, T, S, ACCUMULATE, BIAS)                         \
+    LIBDIVIDE_SUM_QUOTIENTS_VEC(ALGO, T, S, vec512, __m512i, __m512i, LIBDIVIDE_LOADU_SI512, \
+        _mm512_setzero_si512(), ACCUMULATE, BIAS)
+
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(u16, uint16_t, uint64_t, libdivide_sum_u16_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(s16, int16_t, int64_t, libdivide_sum_s16_vec512, 1u << 15)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(u16_branchfree, uint16_t, uint64_t, libdivide_sum_u16_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(s16_branchfree, int16_t, int64_t, libdivide_sum_s16_vec512, 1u << 15)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(u32, uint32_t, uint64_t, libdivide_sum_u32_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(s32, int32_t, int64_t, libdivide_sum_s32_vec512, 1u << 31)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(u64, uint64_t, uint64_t, libdivide_sum_u64_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(s64, int64_t, int64_t, libdivide_sum_u64_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(u32_branchfree, uint32_t, uint64_t, libdivide_sum_u32_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(s32_branchfree, int32_t, int64_t, libdivide_sum_s32_vec512, 1u << 31)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(u64_branchfree, uint64_t, uint64_t, libdivide_sum_u64_vec512, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC512(s64_branchfree, int64_t, int64_t, libdivide_sum_u64_vec512, 0)
+
+#define LIBDIVIDE_DO_ARRAY_STREAM_VEC512(ALGO, T) \
+    LIBDIVIDE_DO_ARRAY_STREAM_VEC(                \
+        ALGO, T, vec512, __m512i, LIBDIVIDE_LOADU_SI512, LIBDIVIDE_STREAM_SI512)
+
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(s16, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC512(s64_branchfree, int64_t)
+
+LIBDIVIDE_AVX512_END
+
+#endif
+
+#if defined(LIBDIVIDE_AVX2_KERNELS)
+
+LIBDIVIDE_AVX2_BEGIN
+
+static LIBDIVIDE_INLINE __m256i libdivide_u16_do_vec256(
+    __m256i numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s16_do_vec256(
+    __m256i numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u32_do_vec256(
+    __m256i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s32_do_vec256(
+    __m256i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u64_do_vec256(
+    __m256i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s64_do_vec256(
+    __m256i numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE __m256i libdivide_u16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s64_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE __m256i libdivide_u32_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores);
+static LIBDIVIDE_INLINE __m256i libdivide_s32_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores);
+static LIBDIVIDE_INLINE __m256i libdivide_s32_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores);
+static LIBDIVIDE_INLINE __m256i libdivide_u64_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores);
+static LIBDIVIDE_INLINE __m256i libdivide_s64_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores);
+static LIBDIVIDE_INLINE __m256i libdivide_s64_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores);
+
+static LIBDIVIDE_INLINE void libdivide_gather_packed_vec256(
+    const void *table, __m256i indices, __m256i *magics, __m256i *mores);
+
+//////// Internal Utility Functions
+
+static LIBDIVIDE_INLINE __m256i libdivide_s32_signbits_vec256(__m256i v) {
+    return _mm256_srai_epi32(v, 31);
+}
+
+// Implementation of _mm256_srai_epi64(v, 63) (from AVX512).
+static LIBDIVIDE_INLINE __m256i libdivide_s64_signbits_vec256(__m256i v) {
+    __m256i hiBitsDuped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
+    __m256i signBits = _mm256_srai_epi32(hiBitsDuped, 31);
+    return signBits;
+}
+
+// Implementation of _mm256_srai_epi64 (from AVX512).
+static LIBDIVIDE_INLINE __m256i libdivide_s64_shift_right_vec256(__m256i v, int amt) {
+    const int b = 64 - amt;
+    __m256i m = _mm256_set1_epi64x(1ULL << (b - 1));
+    __m256i x = _mm256_srli_epi64(v, amt);
+    __m256i result = _mm256_sub_epi64(_mm256_xor_si256(x, m), m);
+    return result;
+}
+
+// Here, b is assumed to contain one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u32_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+    __m256i a1X3X = _mm256_srli_epi64(a, 32);
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epu32(a1X3X, b), mask);
+    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// b is one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s32_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
+    __m256i a1X3X = _mm256_srli_epi64(a, 32);
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epi32(a1X3X, b), mask);
+    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// Here, y is assumed to contain one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u64_vec256(__m256i x, __m256i y) {
+    // see m128i variant for comments.
+    __m256i x0y0 = _mm256_mul_epu32(x, y);
+    __m256i x0y0_hi = _mm256_srli_epi64(x0y0, 32);
+
+    __m256i x1 = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+    __m256i y1 = _mm256_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+
+    __m256i x0y1 = _mm256_mul_epu32(x, y1);
+    __m256i x1y0 = _mm256_mul_epu32(x1, y);
+    __m256i x1y1 = _mm256_mul_epu32(x1, y1);
+
+    __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    __m256i temp = _mm256_add_epi64(x1y0, x0y0_hi);
+    __m256i temp_lo = _mm256_and_si256(temp, mask);
+    __m256i temp_hi = _mm256_srli_epi64(temp, 32);
+
+    temp_lo = _mm256_srli_epi64(_mm256_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm256_add_epi64(x1y1, temp_hi);
+    return _mm256_add_epi64(temp_lo, temp_hi);
+}
+
+// y is one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s64_vec256(__m256i x, __m256i y) {
+    __m256i p = libdivide_mullhi_u64_vec256(x, y);
+    __m256i t1 = _mm256_and_si256(libdivide_s64_signbits_vec256(x), y);
+    __m256i t2 = _mm256_and_si256(libdivide_s64_signbits_vec256(y), x);
+    p = _mm256_sub_epi64(p, t1);
+    p = _mm256_sub_epi64(p, t2);
+    return p;
+}
+
+// Low 64 bits of the lane-wise 64-bit product
+static LIBDIVIDE_INLINE __m256i libdivide_mullo_u64_vec256(__m256i x, __m256i y) {
+    __m256i x1 = _mm256_srli_epi64(x, 32);
+    __m256i y1 = _mm256_srli_epi64(y, 32);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(x1, y), _mm256_mul_epu32(x, y1));
+    return _mm256_add_epi64(_mm256_mul_epu32(x, y), _mm256_slli_epi64(cross, 32));
+}
+
+////////// UINT16
+
+__m256i libdivide_u16_do_vec256(__m256i numers, const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi16(numers, more);
+    } else {
+        __m256i q = _mm256_mulhi_epu16(numers, _mm256_set1_epi16((short)denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint16_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+            __m256i t = _mm256_add_epi16(_mm256_srli_epi16(_mm256_sub_epi16(numers, q), 1), q);
+            return _mm256_srli_epi16(t, shift);
+        } else {
+            return _mm256_srli_epi16(q, more);
+        }
+    }
+}
+
+__m256i libdivide_u16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u16_branchfree_t *denom) {
+    __m256i q = _mm256_mulhi_epu16(numers, _mm256_set1_epi16((short)denom->magic));
+    __m256i t = _mm256_add_epi16(_mm256_srli_epi16(_mm256_sub_epi16(numers, q), 1), q);
+    return _mm256_srli_epi16(t, denom->more);
+}
+
+////////// SINT16
+
+__m256i libdivide_s16_do_vec256(__m256i numers, const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        __m256i roundToZeroTweak = _mm256_set1_epi16((short)mask);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi16(
+            numers, _mm256_and_si256(_mm256_srai_epi16(numers, 15), roundToZeroTweak));
+        q = _mm256_srai_epi16(q, shift);
+        __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi16(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = _mm256_mulhi_epi16(numers, _mm256_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi16(q, _mm256_sub_epi16(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm256_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
+        q = _mm256_add_epi16(q, _mm256_srli_epi16(q, 15));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s16_branchfree_t *denom) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
+    __m256i q = _mm256_mulhi_epi16(numers, _mm256_set1_epi16(magic));
+    q = _mm256_add_epi16(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = _mm256_srai_epi16(q, 15);  // q_sign = q >> 15
+    __m256i mask = _mm256_set1_epi16((short)(((uint16_t)1 << shift) - is_power_of_2));
+    q = _mm256_add_epi16(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm256_srai_epi16(q, shift);                  // q >>= shift
+    q = _mm256_sub_epi16(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// UINT32
+
+__m256i libdivide_u32_do_vec256(__m256i numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi32(numers, more);
+    } else {
+        __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
+            return _mm256_srli_epi32(t, shift);
+        } else {
+            return _mm256_srli_epi32(q, more);
+        }
+    }
+}
+
+__m256i libdivide_u32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u32_branchfree_t *denom) {
+    __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
+    __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
+    return _mm256_srli_epi32(t, denom->more);
+}
+
+////////// UINT64
+
+__m256i libdivide_u64_do_vec256(__m256i numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi64(numers, more);
+    } else {
+        __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
+            return _mm256_srli_epi64(t, shift);
+        } else {
+            return _mm256_srli_epi64(q, more);
+        }
+    }
+}
+
+__m256i libdivide_u64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u64_branchfree_t *denom) {
+    __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
+    __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
+    return _mm256_srli_epi64(t, denom->more);
+}
+
+////////// SINT32
+
+__m256i libdivide_s32_do_vec256(__m256i numers, const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t mask = (1U << shift) - 1;
+        __m256i roundToZeroTweak = _mm256_set1_epi32(mask);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi32(
+            numers, _mm256_and_si256(_mm256_srai_epi32(numers, 31), roundToZeroTweak));
+        q = _mm256_srai_epi32(q, shift);
+        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi32(q, _mm256_sub_epi32(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm256_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = _mm256_add_epi32(q, _mm256_srli_epi32(q, 31));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s32_branchfree_t *denom) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+    __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(magic));
+    q = _mm256_add_epi32(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = _mm256_srai_epi32(q, 31);  // q_sign = q >> 31
+    __m256i mask = _mm256_set1_epi32((1U << shift) - is_power_of_2);
+    q = _mm256_add_epi32(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm256_srai_epi32(q, shift);                          // q >>= shift
+    q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT64
+
+__m256i libdivide_s64_do_vec256(__m256i numers, const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    int64_t magic = denom->magic;
+    if (magic == 0) {  // shift path
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t mask = (1ULL << shift) - 1;
+        __m256i roundToZeroTweak = _mm256_set1_epi64x(mask);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi64(
+            numers, _mm256_and_si256(libdivide_s64_signbits_vec256(numers), roundToZeroTweak));
+        q = libdivide_s64_shift_right_vec256(q, shift);
+        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi64(q, _mm256_sub_epi64(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= denom->mult_path.shift
+        q = libdivide_s64_shift_right_vec256(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = _mm256_add_epi64(q, _mm256_srli_epi64(q, 63));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s64_branchfree_t *denom) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+
+    // libdivide_mullhi_s64(numers, magic);
+    __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
+    q = _mm256_add_epi64(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint32_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = libdivide_s64_signbits_vec256(q);  // q_sign = q >> 63
+    __m256i mask = _mm256_set1_epi64x((1ULL << shift) - is_power_of_2);
+    q = _mm256_add_epi64(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_shift_right_vec256(q, shift);           // q >>= shift
+    q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u16, uint16_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s16, int16_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(u16_branchfree, uint16_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s16_branchfree, int16_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(u32, uint32_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s32, int32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(u64, uint64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s64, int64_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(u32_branchfree, uint32_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s32_branchfree, int32_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(u64_branchfree, uint64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s64_branchfree, int64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+
+LIBDIVIDE_DIVMOD_VEC(u32, uint32_t, vec256, __m256i,
+    _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(s32, int32_t, vec256, __m256i,
+    _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(u64, uint64_t, vec256, __m256i,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(s64, int64_t, vec256, __m256i,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(u32_branchfree, uint32_t, vec256, __m256i,
+    _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(s32_branchfree, int32_t, vec256, __m256i,
+    _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(u64_branchfree, uint64_t, vec256, __m256i,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DIVMOD_VEC(s64_branchfree, int64_t, vec256, __m256i,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256)
+
+LIBDIVIDE_ROUNDING_VEC(s32, int32_t, uint32_t, vec256, __m256i,
+    _mm256_set1_epi32, _mm256_add_epi32, _mm256_sub_epi32, _mm256_and_si256, _mm256_xor_si256,
+    libdivide_s32_signbits_vec256)
+LIBDIVIDE_ROUNDING_VEC(s64, int64_t, uint64_t, vec256, __m256i,
+    _mm256_set1_epi64x, _mm256_add_epi64, _mm256_sub_epi64, _mm256_and_si256, _mm256_xor_si256,
+    libdivide_s64_signbits_vec256)
+LIBDIVIDE_ROUNDING_VEC(s32_branchfree, int32_t, uint32_t, vec256, __m256i,
+    _mm256_set1_epi32, _mm256_add_epi32, _mm256_sub_epi32, _mm256_and_si256, _mm256_xor_si256,
+    libdivide_s32_signbits_vec256)
+LIBDIVIDE_ROUNDING_VEC(s64_branchfree, int64_t, uint64_t, vec256, __m256i,
+    _mm256_set1_epi64x, _mm256_add_epi64, _mm256_sub_epi64, _mm256_and_si256, _mm256_xor_si256,
+    libdivide_s64_signbits_vec256)
+
+////////// DIVISIBILITY
+
+// Returns a mask with all bits set in the lanes that are divisible.
+// Shifting by the full lane width yields 0, so shift == 0 works.
+static LIBDIVIDE_INLINE __m256i libdivide_u32_is_divisible_vec256(
+    __m256i numers, const struct libdivide_u32_divisibility_t *denom) {
+    int shift = denom->shift;
+    __m256i x = _mm256_mullo_epi32(numers, _mm256_set1_epi32(denom->inverse));
+    x = _mm256_or_si256(_mm256_srl_epi32(x, _mm_cvtsi32_si128(shift)),
+        _mm256_sll_epi32(x, _mm_cvtsi32_si128(32 - shift)));
+    __m256i threshold = _mm256_set1_epi32(denom->threshold);
+    return _mm256_cmpeq_epi32(_mm256_max_epu32(x, threshold), threshold);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u64_is_divisible_vec256(
+    __m256i numers, const struct libdivide_u64_divisibility_t *denom) {
+    int shift = denom->shift;
+    __m256i x = libdivide_mullo_u64_vec256(numers, _mm256_set1_epi64x(denom->inverse));
+    x = _mm256_or_si256(_mm256_srl_epi64(x, _mm_cvtsi32_si128(shift)),
+        _mm256_sll_epi64(x, _mm_cvtsi32_si128(64 - shift)));
+    // Unsigned compare using the signed compare: flip the sign bits
+    __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    __m256i threshold = _mm256_set1_epi64x(denom->threshold ^ (1ULL << 63));
+    __m256i gt = _mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), threshold);
+    return _mm256_xor_si256(gt, _mm256_set1_epi32(-1));
+}
+
+////////// EXACT DIVISION
+
+// See libdivide_u32_exact_do()
+static LIBDIVIDE_INLINE __m256i libdivide_u32_exact_do_vec256(
+    __m256i numers, const struct libdivide_u32_exact_t *denom) {
+    __m256i q = _mm256_srli_epi32(numers, denom->shift);
+    return _mm256_mullo_epi32(q, _mm256_set1_epi32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s32_exact_do_vec256(
+    __m256i numers, const struct libdivide_s32_exact_t *denom) {
+    __m256i q = _mm256_srai_epi32(numers, denom->shift);
+    return _mm256_mullo_epi32(q, _mm256_set1_epi32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u64_exact_do_vec256(
+    __m256i numers, const struct libdivide_u64_exact_t *denom) {
+    __m256i q = _mm256_srli_epi64(numers, denom->shift);
+    return libdivide_mullo_u64_vec256(q, _mm256_set1_epi64x(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s64_exact_do_vec256(
+    __m256i numers, const struct libdivide_s64_exact_t *denom) {
+    __m256i q = libdivide_s64_shift_right_vec256(numers, denom->shift);
+    return libdivide_mullo_u64_vec256(q, _mm256_set1_epi64x(denom->inverse));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_exact, uint32_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s32_exact, int32_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(u64_exact, uint64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s64_exact, int64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+
+////////// FASTMOD
+
+// Computes the remainders of the even 32-bit lanes, which are
+// returned in the low halves of the 64-bit lanes.
+// See libdivide_u32_mod_do().
+static LIBDIVIDE_INLINE __m256i libdivide_u32_mod_half_vec256(
+    __m256i numers, __m256i m_lo, __m256i m_hi, __m256i d) {
+    __m256i lowbits = _mm256_add_epi64(
+        _mm256_mul_epu32(numers, m_lo), _mm256_slli_epi64(_mm256_mul_epu32(numers, m_hi), 32));
+    __m256i lo = _mm256_srli_epi64(_mm256_mul_epu32(lowbits, d), 32);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(lowbits, 32), d);
+    return _mm256_srli_epi64(_mm256_add_epi64(hi, lo), 32);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u32_mod_do_vec256(
+    __m256i numers, const struct libdivide_u32_mod_t *denom) {
+    __m256i m_lo = _mm256_set1_epi32((uint32_t)denom->M);
+    __m256i m_hi = _mm256_set1_epi32((uint32_t)(denom->M >> 32));
+    __m256i d = _mm256_set1_epi32(denom->d);
+    __m256i even = libdivide_u32_mod_half_vec256(numers, m_lo, m_hi, d);
+    __m256i odd = libdivide_u32_mod_half_vec256(_mm256_srli_epi64(numers, 32), m_lo, m_hi, d);
+    return _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_mod, uint32_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+
+////////// 52-BIT
+
+// See libdivide_u52_do(). With AVX512 IFMA the numerator is added
+// to the 52-bit high product by the multiply instruction itself.
+static LIBDIVIDE_INLINE __m256i libdivide_u52_do_vec256(
+    __m256i numers, const struct libdivide_u52_t *denom) {
+    __m256i magic = _mm256_set1_epi64x(denom->magic);
+#if defined(__AVX512IFMA__) && defined(__AVX512VL__)
+    __m256i q = _mm256_madd52hi_epu64(numers, numers, magic);
+#else
+    __m256i q = libdivide_mullhi_u64_vec256(_mm256_slli_epi64(numers, 12), magic);
+    q = _mm256_add_epi64(q, numers);
+#endif
+    return _mm256_srli_epi64(q, denom->more);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s52_do_vec256(
+    __m256i numers, const struct libdivide_s52_t *denom) {
+    uint8_t more = denom->more;
+    __m256i magic = _mm256_set1_epi64x(denom->magic);
+    __m256i sign = libdivide_s64_signbits_vec256(numers);
+    __m256i absN = _mm256_sub_epi64(_mm256_xor_si256(numers, sign), sign);
+#if defined(__AVX512IFMA__) && defined(__AVX512VL__)
+    __m256i q = _mm256_madd52hi_epu64(absN, absN, magic);
+#else
+    __m256i q = libdivide_mullhi_u64_vec256(_mm256_slli_epi64(absN, 12), magic);
+    q = _mm256_add_epi64(q, absN);
+#endif
+    q = _mm256_srli_epi64(q, more & LIBDIVIDE_64_SHIFT_MASK);
+    sign = _mm256_xor_si256(sign, _mm256_set1_epi32((int8_t)more >> 7));
+    return _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u52, uint64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_VEC(s52, int64_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+
+////////// NARROW 64-BIT
+
+// See libdivide_u64_narrow_do()
+static LIBDIVIDE_INLINE __m256i libdivide_u64_narrow_do_vec256(
+    __m256i numers, const struct libdivide_u64_narrow_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi64(numers, more);
+    }
+    __m256i q = _mm256_mul_epu32(numers, _mm256_set1_epi32(denom->magic));
+    q = _mm256_srli_epi64(q, 32);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
+        return _mm256_srli_epi64(t, more & LIBDIVIDE_32_SHIFT_MASK);
+    }
+    return _mm256_srli_epi64(q, more);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u64_narrow, uint64_t, vec256, __m256i,
+    LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+
+////////// PER-LANE DIVISORS
+
+// a * b high halves of the 32-bit lanes, b may differ per lane
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u32_lanes_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+    __m256i hi_product_1Z3Z =
+        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    return _mm256_or_si256(hi_product_0Z2Z, _mm256_and_si256(hi_product_1Z3Z, mask));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s32_lanes_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
+    __m256i hi_product_1Z3Z =
+        _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    return _mm256_or_si256(hi_product_0Z2Z, _mm256_and_si256(hi_product_1Z3Z, mask));
+}
+
+// Implementation of _mm256_srav_epi64 (from AVX512).
+static LIBDIVIDE_INLINE __m256i libdivide_s64_shift_right_lanes_vec256(__m256i v, __m256i amt) {
+    __m256i m = _mm256_srlv_epi64(_mm256_set1_epi64x(1ULL << 63), amt);
+    __m256i x = _mm256_srlv_epi64(v, amt);
+    return _mm256_sub_epi64(_mm256_xor_si256(x, m), m);
+}
+
+__m256i libdivide_u32_do_lanes_vec256(__m256i numers, __m256i magics, __m256i mores) {
+    __m256i shift = _mm256_and_si256(mores, _mm256_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    __m256i add_marker = _mm256_set1_epi32(LIBDIVIDE_ADD_MARKER);
+    __m256i q = libdivide_mullhi_u32_lanes_vec256(numers, magics);
+    __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
+    q = _mm256_blendv_epi8(
+        q, t, _mm256_cmpeq_epi32(_mm256_and_si256(mores, add_marker), add_marker));
+    // magic number of 0 indicates shift path
+    q = _mm256_blendv_epi8(q, numers, _mm256_cmpeq_epi32(magics, _mm256_setzero_si256()));
+    return _mm256_srlv_epi32(q, shift);
+}
+
+__m256i libdivide_s32_do_lanes_vec256(__m256i numers, __m256i magics, __m256i mores) {
+    __m256i shift = _mm256_and_si256(mores, _mm256_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    __m256i add_marker = _mm256_set1_epi32(LIBDIVIDE_ADD_MARKER);
+    __m256i sign = _mm256_srai_epi32(_mm256_slli_epi32(mores, 24), 31);
+
+    // shift path: q = (numer + ((numer >> 31) & (2**shift - 1))) >> shift
+    __m256i mask = _mm256_sub_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), shift),
+        _mm256_set1_epi32(1));
+    __m256i p = _mm256_add_epi32(numers, _mm256_and_si256(_mm256_srai_epi32(numers, 31), mask));
+    p = _mm256_srav_epi32(p, shift);
+    p = _mm256_sub_epi32(_mm256_xor_si256(p, sign), sign);
+
+    // multiply path: q += ((numer ^ sign) - sign) if the add marker is set
+    __m256i q = libdivide_mullhi_s32_lanes_vec256(numers, magics);
+    __m256i add = _mm256_cmpeq_epi32(_mm256_and_si256(mores, add_marker), add_marker);
+    q = _mm256_add_epi32(
+        q, _mm256_and_si256(add, _mm256_sub_epi32(_mm256_xor_si256(numers, sign), sign)));
+    q = _mm256_srav_epi32(q, shift);
+    q = _mm256_add_epi32(q, _mm256_srli_epi32(q, 31));  // q += (q < 0)
+
+    // magic number of 0 indicates shift path
+    return _mm256_blendv_epi8(q, p, _mm256_cmpeq_epi32(magics, _mm256_setzero_si256()));
+}
+
+__m256i libdivide_s32_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores) {
+    __m256i shift = _mm256_and_si256(mores, _mm256_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    __m256i sign = _mm256_srai_epi32(_mm256_slli_epi32(mores, 24), 31);
+    __m256i q = _mm256_add_epi32(libdivide_mullhi_s32_lanes_vec256(numers, magics), numers);
+
+    // q += (q < 0) ? (2**shift) - is_power_of_2 : 0
+    __m256i is_power_of_2 =
+        _mm256_srli_epi32(_mm256_cmpeq_epi32(magics, _mm256_setzero_si256()), 31);
+    __m256i mask =
+        _mm256_sub_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), shift), is_power_of_2);
+    q = _mm256_add_epi32(q, _mm256_and_si256(_mm256_srai_epi32(q, 31), mask));
+    q = _mm256_srav_epi32(q, shift);
+    return _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);
+}
+
+__m256i libdivide_u64_do_lanes_vec256(__m256i numers, __m256i magics, __m256i mores) {
+    __m256i shift = _mm256_and_si256(mores, _mm256_set1_epi64x(LIBDIVIDE_64_SHIFT_MASK));
+    __m256i add_marker = _mm256_set1_epi64x(LIBDIVIDE_ADD_MARKER);
+    __m256i q = libdivide_mullhi_u64_vec256(numers, magics);
+    __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
+    q = _mm256_blendv_epi8(
+        q, t, _mm256_cmpeq_epi64(_mm256_and_si256(mores, add_marker), add_marker));
+    // magic number of 0 indicates shift path
+    q = _mm256_blendv_epi8(q, numers, _mm256_cmpeq_epi64(magics, _mm256_setzero_si256()));
+    return _mm256_srlv_epi64(q, shift);
+}
+
+__m256i libdivide_s64_do_lanes_vec256(__m256i numers, __m256i magics, __m256i mores) {
+    __m256i shift = _mm256_and_si256(mores, _mm256_set1_epi64x(LIBDIVIDE_64_SHIFT_MASK));
+    __m256i add_marker = _mm256_set1_epi64x(LIBDIVIDE_ADD_MARKER);
+    // more <= 0xFF, bit 7 indicates a negative divisor
+    __m256i sign = _mm256_cmpgt_epi64(mores, _mm256_set1_epi64x(0x7F));
+
+    // shift path: q = (numer + ((numer >> 63) & (2**shift - 1))) >> shift
+    __m256i mask = _mm256_sub_epi64(_mm256_sllv_epi64(_mm256_set1_epi64x(1), shift),
+        _mm256_set1_epi64x(1));
+    __m256i p =
+        _mm256_add_epi64(numers, _mm256_and_si256(libdivide_s64_signbits_vec256(numers), mask));
+    p = libdivide_s64_shift_right_lanes_vec256(p, shift);
+    p = _mm256_sub_epi64(_mm256_xor_si256(p, sign), sign);
+
+    // multiply path: q += ((numer ^ sign) - sign) if the add marker is set
+    __m256i q = libdivide_mullhi_s64_vec256(numers, magics);
+    __m256i add = _mm256_cmpeq_epi64(_mm256_and_si256(mores, add_marker), add_marker);
+    q = _mm256_add_epi64(
+        q, _mm256_and_si256(add, _mm256_sub_epi64(_mm256_xor_si256(numers, sign), sign)));
+    q = libdivide_s64_shift_right_lanes_vec256(q, shift);
+    q = _mm256_add_epi64(q, _mm256_srli_epi64(q, 63));  // q += (q < 0)
+
+    // magic number of 0 indicates shift path
+    return _mm256_blendv_epi8(q, p, _mm256_cmpeq_epi64(magics, _mm256_setzero_si256()));
+}
+
+__m256i libdivide_s64_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores) {
+    __m256i shift = _mm256_and_si256(mores, _mm256_set1_epi64x(LIBDIVIDE_64_SHIFT_MASK));
+    // more <= 0xFF, bit 7 indicates a negative divisor
+    __m256i sign = _mm256_cmpgt_epi64(mores, _mm256_set1_epi64x(0x7F));
+    __m256i q = _mm256_add_epi64(libdivide_mullhi_s64_vec256(numers, magics), numers);
+
+    // q += (q < 0) ? (2**shift) - is_power_of_2 : 0
+    __m256i is_power_of_2 =
+        _mm256_srli_epi64(_mm256_cmpeq_epi64(magics, _mm256_setzero_si256()), 63);
+    __m256i mask =
+        _mm256_sub_epi64(_mm256_sllv_epi64(_mm256_set1_epi64x(1), shift), is_power_of_2);
+    q = _mm256_add_epi64(q, _mm256_and_si256(libdivide_s64_signbits_vec256(q), mask));
+    q = libdivide_s64_shift_right_lanes_vec256(q, shift);
+    return _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);
+}
+
+#define LIBDIVIDE_MORES_EPI32_VEC256(p) _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(p)))
+#define LIBDIVIDE_MORES_EPI64_VEC256(p) _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(LIBDIVIDE_MORES4(p)))
+
+LIBDIVIDE_DO_ARRAY_LANES_VEC(u32, uint32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256, LIBDIVIDE_MORES_EPI32_VEC256)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s32, int32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256, LIBDIVIDE_MORES_EPI32_VEC256)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s32_branchfree, int32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256, LIBDIVIDE_MORES_EPI32_VEC256)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(u64, uint64_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256, LIBDIVIDE_MORES_EPI64_VEC256)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s64, int64_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256, LIBDIVIDE_MORES_EPI64_VEC256)
+LIBDIVIDE_DO_ARRAY_LANES_VEC(s64_branchfree, int64_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256,
+    LIBDIVIDE_STOREU_SI256, LIBDIVIDE_MORES_EPI64_VEC256)
+
+void libdivide_gather_packed_vec256(
+    const void *table, __m256i indices, __m256i *magics, __m256i *mores) {
+    const int *base = (const int *)table;
+    __m256i offsets = _mm256_add_epi32(indices, _mm256_slli_epi32(indices, 2));
+    *magics = _mm256_i32gather_epi32(base, offsets, 1);
+    *mores = _mm256_srli_epi32(
+        _mm256_i32gather_epi32((const int *)((const char *)table + 1), offsets, 1), 24);
+}
+
+LIBDIVIDE_DO_ARRAY_PACKED_VEC(
+    u32, uint32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_PACKED_VEC(
+    s32, int32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+LIBDIVIDE_DO_ARRAY_PACKED_VEC(
+    s32_branchfree, int32_t, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STOREU_SI256)
+
+// Adds the 32-bit quotients of q to the 64-bit sums of acc
+static LIBDIVIDE_INLINE __m256i libdivide_sum_u32_vec256(__m256i acc, __m256i q) {
+    __m256i lo = _mm256_and_si256(q, _mm256_set1_epi64x(0xFFFFFFFF));
+    return _mm256_add_epi64(acc, _mm256_add_epi64(lo, _mm256_srli_epi64(q, 32)));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_sum_s32_vec256(__m256i acc, __m256i q) {
+    return libdivide_sum_u32_vec256(acc, _mm256_xor_si256(q, _mm256_set1_epi32(INT32_MIN)));
+}
+
+// Adds the 16-bit quotients pairwise to 32-bit lanes first
+static LIBDIVIDE_INLINE __m256i libdivide_sum_u16_vec256(__m256i acc, __m256i q) {
+    __m256i lo = _mm256_and_si256(q, _mm256_set1_epi32(0xFFFF));
+    return libdivide_sum_u32_vec256(acc, _mm256_add_epi32(lo, _mm256_srli_epi32(q, 16)));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_sum_s16_vec256(__m256i acc, __m256i q) {
+    return libdivide_sum_u16_vec256(acc, _mm256_xor_si256(q, _mm256_set1_epi16(INT16_MIN)));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_sum_u64_vec256(__m256i acc, __m256i q) {
+    return _mm256_add_epi64(acc, q);
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_reduce_sums_vec256(
+    __m256i acc0, __m256i acc1, __m256i acc2, __m256i acc3) {
+    uint64_t sums[4];
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    _mm256_storeu_si256((__m256i *)sums, acc);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+#define LIBDIVIDE_SUM_QUOTIENTS_VEC256(ALGO, T, S, ACCUMULATE, BIAS)                         \
+    LIBDIVIDE_SUM_QUOTIENTS_VEC(ALGO, T, S, vec256, __m256i, __m256i, LIBDIVIDE_LOADU_SI256, \
+        _mm256_setzero_si256(), ACCUMULATE, BIAS)
+
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(u16, uint16_t, uint64_t, libdivide_sum_u16_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(s16, int16_t, int64_t, libdivide_sum_s16_vec256, 1u << 15)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(u16_branchfree, uint16_t, uint64_t, libdivide_sum_u16_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(s16_branchfree, int16_t, int64_t, libdivide_sum_s16_vec256, 1u << 15)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(u32, uint32_t, uint64_t, libdivide_sum_u32_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(s32, int32_t, int64_t, libdivide_sum_s32_vec256, 1u << 31)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(u64, uint64_t, uint64_t, libdivide_sum_u64_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(s64, int64_t, int64_t, libdivide_sum_u64_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(u32_branchfree, uint32_t, uint64_t, libdivide_sum_u32_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(s32_branchfree, int32_t, int64_t, libdivide_sum_s32_vec256, 1u << 31)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(u64_branchfree, uint64_t, uint64_t, libdivide_sum_u64_vec256, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC256(s64_branchfree, int64_t, int64_t, libdivide_sum_u64_vec256, 0)
+
+#define LIBDIVIDE_DO_ARRAY_STREAM_VEC256(ALGO, T) \
+    LIBDIVIDE_DO_ARRAY_STREAM_VEC(                \
+        ALGO, T, vec256, __m256i, LIBDIVIDE_LOADU_SI256, LIBDIVIDE_STREAM_SI256)
+
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(s16, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC256(s64_branchfree, int64_t)
+
+LIBDIVIDE_AVX2_END
+
+#endif
+
+#if defined(LIBDIVIDE_AVX512_KERNELS) && !defined(__AVX512BW__)
+
+LIBDIVIDE_AVX512_BEGIN
+
+// Without AVX512BW there are no 16-bit lane instructions for 512-bit
+// vectors, hence we divide both 256-bit halves using the AVX2 kernels.
+#define LIBDIVIDE_16_DO_VEC512(ALGO)                                                            \
+    __m512i libdivide_##ALGO##_do_vec512(                                                       \
+        __m512i numers, const struct libdivide_##ALGO##_t *denom) {                             \
+        __m256i lo = libdivide_##ALGO##_do_vec256(_mm512_castsi512_si256(numers), denom);       \
+        __m256i hi = libdivide_##ALGO##_do_vec256(_mm512_extracti64x4_epi64(numers, 1), denom); \
+        return _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);                           \
+    }
+
+LIBDIVIDE_16_DO_VEC512(u16)
+LIBDIVIDE_16_DO_VEC512(s16)
+LIBDIVIDE_16_DO_VEC512(u16_branchfree)
+LIBDIVIDE_16_DO_VEC512(s16_branchfree)
+
+LIBDIVIDE_AVX512_END
+
+#endif
+
+#if defined(LIBDIVIDE_SSE2_KERNELS)
+
+LIBDIVIDE_SSE2_BEGIN
+
+static LIBDIVIDE_INLINE __m128i libdivide_u16_do_vec128(
+    __m128i numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s16_do_vec128(
+    __m128i numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u32_do_vec128(
+    __m128i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s32_do_vec128(
+    __m128i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u64_do_vec128(
+    __m128i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s64_do_vec128(
+    __m128i numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE __m128i libdivide_u16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s64_branchfree_t *denom);
+
+//////// Internal Utility Functions
+
+static LIBDIVIDE_INLINE __m128i libdivide_s32_signbits_vec128(__m128i v) {
+    return _mm_srai_epi32(v, 31);
+}
+
+// Implementation of _mm_srai_epi64(v, 63) (from AVX512).
+static LIBDIVIDE_INLINE __m128i libdivide_s64_signbits_vec128(__m128i v) {
+    __m128i hiBitsDuped = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i signBits = _mm_srai_epi32(hiBitsDuped, 31);
+    return signBits;
+}
+
+// Implementation of _mm_srai_epi64 (from AVX512).
+static LIBDIVIDE_INLINE __m128i libdivide_s64_shift_right_vec128(__m128i v, int amt) {
+    const int b = 64 - amt;
+    __m128i m = _mm_set1_epi64x(1ULL << (b - 1));
+    __m128i x = _mm_srli_epi64(v, amt);
+    __m128i result = _mm_sub_epi64(_mm_xor_si128(x, m), m);
+    return result;
+}
+
+// Here, b is assumed to contain one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u32_vec128(__m128i a, __m128i b) {
+    __m128i hi_product_0Z2Z = _mm_srli_epi64(_mm_mul_epu32(a, b), 32);
+    __m128i a1X3X = _mm_srli_epi64(a, 32);
+    __m128i mask = _mm_set_epi32(-1, 0, -1, 0);
+    __m128i hi_product_Z1Z3 = _mm_and_si128(_mm_mul_epu32(a1X3X, b), mask);
+    return _mm_or_si128(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// SSE2 does not have a signed multiplication instruction, but we can convert
+// unsigned to signed pretty efficiently. Again, b is just a 32 bit value
+// repeated four times.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s32_vec128(__m128i a, __m128i b) {
+    __m128i p = libdivide_mullhi_u32_vec128(a, b);
+    // t1 = (a >> 31) & y, arithmetic shift
+    __m128i t1 = _mm_and_si128(_mm_srai_epi32(a, 31), b);
+    __m128i t2 = _mm_and_si128(_mm_srai_epi32(b, 31), a);
+    p = _mm_sub_epi32(p, t1);
+    p = _mm_sub_epi32(p, t2);
+    return p;
+}
+
+// Here, y is assumed to contain one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u64_vec128(__m128i x, __m128i y) {
+    // full 128 bits product is:
+    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
+    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
+
+    // Compute x0*y0.
+    // Note x1, y1 are ignored by mul_epu32.
+    __m128i x0y0 = _mm_mul_epu32(x, y);
+    __m128i x0y0_hi = _mm_srli_epi64(x0y0, 32);
+
+    // Get x1, y1 in the low bits.
+    // We could shuffle or right shift. Shuffles are preferred as they preserve
+    // the source register for the next computation.
+    __m128i x1 = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i y1 = _mm_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+
+    // No need to mask off top 32 bits for mul_epu32.
+    __m128i x0y1 = _mm_mul_epu32(x, y1);
+    __m128i x1y0 = _mm_mul_epu32(x1, y);
+    __m128i x1y1 = _mm_mul_epu32(x1, y1);
+
+    // Mask here selects low bits only.
+    __m128i mask = _mm_set1_epi64x(0xFFFFFFFF);
+    __m128i temp = _mm_add_epi64(x1y0, x0y0_hi);
+    __m128i temp_lo = _mm_and_si128(temp, mask);
+    __m128i temp_hi = _mm_srli_epi64(temp, 32);
+
+    temp_lo = _mm_srli_epi64(_mm_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm_add_epi64(x1y1, temp_hi);
+    return _mm_add_epi64(temp_lo, temp_hi);
+}
+
+// y is one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s64_vec128(__m128i x, __m128i y) {
+    __m128i p = libdivide_mullhi_u64_vec128(x, y);
+    __m128i t1 = _mm_and_si128(libdivide_s64_signbits_vec128(x), y);
+    __m128i t2 = _mm_and_si128(libdivide_s64_signbits_vec128(y), x);
+    p = _mm_sub_epi64(p, t1);
+    p = _mm_sub_epi64(p, t2);
+    return p;
+}
+
+// Low 32 bits of the lane-wise 32-bit product, SSE2 lacks _mm_mullo_epi32()
+static LIBDIVIDE_INLINE __m128i libdivide_mullo_u32_vec128(__m128i x, __m128i y) {
+    __m128i even = _mm_mul_epu32(x, y);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+    even = _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0));
+    odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0));
+    return _mm_unpacklo_epi32(even, odd);
+}
+
+// Low 64 bits of the lane-wise 64-bit product
+static LIBDIVIDE_INLINE __m128i libdivide_mullo_u64_vec128(__m128i x, __m128i y) {
+    __m128i x1 = _mm_srli_epi64(x, 32);
+    __m128i y1 = _mm_srli_epi64(y, 32);
+    __m128i cross = _mm_add_epi64(_mm_mul_epu32(x1, y), _mm_mul_epu32(x, y1));
+    return _mm_add_epi64(_mm_mul_epu32(x, y), _mm_slli_epi64(cross, 32));
+}
+
+////////// UINT16
+
+__m128i libdivide_u16_do_vec128(__m128i numers, const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi16(numers, more);
+    } else {
+        __m128i q = _mm_mulhi_epu16(numers, _mm_set1_epi16((short)denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint16_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+            __m128i t = _mm_add_epi16(_mm_srli_epi16(_mm_sub_epi16(numers, q), 1), q);
+            return _mm_srli_epi16(t, shift);
+        } else {
+            return _mm_srli_epi16(q, more);
+        }
+    }
+}
+
+__m128i libdivide_u16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u16_branchfree_t *denom) {
+    __m128i q = _mm_mulhi_epu16(numers, _mm_set1_epi16((short)denom->magic));
+    __m128i t = _mm_add_epi16(_mm_srli_epi16(_mm_sub_epi16(numers, q), 1), q);
+    return _mm_srli_epi16(t, denom->more);
+}
+
+////////// SINT16
+
+__m128i libdivide_s16_do_vec128(__m128i numers, const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        __m128i roundToZeroTweak = _mm_set1_epi16((short)mask);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        __m128i q = _mm_add_epi16(
+            numers, _mm_and_si128(_mm_srai_epi16(numers, 15), roundToZeroTweak));
+        q = _mm_srai_epi16(q, shift);
+        __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi16(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = _mm_mulhi_epi16(numers, _mm_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi16(q, _mm_sub_epi16(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
+        q = _mm_add_epi16(q, _mm_srli_epi16(q, 15));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s16_branchfree_t *denom) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
+    __m128i q = _mm_mulhi_epi16(numers, _mm_set1_epi16(magic));
+    q = _mm_add_epi16(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = _mm_srai_epi16(q, 15);  // q_sign = q >> 15
+    __m128i mask = _mm_set1_epi16((short)(((uint16_t)1 << shift) - is_power_of_2));
+    q = _mm_add_epi16(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm_srai_epi16(q, shift);                  // q >>= shift
+    q = _mm_sub_epi16(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// UINT32
+
+__m128i libdivide_u32_do_vec128(__m128i numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi32(numers, more);
+    } else {
+        __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
+            return _mm_srli_epi32(t, shift);
+        } else {
+            return _mm_srli_epi32(q, more);
+        }
+    }
+}
+
+__m128i libdivide_u32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u32_branchfree_t *denom) {
+    __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
+    __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
+    return _mm_srli_epi32(t, denom->more);
+}
+
+////////// UINT64
+
+__m128i libdivide_u64_do_vec128(__m128i numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi64(numers, more);
+    } else {
+        __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
+            return _mm_srli_epi64(t, shift);
+        } else {
+            return _mm_srli_epi64(q, more);
+        }
+    }
+}
+
+__m128i libdivide_u64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u64_branchfree_t *denom) {
+    __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
+    __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
+    return _mm_srli_epi64(t, denom->more);
+}
+
+////////// SINT32
+
+__m128i libdivide_s32_do_vec128(__m128i numers, const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t mask = (1U << shift) - 1;
+        __m128i roundToZeroTweak = _mm_set1_epi32(mask);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        __m128i q =
+            _mm_add_epi32(numers, _mm_and_si128(_mm_srai_epi32(numers, 31), roundToZeroTweak));
+        q = _mm_srai_epi32(q, shift);
+        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi32(q, _mm_sub_epi32(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = _mm_add_epi32(q, _mm_srli_epi32(q, 31));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s32_branchfree_t *denom) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+    __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(magic));
+    q = _mm_add_epi32(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = _mm_srai_epi32(q, 31);  // q_sign = q >> 31
+    __m128i mask = _mm_set1_epi32((1U << shift) - is_power_of_2);
+    q = _mm_add_epi32(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm_srai_epi32(q, shift);                       // q >>= shift
+    q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT64
+
+__m128i libdivide_s64_do_vec128(__m128i numers, const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    int64_t magic = denom->magic;
+    if (magic == 0) {  // shift path
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t mask = (1ULL << shift) - 1;
+        __m128i roundToZeroTweak = _mm_set1_epi64x(mask);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        __m128i q = _mm_add_epi64(
+            numers, _mm_and_si128(libdivide_s64_signbits_vec128(numers), roundToZeroTweak));
+        q = libdivide_s64_shift_right_vec128(q, shift);
+        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi64(q, _mm_sub_epi64(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= denom->mult_path.shift
+        q = libdivide_s64_shift_right_vec128(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = _mm_add_epi64(q, _mm_srli_epi64(q, 63));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s64_branchfree_t *denom) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+
+    // libdivide_mullhi_s64(numers, magic);
+    __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
+    q = _mm_add_epi64(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint32_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = libdivide_s64_signbits_vec128(q);  // q_sign = q >> 63
+    __m128i mask = _mm_set1_epi64x((1ULL << shift) - is_power_of_2);
+    q = _mm_add_epi64(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_shift_right_vec128(q, shift);     // q >>= shift
+    q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u16, uint16_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s16, int16_t, vec128, __m128i, LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(u16_branchfree, uint16_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s16_branchfree, int16_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(u32, uint32_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s32, int32_t, vec128, __m128i, LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(u64, uint64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s64, int64_t, vec128, __m128i, LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(u32_branchfree, uint32_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s32_branchfree, int32_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(u64_branchfree, uint64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s64_branchfree, int64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+
+LIBDIVIDE_DIVMOD_VEC(u32, uint32_t, vec128, __m128i,
+    _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(s32, int32_t, vec128, __m128i,
+    _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(u64, uint64_t, vec128, __m128i,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(s64, int64_t, vec128, __m128i,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(u32_branchfree, uint32_t, vec128, __m128i,
+    _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(s32_branchfree, int32_t, vec128, __m128i,
+    _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(u64_branchfree, uint64_t, vec128, __m128i,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DIVMOD_VEC(s64_branchfree, int64_t, vec128, __m128i,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64, LIBDIVIDE_LOADU_SI128,
+    LIBDIVIDE_STOREU_SI128)
+
+LIBDIVIDE_ROUNDING_VEC(s32, int32_t, uint32_t, vec128, __m128i,
+    _mm_set1_epi32, _mm_add_epi32, _mm_sub_epi32, _mm_and_si128, _mm_xor_si128,
+    libdivide_s32_signbits_vec128)
+LIBDIVIDE_ROUNDING_VEC(s64, int64_t, uint64_t, vec128, __m128i,
+    _mm_set1_epi64x, _mm_add_epi64, _mm_sub_epi64, _mm_and_si128, _mm_xor_si128,
+    libdivide_s64_signbits_vec128)
+LIBDIVIDE_ROUNDING_VEC(s32_branchfree, int32_t, uint32_t, vec128, __m128i,
+    _mm_set1_epi32, _mm_add_epi32, _mm_sub_epi32, _mm_and_si128, _mm_xor_si128,
+    libdivide_s32_signbits_vec128)
+LIBDIVIDE_ROUNDING_VEC(s64_branchfree, int64_t, uint64_t, vec128, __m128i,
+    _mm_set1_epi64x, _mm_add_epi64, _mm_sub_epi64, _mm_and_si128, _mm_xor_si128,
+    libdivide_s64_signbits_vec128)
+
+////////// DIVISIBILITY
+
+// Returns a mask with all bits set in the lanes that are divisible.
+// Shifting by the full lane width yields 0, so shift == 0 works.
+static LIBDIVIDE_INLINE __m128i libdivide_u32_is_divisible_vec128(
+    __m128i numers, const struct libdivide_u32_divisibility_t *denom) {
+    int shift = denom->shift;
+    __m128i x = libdivide_mullo_u32_vec128(numers, _mm_set1_epi32(denom->inverse));
+    x = _mm_or_si128(_mm_srl_epi32(x, _mm_cvtsi32_si128(shift)),
+        _mm_sll_epi32(x, _mm_cvtsi32_si128(32 - shift)));
+    // Unsigned compare using the signed compare: flip the sign bits
+    __m128i sign = _mm_set1_epi32(INT32_MIN);
+    __m128i threshold = _mm_set1_epi32(denom->threshold ^ (1U << 31));
+    __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(x, sign), threshold);
+    return _mm_xor_si128(gt, _mm_set1_epi32(-1));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_u64_is_divisible_vec128(
+    __m128i numers, const struct libdivide_u64_divisibility_t *denom) {
+    int shift = denom->shift;
+    __m128i x = libdivide_mullo_u64_vec128(numers, _mm_set1_epi64x(denom->inverse));
+    x = _mm_or_si128(_mm_srl_epi64(x, _mm_cvtsi32_si128(shift)),
+        _mm_sll_epi64(x, _mm_cvtsi32_si128(64 - shift)));
+    // SSE2 has no 64-bit compare: x > threshold if the high halves
+    // compare greater, or they are equal and the low halves compare
+    // greater (all halves compared as unsigned).
+    __m128i threshold = _mm_set1_epi64x(denom->threshold);
+    __m128i sign = _mm_set1_epi32(INT32_MIN);
+    __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(x, sign), _mm_xor_si128(threshold, sign));
+    __m128i eq = _mm_cmpeq_epi32(x, threshold);
+    __m128i gt_hi = _mm_shuffle_epi32(gt, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i gt_lo = _mm_shuffle_epi32(gt, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128i eq_hi = _mm_shuffle_epi32(eq, _MM_SHUFFLE(3, 3, 1, 1));
+    gt = _mm_or_si128(gt_hi, _mm_and_si128(eq_hi, gt_lo));
+    return _mm_xor_si128(gt, _mm_set1_epi32(-1));
+}
+
+////////// EXACT DIVISION
+
+// See libdivide_u32_exact_do()
+static LIBDIVIDE_INLINE __m128i libdivide_u32_exact_do_vec128(
+    __m128i numers, const struct libdivide_u32_exact_t *denom) {
+    __m128i q = _mm_srli_epi32(numers, denom->shift);
+    return libdivide_mullo_u32_vec128(q, _mm_set1_epi32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_s32_exact_do_vec128(
+    __m128i numers, const struct libdivide_s32_exact_t *denom) {
+    __m128i q = _mm_srai_epi32(numers, denom->shift);
+    return libdivide_mullo_u32_vec128(q, _mm_set1_epi32(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_u64_exact_do_vec128(
+    __m128i numers, const struct libdivide_u64_exact_t *denom) {
+    __m128i q = _mm_srli_epi64(numers, denom->shift);
+    return libdivide_mullo_u64_vec128(q, _mm_set1_epi64x(denom->inverse));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_s64_exact_do_vec128(
+    __m128i numers, const struct libdivide_s64_exact_t *denom) {
+    __m128i q = libdivide_s64_shift_right_vec128(numers, denom->shift);
+    return libdivide_mullo_u64_vec128(q, _mm_set1_epi64x(denom->inverse));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_exact, uint32_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s32_exact, int32_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(u64_exact, uint64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s64_exact, int64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+
+////////// FASTMOD
+
+// Computes the remainders of the even 32-bit lanes, which are
+// returned in the low halves of the 64-bit lanes.
+// See libdivide_u32_mod_do().
+static LIBDIVIDE_INLINE __m128i libdivide_u32_mod_half_vec128(
+    __m128i numers, __m128i m_lo, __m128i m_hi, __m128i d) {
+    __m128i lowbits = _mm_add_epi64(
+        _mm_mul_epu32(numers, m_lo), _mm_slli_epi64(_mm_mul_epu32(numers, m_hi), 32));
+    __m128i lo = _mm_srli_epi64(_mm_mul_epu32(lowbits, d), 32);
+    __m128i hi = _mm_mul_epu32(_mm_srli_epi64(lowbits, 32), d);
+    return _mm_srli_epi64(_mm_add_epi64(hi, lo), 32);
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_u32_mod_do_vec128(
+    __m128i numers, const struct libdivide_u32_mod_t *denom) {
+    __m128i m_lo = _mm_set1_epi32((uint32_t)denom->M);
+    __m128i m_hi = _mm_set1_epi32((uint32_t)(denom->M >> 32));
+    __m128i d = _mm_set1_epi32(denom->d);
+    __m128i even = libdivide_u32_mod_half_vec128(numers, m_lo, m_hi, d);
+    __m128i odd = libdivide_u32_mod_half_vec128(_mm_srli_epi64(numers, 32), m_lo, m_hi, d);
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u32_mod, uint32_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+
+////////// 52-BIT
+
+// See libdivide_u52_do(). With AVX512 IFMA the numerator is added
+// to the 52-bit high product by the multiply instruction itself.
+static LIBDIVIDE_INLINE __m128i libdivide_u52_do_vec128(
+    __m128i numers, const struct libdivide_u52_t *denom) {
+    __m128i magic = _mm_set1_epi64x(denom->magic);
+#if defined(__AVX512IFMA__) && defined(__AVX512VL__)
+    __m128i q = _mm_madd52hi_epu64(numers, numers, magic);
+#else
+    __m128i q = libdivide_mullhi_u64_vec128(_mm_slli_epi64(numers, 12), magic);
+    q = _mm_add_epi64(q, numers);
+#endif
+    return _mm_srli_epi64(q, denom->more);
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_s52_do_vec128(
+    __m128i numers, const struct libdivide_s52_t *denom) {
+    uint8_t more = denom->more;
+    __m128i magic = _mm_set1_epi64x(denom->magic);
+    __m128i sign = libdivide_s64_signbits_vec128(numers);
+    __m128i absN = _mm_sub_epi64(_mm_xor_si128(numers, sign), sign);
+#if defined(__AVX512IFMA__) && defined(__AVX512VL__)
+    __m128i q = _mm_madd52hi_epu64(absN, absN, magic);
+#else
+    __m128i q = libdivide_mullhi_u64_vec128(_mm_slli_epi64(absN, 12), magic);
+    q = _mm_add_epi64(q, absN);
+#endif
+    q = _mm_srli_epi64(q, more & LIBDIVIDE_64_SHIFT_MASK);
+    sign = _mm_xor_si128(sign, _mm_set1_epi32((int8_t)more >> 7));
+    return _mm_sub_epi64(_mm_xor_si128(q, sign), sign);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u52, uint64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+LIBDIVIDE_DO_ARRAY_VEC(s52, int64_t, vec128, __m128i, LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+
+////////// NARROW 64-BIT
+
+// See libdivide_u64_narrow_do()
+static LIBDIVIDE_INLINE __m128i libdivide_u64_narrow_do_vec128(
+    __m128i numers, const struct libdivide_u64_narrow_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi64(numers, more);
+    }
+    __m128i q = _mm_srli_epi64(_mm_mul_epu32(numers, _mm_set1_epi32(denom->magic)), 32);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
+        return _mm_srli_epi64(t, more & LIBDIVIDE_32_SHIFT_MASK);
+    }
+    return _mm_srli_epi64(q, more);
+}
+
+LIBDIVIDE_DO_ARRAY_VEC(u64_narrow, uint64_t, vec128, __m128i,
+    LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STOREU_SI128)
+
+// Adds the 32-bit quotients of q to the 64-bit sums of acc
+static LIBDIVIDE_INLINE __m128i libdivide_sum_u32_vec128(__m128i acc, __m128i q) {
+    __m128i lo = _mm_and_si128(q, _mm_set1_epi64x(0xFFFFFFFF));
+    return _mm_add_epi64(acc, _mm_add_epi64(lo, _mm_srli_epi64(q, 32)));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_sum_s32_vec128(__m128i acc, __m128i q) {
+    return libdivide_sum_u32_vec128(acc, _mm_xor_si128(q, _mm_set1_epi32(INT32_MIN)));
+}
+
+// Adds the 16-bit quotients pairwise to 32-bit lanes first
+static LIBDIVIDE_INLINE __m128i libdivide_sum_u16_vec128(__m128i acc, __m128i q) {
+    __m128i lo = _mm_and_si128(q, _mm_set1_epi32(0xFFFF));
+    return libdivide_sum_u32_vec128(acc, _mm_add_epi32(lo, _mm_srli_epi32(q, 16)));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_sum_s16_vec128(__m128i acc, __m128i q) {
+    return libdivide_sum_u16_vec128(acc, _mm_xor_si128(q, _mm_set1_epi16(INT16_MIN)));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_sum_u64_vec128(__m128i acc, __m128i q) {
+    return _mm_add_epi64(acc, q);
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_reduce_sums_vec128(
+    __m128i acc0, __m128i acc1, __m128i acc2, __m128i acc3) {
+    uint64_t sums[2];
+    __m128i acc = _mm_add_epi64(_mm_add_epi64(acc0, acc1), _mm_add_epi64(acc2, acc3));
+    _mm_storeu_si128((__m128i *)sums, acc);
+    return sums[0] + sums[1];
+}
+
+#define LIBDIVIDE_SUM_QUOTIENTS_VEC128(ALGO, T, S, ACCUMULATE, BIAS)                         \
+    LIBDIVIDE_SUM_QUOTIENTS_VEC(ALGO, T, S, vec128, __m128i, __m128i, LIBDIVIDE_LOADU_SI128, \
+        _mm_setzero_si128(), ACCUMULATE, BIAS)
+
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(u16, uint16_t, uint64_t, libdivide_sum_u16_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(s16, int16_t, int64_t, libdivide_sum_s16_vec128, 1u << 15)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(u16_branchfree, uint16_t, uint64_t, libdivide_sum_u16_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(s16_branchfree, int16_t, int64_t, libdivide_sum_s16_vec128, 1u << 15)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(u32, uint32_t, uint64_t, libdivide_sum_u32_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(s32, int32_t, int64_t, libdivide_sum_s32_vec128, 1u << 31)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(u64, uint64_t, uint64_t, libdivide_sum_u64_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(s64, int64_t, int64_t, libdivide_sum_u64_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(u32_branchfree, uint32_t, uint64_t, libdivide_sum_u32_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(s32_branchfree, int32_t, int64_t, libdivide_sum_s32_vec128, 1u << 31)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(u64_branchfree, uint64_t, uint64_t, libdivide_sum_u64_vec128, 0)
+LIBDIVIDE_SUM_QUOTIENTS_VEC128(s64_branchfree, int64_t, int64_t, libdivide_sum_u64_vec128, 0)
+
+#define LIBDIVIDE_DO_ARRAY_STREAM_VEC128(ALGO, T) \
+    LIBDIVIDE_DO_ARRAY_STREAM_VEC(                \
+        ALGO, T, vec128, __m128i, LIBDIVIDE_LOADU_SI128, LIBDIVIDE_STREAM_SI128)
+
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(s16, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM_VEC128(s64_branchfree, int64_t)
+
+LIBDIVIDE_SSE2_END
+
+#endif
+
+///////////// ARRAY DISPATCH
+
+#if defined(LIBDIVIDE_DISPATCH_X86)
+
+// With LIBDIVIDE_DISPATCH libdivide_*_do_array() detects the
+// widest vector instruction set supported by the CPU upon its
+// first call and then caches the selected kernel in a function
+// pointer, hence subsequent calls are a single indirect call.
+
+enum libdivide_isa {
+    LIBDIVIDE_ISA_SCALAR = 0,
+    LIBDIVIDE_ISA_SSE2 = 1,
+    LIBDIVIDE_ISA_AVX2 = 2,
+    LIBDIVIDE_ISA_AVX512 = 3
+};
+
+// Returns the widest vector instruction set supported by the CPU
+// (and operating system) that libdivide has kernels for.
+static inline enum libdivide_isa libdivide_cpu_isa(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return LIBDIVIDE_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return LIBDIVIDE_ISA_AVX2;
+    if (__builtin_cpu_supports("sse2")) return LIBDIVIDE_ISA_SSE2;
+    return LIBDIVIDE_ISA_SCALAR;
+}
+
+// Generates the array function NAME which forwards to NAME##_vec512,
+// NAME##_vec256, NAME##_vec128 or NAME##_scalar. The function pointer
+// is initialized to a resolver which selects the kernel, stores it
+// and forwards the call. Concurrent first calls may all resolve, but
+// they store the same value.
+#define LIBDIVIDE_ARRAY_FUNC(NAME, PARAMS, ARGS)                          \
+    typedef void(*NAME##_t) PARAMS;                                       \
+    static void NAME##_resolve PARAMS;                                    \
+    static NAME##_t NAME##_ptr = NAME##_resolve;                          \
+    static void NAME##_resolve PARAMS {                                   \
+        NAME##_t kernel;                                                  \
+        switch (libdivide_cpu_isa()) {                                    \
+            case LIBDIVIDE_ISA_AVX512:                                    \
+                kernel = NAME##_vec512;                                   \
+                break;                                                    \
+            case LIBDIVIDE_ISA_AVX2:                                      \
+                kernel = NAME##_vec256;                                   \
+                break;                                                    \
+            case LIBDIVIDE_ISA_SSE2:                                      \
+                kernel = NAME##_vec128;                                   \
+                break;                                                    \
+            default:                                                      \
+                kernel = NAME##_scalar;                                   \
+                break;                                                    \
+        }                                                                 \
+        __atomic_store_n(&NAME##_ptr, kernel, __ATOMIC_RELAXED);          \
+        kernel ARGS;                                                      \
+    }                                                                     \
+    static inline void NAME PARAMS {                                      \
+        NAME##_t kernel = __atomic_load_n(&NAME##_ptr, __ATOMIC_RELAXED); \
+        kernel ARGS;                                                      \
+    }
+
+#else
+
+// The array functions forward to the widest vector
+// instruction set that has been enabled.
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_ARRAY_BEST vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_ARRAY_BEST vec256
+#elif defined(LIBDIVIDE_SVE)
+#define LIBDIVIDE_ARRAY_BEST sve
+#elif defined(LIBDIVIDE_RVV)
+#define LIBDIVIDE_ARRAY_BEST rvv
+#elif defined(LIBDIVIDE_SSE2) || defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_ARRAY_BEST vec128
+#else
+#define LIBDIVIDE_ARRAY_BEST scalar
+#endif
+
+#define LIBDIVIDE_ARRAY_CAT(NAME, VEC) NAME##_##VEC
+#define LIBDIVIDE_ARRAY_IMPL(NAME, VEC) LIBDIVIDE_ARRAY_CAT(NAME, VEC)
+
+// Generates the array function NAME which forwards to NAME##_<best ISA>
+#define LIBDIVIDE_ARRAY_FUNC(NAME, PARAMS, ARGS) \
+    static inline void NAME PARAMS { LIBDIVIDE_ARRAY_IMPL(NAME, LIBDIVIDE_ARRAY_BEST) ARGS; }
+
+#endif
+
+#define LIBDIVIDE_DO_ARRAY_FORWARD(ALGO, T, VEC, TO)                                     \
+    static inline void libdivide_##ALGO##_do_array_##VEC(const T *numers, T *quotients, \
+        size_t count, const struct libdivide_##ALGO##_t *denom) {                        \
+        libdivide_##ALGO##_do_array_##TO(numers, quotients, count, denom);               \
+    }
+
+#if defined(LIBDIVIDE_SVE)
+// There is no SVE fastmod kernel, SVE CPUs also support NEON
+#if defined(LIBDIVIDE_NEON)
+LIBDIVIDE_DO_ARRAY_FORWARD(u32_mod, uint32_t, sve, vec128)
+#else
+LIBDIVIDE_DO_ARRAY_FORWARD(u32_mod, uint32_t, sve, scalar)
+#endif
+#endif
+
+#if defined(LIBDIVIDE_NEON)
+// The narrow 64-bit dividers only have x86 kernels
+LIBDIVIDE_DO_ARRAY_FORWARD(u64_narrow, uint64_t, vec128, scalar)
+#endif
+#if defined(LIBDIVIDE_SVE)
+LIBDIVIDE_DO_ARRAY_FORWARD(u64_narrow, uint64_t, sve, scalar)
+#endif
+
+#if defined(LIBDIVIDE_RVV)
+// RVV only has kernels for the regular dividers
+LIBDIVIDE_DO_ARRAY_FORWARD(u64_narrow, uint64_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_FORWARD(u32_mod, uint32_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_FORWARD(u52, uint64_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_FORWARD(s52, int64_t, rvv, scalar)
+#endif
+
+#define LIBDIVIDE_DO_ARRAY(ALGO, T)                                                              \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_do_array,                                            \
+        (const T *numers, T *quotients, size_t count, const struct libdivide_##ALGO##_t *denom), \
+        (numers, quotients, count, denom))
+
+#define LIBDIVIDE_DIVMOD_ARRAY(ALGO, T)                        \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_divmod_array,      \
+        (const T *numers, T *quotients, T *rems, size_t count, \
+            const struct libdivide_##ALGO##_divmod_t *denom),  \
+        (numers, quotients, rems, count, denom))
+
+LIBDIVIDE_DO_ARRAY(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY(s16, int16_t)
+LIBDIVIDE_DO_ARRAY(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY(s32, int32_t)
+LIBDIVIDE_DO_ARRAY(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY(s64, int64_t)
+LIBDIVIDE_DO_ARRAY(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY(s64_branchfree, int64_t)
+LIBDIVIDE_DO_ARRAY(u32_mod, uint32_t)
+LIBDIVIDE_DO_ARRAY(u52, uint64_t)
+LIBDIVIDE_DO_ARRAY(u64_narrow, uint64_t)
+LIBDIVIDE_DO_ARRAY(s52, int64_t)
+LIBDIVIDE_DO_ARRAY(u32_exact, uint32_t)
+LIBDIVIDE_DO_ARRAY(s32_exact, int32_t)
+LIBDIVIDE_DO_ARRAY(u64_exact, uint64_t)
+LIBDIVIDE_DO_ARRAY(s64_exact, int64_t)
+
+LIBDIVIDE_DIVMOD_ARRAY(u32, uint32_t)
+LIBDIVIDE_DIVMOD_ARRAY(s32, int32_t)
+LIBDIVIDE_DIVMOD_ARRAY(u64, uint64_t)
+LIBDIVIDE_DIVMOD_ARRAY(s64, int64_t)
+LIBDIVIDE_DIVMOD_ARRAY(u32_branchfree, uint32_t)
+LIBDIVIDE_DIVMOD_ARRAY(s32_branchfree, int32_t)
+LIBDIVIDE_DIVMOD_ARRAY(u64_branchfree, uint64_t)
+LIBDIVIDE_DIVMOD_ARRAY(s64_branchfree, int64_t)
+
+// The gen arrays only have AVX512 kernels, the other
+// instruction sets use the scalar gen functions.
+#define LIBDIVIDE_GEN_ARRAY_FORWARD(ALGO, T, VEC, TO)                             \
+    static inline void libdivide_##ALGO##_gen_array_##VEC(                        \
+        const T *divisors, struct libdivide_##ALGO##_t *dividers, size_t count) { \
+        libdivide_##ALGO##_gen_array_##TO(divisors, dividers, count);             \
+    }
+
+#if !defined(LIBDIVIDE_AVX512_KERNELS)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32, uint32_t, vec512, scalar)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32_branchfree, uint32_t, vec512, scalar)
+#endif
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32, uint32_t, vec256, scalar)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32_branchfree, uint32_t, vec256, scalar)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32, uint32_t, vec128, scalar)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32_branchfree, uint32_t, vec128, scalar)
+#if defined(LIBDIVIDE_SVE)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32, uint32_t, sve, scalar)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32_branchfree, uint32_t, sve, scalar)
+#endif
+#if defined(LIBDIVIDE_RVV)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32, uint32_t, rvv, scalar)
+LIBDIVIDE_GEN_ARRAY_FORWARD(u32_branchfree, uint32_t, rvv, scalar)
+#endif
+
+#define LIBDIVIDE_GEN_ARRAY(ALGO, T)                                              \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_gen_array,                            \
+        (const T *divisors, struct libdivide_##ALGO##_t *dividers, size_t count), \
+        (divisors, dividers, count))
+
+LIBDIVIDE_GEN_ARRAY(u32, uint32_t)
+LIBDIVIDE_GEN_ARRAY(u32_branchfree, uint32_t)
+
+// The per-lane divisors need variable shifts, hence
+// there are no SSE2 and NEON kernels. SVE and RVV use the scalar loop.
+#define LIBDIVIDE_DO_ARRAY_LANES_FORWARD(ALGO, T, VEC, TO)                               \
+    static inline void libdivide_##ALGO##_do_array_lanes_##VEC(const T *numers,          \
+        T *quotients, size_t count, const T *magics, const uint8_t *mores) {             \
+        libdivide_##ALGO##_do_array_lanes_##TO(numers, quotients, count, magics, mores); \
+    }
+
+#if !defined(LIBDIVIDE_AVX512_KERNELS)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u32, uint32_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32, int32_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32_branchfree, int32_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u64, uint64_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64, int64_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64_branchfree, int64_t, vec512, scalar)
+#endif
+#if !defined(LIBDIVIDE_AVX2_KERNELS)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u32, uint32_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32, int32_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32_branchfree, int32_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u64, uint64_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64, int64_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64_branchfree, int64_t, vec256, scalar)
+#endif
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u32, uint32_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32, int32_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32_branchfree, int32_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u64, uint64_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64, int64_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64_branchfree, int64_t, vec128, scalar)
+#if defined(LIBDIVIDE_SVE)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u32, uint32_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32, int32_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32_branchfree, int32_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u64, uint64_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64, int64_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64_branchfree, int64_t, sve, scalar)
+#endif
+#if defined(LIBDIVIDE_RVV)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u32, uint32_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32, int32_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s32_branchfree, int32_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(u64, uint64_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64, int64_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_LANES_FORWARD(s64_branchfree, int64_t, rvv, scalar)
+#endif
+
+#define LIBDIVIDE_DO_ARRAY_LANES(ALGO, T)                              \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_do_array_lanes,            \
+        (const T *numers, T *quotients, size_t count, const T *magics, \
+            const uint8_t *mores),                                     \
+        (numers, quotients, count, magics, mores))
+
+LIBDIVIDE_DO_ARRAY_LANES(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_LANES(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_LANES(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_LANES(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_LANES(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_LANES(s64_branchfree, int64_t)
+
+#define LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(ALGO, T, VEC, TO)                                \
+    static inline void libdivide_##ALGO##_do_array_packed_##VEC(const T *numers,           \
+        T *quotients, size_t count, const struct libdivide_##ALGO##_t *table,              \
+        const uint32_t *indices) {                                                         \
+        libdivide_##ALGO##_do_array_packed_##TO(numers, quotients, count, table, indices); \
+    }
+
+#if !defined(LIBDIVIDE_AVX512_KERNELS)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(u32, uint32_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32, int32_t, vec512, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32_branchfree, int32_t, vec512, scalar)
+#endif
+#if !defined(LIBDIVIDE_AVX2_KERNELS)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(u32, uint32_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32, int32_t, vec256, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32_branchfree, int32_t, vec256, scalar)
+#endif
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(u32, uint32_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32, int32_t, vec128, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32_branchfree, int32_t, vec128, scalar)
+#if defined(LIBDIVIDE_SVE)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(u32, uint32_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32, int32_t, sve, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32_branchfree, int32_t, sve, scalar)
+#endif
+#if defined(LIBDIVIDE_RVV)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(u32, uint32_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32, int32_t, rvv, scalar)
+LIBDIVIDE_DO_ARRAY_PACKED_FORWARD(s32_branchfree, int32_t, rvv, scalar)
+#endif
+
+#define LIBDIVIDE_DO_ARRAY_PACKED(ALGO, T)                                      \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_do_array_packed,                    \
+        (const T *numers, T *quotients, size_t count,                           \
+            const struct libdivide_##ALGO##_t *table, const uint32_t *indices), \
+        (numers, quotients, count, table, indices))
+
+LIBDIVIDE_DO_ARRAY_PACKED(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_PACKED(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_PACKED(s32_branchfree, int32_t)
+
+#if defined(LIBDIVIDE_SVE)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u16, uint16_t, uint64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s16, int16_t, int64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u16_branchfree, uint16_t, uint64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s16_branchfree, int16_t, int64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u32, uint32_t, uint64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s32, int32_t, int64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u64, uint64_t, uint64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s64, int64_t, int64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u32_branchfree, uint32_t, uint64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s32_branchfree, int32_t, int64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u64_branchfree, uint64_t, uint64_t, sve)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s64_branchfree, int64_t, int64_t, sve)
+#endif
+#if defined(LIBDIVIDE_RVV)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u16, uint16_t, uint64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s16, int16_t, int64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u16_branchfree, uint16_t, uint64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s16_branchfree, int16_t, int64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u32, uint32_t, uint64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s32, int32_t, int64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u64, uint64_t, uint64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s64, int64_t, int64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u32_branchfree, uint32_t, uint64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s32_branchfree, int32_t, int64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(u64_branchfree, uint64_t, uint64_t, rvv)
+LIBDIVIDE_SUM_QUOTIENTS_BLOCKED(s64_branchfree, int64_t, int64_t, rvv)
+#endif
+
+#define LIBDIVIDE_SUM_QUOTIENTS(ALGO, T, S)                                                \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_sum_quotients,                                 \
+        (const T *numers, size_t count, const struct libdivide_##ALGO##_t *denom, S *sum), \
+        (numers, count, denom, sum))
+
+LIBDIVIDE_SUM_QUOTIENTS(u16, uint16_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS(s16, int16_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS(u16_branchfree, uint16_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS(s16_branchfree, int16_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS(u32, uint32_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS(s32, int32_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS(u64, uint64_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS(s64, int64_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS(u32_branchfree, uint32_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS(s32_branchfree, int32_t, int64_t)
+LIBDIVIDE_SUM_QUOTIENTS(u64_branchfree, uint64_t, uint64_t)
+LIBDIVIDE_SUM_QUOTIENTS(s64_branchfree, int64_t, int64_t)
+
+// libdivide_*_min_max_quotients() stores the minimum and the maximum
+// quotient of count > 0 numerators. The quotient is monotonic in the
+// numerator (non-decreasing for a positive divisor, non-increasing for
+// a negative one), hence the loop only compares the numerators and
+// then the minimum and the maximum numerators are divided.
+#define LIBDIVIDE_MIN_MAX_QUOTIENTS(ALGO, T)                                      \
+    static inline void libdivide_##ALGO##_min_max_quotients(const T *numers,      \
+        size_t count, const struct libdivide_##ALGO##_t *denom, T *min, T *max) { \
+        T lo = numers[0], hi = numers[0], q0, q1;                                 \
+        for (size_t i = 1; i < count; i++) {                                      \
+            lo = numers[i] < lo ? numers[i] : lo;                                 \
+            hi = numers[i] > hi ? numers[i] : hi;                                 \
+        }                                                                         \
+        q0 = libdivide_##ALGO##_do(lo, denom);                                    \
+        q1 = libdivide_##ALGO##_do(hi, denom);                                    \
+        *min = q0 < q1 ? q0 : q1;                                                 \
+        *max = q0 < q1 ? q1 : q0;                                                 \
+    }
+
+// libdivide_*_histogram_quotients() increments bins[numers[i] / d] for
+// the count numerators, bucketing them by a width of d. The quotients
+// >= num_bins are counted in the last bin (num_bins must be > 0). The
+// bins are not cleared, so that several arrays can be accumulated.
+// Blocks of LIBDIVIDE_REDUCE_BLOCK numerators are divided using
+// libdivide_*_do_array() into a buffer on the stack, which stays in the
+// L1 cache, the increments are scalar. Only unsigned dividers are
+// supported.
+#define LIBDIVIDE_HISTOGRAM_QUOTIENTS(ALGO, T)                                                  \
+    static inline void libdivide_##ALGO##_histogram_quotients(const T *numers, size_t count,    \
+        const struct libdivide_##ALGO##_t *denom, uint32_t *bins, size_t num_bins) {            \
+        T block[LIBDIVIDE_REDUCE_BLOCK];                                                        \
+        for (size_t i = 0; i < count; i += LIBDIVIDE_REDUCE_BLOCK) {                            \
+            size_t n = count - i < LIBDIVIDE_REDUCE_BLOCK ? count - i : LIBDIVIDE_REDUCE_BLOCK; \
+            libdivide_##ALGO##_do_array(numers + i, block, n, denom);                           \
+            for (size_t j = 0; j < n; j++) {                                                    \
+                uint64_t q = block[j];                                                          \
+                bins[q < num_bins - 1 ? (size_t)q : num_bins - 1]++;                            \
+            }                                                                                   \
+        }                                                                                       \
+    }
+
+LIBDIVIDE_MIN_MAX_QUOTIENTS(u16, uint16_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(s16, int16_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(u16_branchfree, uint16_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(s16_branchfree, int16_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(u32, uint32_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(s32, int32_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(u64, uint64_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(s64, int64_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(u32_branchfree, uint32_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(s32_branchfree, int32_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(u64_branchfree, uint64_t)
+LIBDIVIDE_MIN_MAX_QUOTIENTS(s64_branchfree, int64_t)
+
+LIBDIVIDE_HISTOGRAM_QUOTIENTS(u16, uint16_t)
+LIBDIVIDE_HISTOGRAM_QUOTIENTS(u16_branchfree, uint16_t)
+LIBDIVIDE_HISTOGRAM_QUOTIENTS(u32, uint32_t)
+LIBDIVIDE_HISTOGRAM_QUOTIENTS(u64, uint64_t)
+LIBDIVIDE_HISTOGRAM_QUOTIENTS(u32_branchfree, uint32_t)
+LIBDIVIDE_HISTOGRAM_QUOTIENTS(u64_branchfree, uint64_t)
+
+// There are no non-temporal stores on the other instruction sets,
+// the stream functions divide the arrays using the regular kernels.
+#define LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(ALGO, T, VEC)                          \
+    static inline void libdivide_##ALGO##_do_array_stream_##VEC(const T *numers, \
+        T *quotients, size_t count, const struct libdivide_##ALGO##_t *denom) {  \
+        libdivide_##ALGO##_do_array_##VEC(numers, quotients, count, denom);      \
+    }
+
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16, uint16_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16, int16_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16_branchfree, uint16_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16_branchfree, int16_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32, uint32_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32, int32_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64, uint64_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64, int64_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32_branchfree, uint32_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32_branchfree, int32_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64_branchfree, uint64_t, scalar)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64_branchfree, int64_t, scalar)
+#if defined(LIBDIVIDE_NEON)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16, uint16_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16, int16_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16_branchfree, uint16_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16_branchfree, int16_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32, uint32_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32, int32_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64, uint64_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64, int64_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32_branchfree, uint32_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32_branchfree, int32_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64_branchfree, uint64_t, vec128)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64_branchfree, int64_t, vec128)
+#endif
+#if defined(LIBDIVIDE_SVE)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16, uint16_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16, int16_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16_branchfree, uint16_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16_branchfree, int16_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32, uint32_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32, int32_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64, uint64_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64, int64_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32_branchfree, uint32_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32_branchfree, int32_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64_branchfree, uint64_t, sve)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64_branchfree, int64_t, sve)
+#endif
+#if defined(LIBDIVIDE_RVV)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16, uint16_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16, int16_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u16_branchfree, uint16_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s16_branchfree, int16_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32, uint32_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32, int32_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64, uint64_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64, int64_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u32_branchfree, uint32_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s32_branchfree, int32_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(u64_branchfree, uint64_t, rvv)
+LIBDIVIDE_DO_ARRAY_STREAM_FORWARD(s64_branchfree, int64_t, rvv)
+#endif
+
+#define LIBDIVIDE_DO_ARRAY_STREAM(ALGO, T)                                                       \
+    LIBDIVIDE_ARRAY_FUNC(libdivide_##ALGO##_do_array_stream,                                     \
+        (const T *numers, T *quotients, size_t count, const struct libdivide_##ALGO##_t *denom), \
+        (numers, quotients, count, denom))
+
+LIBDIVIDE_DO_ARRAY_STREAM(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM(s16, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY_STREAM(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY_STREAM(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_STREAM(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY_STREAM(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_STREAM(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY_STREAM(s64_branchfree, int64_t)
+
+///////////// DIVIDER TABLES
+
+// A table of count dividers is libdivide_table_size(type, count) bytes,
+// the dividers are stored at offset LIBDIVIDE_TABLE_HEADER_SIZE so that
+// a mapped table can be used in place. libdivide_table_read() rejects
+// tables of another type, byte order or LIBDIVIDE_VERSION_MAJOR.
+
+size_t libdivide_table_entry_size(enum libdivide_table_type type) {
+    switch (type) {
+        case LIBDIVIDE_TABLE_U16:
+        case LIBDIVIDE_TABLE_S16:
+        case LIBDIVIDE_TABLE_U16_BRANCHFREE:
+        case LIBDIVIDE_TABLE_S16_BRANCHFREE:
+            return sizeof(struct libdivide_u16_t);
+        case LIBDIVIDE_TABLE_U32:
+        case LIBDIVIDE_TABLE_S32:
+        case LIBDIVIDE_TABLE_U32_BRANCHFREE:
+        case LIBDIVIDE_TABLE_S32_BRANCHFREE:
+            return sizeof(struct libdivide_u32_t);
+        case LIBDIVIDE_TABLE_U64:
+        case LIBDIVIDE_TABLE_S64:
+        case LIBDIVIDE_TABLE_U64_BRANCHFREE:
+        case LIBDIVIDE_TABLE_S64_BRANCHFREE:
+            return sizeof(struct libdivide_u64_t);
+    }
+    LIBDIVIDE_ERROR("invalid table type");
+    return 0;
+}
+
+size_t libdivide_table_size(enum libdivide_table_type type, size_t count) {
+    size_t entry_size = libdivide_table_entry_size(type);
+    if (count > (SIZE_MAX - LIBDIVIDE_TABLE_HEADER_SIZE) / entry_size) {
+        LIBDIVIDE_ERROR("table too large");
+    }
+    return LIBDIVIDE_TABLE_HEADER_SIZE + count * entry_size;
+}
+
+static LIBDIVIDE_INLINE struct libdivide_table_header libdivide_internal_table_header(
+    enum libdivide_table_type type, size_t count) {
+    struct libdivide_table_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "LIBDIVT", 8);
+    header.byte_order = LIBDIVIDE_TABLE_BYTE_ORDER;
+    header.format = LIBDIVIDE_TABLE_FORMAT;
+    header.version_major = LIBDIVIDE_VERSION_MAJOR;
+    header.version_minor = LIBDIVIDE_VERSION_MINOR;
+    header.type = (uint8_t)type;
+    header.entry_size = (uint8_t)libdivide_table_entry_size(type);
+    header.count = count;
+    return header;
+}
+
+size_t libdivide_table_write(
+    void *buffer, enum libdivide_table_type type, const void *dividers, size_t count) {
+    struct libdivide_table_header header = libdivide_internal_table_header(type, count);
+    size_t size = libdivide_table_size(type, count);
+    memcpy(buffer, &header, sizeof(header));
+    if (count > 0) {
+        memcpy((char *)buffer + LIBDIVIDE_TABLE_HEADER_SIZE, dividers, count * header.entry_size);
+    }
+    return size;
+}
+
+const void *libdivide_table_read(
+    const void *data, size_t size, enum libdivide_table_type type, size_t *count) {
+    struct libdivide_table_header header;
+    size_t entry_size = libdivide_table_entry_size(type);
+    if (size < LIBDIVIDE_TABLE_HEADER_SIZE) return NULL;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "LIBDIVT", 8) != 0 ||
+        header.byte_order != LIBDIVIDE_TABLE_BYTE_ORDER ||
+        header.format != LIBDIVIDE_TABLE_FORMAT ||
+        header.version_major != LIBDIVIDE_VERSION_MAJOR || header.type != (uint8_t)type ||
+        header.entry_size != entry_size ||
+        header.count > (size - LIBDIVIDE_TABLE_HEADER_SIZE) / entry_size) {
+        return NULL;
+    }
+    *count = (size_t)header.count;
+    return (const char *)data + LIBDIVIDE_TABLE_HEADER_SIZE;
+}
+
+// Returns 0 on success, -1 if the file cannot be written
+int libdivide_table_save(
+    const char *path, enum libdivide_table_type type, const void *dividers, size_t count) {
+    struct libdivide_table_header header = libdivide_internal_table_header(type, count);
+    FILE *file = fopen(path, "wb");
+    int ok;
+    if (!file) return -1;
+    ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && count > 0) ok = fwrite(dividers, header.entry_size, count, file) == count;
+    if (fclose(file) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+#if defined(LIBDIVIDE_MMAP)
+
+// Maps a table saved by libdivide_table_save() read-only, all the
+// processes mapping the same file share its page cache pages. Returns
+// 0 on success, -1 if the file cannot be mapped or is not a valid table.
+int libdivide_table_map(
+    const char *path, enum libdivide_table_type type, struct libdivide_table_mapping *mapping) {
+    struct stat st;
+    void *addr;
+    size_t size;
+    int fd = open(path, O_RDONLY);
+    memset(mapping, 0, sizeof(*mapping));
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || st.st_size < LIBDIVIDE_TABLE_HEADER_SIZE) {
+        close(fd);
+        return -1;
+    }
+    size = (size_t)st.st_size;
+    addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return -1;
+    mapping->dividers = libdivide_table_read(addr, size, type, &mapping->count);
+    if (!mapping->dividers) {
+        munmap(addr, size);
+        mapping->count = 0;
+        return -1;
+    }
+    mapping->addr = addr;
+    mapping->size = size;
+    return 0;
+}
+
+void libdivide_table_unmap(struct libdivide_table_mapping *mapping) {
+    if (mapping->addr) munmap(mapping->addr, mapping->size);
+    memset(mapping, 0, sizeof(*mapping));
+}
+
+#endif
+
+/////////// C++ stuff
+
+#ifdef __cplusplus
+
+enum Branching {
+    BRANCHFULL,  // use branching algorithms
+    BRANCHFREE,  // use branchfree algorithms
+    EXACT        // numerators are multiples of the divisor (32-bit and 64-bit only)
+};
+
+#if defined(LIBDIVIDE_HAS_CONSTEXPR_GEN)
+// Portable constexpr versions of the gen functions, e.g.
+// constexpr libdivide_u32_t denom = libdivide::constexpr_u32_gen(1000);
+// They return the same dividers as the C gen functions, but are much
+// slower since they use neither intrinsics nor hardware division.
+
+template <typename T>
+struct constexpr_magic {
+    T magic;
+    uint8_t shift;
+    uint8_t flags;  // LIBDIVIDE_ADD_MARKER and LIBDIVIDE_NEGATIVE_DIVISOR
+};
+
+// val must be != 0
+template <typename UT>
+constexpr int constexpr_count_leading_zeros(UT val) {
+    int result = 0;
+    for (UT bit = (UT)((UT)1 << (sizeof(UT) * 8 - 1)); (val & bit) == 0; bit >>= 1) {
+        result++;
+    }
+    return result;
+}
+
+// Divides {u1, 0} by v using bitwise long division, u1 must be < v
+template <typename UT>
+constexpr UT constexpr_wide_div(UT u1, UT v, UT &rem) {
+    UT q = 0;
+    for (size_t i = 0; i < sizeof(UT) * 8; i++) {
+        bool carry = (u1 >> (sizeof(UT) * 8 - 1)) != 0;
+        u1 = (UT)(u1 << 1);
+        q = (UT)(q << 1);
+        if (carry || u1 >= v) {
+            u1 = (UT)(u1 - v);
+            q |= 1;
+        }
+    }
+    rem = u1;
+    return q;
+}
+
+// Same algorithm as libdivide_internal_u32_gen()
+template <typename UT>
+constexpr constexpr_magic<UT> constexpr_internal_u_gen(UT d, bool branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    constexpr_magic<UT> result = {0, 0, 0};
+    int floor_log_2_d = (int)(sizeof(UT) * 8 - 1) - constexpr_count_leading_zeros(d);
+
+    if ((d & (d - 1)) == 0) {
+        result.shift = (uint8_t)(floor_log_2_d - (branchfree ? 1 : 0));
+    } else {
+        UT rem = 0;
+        UT proposed_m = constexpr_wide_div((UT)((UT)1 << floor_log_2_d), d, rem);
+        const UT e = (UT)(d - rem);
+
+        if (branchfree || e >= (UT)((UT)1 << floor_log_2_d)) {
+            proposed_m = (UT)(proposed_m + proposed_m);
+            const UT twice_rem = (UT)(rem + rem);
+            if (twice_rem >= d || twice_rem < rem) proposed_m = (UT)(proposed_m + 1);
+            result.flags = LIBDIVIDE_ADD_MARKER;
+        }
+        result.magic = (UT)(1 + proposed_m);
+        result.shift = (uint8_t)floor_log_2_d;
+    }
+    return result;
+}
+
+// Same algorithm as libdivide_internal_s32_gen()
+template <typename ST, typename UT>
+constexpr constexpr_magic<ST> constexpr_internal_s_gen(ST d, bool branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    constexpr_magic<ST> result = {0, 0, 0};
+    const UT absD = d < 0 ? (UT)(0 - (UT)d) : (UT)d;
+    int floor_log_2_d = (int)(sizeof(UT) * 8 - 1) - constexpr_count_leading_zeros(absD);
+
+    if ((absD & (absD - 1)) == 0) {
+        result.shift = (uint8_t)floor_log_2_d;
+        result.flags = d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0;
+    } else {
+        UT rem = 0;
+        UT proposed_m = constexpr_wide_div((UT)((UT)1 << (floor_log_2_d - 1)), absD, rem);
+        const UT e = (UT)(absD - rem);
+
+        if (!branchfree && e < (UT)((UT)1 << floor_log_2_d)) {
+            result.shift = (uint8_t)(floor_log_2_d - 1);
+        } else {
+            proposed_m = (UT)(proposed_m + proposed_m);
+            const UT twice_rem = (UT)(rem + rem);
+            if (twice_rem >= absD || twice_rem < rem) proposed_m = (UT)(proposed_m + 1);
+            result.shift = (uint8_t)floor_log_2_d;
+            result.flags = LIBDIVIDE_ADD_MARKER;
+        }
+        proposed_m = (UT)(proposed_m + 1);
+
+        // Only the branchfull magic number is negated
+        if (d < 0) {
+            result.flags |= LIBDIVIDE_NEGATIVE_DIVISOR;
+            if (!branchfree) {
+                proposed_m = (UT)(0 - proposed_m);
+            }
+        }
+        result.magic = (ST)proposed_m;
+    }
+    return result;
+}
+
+// The constexpr_*_gen() functions for the 16-bit, 32-bit and 64-bit
+// dividers, which store the shift and the flags in the "more" field.
+#define LIBDIVIDE_CONSTEXPR_GEN(BITS)                                                   \
+    constexpr libdivide_u##BITS##_t constexpr_u##BITS##_gen(uint##BITS##_t d) {         \
+        constexpr_magic<uint##BITS##_t> m = constexpr_internal_u_gen(d, false);         \
+        return libdivide_u##BITS##_t{m.magic, (uint8_t)(m.shift | m.flags)};            \
+    }                                                                                   \
+    constexpr libdivide_u##BITS##_branchfree_t constexpr_u##BITS##_branchfree_gen(      \
+        uint##BITS##_t d) {                                                             \
+        if (d == 1) {                                                                   \
+            LIBDIVIDE_ERROR("branchfree divider must be != 1");                         \
+        }                                                                               \
+        constexpr_magic<uint##BITS##_t> m = constexpr_internal_u_gen(d, true);          \
+        return libdivide_u##BITS##_branchfree_t{m.magic, m.shift};                      \
+    }                                                                                   \
+    constexpr libdivide_s##BITS##_t constexpr_s##BITS##_gen(int##BITS##_t d) {          \
+        constexpr_magic<int##BITS##_t> m =                                              \
+            constexpr_internal_s_gen<int##BITS##_t, uint##BITS##_t>(d, false);          \
+        return libdivide_s##BITS##_t{m.magic, (uint8_t)(m.shift | m.flags)};            \
+    }                                                                                   \
+    constexpr libdivide_s##BITS##_branchfree_t constexpr_s##BITS##_branchfree_gen(      \
+        int##BITS##_t d) {                                                              \
+        constexpr_magic<int##BITS##_t> m =                                              \
+            constexpr_internal_s_gen<int##BITS##_t, uint##BITS##_t>(d, true);           \
+        return libdivide_s##BITS##_branchfree_t{m.magic, (uint8_t)(m.shift | m.flags)}; \
+    }
+
+LIBDIVIDE_CONSTEXPR_GEN(16)
+LIBDIVIDE_CONSTEXPR_GEN(32)
+LIBDIVIDE_CONSTEXPR_GEN(64)
+
+// Same algorithm as libdivide_inverse_u32(), d0 must be odd
+template <typename UT>
+constexpr UT constexpr_inverse(UT d0) {
+    UT inverse = d0;
+    for (size_t bits = 3; bits < sizeof(UT) * 8; bits *= 2) {
+        inverse = (UT)(inverse * (UT)(2 - d0 * inverse));
+    }
+    return inverse;
+}
+
+// val must be != 0
+template <typename UT>
+constexpr uint8_t constexpr_count_trailing_zeros(UT val) {
+    uint8_t result = 0;
+    for (; (val & 1) == 0; val >>= 1) {
+        result++;
+    }
+    return result;
+}
+
+// The constexpr_*_exact_gen() functions, see libdivide_u32_exact_gen()
+#define LIBDIVIDE_CONSTEXPR_EXACT_GEN(BITS)                                                   \
+    constexpr libdivide_u##BITS##_exact_t constexpr_u##BITS##_exact_gen(uint##BITS##_t d) {   \
+        if (d == 0) {                                                                         \
+            LIBDIVIDE_ERROR("divider must be != 0");                                          \
+        }                                                                                     \
+        uint8_t shift = constexpr_count_trailing_zeros(d);                                    \
+        return libdivide_u##BITS##_exact_t{constexpr_inverse((uint##BITS##_t)(d >> shift)),   \
+            shift};                                                                           \
+    }                                                                                         \
+    constexpr libdivide_s##BITS##_exact_t constexpr_s##BITS##_exact_gen(int##BITS##_t d) {    \
+        if (d == 0) {                                                                         \
+            LIBDIVIDE_ERROR("divider must be != 0");                                          \
+        }                                                                                     \
+        uint8_t shift = constexpr_count_trailing_zeros((uint##BITS##_t)d);                    \
+        return libdivide_s##BITS##_exact_t{                                                   \
+            (int##BITS##_t)constexpr_inverse((uint##BITS##_t)(d >> shift)), shift};           \
+    }
+
+LIBDIVIDE_CONSTEXPR_EXACT_GEN(32)
+LIBDIVIDE_CONSTEXPR_EXACT_GEN(64)
+
+#if defined(HAS_INT128_T)
+// The 128-bit dividers store the shift separately
+constexpr libdivide_u128_t constexpr_u128_gen(__uint128_t d) {
+    constexpr_magic<__uint128_t> m = constexpr_internal_u_gen(d, false);
+    return libdivide_u128_t{m.magic, m.flags, m.shift};
+}
+
+constexpr libdivide_u128_branchfree_t constexpr_u128_branchfree_gen(__uint128_t d) {
+    if (d == 1) {
+        LIBDIVIDE_ERROR("branchfree divider must be != 1");
+    }
+    constexpr_magic<__uint128_t> m = constexpr_internal_u_gen(d, true);
+    return libdivide_u128_branchfree_t{m.magic, 0, m.shift};
+}
+
+constexpr libdivide_s128_t constexpr_s128_gen(__int128_t d) {
+    constexpr_magic<__int128_t> m = constexpr_internal_s_gen<__int128_t, __uint128_t>(d, false);
+    return libdivide_s128_t{m.magic, m.flags, m.shift};
+}
+
+constexpr libdivide_s128_branchfree_t constexpr_s128_branchfree_gen(__int128_t d) {
+    constexpr_magic<__int128_t> m = constexpr_internal_s_gen<__int128_t, __uint128_t>(d, true);
+    return libdivide_s128_branchfree_t{m.magic, m.flags, m.shift};
+}
+#endif
+#endif
+
+// In constant expressions the dispatchers generate their divider
+// using the constexpr gen functions.
+#if defined(LIBDIVIDE_HAS_CONSTEXPR_DIVIDER)
+#define LIBDIVIDE_DISPATCHER_DENOM(ALGO, d) \
+    (LIBDIVIDE_IS_CONSTANT_EVALUATED() ? constexpr_##ALGO##_gen(d) : libdivide_##ALGO##_gen(d))
+#else
+#define LIBDIVIDE_DISPATCHER_DENOM(ALGO, d) libdivide_##ALGO##_gen(d)
+#endif
+
+#if defined(LIBDIVIDE_NEON)
+// Helper to deduce NEON vector type for integral type. The divider
+// class declares divide(NeonVecFor<T>::type) for every T, hence the
+// types without vector kernels (8-bit and 128-bit integers) must get
+// a placeholder type, without which divider<uint8_t> does not compile
+// when LIBDIVIDE_NEON is defined. SveVecFor and RvvVecFor do the same.
+template <typename T>
+struct NeonVecFor {
+    struct type {};
+};
+
+template <>
+struct NeonVecFor<uint16_t> {
+    typedef uint16x8_t type;
+};
+
+template <>
+struct NeonVecFor<int16_t> {
+    typedef int16x8_t type;
+};
+
+template <>
+struct NeonVecFor<uint32_t> {
+    typedef uint32x4_t type;
+};
+
+template <>
+struct NeonVecFor<int32_t> {
+    typedef int32x4_t type;
+};
+
+template <>
+struct NeonVecFor<uint64_t> {
+    typedef uint64x2_t type;
+};
+
+template <>
+struct NeonVecFor<int64_t> {
+    typedef int64x2_t type;
+};
+#endif
+
+#if defined(LIBDIVIDE_RVV)
+// Helper to deduce the (sizeless) RVV vector type for integral type,
+// see NeonVecFor. The divide() overloads divide VLMAX lanes.
+template <typename T>
+struct RvvVecFor {
+    struct type {};
+};
+
+template <>
+struct RvvVecFor<uint16_t> {
+    typedef vuint16m1_t type;
+    static size_t vlmax() { return __riscv_vsetvlmax_e16m1(); }
+};
+
+template <>
+struct RvvVecFor<int16_t> {
+    typedef vint16m1_t type;
+    static size_t vlmax() { return __riscv_vsetvlmax_e16m1(); }
+};
+
+template <>
+struct RvvVecFor<uint32_t> {
+    typedef vuint32m1_t type;
+    static size_t vlmax() { return __riscv_vsetvlmax_e32m1(); }
+};
+
+template <>
+struct RvvVecFor<int32_t> {
+    typedef vint32m1_t type;
+    static size_t vlmax() { return __riscv_vsetvlmax_e32m1(); }
+};
+
+template <>
+struct RvvVecFor<uint64_t> {
+    typedef vuint64m1_t type;
+    static size_t vlmax() { return __riscv_vsetvlmax_e64m1(); }
+};
+
+template <>
+struct RvvVecFor<int64_t> {
+    typedef vint64m1_t type;
+    static size_t vlmax() { return __riscv_vsetvlmax_e64m1(); }
+};
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+// Helper to deduce the (sizeless) SVE vector type for integral type,
+// see NeonVecFor.
+template <typename T>
+struct SveVecFor {
+    struct type {};
+};
+
+template <>
+struct SveVecFor<uint16_t> {
+    typedef svuint16_t type;
+};
+
+template <>
+struct SveVecFor<int16_t> {
+    typedef svint16_t type;
+};
+
+template <>
+struct SveVecFor<uint32_t> {
+    typedef svuint32_t type;
+};
+
+template <>
+struct SveVecFor<int32_t> {
+    typedef svint32_t type;
+};
+
+template <>
+struct SveVecFor<uint64_t> {
+    typedef svuint64_t type;
+};
+
+template <>
+struct SveVecFor<int64_t> {
+    typedef svint64_t type;
+};
+#endif
+
+// Versions of our algorithms for SIMD.
+#if defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)                    \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divide( \
+        typename NeonVecFor<INT_TYPE>::type n) const {           \
+        return libdivide_##ALGO##_do_vec128(n, &denom);          \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)
+#endif
+#if defined(LIBDIVIDE_SVE)
+#define LIBDIVIDE_DIVIDE_SVE(ALGO, INT_TYPE)                    \
+    LIBDIVIDE_INLINE typename SveVecFor<INT_TYPE>::type divide( \
+        typename SveVecFor<INT_TYPE>::type n) const {           \
+        return libdivide_##ALGO##_do_sve(n, &denom);            \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_SVE(ALGO, INT_TYPE)
+#endif
+#if defined(LIBDIVIDE_RVV)
+#define LIBDIVIDE_DIVIDE_RVV(ALGO, INT_TYPE)                                    \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type divide(                 \
+        typename RvvVecFor<INT_TYPE>::type n) const {                           \
+        return libdivide_##ALGO##_do_rvv(n, &denom, RvvVecFor<INT_TYPE>::vlmax()); \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_RVV(ALGO, INT_TYPE)
+#endif
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_DIVIDE_SSE2(ALGO)                     \
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {  \
+        return libdivide_##ALGO##_do_vec128(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DIVIDE_AVX2(ALGO)                     \
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {  \
+        return libdivide_##ALGO##_do_vec256(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DIVIDE_AVX512(ALGO)                   \
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {  \
+        return libdivide_##ALGO##_do_vec512(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_AVX512(ALGO)
+#endif
+
+// Versions of our divmod algorithms for SIMD.
+#if defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_DIVMOD_NEON(ALGO, INT_TYPE)                                                    \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divide(                                 \
+        typename NeonVecFor<INT_TYPE>::type n) const {                                           \
+        return libdivide_##ALGO##_do_vec128(n, &denom.denom);                                    \
+    }                                                                                            \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divmod(                                 \
+        typename NeonVecFor<INT_TYPE>::type n, typename NeonVecFor<INT_TYPE>::type *rem) const { \
+        return libdivide_##ALGO##_divmod_vec128(n, rem, &denom);                                 \
+    }
+#else
+#define LIBDIVIDE_DIVMOD_NEON(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+#define LIBDIVIDE_DIVMOD_SVE(ALGO, INT_TYPE)                                                   \
+    LIBDIVIDE_INLINE typename SveVecFor<INT_TYPE>::type divide(                                \
+        typename SveVecFor<INT_TYPE>::type n) const {                                          \
+        return libdivide_##ALGO##_do_sve(n, &denom.denom);                                     \
+    }                                                                                          \
+    LIBDIVIDE_INLINE typename SveVecFor<INT_TYPE>::type divmod(                                \
+        typename SveVecFor<INT_TYPE>::type n, typename SveVecFor<INT_TYPE>::type *rem) const { \
+        return libdivide_##ALGO##_divmod_sve(n, rem, &denom);                                  \
+    }
+#else
+#define LIBDIVIDE_DIVMOD_SVE(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_RVV)
+#define LIBDIVIDE_DIVMOD_RVV(ALGO, INT_TYPE)                                                   \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type divide(                                \
+        typename RvvVecFor<INT_TYPE>::type n) const {                                          \
+        return libdivide_##ALGO##_do_rvv(n, &denom.denom, RvvVecFor<INT_TYPE>::vlmax());       \
+    }                                                                                          \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type divmod(                                \
+        typename RvvVecFor<INT_TYPE>::type n, typename RvvVecFor<INT_TYPE>::type *rem) const { \
+        return libdivide_##ALGO##_divmod_rvv(n, rem, &denom, RvvVecFor<INT_TYPE>::vlmax());    \
+    }
+#else
+#define LIBDIVIDE_DIVMOD_RVV(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_DIVMOD_SSE2(ALGO)                                  \
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {               \
+        return libdivide_##ALGO##_do_vec128(n, &denom.denom);        \
+    }                                                                \
+    LIBDIVIDE_INLINE __m128i divmod(__m128i n, __m128i *rem) const { \
+        return libdivide_##ALGO##_divmod_vec128(n, rem, &denom);     \
+    }
+#else
+#define LIBDIVIDE_DIVMOD_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DIVMOD_AVX2(ALGO)                                  \
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {               \
+        return libdivide_##ALGO##_do_vec256(n, &denom.denom);        \
+    }                                                                \
+    LIBDIVIDE_INLINE __m256i divmod(__m256i n, __m256i *rem) const { \
+        return libdivide_##ALGO##_divmod_vec256(n, rem, &denom);     \
+    }
+#else
+#define LIBDIVIDE_DIVMOD_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DIVMOD_AVX512(ALGO)                                \
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {               \
+        return libdivide_##ALGO##_do_vec512(n, &denom.denom);        \
+    }                                                                \
+    LIBDIVIDE_INLINE __m512i divmod(__m512i n, __m512i *rem) const { \
+        return libdivide_##ALGO##_divmod_vec512(n, rem, &denom);     \
+    }
+#else
+#define LIBDIVIDE_DIVMOD_AVX512(ALGO)
+#endif
+
+// The DISPATCHER_GEN() macro generates C++ methods (for the given integer
+// and algorithm types) that redirect to libdivide's C API.
+#define DISPATCHER_GEN(T, ALGO)                                                       \
+    libdivide_##ALGO##_t denom;                                                       \
+    LIBDIVIDE_INLINE dispatcher() {}                                                  \
+    LIBDIVIDE_CONSTEXPR_DIVIDER LIBDIVIDE_INLINE dispatcher(T d)                      \
+        : denom(LIBDIVIDE_DISPATCHER_DENOM(ALGO, d)) {}                               \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); } \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); } \
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const { \
+        libdivide_##ALGO##_do_array(numers, quotients, count, &denom);                \
+    }                                                                                 \
+    LIBDIVIDE_DIVIDE_NEON(ALGO, T)                                                    \
+    LIBDIVIDE_DIVIDE_SVE(ALGO, T)                                                     \
+    LIBDIVIDE_DIVIDE_RVV(ALGO, T)                                                     \
+    LIBDIVIDE_DIVIDE_SSE2(ALGO)                                                       \
+    LIBDIVIDE_DIVIDE_AVX2(ALGO)                                                       \
+    LIBDIVIDE_DIVIDE_AVX512(ALGO)
+
+// DISPATCHER_GEN_BOUNDED() generates the constructor of the branchfull
+// dispatchers for numerators whose absolute value is <= max_numer.
+#define DISPATCHER_GEN_BOUNDED(T, ALGO)           \
+    LIBDIVIDE_INLINE dispatcher(T d, T max_numer) \
+        : denom(libdivide_##ALGO##_gen_bounded(d, max_numer)) {}
+
+// DISPATCHER_GEN_REDUCE() generates the fused divide and reduce
+// functions of the 16-bit, 32-bit and 64-bit dispatchers, S is the
+// type of the sums. Histograms are only supported by unsigned ALGOs.
+#define DISPATCHER_GEN_REDUCE(T, S, ALGO)                                                          \
+    LIBDIVIDE_INLINE S sum_quotients(const T *numers, size_t count) const {                        \
+        S sum;                                                                                     \
+        libdivide_##ALGO##_sum_quotients(numers, count, &denom, &sum);                             \
+        return sum;                                                                                \
+    }                                                                                              \
+    LIBDIVIDE_INLINE void min_max_quotients(const T *numers, size_t count, T *min, T *max) const { \
+        libdivide_##ALGO##_min_max_quotients(numers, count, &denom, min, max);                     \
+    }
+
+// DISPATCHER_GEN_STREAM() generates the array division using
+// non-temporal stores of the 16-bit, 32-bit and 64-bit dispatchers.
+#define DISPATCHER_GEN_STREAM(T, ALGO)                                                       \
+    LIBDIVIDE_INLINE void divide_stream(const T *numers, T *quotients, size_t count) const { \
+        libdivide_##ALGO##_do_array_stream(numers, quotients, count, &denom);                \
+    }
+
+#define DISPATCHER_GEN_HISTOGRAM(T, ALGO)                                              \
+    LIBDIVIDE_INLINE void histogram_quotients(                                         \
+        const T *numers, size_t count, uint32_t *bins, size_t num_bins) const {        \
+        libdivide_##ALGO##_histogram_quotients(numers, count, &denom, bins, num_bins); \
+    }
+
+// DISPATCHER_GEN_ALGORITHM() generates the division path query of the
+// branchfull dispatchers.
+#define DISPATCHER_GEN_ALGORITHM(ALGO)                       \
+    LIBDIVIDE_INLINE libdivide_algorithm algorithm() const { \
+        return libdivide_##ALGO##_algorithm(&denom);         \
+    }
+
+// DISPATCHER_GEN_SCALAR() is used for the types without vector kernels:
+// 8-bit integers are divided using the 16-bit algorithms since SSE2, AVX2
+// and AVX512 lack an 8-bit high multiplication, and there is no vector
+// 128-bit multiplication at all.
+#define DISPATCHER_GEN_SCALAR(T, ALGO)                                                   \
+    libdivide_##ALGO##_t denom;                                                          \
+    LIBDIVIDE_INLINE dispatcher() {}                                                     \
+    LIBDIVIDE_CONSTEXPR_DIVIDER LIBDIVIDE_INLINE dispatcher(T d)                         \
+        : denom(LIBDIVIDE_DISPATCHER_DENOM(ALGO, d)) {}                                  \
+    LIBDIVIDE_INLINE T divide(T n) const { return (T)libdivide_##ALGO##_do(n, &denom); } \
+    LIBDIVIDE_INLINE T recover() const { return (T)libdivide_##ALGO##_recover(&denom); } \
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const {    \
+        for (size_t i = 0; i < count; i++) {                                             \
+            quotients[i] = divide(numers[i]);                                            \
+        }                                                                                \
+    }
+
+// The dispatcher selects a specific division algorithm for a given
+// type and ALGO using partial template specialization.
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF, Branching ALGO>
+struct dispatcher {};
+
+template <>
+struct dispatcher<true, true, sizeof(int8_t), BRANCHFULL> {
+    DISPATCHER_GEN_SCALAR(int8_t, s16)
+    DISPATCHER_GEN_BOUNDED(int8_t, s16)
+    DISPATCHER_GEN_ALGORITHM(s16)
+};
+template <>
+struct dispatcher<true, true, sizeof(int8_t), BRANCHFREE> {
+    DISPATCHER_GEN_SCALAR(int8_t, s16_branchfree)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint8_t), BRANCHFULL> {
+    DISPATCHER_GEN_SCALAR(uint8_t, u16)
+    DISPATCHER_GEN_BOUNDED(uint8_t, u16)
+    DISPATCHER_GEN_ALGORITHM(u16)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint8_t), BRANCHFREE> {
+    DISPATCHER_GEN_SCALAR(uint8_t, u16_branchfree)
+};
+template <>
+struct dispatcher<true, true, sizeof(int16_t), BRANCHFULL> {
+    DISPATCHER_GEN(int16_t, s16)
+    DISPATCHER_GEN_REDUCE(int16_t, int64_t, s16)
+    DISPATCHER_GEN_STREAM(int16_t, s16)
+    DISPATCHER_GEN_BOUNDED(int16_t, s16)
+    DISPATCHER_GEN_ALGORITHM(s16)
+};
+template <>
+struct dispatcher<true, true, sizeof(int16_t), BRANCHFREE> {
+    DISPATCHER_GEN(int16_t, s16_branchfree)
+    DISPATCHER_GEN_REDUCE(int16_t, int64_t, s16_branchfree)
+    DISPATCHER_GEN_STREAM(int16_t, s16_branchfree)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint16_t), BRANCHFULL> {
+    DISPATCHER_GEN(uint16_t, u16)
+    DISPATCHER_GEN_REDUCE(uint16_t, uint64_t, u16)
+    DISPATCHER_GEN_STREAM(uint16_t, u16)
+    DISPATCHER_GEN_HISTOGRAM(uint16_t, u16)
+    DISPATCHER_GEN_BOUNDED(uint16_t, u16)
+    DISPATCHER_GEN_ALGORITHM(u16)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint16_t), BRANCHFREE> {
+    DISPATCHER_GEN(uint16_t, u16_branchfree)
+    DISPATCHER_GEN_REDUCE(uint16_t, uint64_t, u16_branchfree)
+    DISPATCHER_GEN_STREAM(uint16_t, u16_branchfree)
+    DISPATCHER_GEN_HISTOGRAM(uint16_t, u16_branchfree)
+};
+template <>
+struct dispatcher<true, true, sizeof(int32_t), BRANCHFULL> {
+    DISPATCHER_GEN(int32_t, s32)
+    DISPATCHER_GEN_REDUCE(int32_t, int64_t, s32)
+    DISPATCHER_GEN_STREAM(int32_t, s32)
+    DISPATCHER_GEN_BOUNDED(int32_t, s32)
+    DISPATCHER_GEN_ALGORITHM(s32)
+};
+template <>
+struct dispatcher<true, true, sizeof(int32_t), BRANCHFREE> {
+    DISPATCHER_GEN(int32_t, s32_branchfree)
+    DISPATCHER_GEN_REDUCE(int32_t, int64_t, s32_branchfree)
+    DISPATCHER_GEN_STREAM(int32_t, s32_branchfree)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint32_t), BRANCHFULL> {
+    DISPATCHER_GEN(uint32_t, u32)
+    DISPATCHER_GEN_REDUCE(uint32_t, uint64_t, u32)
+    DISPATCHER_GEN_STREAM(uint32_t, u32)
+    DISPATCHER_GEN_HISTOGRAM(uint32_t, u32)
+    DISPATCHER_GEN_BOUNDED(uint32_t, u32)
+    DISPATCHER_GEN_ALGORITHM(u32)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint32_t), BRANCHFREE> {
+    DISPATCHER_GEN(uint32_t, u32_branchfree)
+    DISPATCHER_GEN_REDUCE(uint32_t, uint64_t, u32_branchfree)
+    DISPATCHER_GEN_STREAM(uint32_t, u32_branchfree)
+    DISPATCHER_GEN_HISTOGRAM(uint32_t, u32_branchfree)
+};
+template <>
+struct dispatcher<true, true, sizeof(int64_t), BRANCHFULL> {
+    DISPATCHER_GEN(int64_t, s64)
+    DISPATCHER_GEN_REDUCE(int64_t, int64_t, s64)
+    DISPATCHER_GEN_STREAM(int64_t, s64)
+    DISPATCHER_GEN_BOUNDED(int64_t, s64)
+    DISPATCHER_GEN_ALGORITHM(s64)
+};
+template <>
+struct dispatcher<true, true, sizeof(int64_t), BRANCHFREE> {
+    DISPATCHER_GEN(int64_t, s64_branchfree)
+    DISPATCHER_GEN_REDUCE(int64_t, int64_t, s64_branchfree)
+    DISPATCHER_GEN_STREAM(int64_t, s64_branchfree)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint64_t), BRANCHFULL> {
+    DISPATCHER_GEN(uint64_t, u64)
+    DISPATCHER_GEN_REDUCE(uint64_t, uint64_t, u64)
+    DISPATCHER_GEN_STREAM(uint64_t, u64)
+    DISPATCHER_GEN_HISTOGRAM(uint64_t, u64)
+    DISPATCHER_GEN_BOUNDED(uint64_t, u64)
+    DISPATCHER_GEN_ALGORITHM(u64)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint64_t), BRANCHFREE> {
+    DISPATCHER_GEN(uint64_t, u64_branchfree)
+    DISPATCHER_GEN_REDUCE(uint64_t, uint64_t, u64_branchfree)
+    DISPATCHER_GEN_STREAM(uint64_t, u64_branchfree)
+    DISPATCHER_GEN_HISTOGRAM(uint64_t, u64_branchfree)
+};
+template <>
+struct dispatcher<true, true, sizeof(int32_t), EXACT> {
+    DISPATCHER_GEN(int32_t, s32_exact)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint32_t), EXACT> {
+    DISPATCHER_GEN(uint32_t, u32_exact)
+};
+template <>
+struct dispatcher<true, true, sizeof(int64_t), EXACT> {
+    DISPATCHER_GEN(int64_t, s64_exact)
+};
+template <>
+struct dispatcher<true, false, sizeof(uint64_t), EXACT> {
+    DISPATCHER_GEN(uint64_t, u64_exact)
+};
+#if defined(HAS_INT128_T)
+template <>
+struct dispatcher<true, true, sizeof(__int128_t), BRANCHFULL> {
+    DISPATCHER_GEN_SCALAR(__int128_t, s128)
+    DISPATCHER_GEN_ALGORITHM(s128)
+};
+template <>
+struct dispatcher<true, true, sizeof(__int128_t), BRANCHFREE> {
+    DISPATCHER_GEN_SCALAR(__int128_t, s128_branchfree)
+};
+template <>
+struct dispatcher<true, false, sizeof(__uint128_t), BRANCHFULL> {
+    DISPATCHER_GEN_SCALAR(__uint128_t, u128)
+    DISPATCHER_GEN_ALGORITHM(u128)
+};
+template <>
+struct dispatcher<true, false, sizeof(__uint128_t), BRANCHFREE> {
+    DISPATCHER_GEN_SCALAR(__uint128_t, u128_branchfree)
+};
+#endif
+
+// std::is_integral and std::is_signed are false for the 128-bit
+// integers in strict ISO C++ modes (e.g. -std=c++11), so the divider
+// class selects its dispatcher using these traits instead.
+template <typename T>
+struct integer_traits {
+    static const bool is_integral = std::is_integral<T>::value;
+    static const bool is_signed = std::is_signed<T>::value;
+};
+#if defined(HAS_INT128_T)
+template <>
+struct integer_traits<__int128_t> {
+    static const bool is_integral = true;
+    static const bool is_signed = true;
+};
+template <>
+struct integer_traits<__uint128_t> {
+    static const bool is_integral = true;
+    static const bool is_signed = false;
+};
+#endif
+
+// Methods of the signed divmod dispatchers that redirect to the
+// floor, ceiling and Euclidean variants of the C API. VEC is the
+// suffix of the vector functions (empty for scalars).
+#define LIBDIVIDE_ROUNDING_METHODS(ALGO, VEC_T, VEC)            \
+    LIBDIVIDE_INLINE VEC_T divide_floor(VEC_T n) const {        \
+        return libdivide_##ALGO##_divide_floor##VEC(n, &denom); \
+    }                                                           \
+    LIBDIVIDE_INLINE VEC_T divide_ceil(VEC_T n) const {         \
+        return libdivide_##ALGO##_divide_ceil##VEC(n, &denom);  \
+    }                                                           \
+    LIBDIVIDE_INLINE VEC_T mod_floor(VEC_T n) const {           \
+        return libdivide_##ALGO##_mod_floor##VEC(n, &denom);    \
+    }                                                           \
+    LIBDIVIDE_INLINE VEC_T mod_euclid(VEC_T n) const {          \
+        return libdivide_##ALGO##_mod_euclid##VEC(n, &denom);   \
+    }
+
+#if defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_ROUNDING_NEON(ALGO, INT_TYPE) \
+    LIBDIVIDE_ROUNDING_METHODS(ALGO, typename NeonVecFor<INT_TYPE>::type, _vec128)
+#else
+#define LIBDIVIDE_ROUNDING_NEON(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+#define LIBDIVIDE_ROUNDING_SVE(ALGO, INT_TYPE) \
+    LIBDIVIDE_ROUNDING_METHODS(ALGO, typename SveVecFor<INT_TYPE>::type, _sve)
+#else
+#define LIBDIVIDE_ROUNDING_SVE(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_RVV)
+#define LIBDIVIDE_ROUNDING_RVV(ALGO, INT_TYPE)                                               \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type divide_floor(                        \
+        typename RvvVecFor<INT_TYPE>::type n) const {                                        \
+        return libdivide_##ALGO##_divide_floor_rvv(n, &denom, RvvVecFor<INT_TYPE>::vlmax()); \
+    }                                                                                        \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type divide_ceil(                         \
+        typename RvvVecFor<INT_TYPE>::type n) const {                                        \
+        return libdivide_##ALGO##_divide_ceil_rvv(n, &denom, RvvVecFor<INT_TYPE>::vlmax());  \
+    }                                                                                        \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type mod_floor(                           \
+        typename RvvVecFor<INT_TYPE>::type n) const {                                        \
+        return libdivide_##ALGO##_mod_floor_rvv(n, &denom, RvvVecFor<INT_TYPE>::vlmax());    \
+    }                                                                                        \
+    LIBDIVIDE_INLINE typename RvvVecFor<INT_TYPE>::type mod_euclid(                          \
+        typename RvvVecFor<INT_TYPE>::type n) const {                                        \
+        return libdivide_##ALGO##_mod_euclid_rvv(n, &denom, RvvVecFor<INT_TYPE>::vlmax());   \
+    }
+#else
+#define LIBDIVIDE_ROUNDING_RVV(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_ROUNDING_SSE2(ALGO) LIBDIVIDE_ROUNDING_METHODS(ALGO, __m128i, _vec128)
+#else
+#define LIBDIVIDE_ROUNDING_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_ROUNDING_AVX2(ALGO) LIBDIVIDE_ROUNDING_METHODS(ALGO, __m256i, _vec256)
+#else
+#define LIBDIVIDE_ROUNDING_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_ROUNDING_AVX512(ALGO) LIBDIVIDE_ROUNDING_METHODS(ALGO, __m512i, _vec512)
+#else
+#define LIBDIVIDE_ROUNDING_AVX512(ALGO)
+#endif
+
+#define LIBDIVIDE_ROUNDING_DISPATCHER_GEN(T, ALGO) \
+    LIBDIVIDE_ROUNDING_METHODS(ALGO, T, )          \
+    LIBDIVIDE_ROUNDING_NEON(ALGO, T)               \
+    LIBDIVIDE_ROUNDING_SVE(ALGO, T)                \
+    LIBDIVIDE_ROUNDING_RVV(ALGO, T)                \
+    LIBDIVIDE_ROUNDING_SSE2(ALGO)                  \
+    LIBDIVIDE_ROUNDING_AVX2(ALGO)                  \
+    LIBDIVIDE_ROUNDING_AVX512(ALGO)
+
+// The DIVMOD_DISPATCHER_GEN() macro generates the C++ methods of
+// divmod_dispatcher, which also stores the divisor.
+#define DIVMOD_DISPATCHER_GEN(T, ALGO)                                                         \
+    libdivide_##ALGO##_divmod_t denom;                                                         \
+    LIBDIVIDE_INLINE divmod_dispatcher() {}                                                    \
+    LIBDIVIDE_INLINE divmod_dispatcher(T d) : denom(libdivide_##ALGO##_divmod_gen(d)) {}       \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom.denom); }    \
+    LIBDIVIDE_INLINE T divmod(T n, T *rem) const {                                             \
+        return libdivide_##ALGO##_divmod(n, rem, &denom);                                      \
+    }                                                                                          \
+    LIBDIVIDE_INLINE T recover() const { return denom.d; }                                     \
+    LIBDIVIDE_INLINE void divmod(const T *numers, T *quotients, T *rems, size_t count) const { \
+        libdivide_##ALGO##_divmod_array(numers, quotients, rems, count, &denom);               \
+    }                                                                                          \
+    LIBDIVIDE_DIVMOD_NEON(ALGO, T)                                                             \
+    LIBDIVIDE_DIVMOD_SVE(ALGO, T)                                                              \
+    LIBDIVIDE_DIVMOD_RVV(ALGO, T)                                                              \
+    LIBDIVIDE_DIVMOD_SSE2(ALGO)                                                                \
+    LIBDIVIDE_DIVMOD_AVX2(ALGO)                                                                \
+    LIBDIVIDE_DIVMOD_AVX512(ALGO)
+
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF, Branching ALGO>
+struct divmod_dispatcher {};
+
+template <>
+struct divmod_dispatcher<true, true, sizeof(int32_t), BRANCHFULL> {
+    DIVMOD_DISPATCHER_GEN(int32_t, s32)
+    LIBDIVIDE_ROUNDING_DISPATCHER_GEN(int32_t, s32)
+};
+template <>
+struct divmod_dispatcher<true, true, sizeof(int32_t), BRANCHFREE> {
+    DIVMOD_DISPATCHER_GEN(int32_t, s32_branchfree)
+    LIBDIVIDE_ROUNDING_DISPATCHER_GEN(int32_t, s32_branchfree)
+};
+template <>
+struct divmod_dispatcher<true, false, sizeof(uint32_t), BRANCHFULL> {
+    DIVMOD_DISPATCHER_GEN(uint32_t, u32)
+};
+template <>
+struct divmod_dispatcher<true, false, sizeof(uint32_t), BRANCHFREE> {
+    DIVMOD_DISPATCHER_GEN(uint32_t, u32_branchfree)
+};
+template <>
+struct divmod_dispatcher<true, true, sizeof(int64_t), BRANCHFULL> {
+    DIVMOD_DISPATCHER_GEN(int64_t, s64)
+    LIBDIVIDE_ROUNDING_DISPATCHER_GEN(int64_t, s64)
+};
+template <>
+struct divmod_dispatcher<true, true, sizeof(int64_t), BRANCHFREE> {
+    DIVMOD_DISPATCHER_GEN(int64_t, s64_branchfree)
+    LIBDIVIDE_ROUNDING_DISPATCHER_GEN(int64_t, s64_branchfree)
+};
+template <>
+struct divmod_dispatcher<true, false, sizeof(uint64_t), BRANCHFULL> {
+    DIVMOD_DISPATCHER_GEN(uint64_t, u64)
+};
+template <>
+struct divmod_dispatcher<true, false, sizeof(uint64_t), BRANCHFREE> {
+    DIVMOD_DISPATCHER_GEN(uint64_t, u64_branchfree)
+};
+
+#if defined(LIBDIVIDE_GNU_VECTORS)
+// is_vector_of<V, T>::value is true if V is a GCC/Clang vector
+// extension type whose lanes have the type T.
+template <typename V, typename T>
+struct is_vector_of {
+    template <typename U>
+    static typename std::enable_if<!std::is_class<U>::value && !std::is_pointer<U>::value &&
+                                       !std::is_array<U>::value && (sizeof(U) > sizeof(T)) &&
+                                       std::is_same<typename std::decay<decltype(
+                                                        std::declval<U>()[0])>::type,
+                                           T>::value,
+        std::true_type>::type
+    test(int);
+    template <typename U>
+    static std::false_type test(...);
+    static const bool value = decltype(test<V>(0))::value;
+};
+#endif
+
+// This is the main divider class for use by the user (C++ API).
+// The actual division algorithm is selected using the dispatcher struct
+// based on the integer and algorithm template parameters.
+template <typename T, Branching ALGO = BRANCHFULL>
+class divider {
+   public:
+    // We leave the default constructor empty so that creating
+    // an array of dividers and then initializing them
+    // later doesn't slow us down.
+    divider() {}
+
+    // Constructor that takes the divisor as a parameter, constexpr
+    // if LIBDIVIDE_HAS_CONSTEXPR_DIVIDER is defined (C++14 or later)
+    LIBDIVIDE_CONSTEXPR_DIVIDER LIBDIVIDE_INLINE divider(T d) : div(d) {}
+
+    // Constructor for numerators whose absolute value is <= max_numer,
+    // which avoids the add indicator path for many divisors. Only
+    // branchfull dividers of up to 64-bit integers support this.
+    LIBDIVIDE_INLINE divider(T d, T max_numer) : div(d, max_numer) {}
+
+    // Divides n by the divisor
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+
+    // Recovers the divisor, returns the value that was
+    // used to initialize this divider object.
+    T recover() const { return div.recover(); }
+
+    // Returns the path taken by the division of a branchfull divider:
+    // shift, mul or mul+add, the LIBDIVIDE_ALGORITHM_NEGATED flag is set
+    // for negative divisors. Only branchfull dividers support this.
+    LIBDIVIDE_INLINE libdivide_algorithm algorithm() const { return div.algorithm(); }
+
+    // Divides count numerators and stores the quotients, using the
+    // widest enabled vector instruction set. quotients may be equal
+    // to numers, neither array needs to be aligned.
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const {
+        div.divide(numers, quotients, count);
+    }
+
+    // Divides count numerators using non-temporal stores if the arrays are
+    // at least LIBDIVIDE_STREAM_THRESHOLD bytes, 16-bit to 64-bit types only.
+    LIBDIVIDE_INLINE void divide_stream(const T *numers, T *quotients, size_t count) const {
+        div.divide_stream(numers, quotients, count);
+    }
+
+    // Fused divide and reduce functions of the 16-bit, 32-bit and 64-bit
+    // dividers, they read the numerators once and store no quotients.
+    // Returns the sum of the quotients (modulo 2^64) as a 64-bit integer.
+    LIBDIVIDE_INLINE typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type
+    sum_quotients(const T *numers, size_t count) const {
+        return div.sum_quotients(numers, count);
+    }
+
+    // Stores the minimum and the maximum quotient, count must be > 0
+    LIBDIVIDE_INLINE void min_max_quotients(const T *numers, size_t count, T *min, T *max) const {
+        div.min_max_quotients(numers, count, min, max);
+    }
+
+    // Increments bins[min(numers[i] / d, num_bins - 1)], unsigned types only
+    LIBDIVIDE_INLINE void histogram_quotients(
+        const T *numers, size_t count, uint32_t *bins, size_t num_bins) const {
+        div.histogram_quotients(numers, count, bins, num_bins);
+    }
+
+    bool operator==(const divider<T, ALGO> &other) const {
+        return std::memcmp(&div.denom, &other.div.denom, sizeof(div.denom)) == 0;
+    }
+
+    bool operator!=(const divider<T, ALGO> &other) const { return !(*this == other); }
+
+    // Vector variants treat the input as packed integer values with the same type as the divider
+    // (e.g. s16, u16, s32, u32, s64, u64) and divides each of them by the divider, returning the
+    // packed quotients.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+#if defined(LIBDIVIDE_SVE)
+    LIBDIVIDE_INLINE typename SveVecFor<T>::type divide(typename SveVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+#if defined(LIBDIVIDE_RVV)
+    LIBDIVIDE_INLINE typename RvvVecFor<T>::type divide(typename RvvVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+
+    // Portable vector variants for GCC/Clang vector extension types whose
+    // lanes are T, and for std::experimental::simd<T, Abi>. They divide
+    // the lanes using the widest enabled x86 or NEON vector kernels that
+    // fit and divide the remaining lanes one at a time.
+#if defined(LIBDIVIDE_GNU_VECTORS)
+    template <typename V>
+    LIBDIVIDE_INLINE typename std::enable_if<is_vector_of<V, T>::value, V>::type divide(
+        V n) const {
+        T lanes[sizeof(V) / sizeof(T)];
+        std::memcpy(lanes, &n, sizeof(V));
+        divide_lanes(lanes, sizeof(V) / sizeof(T), has_vector_kernels());
+        std::memcpy(&n, lanes, sizeof(V));
+        return n;
+    }
+#endif
+#if defined(LIBDIVIDE_SIMD_TS)
+    template <typename Abi>
+    LIBDIVIDE_INLINE std::experimental::simd<T, Abi> divide(
+        const std::experimental::simd<T, Abi> &n) const {
+        T lanes[std::experimental::simd_size<T, Abi>::value];
+        n.copy_to(lanes, std::experimental::element_aligned);
+        divide_lanes(lanes, std::experimental::simd_size<T, Abi>::value, has_vector_kernels());
+        return std::experimental::simd<T, Abi>(lanes, std::experimental::element_aligned);
+    }
+#endif
+
+   private:
+    // The 8-bit and 128-bit integers have no vector kernels
+    typedef std::integral_constant<bool, sizeof(T) >= 2 && sizeof(T) <= 8> has_vector_kernels;
+
+    // Divides lanes[i, count) using the vector type VEC, returns
+    // the index of the first lane that has not been divided.
+    template <typename VEC>
+    LIBDIVIDE_INLINE size_t divide_lanes_as(T *lanes, size_t count, size_t i) const {
+        for (; i + sizeof(VEC) / sizeof(T) <= count; i += sizeof(VEC) / sizeof(T)) {
+            VEC x;
+            std::memcpy(&x, lanes + i, sizeof(VEC));
+            x = divide(x);
+            std::memcpy(lanes + i, &x, sizeof(VEC));
+        }
+        return i;
+    }
+
+    LIBDIVIDE_INLINE void divide_lanes(T *lanes, size_t count, std::true_type) const {
+        size_t i = 0;
+#if defined(LIBDIVIDE_AVX512)
+        i = divide_lanes_as<__m512i>(lanes, count, i);
+#endif
+#if defined(LIBDIVIDE_AVX2)
+        i = divide_lanes_as<__m256i>(lanes, count, i);
+#endif
+#if defined(LIBDIVIDE_SSE2)
+        i = divide_lanes_as<__m128i>(lanes, count, i);
+#endif
+#if defined(LIBDIVIDE_NEON)
+        i = divide_lanes_as<typename NeonVecFor<T>::type>(lanes, count, i);
+#endif
+        divide_lanes(lanes + i, count - i, std::false_type());
+    }
+
+    LIBDIVIDE_INLINE void divide_lanes(T *lanes, size_t count, std::false_type) const {
+        for (size_t i = 0; i < count; i++) {
+            lanes[i] = divide(lanes[i]);
+        }
+    }
+
+    // Storage for the actual divisor
+    dispatcher<integer_traits<T>::is_integral, integer_traits<T>::is_signed, sizeof(T), ALGO> div;
+};
+
+// Overload of operator / for scalar division
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T operator/(T n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+// Overload of operator /= for scalar division
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T &operator/=(T &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+// Overloads for GCC/Clang vector extension types and std::experimental::simd
+#if defined(LIBDIVIDE_GNU_VECTORS)
+template <typename V, typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename std::enable_if<is_vector_of<V, T>::value, V>::type operator/(
+    V n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename V, typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename std::enable_if<is_vector_of<V, T>::value, V>::type operator/=(
+    V &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+#if defined(LIBDIVIDE_SIMD_TS)
+template <typename T, typename Abi, Branching ALGO>
+LIBDIVIDE_INLINE std::experimental::simd<T, Abi> operator/(
+    const std::experimental::simd<T, Abi> &n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, typename Abi, Branching ALGO>
+LIBDIVIDE_INLINE std::experimental::simd<T, Abi> &operator/=(
+    std::experimental::simd<T, Abi> &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+
+// Overloads for vector types.
+#if defined(LIBDIVIDE_SSE2)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator/(__m128i n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator/=(__m128i &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+#if defined(LIBDIVIDE_AVX2)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator/(__m256i n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator/=(__m256i &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+#if defined(LIBDIVIDE_AVX512)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator/(__m512i n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator/=(__m512i &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+
+#if defined(LIBDIVIDE_NEON)
+template <Branching ALGO>
+LIBDIVIDE_INLINE uint16x8_t operator/(uint16x8_t n, const divider<uint16_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE int16x8_t operator/(int16x8_t n, const divider<int16_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE uint32x4_t operator/(uint32x4_t n, const divider<uint32_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE int32x4_t operator/(int32x4_t n, const divider<int32_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE uint64x2_t operator/(uint64x2_t n, const divider<uint64_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE int64x2_t operator/(int64x2_t n, const divider<int64_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE uint16x8_t operator/=(uint16x8_t &n, const divider<uint16_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE int16x8_t operator/=(int16x8_t &n, const divider<int16_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE uint32x4_t operator/=(uint32x4_t &n, const divider<uint32_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE int32x4_t operator/=(int32x4_t &n, const divider<int32_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE uint64x2_t operator/=(uint64x2_t &n, const divider<uint64_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE int64x2_t operator/=(int64x2_t &n, const divider<int64_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+template <Branching ALGO>
+LIBDIVIDE_INLINE svuint16_t operator/(svuint16_t n, const divider<uint16_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svint16_t operator/(svint16_t n, const divider<int16_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svuint32_t operator/(svuint32_t n, const divider<uint32_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svint32_t operator/(svint32_t n, const divider<int32_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svuint64_t operator/(svuint64_t n, const divider<uint64_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svint64_t operator/(svint64_t n, const divider<int64_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svuint16_t operator/=(svuint16_t &n, const divider<uint16_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svint16_t operator/=(svint16_t &n, const divider<int16_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svuint32_t operator/=(svuint32_t &n, const divider<uint32_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svint32_t operator/=(svint32_t &n, const divider<int32_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svuint64_t operator/=(svuint64_t &n, const divider<uint64_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE svint64_t operator/=(svint64_t &n, const divider<int64_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+
+#if defined(LIBDIVIDE_RVV)
+template <Branching ALGO>
+LIBDIVIDE_INLINE vuint16m1_t operator/(vuint16m1_t n, const divider<uint16_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vint16m1_t operator/(vint16m1_t n, const divider<int16_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vuint32m1_t operator/(vuint32m1_t n, const divider<uint32_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vint32m1_t operator/(vint32m1_t n, const divider<int32_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vuint64m1_t operator/(vuint64m1_t n, const divider<uint64_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vint64m1_t operator/(vint64m1_t n, const divider<int64_t, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vuint16m1_t operator/=(vuint16m1_t &n, const divider<uint16_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vint16m1_t operator/=(vint16m1_t &n, const divider<int16_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vuint32m1_t operator/=(vuint32m1_t &n, const divider<uint32_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vint32m1_t operator/=(vint32m1_t &n, const divider<int32_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vuint64m1_t operator/=(vuint64m1_t &n, const divider<uint64_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <Branching ALGO>
+LIBDIVIDE_INLINE vint64m1_t operator/=(vint64m1_t &n, const divider<int64_t, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+
+// Forwards the floor, ceiling and Euclidean variants of
+// divmod_divider to its dispatcher (signed 32-bit and 64-bit only).
+#define LIBDIVIDE_ROUNDING_FORWARD(VEC_T)                                              \
+    LIBDIVIDE_INLINE VEC_T divide_floor(VEC_T n) const { return div.divide_floor(n); } \
+    LIBDIVIDE_INLINE VEC_T divide_ceil(VEC_T n) const { return div.divide_ceil(n); }   \
+    LIBDIVIDE_INLINE VEC_T mod_floor(VEC_T n) const { return div.mod_floor(n); }       \
+    LIBDIVIDE_INLINE VEC_T mod_euclid(VEC_T n) const { return div.mod_euclid(n); }
+
+// Divider that also stores the divisor so that it can compute the
+// quotient and the remainder at once, the remainder costs one
+// multiplication and one subtraction.
+template <typename T, Branching ALGO = BRANCHFULL>
+class divmod_divider {
+   public:
+    divmod_divider() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE divmod_divider(T d) : div(d) {}
+
+    // Divides n by the divisor
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+
+    // Returns n / divisor and stores n % divisor to rem
+    LIBDIVIDE_INLINE T divmod(T n, T *rem) const { return div.divmod(n, rem); }
+
+    // Returns the divisor
+    LIBDIVIDE_INLINE T recover() const { return div.recover(); }
+
+    // Divides count numerators and stores the quotients and the
+    // remainders to separate arrays, none of which needs to be aligned.
+    LIBDIVIDE_INLINE void divmod(const T *numers, T *quotients, T *rems, size_t count) const {
+        div.divmod(numers, quotients, rems, count);
+    }
+
+    // Signed types only: the quotient rounded towards negative
+    // (divide_floor) or positive (divide_ceil) infinity, the remainder
+    // with the sign of the divisor (mod_floor) and the non-negative
+    // remainder (mod_euclid).
+    LIBDIVIDE_ROUNDING_FORWARD(T)
+
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+    LIBDIVIDE_INLINE __m128i divmod(__m128i n, __m128i *rem) const { return div.divmod(n, rem); }
+    LIBDIVIDE_ROUNDING_FORWARD(__m128i)
+#endif
 #if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+    LIBDIVIDE_INLINE __m256i divmod(__m256i n, __m256i *rem) const { return div.divmod(n, rem); }
+    LIBDIVIDE_ROUNDING_FORWARD(__m256i)
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+    LIBDIVIDE_INLINE __m512i divmod(__m512i n, __m512i *rem) const { return div.divmod(n, rem); }
+    LIBDIVIDE_ROUNDING_FORWARD(__m512i)
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divmod(
+        typename NeonVecFor<T>::type n, typename NeonVecFor<T>::type *rem) const {
+        return div.divmod(n, rem);
+    }
+    LIBDIVIDE_ROUNDING_FORWARD(typename NeonVecFor<T>::type)
+#endif
+#if defined(LIBDIVIDE_SVE)
+    LIBDIVIDE_INLINE typename SveVecFor<T>::type divide(typename SveVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+    LIBDIVIDE_INLINE typename SveVecFor<T>::type divmod(
+        typename SveVecFor<T>::type n, typename SveVecFor<T>::type *rem) const {
+        return div.divmod(n, rem);
+    }
+    LIBDIVIDE_ROUNDING_FORWARD(typename SveVecFor<T>::type)
+#endif
+#if defined(LIBDIVIDE_RVV)
+    LIBDIVIDE_INLINE typename RvvVecFor<T>::type divide(typename RvvVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+    LIBDIVIDE_INLINE typename RvvVecFor<T>::type divmod(
+        typename RvvVecFor<T>::type n, typename RvvVecFor<T>::type *rem) const {
+        return div.divmod(n, rem);
+    }
+    LIBDIVIDE_ROUNDING_FORWARD(typename RvvVecFor<T>::type)
+#endif
 
-static LIBDIVIDE_INLINE __m256i libdivide_u32_do_vec256(
-    __m256i numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s32_do_vec256(
-    __m256i numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_u64_do_vec256(
-    __m256i numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s64_do_vec256(
-    __m256i numers, const struct libdivide_s64_t *denom);
+   private:
+    divmod_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T), ALGO> div;
+};
 
-static LIBDIVIDE_INLINE __m256i libdivide_u32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_u64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s64_branchfree_t *denom);
+// Overload of operator / and % for divmod_divider
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T operator/(T n, const divmod_divider<T, ALGO> &div) {
+    return div.divide(n);
+}
 
-//////// Internal Utility Functions
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T operator%(T n, const divmod_divider<T, ALGO> &div) {
+    T rem;
+    div.divmod(n, &rem);
+    return rem;
+}
 
-// Implementation of _mm256_srai_epi64(v, 63) (from AVX512).
-static LIBDIVIDE_INLINE __m256i libdivide_s64_signbits(__m256i v) {
-    __m256i hiBitsDuped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
-    __m256i signBits = _mm256_srai_epi32(hiBitsDuped, 31);
-    return signBits;
+// The DIVISIBILITY_DISPATCHER_GEN() macro generates the C++ methods of
+// divisibility_dispatcher. MASK512 is the AVX512 mask type.
+#if defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_IS_DIVISIBLE_NEON(ALGO, INT_TYPE)                    \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type is_divisible( \
+        typename NeonVecFor<INT_TYPE>::type n) const {                 \
+        return libdivide_##ALGO##_is_divisible_vec128(n, &denom);      \
+    }
+#else
+#define LIBDIVIDE_IS_DIVISIBLE_NEON(ALGO, INT_TYPE)
+#endif
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_IS_DIVISIBLE_SSE2(ALGO)                         \
+    LIBDIVIDE_INLINE __m128i is_divisible(__m128i n) const {      \
+        return libdivide_##ALGO##_is_divisible_vec128(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_IS_DIVISIBLE_SSE2(ALGO)
+#endif
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_IS_DIVISIBLE_AVX2(ALGO)                         \
+    LIBDIVIDE_INLINE __m256i is_divisible(__m256i n) const {      \
+        return libdivide_##ALGO##_is_divisible_vec256(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_IS_DIVISIBLE_AVX2(ALGO)
+#endif
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_IS_DIVISIBLE_AVX512(ALGO, MASK512)              \
+    typedef MASK512 mask512_type;                                 \
+    LIBDIVIDE_INLINE MASK512 is_divisible(__m512i n) const {      \
+        return libdivide_##ALGO##_is_divisible_vec512(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_IS_DIVISIBLE_AVX512(ALGO, MASK512)
+#endif
+
+#define DIVISIBILITY_DISPATCHER_GEN(T, ALGO, MASK512)           \
+    libdivide_##ALGO##_divisibility_t denom;                    \
+    LIBDIVIDE_INLINE divisibility_dispatcher() {}               \
+    LIBDIVIDE_INLINE divisibility_dispatcher(T d)               \
+        : denom(libdivide_##ALGO##_divisibility_gen(d)) {}      \
+    LIBDIVIDE_INLINE bool is_divisible(T n) const {             \
+        return libdivide_##ALGO##_is_divisible(n, &denom) != 0; \
+    }                                                           \
+    LIBDIVIDE_IS_DIVISIBLE_NEON(ALGO, T)                        \
+    LIBDIVIDE_IS_DIVISIBLE_SSE2(ALGO)                           \
+    LIBDIVIDE_IS_DIVISIBLE_AVX2(ALGO)                           \
+    LIBDIVIDE_IS_DIVISIBLE_AVX512(ALGO, MASK512)
+
+// Divisibility tests are only available for unsigned integers
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF>
+struct divisibility_dispatcher {};
+
+template <>
+struct divisibility_dispatcher<true, false, sizeof(uint32_t)> {
+    DIVISIBILITY_DISPATCHER_GEN(uint32_t, u32, __mmask16)
+};
+template <>
+struct divisibility_dispatcher<true, false, sizeof(uint64_t)> {
+    DIVISIBILITY_DISPATCHER_GEN(uint64_t, u64, __mmask8)
+};
+
+// Tests whether numerators are divisible by d, this is cheaper
+// than computing the remainder because only one multiplication
+// and one comparison are needed.
+template <typename T>
+class divisibility {
+    typedef divisibility_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value,
+        sizeof(T)>
+        dispatcher_t;
+
+   public:
+    divisibility() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE divisibility(T d) : div(d) {}
+
+    // Returns true if n % d == 0
+    LIBDIVIDE_INLINE bool is_divisible(T n) const { return div.is_divisible(n); }
+
+    // Vector variants return a mask which is set in
+    // the lanes that are divisible.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i is_divisible(__m128i n) const { return div.is_divisible(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i is_divisible(__m256i n) const { return div.is_divisible(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    // __mmask16 for 32-bit and __mmask8 for 64-bit integers
+    LIBDIVIDE_INLINE typename dispatcher_t::mask512_type is_divisible(__m512i n) const {
+        return div.is_divisible(n);
+    }
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type is_divisible(
+        typename NeonVecFor<T>::type n) const {
+        return div.is_divisible(n);
+    }
+#endif
+
+   private:
+    dispatcher_t div;
+};
+
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF>
+struct modulus_dispatcher {};
+
+// Only 32-bit unsigned integers are supported
+template <>
+struct modulus_dispatcher<true, false, sizeof(uint32_t)> {
+    libdivide_u32_mod_t denom;
+    LIBDIVIDE_INLINE modulus_dispatcher() {}
+    LIBDIVIDE_INLINE modulus_dispatcher(uint32_t d) : denom(libdivide_u32_mod_gen(d)) {}
+    LIBDIVIDE_INLINE uint32_t mod(uint32_t n) const { return libdivide_u32_mod_do(n, &denom); }
+    LIBDIVIDE_INLINE uint32_t recover() const { return libdivide_u32_mod_recover(&denom); }
+    LIBDIVIDE_INLINE void mod(const uint32_t *numers, uint32_t *rems, size_t count) const {
+        libdivide_u32_mod_do_array(numers, rems, count, &denom);
+    }
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE uint32x4_t mod(uint32x4_t n) const {
+        return libdivide_u32_mod_do_vec128(n, &denom);
+    }
+#endif
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i mod(__m128i n) const { return libdivide_u32_mod_do_vec128(n, &denom); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i mod(__m256i n) const { return libdivide_u32_mod_do_vec256(n, &denom); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i mod(__m512i n) const { return libdivide_u32_mod_do_vec512(n, &denom); }
+#endif
+};
+
+// Computes remainders only, which is faster than computing the
+// quotient first. Uses 12 bytes instead of the 5 bytes of
+// divider<uint32_t>.
+template <typename T>
+class modulus {
+   public:
+    modulus() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE modulus(T d) : div(d) {}
+
+    // Returns n % d
+    LIBDIVIDE_INLINE T mod(T n) const { return div.mod(n); }
+
+    // Returns the divisor
+    LIBDIVIDE_INLINE T recover() const { return div.recover(); }
+
+    // Stores the remainders of count numerators, rems may be equal to numers
+    LIBDIVIDE_INLINE void mod(const T *numers, T *rems, size_t count) const {
+        div.mod(numers, rems, count);
+    }
+
+    bool operator==(const modulus<T> &other) const { return recover() == other.recover(); }
+
+    bool operator!=(const modulus<T> &other) const { return !(*this == other); }
+
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i mod(__m128i n) const { return div.mod(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i mod(__m256i n) const { return div.mod(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i mod(__m512i n) const { return div.mod(n); }
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type mod(typename NeonVecFor<T>::type n) const {
+        return div.mod(n);
+    }
+#endif
+
+   private:
+    modulus_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T)> div;
+};
+
+// Overload of operator % for scalar modulo
+template <typename T>
+LIBDIVIDE_INLINE T operator%(T n, const modulus<T> &div) {
+    return div.mod(n);
 }
 
-// Implementation of _mm256_srai_epi64 (from AVX512).
-static LIBDIVIDE_INLINE __m256i libdivide_s64_shift_right_vec256(__m256i v, int amt) {
-    const int b = 64 - amt;
-    __m256i m = _mm256_set1_epi64x(1ULL << (b - 1));
-    __m256i x = _mm256_srli_epi64(v, amt);
-    __m256i result = _mm256_sub_epi64(_mm256_xor_si256(x, m), m);
-    return result;
+// Overload of operator %= for scalar modulo
+template <typename T>
+LIBDIVIDE_INLINE T &operator%=(T &n, const modulus<T> &div) {
+    n = div.mod(n);
+    return n;
+}
+
+// The DIVIDER52_DISPATCHER_GEN() macro generates the C++ methods
+// of divider52_dispatcher, which wraps a 52-bit C divider.
+#define DIVIDER52_DISPATCHER_GEN(T, ALGO)                                             \
+    libdivide_##ALGO##_t denom;                                                       \
+    LIBDIVIDE_INLINE divider52_dispatcher() {}                                        \
+    LIBDIVIDE_INLINE divider52_dispatcher(T d) : denom(libdivide_##ALGO##_gen(d)) {}  \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); } \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); } \
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const { \
+        libdivide_##ALGO##_do_array(numers, quotients, count, &denom);                \
+    }                                                                                 \
+    LIBDIVIDE_DIVIDE_NEON(ALGO, T)                                                    \
+    LIBDIVIDE_DIVIDE_SVE(ALGO, T)                                                     \
+    LIBDIVIDE_DIVIDE_SSE2(ALGO)                                                       \
+    LIBDIVIDE_DIVIDE_AVX2(ALGO)                                                       \
+    LIBDIVIDE_DIVIDE_AVX512(ALGO)
+
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF>
+struct divider52_dispatcher {};
+
+// Only 64-bit integers are supported
+template <>
+struct divider52_dispatcher<true, false, sizeof(uint64_t)> {
+    DIVIDER52_DISPATCHER_GEN(uint64_t, u52)
+};
+template <>
+struct divider52_dispatcher<true, true, sizeof(int64_t)> {
+    DIVIDER52_DISPATCHER_GEN(int64_t, s52)
+};
+
+// Divides 64-bit integers whose absolute value is < 2^52 by a divisor
+// whose absolute value is < 2^52. This requires a single 52-bit high
+// multiply per quotient (one instruction with AVX512 IFMA) and no fixup,
+// larger numerators yield wrong quotients.
+template <typename T>
+class divider52 {
+   public:
+    divider52() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE divider52(T d) : div(d) {}
+
+    // Returns n / d
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+
+    // Returns the divisor
+    LIBDIVIDE_INLINE T recover() const { return div.recover(); }
+
+    // Stores the quotients of count numerators, quotients may be equal to numers
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const {
+        div.divide(numers, quotients, count);
+    }
+
+    bool operator==(const divider52<T> &other) const { return recover() == other.recover(); }
+
+    bool operator!=(const divider52<T> &other) const { return !(*this == other); }
+
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+#if defined(LIBDIVIDE_SVE)
+    LIBDIVIDE_INLINE typename SveVecFor<T>::type divide(typename SveVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+
+   private:
+    divider52_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T)> div;
+};
+
+// Overload of operator / for scalar division
+template <typename T>
+LIBDIVIDE_INLINE T operator/(T n, const divider52<T> &div) {
+    return div.divide(n);
+}
+
+// Overload of operator /= for scalar division
+template <typename T>
+LIBDIVIDE_INLINE T &operator/=(T &n, const divider52<T> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+// Overloads for vector types.
+#if defined(LIBDIVIDE_SSE2)
+template <typename T>
+LIBDIVIDE_INLINE __m128i operator%(__m128i n, const modulus<T> &div) {
+    return div.mod(n);
+}
+#endif
+#if defined(LIBDIVIDE_AVX2)
+template <typename T>
+LIBDIVIDE_INLINE __m256i operator%(__m256i n, const modulus<T> &div) {
+    return div.mod(n);
 }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+template <typename T>
+LIBDIVIDE_INLINE __m512i operator%(__m512i n, const modulus<T> &div) {
+    return div.mod(n);
+}
+#endif
+#if defined(LIBDIVIDE_NEON)
+LIBDIVIDE_INLINE uint32x4_t operator%(uint32x4_t n, const modulus<uint32_t> &div) {
+    return div.mod(n);
+}
+#endif
+
+// The ADAPTIVE_DISPATCHER_GEN() macro generates the C++ methods of
+// adaptive_dispatcher. The divider is classified once by its path,
+// the add indicator dividers are converted to branchfree dividers
+// which compute the same quotients without any branches: unsigned
+// branchfree dividers use the same magic number and shift, signed
+// ones do not negate the magic number of negative divisors.
+#define ADAPTIVE_DISPATCHER_GEN(T, UT, ALGO, SHIFT_MASK)                                         \
+    union {                                                                                      \
+        libdivide_##ALGO##_t denom;                                                              \
+        libdivide_##ALGO##_branchfree_t branchfree_denom;                                        \
+    };                                                                                           \
+    uint8_t path;                                                                                \
+    LIBDIVIDE_INLINE adaptive_dispatcher() {}                                                    \
+    LIBDIVIDE_INLINE adaptive_dispatcher(T d) : denom(libdivide_##ALGO##_gen(d)) {               \
+        path = (uint8_t)(libdivide_##ALGO##_algorithm(&denom) & ~LIBDIVIDE_ALGORITHM_NEGATED);   \
+        if (path == LIBDIVIDE_ALGORITHM_MUL_ADD) {                                               \
+            T magic = denom.magic;                                                               \
+            uint8_t more = denom.more;                                                           \
+            if (std::is_signed<T>::value && (more & LIBDIVIDE_NEGATIVE_DIVISOR)) {               \
+                magic = (T)(0 - (UT)magic);                                                      \
+            }                                                                                    \
+            if (!std::is_signed<T>::value) {                                                     \
+                more &= SHIFT_MASK;                                                              \
+            }                                                                                    \
+            branchfree_denom.magic = magic;                                                      \
+            branchfree_denom.more = more;                                                        \
+        }                                                                                        \
+    }                                                                                            \
+    LIBDIVIDE_INLINE T divide(T n) const {                                                       \
+        switch (path) {                                                                          \
+            case LIBDIVIDE_ALGORITHM_SHIFT: {                                                    \
+                const libdivide_##ALGO##_t shift = {0, denom.more};                              \
+                return libdivide_##ALGO##_do(n, &shift);                                         \
+            }                                                                                    \
+            case LIBDIVIDE_ALGORITHM_MUL: {                                                      \
+                const libdivide_##ALGO##_t mul = {                                               \
+                    denom.magic, (uint8_t)(denom.more & ~LIBDIVIDE_ADD_MARKER)};                 \
+                return libdivide_##ALGO##_do(n, &mul);                                           \
+            }                                                                                    \
+            default:                                                                             \
+                return libdivide_##ALGO##_branchfree_do(n, &branchfree_denom);                   \
+        }                                                                                        \
+    }                                                                                            \
+    LIBDIVIDE_INLINE T recover() const {                                                         \
+        if (path == LIBDIVIDE_ALGORITHM_MUL_ADD) {                                               \
+            return libdivide_##ALGO##_branchfree_recover(&branchfree_denom);                     \
+        }                                                                                        \
+        return libdivide_##ALGO##_recover(&denom);                                               \
+    }                                                                                            \
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const {            \
+        if (path == LIBDIVIDE_ALGORITHM_MUL_ADD) {                                               \
+            libdivide_##ALGO##_branchfree_do_array(numers, quotients, count, &branchfree_denom); \
+        } else {                                                                                 \
+            libdivide_##ALGO##_do_array(numers, quotients, count, &denom);                       \
+        }                                                                                        \
+    }
+
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF>
+struct adaptive_dispatcher {};
+
+template <>
+struct adaptive_dispatcher<true, false, sizeof(uint16_t)> {
+    ADAPTIVE_DISPATCHER_GEN(uint16_t, uint16_t, u16, LIBDIVIDE_16_SHIFT_MASK)
+};
+template <>
+struct adaptive_dispatcher<true, true, sizeof(int16_t)> {
+    ADAPTIVE_DISPATCHER_GEN(int16_t, uint16_t, s16, LIBDIVIDE_16_SHIFT_MASK)
+};
+template <>
+struct adaptive_dispatcher<true, false, sizeof(uint32_t)> {
+    ADAPTIVE_DISPATCHER_GEN(uint32_t, uint32_t, u32, LIBDIVIDE_32_SHIFT_MASK)
+};
+template <>
+struct adaptive_dispatcher<true, true, sizeof(int32_t)> {
+    ADAPTIVE_DISPATCHER_GEN(int32_t, uint32_t, s32, LIBDIVIDE_32_SHIFT_MASK)
+};
+template <>
+struct adaptive_dispatcher<true, false, sizeof(uint64_t)> {
+    ADAPTIVE_DISPATCHER_GEN(uint64_t, uint64_t, u64, LIBDIVIDE_64_SHIFT_MASK)
+};
+template <>
+struct adaptive_dispatcher<true, true, sizeof(int64_t)> {
+    ADAPTIVE_DISPATCHER_GEN(int64_t, uint64_t, s64, LIBDIVIDE_64_SHIFT_MASK)
+};
+
+// Divider that picks its algorithm when it is generated instead of
+// using the Branching template parameter: powers of 2 are divided
+// using shifts, divisors without the add indicator using a high
+// multiplication and a shift, and all other divisors using the
+// branchfree algorithm. The array division branches on the path once
+// per array. 16-bit, 32-bit and 64-bit integers only.
+template <typename T>
+class adaptive_divider {
+   public:
+    adaptive_divider() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE adaptive_divider(T d) : div(d) {}
+
+    // Returns LIBDIVIDE_ALGORITHM_SHIFT, _MUL or _MUL_ADD (branchfree)
+    LIBDIVIDE_INLINE libdivide_algorithm path() const { return (libdivide_algorithm)div.path; }
+
+    // Returns n / d
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
 
-// Here, b is assumed to contain one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u32_vec256(__m256i a, __m256i b) {
-    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
-    __m256i a1X3X = _mm256_srli_epi64(a, 32);
-    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
-    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epu32(a1X3X, b), mask);
-    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+    // Returns the divisor
+    LIBDIVIDE_INLINE T recover() const { return div.recover(); }
+
+    // Stores the quotients of count numerators, quotients may be equal to numers
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count) const {
+        div.divide(numers, quotients, count);
+    }
+
+    bool operator==(const adaptive_divider<T> &other) const {
+        return recover() == other.recover();
+    }
+
+    bool operator!=(const adaptive_divider<T> &other) const { return !(*this == other); }
+
+   private:
+    adaptive_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T)> div;
+};
+
+// Overload of operator / for scalar division
+template <typename T>
+LIBDIVIDE_INLINE T operator/(T n, const adaptive_divider<T> &div) {
+    return div.divide(n);
 }
 
-// b is one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s32_vec256(__m256i a, __m256i b) {
-    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
-    __m256i a1X3X = _mm256_srli_epi64(a, 32);
-    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
-    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epi32(a1X3X, b), mask);
-    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+// Overload of operator /= for scalar division
+template <typename T>
+LIBDIVIDE_INLINE T &operator/=(T &n, const adaptive_divider<T> &div) {
+    n = div.divide(n);
+    return n;
 }
 
-// Here, y is assumed to contain one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u64_vec256(__m256i x, __m256i y) {
-    // see m128i variant for comments.
-    __m256i x0y0 = _mm256_mul_epu32(x, y);
-    __m256i x0y0_hi = _mm256_srli_epi64(x0y0, 32);
+// Converts count floating-point values to T by truncation towards
+// zero, like a cast. The values must be representable in T once
+// truncated (as for the cast), the vector conversions below return
+// the same integers as the cast for all of them.
+template <typename F, typename T>
+struct quantize_convert {
+    static LIBDIVIDE_INLINE void convert(const F *values, T *ints, size_t count) {
+        for (size_t i = 0; i < count; i++) ints[i] = (T)values[i];
+    }
+};
 
-    __m256i x1 = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
-    __m256i y1 = _mm256_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+// The QUANTIZE_CONVERT_GEN() macro generates the specialization of
+// quantize_convert which converts LANES values per STEP, where STEP
+// reads the values at v and stores the integers at q.
+#define QUANTIZE_CONVERT_GEN(F, T, LANES, STEP)                                        \
+    template <>                                                                        \
+    struct quantize_convert<F, T> {                                                    \
+        static LIBDIVIDE_INLINE void convert(const F *values, T *ints, size_t count) { \
+            size_t i = 0;                                                              \
+            for (; i + LANES <= count; i += LANES) {                                   \
+                const F *v = values + i;                                               \
+                T *q = ints + i;                                                       \
+                STEP;                                                                  \
+            }                                                                          \
+            for (; i < count; i++) ints[i] = (T)values[i];                             \
+        }                                                                              \
+    };
 
-    __m256i x0y1 = _mm256_mul_epu32(x, y1);
-    __m256i x1y0 = _mm256_mul_epu32(x1, y);
-    __m256i x1y1 = _mm256_mul_epu32(x1, y1);
+#if defined(LIBDIVIDE_AVX512)
+QUANTIZE_CONVERT_GEN(float, int32_t, 16,
+    _mm512_storeu_si512((__m512i *)q, _mm512_cvttps_epi32(_mm512_loadu_ps(v))))
+QUANTIZE_CONVERT_GEN(float, uint32_t, 16,
+    _mm512_storeu_si512((__m512i *)q, _mm512_cvttps_epu32(_mm512_loadu_ps(v))))
+QUANTIZE_CONVERT_GEN(double, int32_t, 8,
+    _mm256_storeu_si256((__m256i *)q, _mm512_cvttpd_epi32(_mm512_loadu_pd(v))))
+QUANTIZE_CONVERT_GEN(double, uint32_t, 8,
+    _mm256_storeu_si256((__m256i *)q, _mm512_cvttpd_epu32(_mm512_loadu_pd(v))))
+#if defined(__AVX512DQ__)
+QUANTIZE_CONVERT_GEN(float, int64_t, 8,
+    _mm512_storeu_si512((__m512i *)q, _mm512_cvttps_epi64(_mm256_loadu_ps(v))))
+QUANTIZE_CONVERT_GEN(float, uint64_t, 8,
+    _mm512_storeu_si512((__m512i *)q, _mm512_cvttps_epu64(_mm256_loadu_ps(v))))
+QUANTIZE_CONVERT_GEN(double, int64_t, 8,
+    _mm512_storeu_si512((__m512i *)q, _mm512_cvttpd_epi64(_mm512_loadu_pd(v))))
+QUANTIZE_CONVERT_GEN(double, uint64_t, 8,
+    _mm512_storeu_si512((__m512i *)q, _mm512_cvttpd_epu64(_mm512_loadu_pd(v))))
+#endif
+#elif defined(LIBDIVIDE_AVX2)
+QUANTIZE_CONVERT_GEN(float, int32_t, 8,
+    _mm256_storeu_si256((__m256i *)q, _mm256_cvttps_epi32(_mm256_loadu_ps(v))))
+QUANTIZE_CONVERT_GEN(double, int32_t, 4,
+    _mm_storeu_si128((__m128i *)q, _mm256_cvttpd_epi32(_mm256_loadu_pd(v))))
+#elif defined(LIBDIVIDE_SSE2)
+QUANTIZE_CONVERT_GEN(float, int32_t, 4,
+    _mm_storeu_si128((__m128i *)q, _mm_cvttps_epi32(_mm_loadu_ps(v))))
+QUANTIZE_CONVERT_GEN(double, int32_t, 2,
+    _mm_storel_epi64((__m128i *)q, _mm_cvttpd_epi32(_mm_loadu_pd(v))))
+#elif defined(LIBDIVIDE_NEON)
+QUANTIZE_CONVERT_GEN(float, int32_t, 4, vst1q_s32(q, vcvtq_s32_f32(vld1q_f32(v))))
+QUANTIZE_CONVERT_GEN(float, uint32_t, 4, vst1q_u32(q, vcvtq_u32_f32(vld1q_f32(v))))
+#endif
 
-    __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
-    __m256i temp = _mm256_add_epi64(x1y0, x0y0_hi);
-    __m256i temp_lo = _mm256_and_si256(temp, mask);
-    __m256i temp_hi = _mm256_srli_epi64(temp, 32);
+// Quantizes floating-point values into integer bins of width d:
+// the bin of x is (T)x / d, i.e. x truncated towards zero and divided
+// by d. This is exactly trunc(x / d) computed without rounding,
+// unlike (T)(x / d) whose floating-point division may round up to
+// the next bin. The arrays are converted in blocks which are then
+// divided in place by the array functions of divider<T, ALGO>, so
+// the bins are written in one pass over the values. Truncated values
+// must be representable in T, as for the cast.
+template <typename T, Branching ALGO = BRANCHFULL>
+class quantizer {
+   public:
+    quantizer() {}
 
-    temp_lo = _mm256_srli_epi64(_mm256_add_epi64(temp_lo, x0y1), 32);
-    temp_hi = _mm256_add_epi64(x1y1, temp_hi);
-    return _mm256_add_epi64(temp_lo, temp_hi);
-}
+    // Constructor that takes the bin width as a parameter
+    LIBDIVIDE_INLINE quantizer(T d) : div(d) {}
 
-// y is one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s64_vec256(__m256i x, __m256i y) {
-    __m256i p = libdivide_mullhi_u64_vec256(x, y);
-    __m256i t1 = _mm256_and_si256(libdivide_s64_signbits(x), y);
-    __m256i t2 = _mm256_and_si256(libdivide_s64_signbits(y), x);
-    p = _mm256_sub_epi64(p, t1);
-    p = _mm256_sub_epi64(p, t2);
-    return p;
-}
+    // Returns the bin of x
+    LIBDIVIDE_INLINE T quantize(float x) const { return div.divide((T)x); }
+    LIBDIVIDE_INLINE T quantize(double x) const { return div.divide((T)x); }
 
-////////// UINT32
+    // Stores the bins of count values, neither array needs to be aligned
+    LIBDIVIDE_INLINE void quantize(const float *values, T *bins, size_t count) const {
+        quantize_array(values, bins, count);
+    }
+    LIBDIVIDE_INLINE void quantize(const double *values, T *bins, size_t count) const {
+        quantize_array(values, bins, count);
+    }
 
-__m256i libdivide_u32_do_vec256(__m256i numers, const struct libdivide_u32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm256_srli_epi32(numers, more);
-    } else {
-        __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
-            return _mm256_srli_epi32(t, shift);
-        } else {
-            return _mm256_srli_epi32(q, more);
-        }
+    // Integer (e.g. fixed-point) values are divided by d, bins may be equal to values
+    LIBDIVIDE_INLINE void quantize(const T *values, T *bins, size_t count) const {
+        div.divide(values, bins, count);
     }
-}
 
-__m256i libdivide_u32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u32_branchfree_t *denom) {
-    __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
-    __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
-    return _mm256_srli_epi32(t, denom->more);
-}
+    // Returns the bin width
+    LIBDIVIDE_INLINE T recover() const { return div.recover(); }
 
-////////// UINT64
+    bool operator==(const quantizer<T, ALGO> &other) const { return div == other.div; }
 
-__m256i libdivide_u64_do_vec256(__m256i numers, const struct libdivide_u64_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm256_srli_epi64(numers, more);
-    } else {
-        __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
-            return _mm256_srli_epi64(t, shift);
-        } else {
-            return _mm256_srli_epi64(q, more);
+    bool operator!=(const quantizer<T, ALGO> &other) const { return !(*this == other); }
+
+   private:
+    // The bins of a block are still in the L1 cache when they are divided
+    static const size_t block = 4096 / sizeof(T);
+
+    template <typename F>
+    LIBDIVIDE_INLINE void quantize_array(const F *values, T *bins, size_t count) const {
+        for (size_t i = 0; i < count; i += block) {
+            size_t n = (count - i < block) ? count - i : block;
+            quantize_convert<F, T>::convert(values + i, bins + i, n);
+            div.divide(bins + i, bins + i, n);
         }
     }
-}
-
-__m256i libdivide_u64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u64_branchfree_t *denom) {
-    __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
-    __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
-    return _mm256_srli_epi64(t, denom->more);
-}
 
-////////// SINT32
+    divider<T, ALGO> div;
+};
 
-__m256i libdivide_s32_do_vec256(__m256i numers, const struct libdivide_s32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        uint32_t mask = (1U << shift) - 1;
-        __m256i roundToZeroTweak = _mm256_set1_epi32(mask);
-        // q = numer + ((numer >> 31) & roundToZeroTweak);
-        __m256i q = _mm256_add_epi32(
-            numers, _mm256_and_si256(_mm256_srai_epi32(numers, 31), roundToZeroTweak));
-        q = _mm256_srai_epi32(q, shift);
-        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);
-        return q;
-    } else {
-        __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm256_add_epi32(q, _mm256_sub_epi32(_mm256_xor_si256(numers, sign), sign));
-        }
-        // q >>= shift
-        q = _mm256_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = _mm256_add_epi32(q, _mm256_srli_epi32(q, 31));  // q += (q < 0)
-        return q;
+// The LANES_DISPATCHER_GEN() macro generates the static C++ methods
+// of lanes_dispatcher, which operate on one divider of a divider_array.
+#define LANES_DISPATCHER_GEN(T, ALGO)                                                         \
+    typedef libdivide_##ALGO##_t denom_t;                                                     \
+    static LIBDIVIDE_INLINE void gen(T d, T *magic, uint8_t *more) {                          \
+        denom_t denom = libdivide_##ALGO##_gen(d);                                            \
+        *magic = denom.magic;                                                                 \
+        *more = denom.more;                                                                   \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE T divide(T n, T magic, uint8_t more) {                            \
+        denom_t denom = {magic, more};                                                        \
+        return libdivide_##ALGO##_do(n, &denom);                                              \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE T recover(T magic, uint8_t more) {                                \
+        denom_t denom = {magic, more};                                                        \
+        return libdivide_##ALGO##_recover(&denom);                                            \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE void divide(                                                      \
+        const T *numers, T *quotients, size_t count, const T *magics, const uint8_t *mores) { \
+        libdivide_##ALGO##_do_array_lanes(numers, quotients, count, magics, mores);           \
     }
-}
 
-__m256i libdivide_s32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s32_branchfree_t *denom) {
-    int32_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    // must be arithmetic shift
-    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-    __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(magic));
-    q = _mm256_add_epi32(q, numers);  // q += numers
+// Unsigned integers use the branchfull algorithm as it supports
+// the divisor 1, signed integers use the branchfree algorithm
+// which has the same instruction count for all divisors.
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF>
+struct lanes_dispatcher {};
 
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint32_t is_power_of_2 = (magic == 0);
-    __m256i q_sign = _mm256_srai_epi32(q, 31);  // q_sign = q >> 31
-    __m256i mask = _mm256_set1_epi32((1U << shift) - is_power_of_2);
-    q = _mm256_add_epi32(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm256_srai_epi32(q, shift);                          // q >>= shift
-    q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
-}
+template <>
+struct lanes_dispatcher<true, false, sizeof(uint32_t)> {
+    LANES_DISPATCHER_GEN(uint32_t, u32)
+};
+template <>
+struct lanes_dispatcher<true, true, sizeof(int32_t)> {
+    LANES_DISPATCHER_GEN(int32_t, s32_branchfree)
+};
+template <>
+struct lanes_dispatcher<true, false, sizeof(uint64_t)> {
+    LANES_DISPATCHER_GEN(uint64_t, u64)
+};
+template <>
+struct lanes_dispatcher<true, true, sizeof(int64_t)> {
+    LANES_DISPATCHER_GEN(int64_t, s64_branchfree)
+};
 
-////////// SINT64
+// Stores many dividers as a structure of arrays: the magic numbers
+// and the "more" bytes are kept in two separate 64-byte aligned
+// arrays. This uses sizeof(T) + 1 bytes per divisor, instead of the
+// padded divider<T>, and supports dividing each numerator by its own
+// divisor using SIMD: quotients[i] = numers[i] / d[i].
+template <typename T>
+class divider_array {
+    typedef lanes_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T)>
+        dispatcher_t;
 
-__m256i libdivide_s64_do_vec256(__m256i numers, const struct libdivide_s64_t *denom) {
-    uint8_t more = denom->more;
-    int64_t magic = denom->magic;
-    if (magic == 0) {  // shift path
-        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-        uint64_t mask = (1ULL << shift) - 1;
-        __m256i roundToZeroTweak = _mm256_set1_epi64x(mask);
-        // q = numer + ((numer >> 63) & roundToZeroTweak);
-        __m256i q = _mm256_add_epi64(
-            numers, _mm256_and_si256(libdivide_s64_signbits(numers), roundToZeroTweak));
-        q = libdivide_s64_shift_right_vec256(q, shift);
-        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);
-        return q;
-    } else {
-        __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm256_add_epi64(q, _mm256_sub_epi64(_mm256_xor_si256(numers, sign), sign));
-        }
-        // q >>= denom->mult_path.shift
-        q = libdivide_s64_shift_right_vec256(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = _mm256_add_epi64(q, _mm256_srli_epi64(q, 63));  // q += (q < 0)
-        return q;
+   public:
+    divider_array() : count(0), block(NULL), magic(NULL), more(NULL) {}
+
+    // Generates the dividers of the divisors array
+    divider_array(const T *divisors, size_t count)
+        : count(0), block(NULL), magic(NULL), more(NULL) {
+        allocate(count);
+        for (size_t i = 0; i < count; i++) dispatcher_t::gen(divisors[i], &magic[i], &more[i]);
     }
-}
 
-__m256i libdivide_s64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s64_branchfree_t *denom) {
-    int64_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift
-    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+    divider_array(const divider_array &other) : count(0), block(NULL), magic(NULL), more(NULL) {
+        copy(other);
+    }
 
-    // libdivide_mullhi_s64(numers, magic);
-    __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
-    q = _mm256_add_epi64(q, numers);  // q += numers
+    divider_array &operator=(const divider_array &other) {
+        if (this != &other) {
+            release();
+            copy(other);
+        }
+        return *this;
+    }
 
-    // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2.
-    uint32_t is_power_of_2 = (magic == 0);
-    __m256i q_sign = libdivide_s64_signbits(q);  // q_sign = q >> 63
-    __m256i mask = _mm256_set1_epi64x((1ULL << shift) - is_power_of_2);
-    q = _mm256_add_epi64(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_shift_right_vec256(q, shift);           // q >>= shift
-    q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
-}
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+    divider_array(divider_array &&other) noexcept
+        : count(other.count), block(other.block), magic(other.magic), more(other.more) {
+        other.count = 0;
+        other.block = NULL;
+        other.magic = NULL;
+        other.more = NULL;
+    }
 
+    divider_array &operator=(divider_array &&other) noexcept {
+        if (this != &other) {
+            release();
+            count = other.count;
+            block = other.block;
+            magic = other.magic;
+            more = other.more;
+            other.count = 0;
+            other.block = NULL;
+            other.magic = NULL;
+            other.more = NULL;
+        }
+        return *this;
+    }
 #endif
 
-#if defined(LIBDIVIDE_SSE2)
+    ~divider_array() { release(); }
 
-static LIBDIVIDE_INLINE __m128i libdivide_u32_do_vec128(
-    __m128i numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s32_do_vec128(
-    __m128i numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_u64_do_vec128(
-    __m128i numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s64_do_vec128(
-    __m128i numers, const struct libdivide_s64_t *denom);
+    // Number of dividers
+    LIBDIVIDE_INLINE size_t size() const { return count; }
 
-static LIBDIVIDE_INLINE __m128i libdivide_u32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_u64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s64_branchfree_t *denom);
+    // Returns n / d[i]
+    LIBDIVIDE_INLINE T divide(T n, size_t i) const {
+        return dispatcher_t::divide(n, magic[i], more[i]);
+    }
 
-//////// Internal Utility Functions
+    // Returns d[i]
+    LIBDIVIDE_INLINE T recover(size_t i) const { return dispatcher_t::recover(magic[i], more[i]); }
 
-// Implementation of _mm_srai_epi64(v, 63) (from AVX512).
-static LIBDIVIDE_INLINE __m128i libdivide_s64_signbits(__m128i v) {
-    __m128i hiBitsDuped = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
-    __m128i signBits = _mm_srai_epi32(hiBitsDuped, 31);
-    return signBits;
-}
+    // Computes quotients[i] = numers[i] / d[i] for all size() dividers,
+    // numers and quotients do not need to be aligned.
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quotients) const {
+        dispatcher_t::divide(numers, quotients, count, magic, more);
+    }
+
+    // The separate arrays, which can be fed to the
+    // libdivide_*_do_lanes_vec256/vec512 kernels.
+    LIBDIVIDE_INLINE const T *magics() const { return magic; }
+    LIBDIVIDE_INLINE const uint8_t *mores() const { return more; }
+
+   private:
+    enum { ALIGNMENT = 64 };
+
+    void allocate(size_t n) {
+        if (n == 0) return;
+        size_t magic_bytes = (n * sizeof(T) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+        block = std::malloc(magic_bytes + n + ALIGNMENT);
+        if (!block) {
+            LIBDIVIDE_ERROR("out of memory");
+        }
+        uintptr_t aligned = ((uintptr_t)block + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1);
+        magic = (T *)aligned;
+        more = (uint8_t *)(aligned + magic_bytes);
+        count = n;
+    }
 
-// Implementation of _mm_srai_epi64 (from AVX512).
-static LIBDIVIDE_INLINE __m128i libdivide_s64_shift_right_vec128(__m128i v, int amt) {
-    const int b = 64 - amt;
-    __m128i m = _mm_set1_epi64x(1ULL << (b - 1));
-    __m128i x = _mm_srli_epi64(v, amt);
-    __m128i result = _mm_sub_epi64(_mm_xor_si128(x, m), m);
-    return result;
-}
+    void copy(const divider_array &other) {
+        allocate(other.count);
+        if (count == 0) return;
+        std::memcpy(magic, other.magic, count * sizeof(T));
+        std::memcpy(more, other.more, count);
+    }
 
-// Here, b is assumed to contain one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u32_vec128(__m128i a, __m128i b) {
-    __m128i hi_product_0Z2Z = _mm_srli_epi64(_mm_mul_epu32(a, b), 32);
-    __m128i a1X3X = _mm_srli_epi64(a, 32);
-    __m128i mask = _mm_set_epi32(-1, 0, -1, 0);
-    __m128i hi_product_Z1Z3 = _mm_and_si128(_mm_mul_epu32(a1X3X, b), mask);
-    return _mm_or_si128(hi_product_0Z2Z, hi_product_Z1Z3);
-}
+    void release() {
+        std::free(block);
+        count = 0;
+        block = NULL;
+        magic = NULL;
+        more = NULL;
+    }
 
-// SSE2 does not have a signed multiplication instruction, but we can convert
-// unsigned to signed pretty efficiently. Again, b is just a 32 bit value
-// repeated four times.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s32_vec128(__m128i a, __m128i b) {
-    __m128i p = libdivide_mullhi_u32_vec128(a, b);
-    // t1 = (a >> 31) & y, arithmetic shift
-    __m128i t1 = _mm_and_si128(_mm_srai_epi32(a, 31), b);
-    __m128i t2 = _mm_and_si128(_mm_srai_epi32(b, 31), a);
-    p = _mm_sub_epi32(p, t1);
-    p = _mm_sub_epi32(p, t2);
-    return p;
-}
+    size_t count;
+    void *block;
+    T *magic;
+    uint8_t *more;
+};
 
-// Here, y is assumed to contain one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u64_vec128(__m128i x, __m128i y) {
-    // full 128 bits product is:
-    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
-    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
+// The PACKED_DISPATCHER_GEN() macro generates the static C++ methods
+// of packed_dispatcher, which operate on the structs of a packed_divider_array.
+#define PACKED_DISPATCHER_GEN(T, ALGO)                                                \
+    typedef libdivide_##ALGO##_t denom_t;                                             \
+    static LIBDIVIDE_INLINE denom_t gen(T d) { return libdivide_##ALGO##_gen(d); }    \
+    static LIBDIVIDE_INLINE T divide(T n, const denom_t &denom) {                     \
+        return libdivide_##ALGO##_do(n, &denom);                                      \
+    }                                                                                 \
+    static LIBDIVIDE_INLINE T recover(const denom_t &denom) {                         \
+        return libdivide_##ALGO##_recover(&denom);                                    \
+    }                                                                                 \
+    static LIBDIVIDE_INLINE void divide(const T *numers, T *quotients, size_t count,  \
+        const denom_t *table, const uint32_t *indices) {                              \
+        libdivide_##ALGO##_do_array_packed(numers, quotients, count, table, indices); \
+    }
 
-    // Compute x0*y0.
-    // Note x1, y1 are ignored by mul_epu32.
-    __m128i x0y0 = _mm_mul_epu32(x, y);
-    __m128i x0y0_hi = _mm_srli_epi64(x0y0, 32);
+// Same algorithms as lanes_dispatcher
+template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF>
+struct packed_dispatcher {};
 
-    // Get x1, y1 in the low bits.
-    // We could shuffle or right shift. Shuffles are preferred as they preserve
-    // the source register for the next computation.
-    __m128i x1 = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
-    __m128i y1 = _mm_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+template <>
+struct packed_dispatcher<true, false, sizeof(uint32_t)> {
+    PACKED_DISPATCHER_GEN(uint32_t, u32)
+};
+template <>
+struct packed_dispatcher<true, true, sizeof(int32_t)> {
+    PACKED_DISPATCHER_GEN(int32_t, s32_branchfree)
+};
 
-    // No need to mask off top 32 bits for mul_epu32.
-    __m128i x0y1 = _mm_mul_epu32(x, y1);
-    __m128i x1y0 = _mm_mul_epu32(x1, y);
-    __m128i x1y1 = _mm_mul_epu32(x1, y1);
+// Stores many 32-bit dividers as an array of the byte packed (5-byte)
+// libdivide_*_t structs, see libdivide_*_do_array_packed(). Unlike divider_array each divider is
+// stored contiguously, which suits tables that are looked up at random:
+// quotients[i] = numers[i] / d[indices[i]] gathers the dividers using
+// AVX2 and AVX512.
+template <typename T>
+class packed_divider_array {
+    typedef packed_dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T)>
+        dispatcher_t;
+    typedef typename dispatcher_t::denom_t denom_t;
 
-    // Mask here selects low bits only.
-    __m128i mask = _mm_set1_epi64x(0xFFFFFFFF);
-    __m128i temp = _mm_add_epi64(x1y0, x0y0_hi);
-    __m128i temp_lo = _mm_and_si128(temp, mask);
-    __m128i temp_hi = _mm_srli_epi64(temp, 32);
+   public:
+    packed_divider_array() : count(0), block(NULL), denoms(NULL) {}
 
-    temp_lo = _mm_srli_epi64(_mm_add_epi64(temp_lo, x0y1), 32);
-    temp_hi = _mm_add_epi64(x1y1, temp_hi);
-    return _mm_add_epi64(temp_lo, temp_hi);
-}
+    // Generates the dividers of the divisors array
+    packed_divider_array(const T *divisors, size_t count) : count(0), block(NULL), denoms(NULL) {
+        allocate(count);
+        for (size_t i = 0; i < count; i++) denoms[i] = dispatcher_t::gen(divisors[i]);
+    }
 
-// y is one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s64_vec128(__m128i x, __m128i y) {
-    __m128i p = libdivide_mullhi_u64_vec128(x, y);
-    __m128i t1 = _mm_and_si128(libdivide_s64_signbits(x), y);
-    __m128i t2 = _mm_and_si128(libdivide_s64_signbits(y), x);
-    p = _mm_sub_epi64(p, t1);
-    p = _mm_sub_epi64(p, t2);
-    return p;
-}
+    packed_divider_array(const packed_divider_array &other)
+        : count(0), block(NULL), denoms(NULL) {
+        copy(other);
+    }
 
-////////// UINT32
+    packed_divider_array &operator=(const packed_divider_array &other) {
+        if (this != &other) {
+            release();
+            copy(other);
+        }
+        return *this;
+    }
 
-__m128i libdivide_u32_do_vec128(__m128i numers, const struct libdivide_u32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm_srli_epi32(numers, more);
-    } else {
-        __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
-            return _mm_srli_epi32(t, shift);
-        } else {
-            return _mm_srli_epi32(q, more);
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+    packed_divider_array(packed_divider_array &&other) noexcept
+        : count(other.count), block(other.block), denoms(other.denoms) {
+        other.count = 0;
+        other.block = NULL;
+        other.denoms = NULL;
+    }
+
+    packed_divider_array &operator=(packed_divider_array &&other) noexcept {
+        if (this != &other) {
+            release();
+            count = other.count;
+            block = other.block;
+            denoms = other.denoms;
+            other.count = 0;
+            other.block = NULL;
+            other.denoms = NULL;
         }
+        return *this;
     }
-}
+#endif
 
-__m128i libdivide_u32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u32_branchfree_t *denom) {
-    __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
-    __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
-    return _mm_srli_epi32(t, denom->more);
-}
+    ~packed_divider_array() { release(); }
 
-////////// UINT64
+    // Number of dividers
+    LIBDIVIDE_INLINE size_t size() const { return count; }
 
-__m128i libdivide_u64_do_vec128(__m128i numers, const struct libdivide_u64_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm_srli_epi64(numers, more);
-    } else {
-        __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
-            return _mm_srli_epi64(t, shift);
-        } else {
-            return _mm_srli_epi64(q, more);
-        }
+    // Returns n / d[i]
+    LIBDIVIDE_INLINE T divide(T n, size_t i) const { return dispatcher_t::divide(n, denoms[i]); }
+
+    // Returns d[i]
+    LIBDIVIDE_INLINE T recover(size_t i) const { return dispatcher_t::recover(denoms[i]); }
+
+    // Computes quotients[i] = numers[i] / d[indices[i]] for count
+    // numerators, the indices must be < size() and < 2^31 / 5.
+    LIBDIVIDE_INLINE void divide(
+        const T *numers, const uint32_t *indices, T *quotients, size_t count) const {
+        dispatcher_t::divide(numers, quotients, count, denoms, indices);
     }
-}
 
-__m128i libdivide_u64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u64_branchfree_t *denom) {
-    __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
-    __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
-    return _mm_srli_epi64(t, denom->more);
-}
+    // The dividers, which can be fed to the
+    // libdivide_gather_packed_vec256/vec512 loaders.
+    LIBDIVIDE_INLINE const denom_t *data() const { return denoms; }
 
-////////// SINT32
+   private:
+    enum { ALIGNMENT = 64 };
 
-__m128i libdivide_s32_do_vec128(__m128i numers, const struct libdivide_s32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        uint32_t mask = (1U << shift) - 1;
-        __m128i roundToZeroTweak = _mm_set1_epi32(mask);
-        // q = numer + ((numer >> 31) & roundToZeroTweak);
-        __m128i q =
-            _mm_add_epi32(numers, _mm_and_si128(_mm_srai_epi32(numers, 31), roundToZeroTweak));
-        q = _mm_srai_epi32(q, shift);
-        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);
-        return q;
-    } else {
-        __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm_add_epi32(q, _mm_sub_epi32(_mm_xor_si128(numers, sign), sign));
+    void allocate(size_t n) {
+        if (n == 0) return;
+        block = std::malloc(n * sizeof(denom_t) + ALIGNMENT);
+        if (!block) {
+            LIBDIVIDE_ERROR("out of memory");
         }
-        // q >>= shift
-        q = _mm_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = _mm_add_epi32(q, _mm_srli_epi32(q, 31));  // q += (q < 0)
-        return q;
+        denoms = (denom_t *)(((uintptr_t)block + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1));
+        count = n;
     }
-}
 
-__m128i libdivide_s32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s32_branchfree_t *denom) {
-    int32_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    // must be arithmetic shift
-    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
-    __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(magic));
-    q = _mm_add_epi32(q, numers);  // q += numers
+    void copy(const packed_divider_array &other) {
+        allocate(other.count);
+        if (count == 0) return;
+        std::memcpy(denoms, other.denoms, count * sizeof(denom_t));
+    }
 
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint32_t is_power_of_2 = (magic == 0);
-    __m128i q_sign = _mm_srai_epi32(q, 31);  // q_sign = q >> 31
-    __m128i mask = _mm_set1_epi32((1U << shift) - is_power_of_2);
-    q = _mm_add_epi32(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm_srai_epi32(q, shift);                       // q >>= shift
-    q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+    void release() {
+        std::free(block);
+        count = 0;
+        block = NULL;
+        denoms = NULL;
+    }
+
+    size_t count;
+    void *block;
+    denom_t *denoms;
+};
+
+// Divisors that bypass the divider caches: 0 (which is not a valid
+// divisor and is the empty key) as well as 1 and powers of 2, whose
+// dividers are generated without any division.
+template <typename T>
+LIBDIVIDE_INLINE bool divider_cache_bypass(T d) {
+    return d == 0 || (d > 0 && (d & (d - 1)) == 0);
 }
 
-////////// SINT64
+// Fibonacci hashing, returns the top bits of d * 2^64 / phi
+template <typename T>
+LIBDIVIDE_INLINE size_t divider_cache_index(T d, int bits) {
+    uint64_t x = (uint64_t)d;
+    if (sizeof(T) > 8) x ^= (uint64_t)(d >> (sizeof(T) * 4));
+    return (size_t)((x * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
 
-__m128i libdivide_s64_do_vec128(__m128i numers, const struct libdivide_s64_t *denom) {
-    uint8_t more = denom->more;
-    int64_t magic = denom->magic;
-    if (magic == 0) {  // shift path
-        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-        uint64_t mask = (1ULL << shift) - 1;
-        __m128i roundToZeroTweak = _mm_set1_epi64x(mask);
-        // q = numer + ((numer >> 63) & roundToZeroTweak);
-        __m128i q =
-            _mm_add_epi64(numers, _mm_and_si128(libdivide_s64_signbits(numers), roundToZeroTweak));
-        q = libdivide_s64_shift_right_vec128(q, shift);
-        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);
-        return q;
-    } else {
-        __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm_add_epi64(q, _mm_sub_epi64(_mm_xor_si128(numers, sign), sign));
+constexpr int divider_cache_log2(size_t n) { return n <= 1 ? 0 : 1 + divider_cache_log2(n / 2); }
+
+// Memoizes the dividers of recurring runtime divisors, so that
+// looking up a cached divisor skips the libdivide_*_gen() division.
+// The cache is 2-way set associative with N entries (a power of 2)
+// and least recently used eviction. It is not thread safe, see
+// thread_divider_cache() and shared_divider_cache.
+template <typename T, size_t N = 256, Branching ALGO = BRANCHFULL>
+class divider_cache {
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "N must be a power of 2 >= 4");
+
+   public:
+    divider_cache() { clear(); }
+
+    // Returns the divider of d, generating it on a cache miss
+    LIBDIVIDE_INLINE divider<T, ALGO> get(T d) {
+        if (divider_cache_bypass(d)) return divider<T, ALGO>(d);
+        set_t &set = sets[divider_cache_index(d, BITS)];
+        if (set.key[0] == d) return set.div[0];
+        if (set.key[1] == d) {
+            set.key[1] = set.key[0];
+            set.key[0] = d;
+            divider<T, ALGO> div = set.div[1];
+            set.div[1] = set.div[0];
+            set.div[0] = div;
+            return div;
         }
-        // q >>= denom->mult_path.shift
-        q = libdivide_s64_shift_right_vec128(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = _mm_add_epi64(q, _mm_srli_epi64(q, 63));  // q += (q < 0)
-        return q;
+        divider<T, ALGO> div(d);
+        set.key[1] = set.key[0];
+        set.div[1] = set.div[0];
+        set.key[0] = d;
+        set.div[0] = div;
+        return div;
     }
-}
 
-__m128i libdivide_s64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s64_branchfree_t *denom) {
-    int64_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift
-    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+    // Empties the cache
+    void clear() {
+        for (size_t i = 0; i < N / 2; i++) {
+            sets[i].key[0] = 0;
+            sets[i].key[1] = 0;
+        }
+    }
 
-    // libdivide_mullhi_s64(numers, magic);
-    __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
-    q = _mm_add_epi64(q, numers);  // q += numers
+   private:
+    static const int BITS = divider_cache_log2(N / 2);
+
+    // Way 0 holds the most recently used divisor
+    struct set_t {
+        T key[2];
+        divider<T, ALGO> div[2];
+    };
+    set_t sets[N / 2];
+};
 
-    // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2.
-    uint32_t is_power_of_2 = (magic == 0);
-    __m128i q_sign = libdivide_s64_signbits(q);  // q_sign = q >> 63
-    __m128i mask = _mm_set1_epi64x((1ULL << shift) - is_power_of_2);
-    q = _mm_add_epi64(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_shift_right_vec128(q, shift);     // q >>= shift
-    q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+// Returns the divider cache of the calling thread
+template <typename T, size_t N = 256, Branching ALGO = BRANCHFULL>
+LIBDIVIDE_INLINE divider_cache<T, N, ALGO> &thread_divider_cache() {
+    static thread_local divider_cache<T, N, ALGO> cache;
+    return cache;
 }
 
-#endif
-
-/////////// C++ stuff
-
-#ifdef __cplusplus
+// A direct mapped divider cache which can be shared by many threads.
+// It is lock-free: each entry is guarded by a sequence number, which
+// is odd while the entry is written. Readers treat a concurrent write
+// as a miss and writers skip the insertion if another thread is
+// writing the same entry.
+template <typename T, size_t N = 256, Branching ALGO = BRANCHFULL>
+class shared_divider_cache {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of 2 >= 2");
+    static_assert(sizeof(T) <= 8, "128-bit atomics are not lock-free");
 
-enum Branching {
-    BRANCHFULL,  // use branching algorithms
-    BRANCHFREE   // use branchfree algorithms
-};
+   public:
+    shared_divider_cache() {
+        for (size_t i = 0; i < N; i++) {
+            entries[i].seq.store(0, std::memory_order_relaxed);
+            entries[i].key.store(0, std::memory_order_relaxed);
+        }
+    }
 
-#if defined(LIBDIVIDE_NEON)
-// Helper to deduce NEON vector type for integral type.
-template <typename T>
-struct NeonVecFor {};
+    shared_divider_cache(const shared_divider_cache &) = delete;
+    shared_divider_cache &operator=(const shared_divider_cache &) = delete;
+
+    // Returns the divider of d, generating it on a cache miss
+    LIBDIVIDE_INLINE divider<T, ALGO> get(T d) {
+        if (divider_cache_bypass(d)) return divider<T, ALGO>(d);
+        entry_t &e = entries[divider_cache_index(d, BITS)];
+        uint32_t seq = e.seq.load(std::memory_order_acquire);
+        if ((seq & 1) == 0 && e.key.load(std::memory_order_relaxed) == d) {
+            T words[WORDS];
+            for (int i = 0; i < WORDS; i++) words[i] = e.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq.load(std::memory_order_relaxed) == seq) {
+                divider<T, ALGO> div;
+                std::memcpy((void *)&div, words, sizeof(div));
+                return div;
+            }
+        }
 
-template <>
-struct NeonVecFor<uint32_t> {
-    typedef uint32x4_t type;
-};
+        divider<T, ALGO> div(d);
+        if ((seq & 1) == 0 &&
+            e.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed)) {
+            std::atomic_thread_fence(std::memory_order_release);
+            T words[WORDS] = {0};
+            std::memcpy(words, &div, sizeof(div));
+            e.key.store(d, std::memory_order_relaxed);
+            for (int i = 0; i < WORDS; i++) e.words[i].store(words[i], std::memory_order_relaxed);
+            e.seq.store(seq + 2, std::memory_order_release);
+        }
+        return div;
+    }
 
-template <>
-struct NeonVecFor<int32_t> {
-    typedef int32x4_t type;
+   private:
+    static const int BITS = divider_cache_log2(N);
+    // The divider is stored as T words, the magic number
+    // being the first one avoids store forwarding stalls.
+    static const int WORDS = (sizeof(divider<T, ALGO>) + sizeof(T) - 1) / sizeof(T);
+
+    struct entry_t {
+        std::atomic<uint32_t> seq;
+        std::atomic<T> key;
+        std::atomic<T> words[WORDS];
+    };
+    entry_t entries[N];
 };
 
-template <>
-struct NeonVecFor<uint64_t> {
-    typedef uint64x2_t type;
-};
+// An entry of divider_table. Dividers of up to 8 bytes (all except
+// the 64-bit and 128-bit ones) are stored in a single atomic word,
+// readers load a consistent divider using one (wait-free) load.
+template <typename Divider, bool PACKED = (sizeof(Divider) <= 8)>
+struct divider_table_entry {
+    std::atomic<uint64_t> word;
+
+    LIBDIVIDE_INLINE Divider load() const {
+        uint64_t w = word.load(std::memory_order_acquire);
+        Divider div;
+        std::memcpy((void *)&div, &w, sizeof(div));
+        return div;
+    }
 
-template <>
-struct NeonVecFor<int64_t> {
-    typedef int64x2_t type;
+    void store(const Divider &div) {
+        uint64_t w = 0;
+        std::memcpy(&w, &div, sizeof(div));
+        word.store(w, std::memory_order_release);
+    }
 };
-#endif
 
-// Versions of our algorithms for SIMD.
-#if defined(LIBDIVIDE_NEON)
-#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)                    \
-    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divide( \
-        typename NeonVecFor<INT_TYPE>::type n) const {           \
-        return libdivide_##ALGO##_do_vec128(n, &denom);          \
-    }
-#else
-#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)
-#endif
-#if defined(LIBDIVIDE_SSE2)
-#define LIBDIVIDE_DIVIDE_SSE2(ALGO)                     \
-    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {  \
-        return libdivide_##ALGO##_do_vec128(n, &denom); \
+// Larger dividers are guarded by a sequence number which is odd while
+// the entry is written, readers retry if a write overlapped their read.
+template <typename Divider>
+struct divider_table_entry<Divider, false> {
+    static const int WORDS = (sizeof(Divider) + 7) / 8;
+    std::atomic<uint32_t> seq;
+    std::atomic<uint64_t> words[WORDS];
+
+    LIBDIVIDE_INLINE Divider load() const {
+        uint64_t w[WORDS];
+        for (;;) {
+            uint32_t s = seq.load(std::memory_order_acquire);
+            for (int i = 0; i < WORDS; i++) w[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((s & 1) == 0 && seq.load(std::memory_order_relaxed) == s) break;
+        }
+        Divider div;
+        std::memcpy((void *)&div, w, sizeof(div));
+        return div;
     }
-#else
-#define LIBDIVIDE_DIVIDE_SSE2(ALGO)
-#endif
 
-#if defined(LIBDIVIDE_AVX2)
-#define LIBDIVIDE_DIVIDE_AVX2(ALGO)                     \
-    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {  \
-        return libdivide_##ALGO##_do_vec256(n, &denom); \
+    void store(const Divider &div) {
+        uint64_t w[WORDS] = {0};
+        std::memcpy(w, &div, sizeof(div));
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        while ((s & 1) != 0 || !seq.compare_exchange_weak(s, s + 1, std::memory_order_relaxed))
+            s = seq.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < WORDS; i++) words[i].store(w[i], std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
     }
-#else
-#define LIBDIVIDE_DIVIDE_AVX2(ALGO)
-#endif
+};
 
-#if defined(LIBDIVIDE_AVX512)
-#define LIBDIVIDE_DIVIDE_AVX512(ALGO)                   \
-    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {  \
-        return libdivide_##ALGO##_do_vec512(n, &denom); \
+// An entry of divider_table padded to its own 64-byte cache line
+template <typename Divider>
+struct alignas(64) padded_divider_table_entry : divider_table_entry<Divider> {};
+
+// A fixed size table of dividers that is read by many threads and
+// republished by writers, e.g. when a configuration reload changes
+// the divisors. Each entry is updated atomically: readers always see
+// either the old or the new divider of an entry, never a torn one,
+// without taking any lock. If PADDED is true (default) each entry
+// occupies its own 64-byte cache line, so that a writer republishing
+// an entry does not invalidate the cache lines read by the readers of
+// the other entries. Otherwise the entries are packed (8 bytes each,
+// or 8 bytes per word plus a sequence number for larger dividers)
+// and only the table itself is 64-byte aligned.
+template <typename T, Branching ALGO = BRANCHFREE, bool PADDED = true>
+class divider_table {
+    typedef typename std::conditional<PADDED, padded_divider_table_entry<divider<T, ALGO> >,
+        divider_table_entry<divider<T, ALGO> > >::type entry_t;
+    static_assert(!PADDED || sizeof(entry_t) % 64 == 0, "padded entries must fill cache lines");
+
+   public:
+    // All count entries are initialized to d
+    divider_table(size_t count, T d) : count(0), block(NULL), entries(NULL) {
+        allocate(count);
+        divider<T, ALGO> div(d);
+        for (size_t i = 0; i < count; i++) entries[i].store(div);
     }
-#else
-#define LIBDIVIDE_DIVIDE_AVX512(ALGO)
-#endif
 
-// The DISPATCHER_GEN() macro generates C++ methods (for the given integer
-// and algorithm types) that redirect to libdivide's C API.
-#define DISPATCHER_GEN(T, ALGO)                                                       \
-    libdivide_##ALGO##_t denom;                                                       \
-    LIBDIVIDE_INLINE dispatcher() {}                                                  \
-    LIBDIVIDE_INLINE dispatcher(T d) : denom(libdivide_##ALGO##_gen(d)) {}            \
-    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); } \
-    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); } \
-    LIBDIVIDE_DIVIDE_NEON(ALGO, T)                                                    \
-    LIBDIVIDE_DIVIDE_SSE2(ALGO)                                                       \
-    LIBDIVIDE_DIVIDE_AVX2(ALGO)                                                       \
-    LIBDIVIDE_DIVIDE_AVX512(ALGO)
+    divider_table(const T *divisors, size_t count) : count(0), block(NULL), entries(NULL) {
+        allocate(count);
+        for (size_t i = 0; i < count; i++) entries[i].store(divider<T, ALGO>(divisors[i]));
+    }
 
-// The dispatcher selects a specific division algorithm for a given
-// type and ALGO using partial template specialization.
-template <bool IS_INTEGRAL, bool IS_SIGNED, int SIZEOF, Branching ALGO>
-struct dispatcher {};
+    divider_table(const divider_table &) = delete;
+    divider_table &operator=(const divider_table &) = delete;
 
-template <>
-struct dispatcher<true, true, sizeof(int32_t), BRANCHFULL> {
-    DISPATCHER_GEN(int32_t, s32)
-};
-template <>
-struct dispatcher<true, true, sizeof(int32_t), BRANCHFREE> {
-    DISPATCHER_GEN(int32_t, s32_branchfree)
-};
-template <>
-struct dispatcher<true, false, sizeof(uint32_t), BRANCHFULL> {
-    DISPATCHER_GEN(uint32_t, u32)
-};
-template <>
-struct dispatcher<true, false, sizeof(uint32_t), BRANCHFREE> {
-    DISPATCHER_GEN(uint32_t, u32_branchfree)
-};
-template <>
-struct dispatcher<true, true, sizeof(int64_t), BRANCHFULL> {
-    DISPATCHER_GEN(int64_t, s64)
-};
-template <>
-struct dispatcher<true, true, sizeof(int64_t), BRANCHFREE> {
-    DISPATCHER_GEN(int64_t, s64_branchfree)
-};
-template <>
-struct dispatcher<true, false, sizeof(uint64_t), BRANCHFULL> {
-    DISPATCHER_GEN(uint64_t, u64)
-};
-template <>
-struct dispatcher<true, false, sizeof(uint64_t), BRANCHFREE> {
-    DISPATCHER_GEN(uint64_t, u64_branchfree)
-};
+    ~divider_table() {
+        for (size_t i = 0; i < count; i++) entries[i].~entry_t();
+        std::free(block);
+    }
 
-// This is the main divider class for use by the user (C++ API).
-// The actual division algorithm is selected using the dispatcher struct
-// based on the integer and algorithm template parameters.
-template <typename T, Branching ALGO = BRANCHFULL>
-class divider {
-   public:
-    // We leave the default constructor empty so that creating
-    // an array of dividers and then initializing them
-    // later doesn't slow us down.
-    divider() {}
+    // Number of entries
+    LIBDIVIDE_INLINE size_t size() const { return count; }
 
-    // Constructor that takes the divisor as a parameter
-    LIBDIVIDE_INLINE divider(T d) : div(d) {}
+    // Returns a consistent copy of the divider of entry i
+    LIBDIVIDE_INLINE divider<T, ALGO> load(size_t i) const { return entries[i].load(); }
 
-    // Divides n by the divisor
-    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+    // Returns n / d[i]
+    LIBDIVIDE_INLINE T divide(T n, size_t i) const { return load(i).divide(n); }
 
-    // Recovers the divisor, returns the value that was
-    // used to initialize this divider object.
-    T recover() const { return div.recover(); }
+    // Republishes entry i, the divider is generated before the entry
+    // is written so readers are never delayed by the generation.
+    void store(size_t i, T d) { entries[i].store(divider<T, ALGO>(d)); }
 
-    bool operator==(const divider<T, ALGO> &other) const {
-        return div.denom.magic == other.denom.magic && div.denom.more == other.denom.more;
+    // Republishes all entries, each of them is updated atomically
+    // but readers may see a mix of old and new entries meanwhile.
+    void store(const T *divisors) {
+        for (size_t i = 0; i < count; i++) store(i, divisors[i]);
     }
 
-    bool operator!=(const divider<T, ALGO> &other) const { return !(*this == other); }
+   private:
+    enum { ALIGNMENT = 64 };
 
-    // Vector variants treat the input as packed integer values with the same type as the divider
-    // (e.g. s32, u32, s64, u64) and divides each of them by the divider, returning the packed
-    // quotients.
-#if defined(LIBDIVIDE_SSE2)
-    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
-#endif
-#if defined(LIBDIVIDE_AVX2)
-    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
-#endif
-#if defined(LIBDIVIDE_AVX512)
-    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
-#endif
-#if defined(LIBDIVIDE_NEON)
-    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
-        return div.divide(n);
+    void allocate(size_t n) {
+        if (n == 0) return;
+        block = std::malloc(n * sizeof(entry_t) + ALIGNMENT);
+        if (!block) {
+            LIBDIVIDE_ERROR("out of memory");
+        }
+        uintptr_t aligned = ((uintptr_t)block + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1);
+        entries = (entry_t *)aligned;
+        for (size_t i = 0; i < n; i++) new (&entries[i]) entry_t();
+        count = n;
     }
-#endif
 
-   private:
-    // Storage for the actual divisor
-    dispatcher<std::is_integral<T>::value, std::is_signed<T>::value, sizeof(T), ALGO> div;
+    size_t count;
+    void *block;
+    entry_t *entries;
 };
 
-// Overload of operator / for scalar division
+// The serialized table type of divider<T, ALGO>, the 8-bit
+// dividers are stored as the 16-bit dividers they are made of.
 template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE T operator/(T n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
+struct serialized_table_type {
+    static_assert(sizeof(T) <= 8, "128-bit dividers cannot be serialized");
+    static_assert(ALGO == BRANCHFULL || ALGO == BRANCHFREE, "exact dividers cannot be serialized");
+    static_assert(sizeof(divider<T, ALGO>) == (sizeof(T) <= 2 ? 3 : sizeof(T) + 1),
+        "divider<T, ALGO> must only hold its libdivide_*_t struct");
+    static const libdivide_table_type value =
+        (libdivide_table_type)(LIBDIVIDE_TABLE_U16 + (sizeof(T) <= 2 ? 0 : sizeof(T) / 2) +
+                               (std::is_signed<T>::value ? 1 : 0) + (ALGO == BRANCHFREE ? 6 : 0));
+};
 
-// Overload of operator /= for scalar division
+// Writes a serialized table of count dividers to buffer, which must be
+// libdivide_table_size(type, count) bytes. Returns the table size.
 template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE T &operator/=(T &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
+LIBDIVIDE_INLINE size_t write_divider_table(
+    void *buffer, const divider<T, ALGO> *dividers, size_t count) {
+    return libdivide_table_write(buffer, serialized_table_type<T, ALGO>::value, dividers, count);
 }
 
-// Overloads for vector types.
-#if defined(LIBDIVIDE_SSE2)
+// Saves a serialized table of count dividers to a file
 template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m128i operator/(__m128i n, const divider<T, ALGO> &div) {
-    return div.divide(n);
+LIBDIVIDE_INLINE bool save_divider_table(
+    const char *path, const divider<T, ALGO> *dividers, size_t count) {
+    return libdivide_table_save(path, serialized_table_type<T, ALGO>::value, dividers, count) == 0;
 }
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m128i operator/=(__m128i &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
-#endif
-#if defined(LIBDIVIDE_AVX2)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m256i operator/(__m256i n, const divider<T, ALGO> &div) {
-    return div.divide(n);
+// Returns the dividers of a serialized table in place,
+// or NULL if data is not a valid table of divider<T, ALGO>.
+template <typename T, Branching ALGO = BRANCHFULL>
+LIBDIVIDE_INLINE const divider<T, ALGO> *read_divider_table(
+    const void *data, size_t size, size_t *count) {
+    return (const divider<T, ALGO> *)libdivide_table_read(
+        data, size, serialized_table_type<T, ALGO>::value, count);
 }
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m256i operator/=(__m256i &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+#if defined(LIBDIVIDE_MMAP)
+// A serialized table of divider<T, ALGO> mapped read-only, processes
+// mapping the same file share one copy of the dividers.
+template <typename T, Branching ALGO = BRANCHFULL>
+class mapped_divider_table {
+   public:
+    mapped_divider_table() { std::memset(&mapping, 0, sizeof(mapping)); }
+    explicit mapped_divider_table(const char *path) {
+        std::memset(&mapping, 0, sizeof(mapping));
+        open(path);
+    }
+    ~mapped_divider_table() { close(); }
+
+    mapped_divider_table(const mapped_divider_table &) = delete;
+    mapped_divider_table &operator=(const mapped_divider_table &) = delete;
+
+    // Returns false if the file cannot be mapped or is not a valid table
+    bool open(const char *path) {
+        close();
+        return libdivide_table_map(path, serialized_table_type<T, ALGO>::value, &mapping) == 0;
+    }
+
+    void close() { libdivide_table_unmap(&mapping); }
+
+    LIBDIVIDE_INLINE bool is_open() const { return mapping.addr != NULL; }
+    LIBDIVIDE_INLINE size_t size() const { return mapping.count; }
+    LIBDIVIDE_INLINE const divider<T, ALGO> *data() const {
+        return (const divider<T, ALGO> *)mapping.dividers;
+    }
+    LIBDIVIDE_INLINE const divider<T, ALGO> &operator[](size_t i) const { return data()[i]; }
+
+   private:
+    libdivide_table_mapping mapping;
+};
 #endif
-#if defined(LIBDIVIDE_AVX512)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m512i operator/(__m512i n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m512i operator/=(__m512i &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+#if defined(LIBDIVIDE_PARALLEL)
+namespace parallel {
+
+// Bytes of quotients per chunk, a multiple of the 64-byte cache line
+#if !defined(LIBDIVIDE_PARALLEL_CHUNK_BYTES)
+#define LIBDIVIDE_PARALLEL_CHUNK_BYTES 65536
 #endif
 
-#if defined(LIBDIVIDE_NEON)
-template <Branching ALGO>
-LIBDIVIDE_INLINE uint32x4_t operator/(uint32x4_t n, const divider<uint32_t, ALGO> &div) {
-    return div.divide(n);
-}
+// Splits the division of count numerators into chunks of about
+// LIBDIVIDE_PARALLEL_CHUNK_BYTES bytes of quotients. All the chunk
+// boundaries but the first and the last are 64-byte aligned addresses
+// of quotients, so no two chunks write the same cache line.
+template <typename T>
+class chunks {
+   public:
+    chunks(const T *quotients, size_t count) : count(count) {
+        size_t misalignment = (size_t)((uintptr_t)quotients % 64);
+        head = misalignment ? (64 - misalignment) / sizeof(T) : 0;
+        if (head > count) head = count;
+        n = 1;
+        if (count - head > PER_CHUNK) n = (count - head + PER_CHUNK - 1) / PER_CHUNK;
+    }
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE int32x4_t operator/(int32x4_t n, const divider<int32_t, ALGO> &div) {
-    return div.divide(n);
-}
+    // Number of chunks
+    LIBDIVIDE_INLINE size_t size() const { return n; }
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE uint64x2_t operator/(uint64x2_t n, const divider<uint64_t, ALGO> &div) {
-    return div.divide(n);
-}
+    // Chunk i is [begin(i), end(i))
+    LIBDIVIDE_INLINE size_t begin(size_t i) const { return i == 0 ? 0 : boundary(i); }
+    LIBDIVIDE_INLINE size_t end(size_t i) const { return i + 1 == n ? count : boundary(i + 1); }
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE int64x2_t operator/(int64x2_t n, const divider<int64_t, ALGO> &div) {
-    return div.divide(n);
-}
+   private:
+    enum { PER_CHUNK = LIBDIVIDE_PARALLEL_CHUNK_BYTES / sizeof(T) };
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE uint32x4_t operator/=(uint32x4_t &n, const divider<uint32_t, ALGO> &div) {
-    n = div.divide(n);
-    return n;
+    LIBDIVIDE_INLINE size_t boundary(size_t i) const { return head + i * PER_CHUNK; }
+
+    size_t count;
+    size_t head;
+    size_t n;
+};
+
+// A fixed set of threads which run the tasks of one call at a time.
+// pool(tasks, f) calls f(i) for all i in [0, tasks) and returns once
+// they are done. Thread t (the caller being thread 0) always runs the
+// same range [tasks * t / size(), tasks * (t + 1) / size()), so for a
+// given array each thread touches the same pages on every call.
+class thread_pool {
+   public:
+    // 0 threads means one per hardware thread
+    explicit thread_pool(unsigned n = 0)
+        : threads(n ? n : std::thread::hardware_concurrency()), tasks(0), run(NULL),
+          context(NULL), generation(0), pending(0), stopping(false) {
+        if (threads == 0) threads = 1;
+        for (unsigned t = 1; t < threads; t++) workers.emplace_back(&thread_pool::work, this, t);
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    // Number of threads, including the caller
+    LIBDIVIDE_INLINE unsigned size() const { return threads; }
+
+    template <typename F>
+    void operator()(size_t count, F f) {
+        std::lock_guard<std::mutex> call(call_mutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks = count;
+            run = &invoke<F>;
+            context = &f;
+            pending = threads - 1;
+            generation++;
+        }
+        start.notify_all();
+        run_range(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+   private:
+    template <typename F>
+    static void invoke(void *f, size_t i) {
+        (*(F *)f)(i);
+    }
+
+    void run_range(unsigned t) {
+        size_t end = tasks * (t + 1) / threads;
+        for (size_t i = tasks * t / threads; i < end; i++) run(context, i);
+    }
+
+    void work(unsigned t) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            run_range(t);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+
+    unsigned threads;
+    std::vector<std::thread> workers;
+    std::mutex call_mutex;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    size_t tasks;
+    void (*run)(void *, size_t);
+    void *context;
+    uint64_t generation;
+    unsigned pending;
+    bool stopping;
+};
+
+// The pool used by divide() when no executor is given,
+// it has one thread per hardware thread.
+inline thread_pool &default_pool() {
+    static thread_pool pool;
+    return pool;
 }
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE int32x4_t operator/=(int32x4_t &n, const divider<int32_t, ALGO> &div) {
-    n = div.divide(n);
-    return n;
+#if defined(LIBDIVIDE_EXECUTION_POLICIES)
+template <typename P>
+struct is_execution_policy : std::is_execution_policy<typename std::decay<P>::type> {};
+#else
+template <typename P>
+struct is_execution_policy : std::false_type {};
+#endif
+
+// Divides count numerators using an executor: executor(tasks, f)
+// must call f(i) for all i in [0, tasks), possibly concurrently, and
+// return once all calls have returned (e.g. a thread_pool, or a
+// wrapper of tbb::parallel_for or of an OpenMP parallel loop). Arrays
+// that fit in a single chunk are divided by the calling thread.
+template <typename T, Branching ALGO, typename Executor>
+typename std::enable_if<!is_execution_policy<Executor>::value>::type divide(const T *numers,
+    T *quotients, size_t count, const divider<T, ALGO> &div, Executor &&executor) {
+    chunks<T> parts(quotients, count);
+    if (parts.size() == 1) {
+        div.divide(numers, quotients, count);
+        return;
+    }
+    executor(parts.size(), [&](size_t i) {
+        size_t begin = parts.begin(i);
+        div.divide(numers + begin, quotients + begin, parts.end(i) - begin);
+    });
 }
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE uint64x2_t operator/=(uint64x2_t &n, const divider<uint64_t, ALGO> &div) {
-    n = div.divide(n);
-    return n;
+// Divides count numerators using the default thread pool
+template <typename T, Branching ALGO>
+void divide(const T *numers, T *quotients, size_t count, const divider<T, ALGO> &div) {
+    divide(numers, quotients, count, div, default_pool());
 }
 
-template <Branching ALGO>
-LIBDIVIDE_INLINE int64x2_t operator/=(int64x2_t &n, const divider<int64_t, ALGO> &div) {
-    n = div.divide(n);
-    return n;
+#if defined(LIBDIVIDE_EXECUTION_POLICIES)
+// Divides count numerators using a C++17 execution policy,
+// e.g. std::execution::par, the chunks are the same.
+template <typename T, Branching ALGO, typename Policy>
+typename std::enable_if<is_execution_policy<Policy>::value>::type divide(const T *numers,
+    T *quotients, size_t count, const divider<T, ALGO> &div, Policy &&policy) {
+    chunks<T> parts(quotients, count);
+    std::vector<size_t> indices(parts.size());
+    std::iota(indices.begin(), indices.end(), (size_t)0);
+    std::for_each(policy, indices.begin(), indices.end(), [&](size_t i) {
+        size_t begin = parts.begin(i);
+        div.divide(numers + begin, quotients + begin, parts.end(i) - begin);
+    });
 }
 #endif
 
+}  // namespace parallel
+#endif
+
 #if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
 // libdivide::branchfree_divider<T>
 template <typename T>
 using branchfree_divider = divider<T, BRANCHFREE>;
+
+// libdivide::exact_divider<T>
+template <typename T>
+using exact_divider = divider<T, EXACT>;
 #endif
 
 }  // namespace libdivide
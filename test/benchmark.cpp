@@ -2,7 +2,8 @@
 //
 // You can pass the benchmark program one or more of the following
 // options: u32, s32, u64, s64 to compare libdivide's speed against
-// hardware division. If benchmark is run without any options u64
+// hardware division (and cycles to report x86 TSC cycles per element
+// instead of nanoseconds). If benchmark is run without any options u64
 // is used as default option. benchmark tests a simple function that
 // inputs an array of random numerators and a single divisor, and
 // returns the sum of their quotients. It tests this using both
@@ -17,6 +18,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <chrono>
 #include <type_traits>
 
 #if defined(_WIN32) || defined(WIN32)
@@ -33,6 +35,14 @@
 #include <sys/time.h>  // for gettimeofday()
 #endif
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAS_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAS_RDTSC
+#endif
+
 #include "libdivide.h"
 
 #if defined(__GNUC__)
@@ -80,6 +90,10 @@ volatile uint64_t sGlobalUInt64;
 size_t iters = 1 << 19;
 size_t genIters = 1 << 16;
 
+// The reported times are multiplied by this factor,
+// it is the TSC frequency in GHz to report cycles.
+double timeScale = 1.0;
+
 static uint32_t my_random(struct random_state *state) {
     state->hi = (state->hi << 16) + (state->hi >> 16);
     state->hi += state->lo;
@@ -111,6 +125,15 @@ inline uint64_t unsigned_sum_vals(const IntT *vals, size_t count) {
     return sum;
 }
 
+// Sums the lanes of a vector, the lanes are copied out because reading
+// the vector through an IntT pointer violates strict aliasing.
+template <typename IntT, typename VecT>
+inline uint64_t unsigned_sum_lanes(const VecT &vec) {
+    IntT lanes[sizeof(VecT) / sizeof(IntT)];
+    memcpy(lanes, &vec, sizeof(VecT));
+    return unsigned_sum_vals(lanes, sizeof(VecT) / sizeof(IntT));
+}
+
 template <typename IntT, typename Divisor>
 NOINLINE uint64_t sum_quotients(const IntT *vals, Divisor div) {
     // Need to use unsigned to avoid signed integer overlow.
@@ -138,7 +161,7 @@ NOINLINE uint64_t sum_quotients_vec(const IntT *vals, Divisor div) {
             abort();
         }
     }
-    return unsigned_sum_vals((const IntT *)&sumX4, count);
+    return unsigned_sum_lanes<IntT>(sumX4);
 }
 #elif defined(LIBDIVIDE_NEON)
 
@@ -153,7 +176,7 @@ NOINLINE uint64_t sum_quotients_vec(const uint32_t *vals, Divisor div) {
         numers = numers / div;
         sumX4 = vaddq_u32(sumX4, numers);
     }
-    return unsigned_sum_vals((const IntT *)&sumX4, count);
+    return unsigned_sum_lanes<IntT>(sumX4);
 }
 
 template <typename Divisor>
@@ -167,7 +190,7 @@ NOINLINE uint64_t sum_quotients_vec(const int32_t *vals, Divisor div) {
         numers = numers / div;
         sumX4 = vaddq_s32(sumX4, numers);
     }
-    return unsigned_sum_vals((const IntT *)&sumX4, count);
+    return unsigned_sum_lanes<IntT>(sumX4);
 }
 
 template <typename Divisor>
@@ -181,7 +204,7 @@ NOINLINE uint64_t sum_quotients_vec(const uint64_t *vals, Divisor div) {
         numers = numers / div;
         sumX4 = vaddq_u64(sumX4, numers);
     }
-    return unsigned_sum_vals((const IntT *)&sumX4, count);
+    return unsigned_sum_lanes<IntT>(sumX4);
 }
 
 template <typename Divisor>
@@ -196,11 +219,65 @@ NOINLINE uint64_t sum_quotients_vec(const int64_t *vals, Divisor div) {
         numers = numers / div;
         sumX4 = vaddq_s64(sumX4, numers);
     }
-    return unsigned_sum_vals((const IntT *)&sumX4, count);
+    return unsigned_sum_lanes<IntT>(sumX4);
+}
+
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+// The masked kernels blend the paths of the branchfull
+// divider instead of branching on denom->more.
+static inline __m512i divide_masked(__m512i n, const struct libdivide_u32_t *denom) {
+    return libdivide_u32_do_masked_vec512(n, denom);
+}
+static inline __m512i divide_masked(__m512i n, const struct libdivide_s32_t *denom) {
+    return libdivide_s32_do_masked_vec512(n, denom);
+}
+static inline __m512i divide_masked(__m512i n, const struct libdivide_u64_t *denom) {
+    return libdivide_u64_do_masked_vec512(n, denom);
 }
+static inline __m512i divide_masked(__m512i n, const struct libdivide_s64_t *denom) {
+    return libdivide_s64_do_masked_vec512(n, denom);
+}
+
+static inline struct libdivide_u32_t gen_branchfull(uint32_t d) { return libdivide_u32_gen(d); }
+static inline struct libdivide_s32_t gen_branchfull(int32_t d) { return libdivide_s32_gen(d); }
+static inline struct libdivide_u64_t gen_branchfull(uint64_t d) { return libdivide_u64_gen(d); }
+static inline struct libdivide_s64_t gen_branchfull(int64_t d) { return libdivide_s64_gen(d); }
 
+template <typename IntT, typename Denom>
+NOINLINE uint64_t sum_quotients_masked(const IntT *vals, Denom denom) {
+    size_t count = sizeof(__m512i) / sizeof(IntT);
+    __m512i sumX4 = _mm512_setzero_si512();
+    for (size_t iter = 0; iter < iters; iter += count) {
+        __m512i numers = _mm512_load_si512((const __m512i *)&vals[iter]);
+        numers = divide_masked(numers, &denom);
+        if (sizeof(IntT) == 4) {
+            sumX4 = _mm512_add_epi32(sumX4, numers);
+        } else {
+            sumX4 = _mm512_add_epi64(sumX4, numers);
+        }
+    }
+    return unsigned_sum_lanes<IntT>(sumX4);
+}
 #endif
 
+// Divides the numerators using the array function (which interleaves
+// 4 independent vectors) into a buffer small enough to stay in L1.
+template <typename IntT, typename Divisor>
+NOINLINE uint64_t sum_quotients_array(const IntT *vals, const Divisor &div) {
+    typedef typename std::make_unsigned<IntT>::type UIntT;
+    const size_t chunk = 1024;
+    IntT quotients[chunk];
+    UIntT sum = 0;
+    for (size_t iter = 0; iter < iters; iter += chunk) {
+        size_t count = (iters - iter < chunk) ? iters - iter : chunk;
+        div.divide(vals + iter, quotients, count);
+        sum += (UIntT)unsigned_sum_vals(quotients, count);
+    }
+    return (uint64_t)sum;
+}
+
 // noinline to force compiler to emit this
 template <typename IntT>
 NOINLINE divider<IntT> generate_1_divisor(IntT d) {
@@ -225,6 +302,9 @@ enum which_function_t {
     func_scalar_branchfree,
     func_vec_branchfull,
     func_vec_branchfree,
+    func_vec_masked,
+    func_array_branchfull,
+    func_array_branchfree,
     func_generate
 };
 
@@ -260,6 +340,17 @@ NOINLINE static time_result_t time_function(const IntT *vals, IntT denom) {
             result = sum_quotients_vec(vals, div_bfree);
             break;
 #endif
+#if defined(LIBDIVIDE_AVX512)
+        case func_vec_masked:
+            result = sum_quotients_masked(vals, gen_branchfull(denom));
+            break;
+#endif
+        case func_array_branchfull:
+            result = sum_quotients_array(vals, div_bfull);
+            break;
+        case func_array_branchfree:
+            result = sum_quotients_array(vals, div_bfree);
+            break;
         case func_generate:
             generate_divisor(denom);
             result = 0;
@@ -286,6 +377,9 @@ struct TestResult {
     double branchfree_time;
     double vector_time;
     double vector_branchfree_time;
+    double vector_masked_time;
+    double array_time;
+    double array_branchfree_time;
     double gen_time;
     int algo;
 };
@@ -312,7 +406,9 @@ NOINLINE TestResult test_one(const IntT *vals, IntT denom) {
     } while (0)
 
     uint64_t my_times[TEST_COUNT], my_times_branchfree[TEST_COUNT], my_times_vector[TEST_COUNT],
-        my_times_vector_branchfree[TEST_COUNT], his_times[TEST_COUNT], gen_times[TEST_COUNT];
+        my_times_vector_branchfree[TEST_COUNT], my_times_vector_masked[TEST_COUNT],
+        my_times_array[TEST_COUNT], my_times_array_branchfree[TEST_COUNT], his_times[TEST_COUNT],
+        gen_times[TEST_COUNT];
     time_result_t tresult;
     for (size_t iter = 0; iter < TEST_COUNT; iter++) {
         tresult = time_function<func_hardware>(vals, denom);
@@ -339,6 +435,21 @@ NOINLINE TestResult test_one(const IntT *vals, IntT denom) {
         my_times_vector[iter] = 0;
         my_times_vector_branchfree[iter] = 0;
 #endif
+#if defined(LIBDIVIDE_AVX512)
+        tresult = time_function<func_vec_masked>(vals, denom);
+        my_times_vector_masked[iter] = tresult.time;
+        CHECK(tresult.result, expected);
+#else
+        my_times_vector_masked[iter] = 0;
+#endif
+        tresult = time_function<func_array_branchfull>(vals, denom);
+        my_times_array[iter] = tresult.time;
+        CHECK(tresult.result, expected);
+        if (testBranchfree) {
+            tresult = time_function<func_array_branchfree>(vals, denom);
+            my_times_array_branchfree[iter] = tresult.time;
+            CHECK(tresult.result, expected);
+        }
         tresult = time_function<func_generate>(vals, denom);
         gen_times[iter] = tresult.time;
     }
@@ -350,90 +461,76 @@ NOINLINE TestResult test_one(const IntT *vals, IntT denom) {
     result.vector_time = find_min(my_times_vector, TEST_COUNT) / (double)iters;
     result.vector_branchfree_time =
         find_min(my_times_vector_branchfree, TEST_COUNT) / (double)iters;
+    result.vector_masked_time = find_min(my_times_vector_masked, TEST_COUNT) / (double)iters;
+    result.array_time = find_min(my_times_array, TEST_COUNT) / (double)iters;
+    result.array_branchfree_time =
+        testBranchfree ? find_min(my_times_array_branchfree, TEST_COUNT) / (double)iters : -1;
     result.hardware_time = find_min(his_times, TEST_COUNT) / (double)iters;
     return result;
 #undef TEST_COUNT
 }
 
-int libdivide_u32_get_algorithm(uint32_t d) {
-    const struct libdivide_u32_t denom = libdivide_u32_gen(d);
-    uint8_t more = denom.more;
-    if (!denom.magic)
-        return 0;
-    else if (!(more & LIBDIVIDE_ADD_MARKER))
-        return 1;
-    else
-        return 2;
-}
-
 NOINLINE struct TestResult test_one_u32(uint32_t d, const uint32_t *data) {
     struct TestResult result = test_one(data, d);
-    result.algo = libdivide_u32_get_algorithm(d);
+    const struct libdivide_u32_t denom = libdivide_u32_gen(d);
+    result.algo = libdivide_u32_algorithm(&denom);
     return result;
 }
 
-int libdivide_s32_get_algorithm(int32_t d) {
-    const struct libdivide_s32_t denom = libdivide_s32_gen(d);
-    uint8_t more = denom.more;
-    if (!denom.magic)
-        return 0;
-    else if (!(more & LIBDIVIDE_ADD_MARKER))
-        return 1;
-    else
-        return 2;
-}
-
 NOINLINE struct TestResult test_one_s32(int32_t d, const int32_t *data) {
     struct TestResult result = test_one(data, d);
-    result.algo = libdivide_s32_get_algorithm(d);
+    const struct libdivide_s32_t denom = libdivide_s32_gen(d);
+    result.algo = libdivide_s32_algorithm(&denom);
     return result;
 }
 
-int libdivide_u64_get_algorithm(uint64_t d) {
-    const struct libdivide_u64_t denom = libdivide_u64_gen(d);
-    uint8_t more = denom.more;
-    if (!denom.magic)
-        return 0;
-    else if (!(more & LIBDIVIDE_ADD_MARKER))
-        return 1;
-    else
-        return 2;
-}
-
 NOINLINE struct TestResult test_one_u64(uint64_t d, const uint64_t *data) {
     struct TestResult result = test_one(data, d);
-    result.algo = libdivide_u64_get_algorithm(d);
+    const struct libdivide_u64_t denom = libdivide_u64_gen(d);
+    result.algo = libdivide_u64_algorithm(&denom);
     return result;
 }
 
-int libdivide_s64_get_algorithm(int64_t d) {
-    const struct libdivide_s64_t denom = libdivide_s64_gen(d);
-    uint8_t more = denom.more;
-    if (!denom.magic)
-        return 0;
-    else if (!(more & LIBDIVIDE_ADD_MARKER))
-        return 1;
-    else
-        return 2;
-}
-
 NOINLINE struct TestResult test_one_s64(int64_t d, const int64_t *data) {
     struct TestResult result = test_one(data, d);
-    result.algo = libdivide_s64_get_algorithm(d);
+    const struct libdivide_s64_t denom = libdivide_s64_gen(d);
+    result.algo = libdivide_s64_algorithm(&denom);
     return result;
 }
 
 static void report_header(void) {
-    printf("%6s%9s%8s%8s%8s%8s%8s%7s\n", "#", "system", "scalar", "scl_bf", "vector", "vec_bf",
-        "gener", "algo");
+    printf("%6s%9s%8s%8s%8s%8s%8s%8s%8s%8s%7s\n", "#", "system", "scalar", "scl_bf", "vector",
+        "vec_bf", "vec_msk", "array", "arr_bf", "gener", "algo");
 }
 
+// Negative times mark the branchfree columns which are not tested
+static double scale_time(double t) { return (t < 0) ? t : t * timeScale; }
+
 static void report_result(const char *input, struct TestResult result) {
-    printf("%6s%8.3f%8.3f%8.3f%8.3f%8.3f%9.3f%4d\n", input, result.hardware_time, result.base_time,
-        result.branchfree_time, result.vector_time, result.vector_branchfree_time, result.gen_time,
-        result.algo);
+    printf("%6s%8.3f%8.3f%8.3f%8.3f%8.3f%8.3f%8.3f%8.3f%9.3f%4d\n", input,
+        scale_time(result.hardware_time), scale_time(result.base_time),
+        scale_time(result.branchfree_time), scale_time(result.vector_time),
+        scale_time(result.vector_branchfree_time), scale_time(result.vector_masked_time),
+        scale_time(result.array_time), scale_time(result.array_branchfree_time),
+        scale_time(result.gen_time), result.algo);
 }
 
+#if defined(HAS_RDTSC)
+// Measures the TSC frequency in GHz (TSC ticks per nanosecond). On
+// current x86 CPUs the TSC runs at the nominal core frequency.
+static double tsc_ghz(void) {
+    typedef std::chrono::steady_clock clock;
+    clock::time_point start = clock::now();
+    uint64_t tsc_start = __rdtsc();
+    while (clock::now() - start < std::chrono::milliseconds(200)) {
+    }
+    uint64_t tsc_end = __rdtsc();
+    double nanos = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock::now() - start).count();
+    return (double)(tsc_end - tsc_start) / nanos;
+}
+#endif
+
 static void test_many_u32(const uint32_t *data) {
     printf("\n%50s", "=== libdivide u32 benchmark ===\n\n");
     report_header();
@@ -523,36 +620,42 @@ int main(int argc, char *argv[]) {
     int u64 = 0;
     int s64 = 0;
 
-    if (argc == 1) {
-        // By default test only u64
-        u64 = 1;
-    } else {
-        for (int i = 1; i < argc; i++) {
-            if (!strcmp(argv[i], "u32"))
-                u32 = 1;
-            else if (!strcmp(argv[i], "u64"))
-                u64 = 1;
-            else if (!strcmp(argv[i], "s32"))
-                s32 = 1;
-            else if (!strcmp(argv[i], "s64"))
-                s64 = 1;
-            else {
-                printf(
-                    "Usage: benchmark [OPTIONS]\n"
-                    "\n"
-                    "You can pass the benchmark program one or more of the following\n"
-                    "options: u32, s32, u64, s64 to compare libdivide's speed against\n"
-                    "hardware division. If benchmark is run without any options u64\n"
-                    "is used as default option. benchmark tests a simple function that\n"
-                    "inputs an array of random numerators and a single divisor, and\n"
-                    "returns the sum of their quotients. It tests this using both\n"
-                    "hardware division, and the various division approaches supported\n"
-                    "by libdivide, including vector division.\n");
-                exit(1);
-            }
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "u32"))
+            u32 = 1;
+        else if (!strcmp(argv[i], "u64"))
+            u64 = 1;
+        else if (!strcmp(argv[i], "s32"))
+            s32 = 1;
+        else if (!strcmp(argv[i], "s64"))
+            s64 = 1;
+#if defined(HAS_RDTSC)
+        else if (!strcmp(argv[i], "cycles"))
+            timeScale = tsc_ghz();
+#endif
+        else {
+            printf(
+                "Usage: benchmark [OPTIONS]\n"
+                "\n"
+                "You can pass the benchmark program one or more of the following\n"
+                "options: u32, s32, u64, s64 to compare libdivide's speed against\n"
+                "hardware division. If benchmark is run without any options u64\n"
+                "is used as default option. benchmark tests a simple function that\n"
+                "inputs an array of random numerators and a single divisor, and\n"
+                "returns the sum of their quotients. It tests this using both\n"
+                "hardware division, and the various division approaches supported\n"
+                "by libdivide, including vector division. vec_msk is the branchless\n"
+                "AVX512 kernel of the branchfull divider (0 without AVX512), array\n"
+                "and arr_bf use the array functions which interleave 4 vectors.\n"
+                "Times are in nanoseconds per element, pass cycles (x86 only) to\n"
+                "report TSC cycles per element instead.\n");
+            exit(1);
         }
     }
 
+    // By default test only u64
+    if (!u32 && !s32 && !u64 && !s64) u64 = 1;
+
     // Make sure that the number of iterations is not
     // known at compile time to prevent the compiler
     // from magically calculating results at compile
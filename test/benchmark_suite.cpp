@@ -0,0 +1,708 @@
+// Usage: benchmark_suite [OPTIONS]
+//
+// The benchmark suite measures libdivide for each divider type, each
+// division path (shift, mul and mul+add divisors) and each backend,
+// and writes the results as a table, JSON or CSV so that they can be
+// plotted and compared across CPUs and commits. It measures:
+//
+// * throughput: independent divisions of a whole array, using the
+//   scalar code, each compiled vector instruction set separately and
+//   the array functions (best instruction set, branchfree, adaptive
+//   and streaming), for L1, L2 and DRAM sized arrays.
+// * latency: a chain of divisions where each numerator depends on
+//   the previous quotient (scalar code and x86 vectors, the vector
+//   latency is reported per vector instead of per element).
+// * gen: the cost of generating dividers for random divisors.
+//
+// Times are reported in nanoseconds and in cycles per element (per
+// divider for gen). Cycles are read using perf_event on Linux (core
+// cycles) or else using rdtsc on x86 (reference cycles). All results
+// are checked against hardware division.
+//
+// Options:
+//   u16 s16 u32 s32 u64 s64  types to benchmark (default: all)
+//   --sizes=16K,256K,64M      array sizes in bytes (default: L1, L2 and DRAM)
+//   --min-time=MS             minimum duration of a measurement (default: 10)
+//   --divisor=N               benchmark N instead of one divisor per path
+//   --json=FILE, --csv=FILE   write the results to FILE (- for stdout)
+//   --no-perf                 do not use perf_event, use rdtsc
+//   --quick                   L1 size and 1 ms measurements (for smoke tests)
+
+// Silence MSVC sprintf unsafe warnings
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAS_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAS_RDTSC
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAS_PERF_EVENT
+#endif
+
+#include "libdivide.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+using namespace libdivide;
+
+struct options {
+    std::vector<size_t> sizes;
+    double min_time_ns = 10e6;
+    bool perf = true;
+    bool has_divisor = false;
+    long long divisor = 0;
+    std::string json;
+    std::string csv;
+};
+
+struct result {
+    std::string type;
+    std::string divisor;
+    std::string path;
+    std::string mode;
+    std::string backend;
+    size_t bytes;
+    double ns;
+    double cycles;
+};
+
+// Reads the core cycle counter using perf_event if the kernel
+// allows it, and the time stamp counter otherwise.
+class cycle_counter {
+   public:
+    explicit cycle_counter(bool use_perf) {
+#if defined(HAS_PERF_EVENT)
+        if (use_perf) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0) source = "perf";
+        }
+#else
+        (void)use_perf;
+#endif
+#if defined(HAS_RDTSC)
+        if (fd < 0) source = "rdtsc";
+#endif
+    }
+
+    ~cycle_counter() {
+#if defined(HAS_PERF_EVENT)
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    uint64_t read() const {
+#if defined(HAS_PERF_EVENT)
+        if (fd >= 0) {
+            uint64_t count = 0;
+            if (::read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) return 0;
+            return count;
+        }
+#endif
+#if defined(HAS_RDTSC)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    bool enabled() const { return strcmp(source, "none") != 0; }
+
+    const char *source = "none";
+
+   private:
+    int fd = -1;
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+struct sample {
+    double ns;
+    double cycles;
+};
+
+// Calls run() (which processes elements elements) until a call
+// sequence lasts at least min_time_ns, then repeats it 5 times and
+// reports the fastest per element.
+template <typename F>
+sample measure(F run, size_t elements, const options &opt, const cycle_counter &counter) {
+    size_t calls = 1;
+    sample best = {0, 0};
+    for (int trial = 0; trial < 5;) {
+        bench_clock::time_point start = bench_clock::now();
+        uint64_t cycles_start = counter.read();
+        for (size_t i = 0; i < calls; i++) run();
+        uint64_t cycles_end = counter.read();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            bench_clock::now() - start)
+                        .count();
+        if (ns < opt.min_time_ns && trial == 0) {
+            calls *= 2;
+            continue;
+        }
+        double per_element = ns / ((double)calls * elements);
+        if (trial == 0 || per_element < best.ns) {
+            best.ns = per_element;
+            best.cycles = (double)(cycles_end - cycles_start) / ((double)calls * elements);
+        }
+        trial++;
+    }
+    if (!counter.enabled()) best.cycles = 0;
+    return best;
+}
+
+volatile uint64_t sink;
+
+template <typename T>
+struct bench_backend {
+    std::string name;
+    std::function<void(const T *, T *, size_t)> divide;
+};
+
+// Hardware division, the divisor is a parameter so that
+// the compiler cannot replace the division.
+template <typename T>
+NOINLINE void system_divide(const T *numers, T *quotients, size_t count, T d) {
+    for (size_t i = 0; i < count; i++) quotients[i] = numers[i] / d;
+}
+
+template <typename T, typename D>
+NOINLINE void scalar_divide(const T *numers, T *quotients, size_t count, const D &div) {
+    for (size_t i = 0; i < count; i++) quotients[i] = numers[i] / div;
+}
+
+// Latency chains: each numerator is xor'ed with the previous
+// quotient, so a division cannot start before the previous one
+// has completed.
+template <typename T>
+NOINLINE T system_chain(const T *numers, size_t count, T d) {
+    T x = 0;
+    for (size_t i = 0; i < count; i++) x = (T)(numers[i] ^ x) / d;
+    return x;
+}
+
+template <typename T, typename D>
+NOINLINE T scalar_chain(const T *numers, size_t count, const D &div) {
+    T x = 0;
+    for (size_t i = 0; i < count; i++) x = (T)(numers[i] ^ x) / div;
+    return x;
+}
+
+// The chain of one lane of vector_chain(), using hardware division
+template <typename T>
+T system_lane_chain(const T *numers, size_t count, size_t lanes, size_t lane, T d) {
+    T x = 0;
+    for (size_t i = 0; i + lanes <= count; i += lanes) x = (T)(numers[i + lane] ^ x) / d;
+    return x;
+}
+
+#if defined(LIBDIVIDE_SSE2)
+LIBDIVIDE_INLINE __m128i vec_loadu(const __m128i *p) { return _mm_loadu_si128(p); }
+LIBDIVIDE_INLINE __m128i vec_xor(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+LIBDIVIDE_INLINE void vec_storeu(__m128i *p, __m128i a) { _mm_storeu_si128(p, a); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+LIBDIVIDE_INLINE __m256i vec_loadu(const __m256i *p) { return _mm256_loadu_si256(p); }
+LIBDIVIDE_INLINE __m256i vec_xor(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+LIBDIVIDE_INLINE void vec_storeu(__m256i *p, __m256i a) { _mm256_storeu_si256(p, a); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+LIBDIVIDE_INLINE __m512i vec_loadu(const __m512i *p) { return _mm512_loadu_si512(p); }
+LIBDIVIDE_INLINE __m512i vec_xor(__m512i a, __m512i b) { return _mm512_xor_si512(a, b); }
+LIBDIVIDE_INLINE void vec_storeu(__m512i *p, __m512i a) { _mm512_storeu_si512(p, a); }
+#endif
+
+template <typename T, typename V>
+NOINLINE V vector_chain(const T *numers, size_t count, const divider<T> &div) {
+    const size_t lanes = sizeof(V) / sizeof(T);
+    V x = vec_xor(vec_loadu((const V *)numers), vec_loadu((const V *)numers));
+    for (size_t i = 0; i + lanes <= count; i += lanes) {
+        x = div.divide(vec_xor(vec_loadu((const V *)(numers + i)), x));
+    }
+    return x;
+}
+
+// The kernels of each instruction set are benchmarked separately. With
+// LIBDIVIDE_DISPATCH the kernels are compiled for all x86 instruction
+// sets, only the ones supported by the CPU are benchmarked.
+#if defined(LIBDIVIDE_DISPATCH_X86)
+#define isa_supported(isa) __builtin_cpu_supports(isa)
+#else
+#define isa_supported(isa) true
+#endif
+
+#define BENCH_ISA_BACKEND(ALGO, VEC)                                                  \
+    backends.push_back({#VEC, [=](const T *n, T *q, size_t c) {                       \
+        libdivide_##ALGO##_do_array_##VEC(n, q, c, &denom);                           \
+    }});                                                                              \
+    if (has_branchfree) {                                                             \
+        backends.push_back({#VEC "_bf", [=](const T *n, T *q, size_t c) {             \
+            libdivide_##ALGO##_branchfree_do_array_##VEC(n, q, c, &branchfree_denom); \
+        }});                                                                          \
+    }
+
+// BENCH_ISA_BACKENDS() generates isa_backends() which returns
+// the array kernels of each compiled instruction set.
+#if defined(LIBDIVIDE_SSE2_KERNELS) || defined(LIBDIVIDE_NEON)
+#define BENCH_VEC128(ALGO) \
+    if (isa_supported("sse2")) { BENCH_ISA_BACKEND(ALGO, vec128) }
+#else
+#define BENCH_VEC128(ALGO)
+#endif
+#if defined(LIBDIVIDE_AVX2_KERNELS)
+#define BENCH_VEC256(ALGO) \
+    if (isa_supported("avx2")) { BENCH_ISA_BACKEND(ALGO, vec256) }
+#else
+#define BENCH_VEC256(ALGO)
+#endif
+#if defined(LIBDIVIDE_AVX512_KERNELS)
+#define BENCH_VEC512(ALGO) \
+    if (isa_supported("avx512f")) { BENCH_ISA_BACKEND(ALGO, vec512) }
+#else
+#define BENCH_VEC512(ALGO)
+#endif
+#if defined(LIBDIVIDE_SVE)
+#define BENCH_SVE(ALGO) BENCH_ISA_BACKEND(ALGO, sve)
+#else
+#define BENCH_SVE(ALGO)
+#endif
+#if defined(LIBDIVIDE_RVV)
+#define BENCH_RVV(ALGO) BENCH_ISA_BACKEND(ALGO, rvv)
+#else
+#define BENCH_RVV(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_SSE2_KERNELS) || defined(LIBDIVIDE_NEON) || defined(LIBDIVIDE_SVE) || \
+    defined(LIBDIVIDE_RVV)
+#define BENCH_ISA_BACKENDS(TYPE, ALGO)                                               \
+    void isa_backends(TYPE d, std::vector<bench_backend<TYPE>> &backends) {          \
+        typedef TYPE T;                                                              \
+        const bool has_branchfree = d != 1;                                          \
+        const libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(d);                \
+        libdivide_##ALGO##_branchfree_t branchfree_denom = {};                       \
+        if (has_branchfree) branchfree_denom = libdivide_##ALGO##_branchfree_gen(d); \
+        BENCH_VEC128(ALGO)                                                           \
+        BENCH_VEC256(ALGO)                                                           \
+        BENCH_VEC512(ALGO)                                                           \
+        BENCH_SVE(ALGO)                                                              \
+        BENCH_RVV(ALGO)                                                              \
+    }
+#else
+#define BENCH_ISA_BACKENDS(TYPE, ALGO) \
+    void isa_backends(TYPE, std::vector<bench_backend<TYPE>> &) {}
+#endif
+
+BENCH_ISA_BACKENDS(uint16_t, u16)
+BENCH_ISA_BACKENDS(int16_t, s16)
+BENCH_ISA_BACKENDS(uint32_t, u32)
+BENCH_ISA_BACKENDS(int32_t, s32)
+BENCH_ISA_BACKENDS(uint64_t, u64)
+BENCH_ISA_BACKENDS(int64_t, s64)
+
+static const char *path_name(int algorithm) {
+    switch (algorithm & ~LIBDIVIDE_ALGORITHM_NEGATED) {
+        case LIBDIVIDE_ALGORITHM_SHIFT:
+            return "shift";
+        case LIBDIVIDE_ALGORITHM_MUL:
+            return "mul";
+        default:
+            return "mul_add";
+    }
+}
+
+template <typename T>
+class type_benchmark {
+   public:
+    type_benchmark(const char *name, const options &opt, const cycle_counter &counter,
+        std::vector<result> &results)
+        : name(name), opt(opt), counter(counter), results(results) {}
+
+    void run() {
+        size_t max_bytes = *std::max_element(opt.sizes.begin(), opt.sizes.end());
+        std::mt19937_64 rng(12345);
+        numers.resize(max_bytes / sizeof(T));
+        for (T &n : numers) n = (T)rng();
+        quotients.resize(numers.size());
+        expected.resize(numers.size());
+
+        for (T d : divisors()) {
+            for (size_t bytes : opt.sizes) {
+                bench_throughput(d, bytes);
+            }
+            bench_latency(d, opt.sizes[0]);
+        }
+        bench_gen();
+    }
+
+   private:
+    // One divisor per division path, unless --divisor is given
+    std::vector<T> divisors() const {
+        if (opt.has_divisor) return std::vector<T>(1, (T)opt.divisor);
+        std::vector<T> result(1, (T)((T)1 << (sizeof(T) * 4)));
+        for (int algorithm = LIBDIVIDE_ALGORITHM_MUL; algorithm <= LIBDIVIDE_ALGORITHM_MUL_ADD;
+             algorithm++) {
+            T d = 3;
+            while (divider<T>(d).algorithm() != algorithm) d++;
+            result.push_back(d);
+        }
+        return result;
+    }
+
+    void add(T d, const char *mode, const std::string &backend, size_t bytes, sample s) {
+        result r = {name, std::to_string((long long)d), path_name(divider<T>(d).algorithm()),
+            mode, backend, bytes, s.ns, s.cycles};
+        results.push_back(r);
+    }
+
+    void check(T d, const std::string &backend, size_t count) {
+        if (memcmp(quotients.data(), expected.data(), count * sizeof(T)) != 0) {
+            fprintf(stderr, "Error: %s %s / %lld computes wrong quotients\n", name,
+                backend.c_str(), (long long)d);
+            exit(1);
+        }
+    }
+
+    void bench_throughput(T d, size_t bytes) {
+        const size_t count = bytes / sizeof(T);
+        const T *n = numers.data();
+        T *q = quotients.data();
+        system_divide(n, expected.data(), count, d);
+
+        const divider<T> div(d);
+        const adaptive_divider<T> adaptive(d);
+        std::vector<bench_backend<T>> backends;
+        backends.push_back(
+            {"system", [=](const T *n, T *q, size_t c) { system_divide(n, q, c, d); }});
+        backends.push_back(
+            {"scalar", [=](const T *n, T *q, size_t c) { scalar_divide(n, q, c, div); }});
+        if (d != 1) {
+            const branchfree_divider<T> branchfree(d);
+            backends.push_back({"scalar_bf",
+                [=](const T *n, T *q, size_t c) { scalar_divide(n, q, c, branchfree); }});
+        }
+        isa_backends(d, backends);
+        backends.push_back({"array", [=](const T *n, T *q, size_t c) { div.divide(n, q, c); }});
+        if (d != 1) {
+            const branchfree_divider<T> branchfree(d);
+            backends.push_back({"array_bf",
+                [=](const T *n, T *q, size_t c) { branchfree.divide(n, q, c); }});
+        }
+        backends.push_back(
+            {"adaptive", [=](const T *n, T *q, size_t c) { adaptive.divide(n, q, c); }});
+        backends.push_back(
+            {"stream", [=](const T *n, T *q, size_t c) { div.divide_stream(n, q, c); }});
+
+        for (const bench_backend<T> &backend : backends) {
+            memset(q, 0, count * sizeof(T));
+            sample s = measure([&] { backend.divide(n, q, count); }, count, opt, counter);
+            check(d, backend.name, count);
+            add(d, "throughput", backend.name, bytes, s);
+        }
+    }
+
+    template <typename F>
+    void chain(T d, const char *backend, size_t bytes, F f) {
+        const size_t count = bytes / sizeof(T);
+        T x = 0;
+        sample s = measure([&] { x = f(count); }, count, opt, counter);
+        if (x != system_chain(numers.data(), count, d)) {
+            fprintf(stderr, "Error: %s %s chain / %lld computes wrong quotients\n", name,
+                backend, (long long)d);
+            exit(1);
+        }
+        add(d, "latency", backend, bytes, s);
+    }
+
+    template <typename V>
+    void vector_chain_sample(T d, const char *backend, size_t bytes) {
+        const size_t count = bytes / sizeof(T);
+        const divider<T> div(d);
+        const size_t lanes = sizeof(V) / sizeof(T);
+        V x;
+        // One dependent division per vector
+        sample s = measure([&] { x = vector_chain<T, V>(numers.data(), count, div); },
+            count / lanes, opt, counter);
+        T result[sizeof(V) / sizeof(T)];
+        vec_storeu((V *)result, x);
+        for (size_t lane = 0; lane < lanes; lane++) {
+            if (result[lane] != system_lane_chain(numers.data(), count, lanes, lane, d)) {
+                fprintf(stderr, "Error: %s %s chain / %lld computes wrong quotients\n", name,
+                    backend, (long long)d);
+                exit(1);
+            }
+        }
+        add(d, "latency", backend, bytes, s);
+    }
+
+    void bench_latency(T d, size_t bytes) {
+        const T *n = numers.data();
+        const divider<T> div(d);
+        const adaptive_divider<T> adaptive(d);
+        chain(d, "system", bytes, [&](size_t c) { return system_chain(n, c, d); });
+        chain(d, "scalar", bytes, [&](size_t c) { return scalar_chain(n, c, div); });
+        if (d != 1) {
+            const branchfree_divider<T> branchfree(d);
+            chain(d, "scalar_bf", bytes, [&](size_t c) { return scalar_chain(n, c, branchfree); });
+        }
+        chain(d, "adaptive", bytes, [&](size_t c) { return scalar_chain(n, c, adaptive); });
+#if defined(LIBDIVIDE_SSE2)
+        vector_chain_sample<__m128i>(d, "vec128", bytes);
+#endif
+#if defined(LIBDIVIDE_AVX2)
+        vector_chain_sample<__m256i>(d, "vec256", bytes);
+#endif
+#if defined(LIBDIVIDE_AVX512)
+        vector_chain_sample<__m512i>(d, "vec512", bytes);
+#endif
+    }
+
+    // Generates the dividers of 1024 random divisors (never 0 or 1)
+    void bench_gen() {
+        const size_t count = 1024;
+        // numers may be smaller than count (e.g. --sizes=1K)
+        std::mt19937_64 rng(54321);
+        std::vector<T> divisors(count);
+        for (T &d : divisors) d = (T)(rng() | 2);
+        std::vector<divider<T>> dividers(count);
+        std::vector<branchfree_divider<T>> branchfree_dividers(count);
+        std::vector<adaptive_divider<T>> adaptive_dividers(count);
+
+        sample s = measure(
+            [&] {
+                for (size_t i = 0; i < count; i++) dividers[i] = divider<T>(divisors[i]);
+            },
+            count, opt, counter);
+        gen_result("gen", s);
+        s = measure(
+            [&] {
+                for (size_t i = 0; i < count; i++) {
+                    branchfree_dividers[i] = branchfree_divider<T>(divisors[i]);
+                }
+            },
+            count, opt, counter);
+        gen_result("gen_bf", s);
+        s = measure(
+            [&] {
+                for (size_t i = 0; i < count; i++) {
+                    adaptive_dividers[i] = adaptive_divider<T>(divisors[i]);
+                }
+            },
+            count, opt, counter);
+        gen_result("gen_adaptive", s);
+        sink = dividers[count - 1].recover() + branchfree_dividers[count - 1].recover() +
+               adaptive_dividers[count - 1].recover();
+    }
+
+    void gen_result(const char *backend, sample s) {
+        result r = {name, "random", "mixed", "gen", backend, 0, s.ns, s.cycles};
+        results.push_back(r);
+    }
+
+    const char *name;
+    const options &opt;
+    const cycle_counter &counter;
+    std::vector<result> &results;
+    std::vector<T> numers;
+    std::vector<T> quotients;
+    std::vector<T> expected;
+};
+
+static std::string isa_list() {
+    std::string isa;
+#if defined(LIBDIVIDE_DISPATCH_X86)
+    isa += "dispatch ";
+#endif
+#if defined(LIBDIVIDE_SSE2)
+    isa += "sse2 ";
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    isa += "avx2 ";
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    isa += "avx512 ";
+#endif
+#if defined(LIBDIVIDE_NEON)
+    isa += "neon ";
+#endif
+#if defined(LIBDIVIDE_SVE)
+    isa += "sve ";
+#endif
+#if defined(LIBDIVIDE_RVV)
+    isa += "rvv ";
+#endif
+    if (isa.empty()) isa = "scalar ";
+    isa.resize(isa.size() - 1);
+    return isa;
+}
+
+static FILE *open_output(const std::string &file) {
+    if (file == "-") return stdout;
+    FILE *f = fopen(file.c_str(), "w");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open %s\n", file.c_str());
+        exit(1);
+    }
+    return f;
+}
+
+static void write_json(const std::string &file, const std::vector<result> &results,
+    const cycle_counter &counter) {
+    FILE *f = open_output(file);
+    fprintf(f, "{\n  \"libdivide_version\": \"%s\",\n", LIBDIVIDE_VERSION);
+    fprintf(f, "  \"isa\": \"%s\",\n", isa_list().c_str());
+    fprintf(f, "  \"cycles_source\": \"%s\",\n", counter.source);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const result &r = results[i];
+        fprintf(f,
+            "    {\"type\": \"%s\", \"divisor\": \"%s\", \"path\": \"%s\", \"mode\": \"%s\", "
+            "\"backend\": \"%s\", \"bytes\": %zu, \"ns\": %.4f, \"cycles\": %.4f}%s\n",
+            r.type.c_str(), r.divisor.c_str(), r.path.c_str(), r.mode.c_str(),
+            r.backend.c_str(), r.bytes, r.ns, r.cycles, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    if (f != stdout) fclose(f);
+}
+
+static void write_csv(const std::string &file, const std::vector<result> &results) {
+    FILE *f = open_output(file);
+    fprintf(f, "type,divisor,path,mode,backend,bytes,ns,cycles\n");
+    for (const result &r : results) {
+        fprintf(f, "%s,%s,%s,%s,%s,%zu,%.4f,%.4f\n", r.type.c_str(), r.divisor.c_str(),
+            r.path.c_str(), r.mode.c_str(), r.backend.c_str(), r.bytes, r.ns, r.cycles);
+    }
+    if (f != stdout) fclose(f);
+}
+
+static void print_table(const std::vector<result> &results, const cycle_counter &counter) {
+    printf("libdivide %s, isa: %s, cycles: %s\n\n", LIBDIVIDE_VERSION, isa_list().c_str(),
+        counter.source);
+    printf("%5s %21s %8s %11s %10s %12s %9s %9s\n", "type", "divisor", "path", "mode", "bytes",
+        "backend", "ns", "cycles");
+    for (const result &r : results) {
+        printf("%5s %21s %8s %11s %10zu %12s %9.3f %9.3f\n", r.type.c_str(), r.divisor.c_str(),
+            r.path.c_str(), r.mode.c_str(), r.bytes, r.backend.c_str(), r.ns, r.cycles);
+    }
+}
+
+// Parses a size such as 16K, 256K or 64M
+static size_t parse_size(const std::string &s) {
+    char *end;
+    size_t size = (size_t)strtoull(s.c_str(), &end, 10);
+    if (*end == 'K' || *end == 'k') size <<= 10;
+    if (*end == 'M' || *end == 'm') size <<= 20;
+    if (*end == 'G' || *end == 'g') size <<= 30;
+    // Multiple of the widest vector and of 8-byte elements
+    return std::max((size_t)64, size & ~(size_t)63);
+}
+
+static void usage() {
+    printf(
+        "Usage: benchmark_suite [OPTIONS]\n"
+        "\n"
+        "Measures the throughput and latency of libdivide's division and the cost of\n"
+        "generating dividers, for each type, division path and instruction set.\n"
+        "\n"
+        "Options:\n"
+        "  u16 s16 u32 s32 u64 s64  types to benchmark (default: all)\n"
+        "  --sizes=16K,256K,64M      array sizes in bytes (default: L1, L2 and DRAM)\n"
+        "  --min-time=MS             minimum duration of a measurement (default: 10)\n"
+        "  --divisor=N               benchmark N instead of one divisor per path\n"
+        "  --json=FILE, --csv=FILE   write the results to FILE (- for stdout)\n"
+        "  --no-perf                 do not use perf_event, use rdtsc\n"
+        "  --quick                   L1 size and 1 ms measurements (for smoke tests)\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    options opt;
+    std::vector<std::string> types;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (arg == "u16" || arg == "s16" || arg == "u32" || arg == "s32" || arg == "u64" ||
+            arg == "s64") {
+            types.push_back(arg);
+        } else if (arg.compare(0, 8, "--sizes=") == 0) {
+            opt.sizes.clear();
+            for (size_t pos = 0; pos < value.size();) {
+                size_t comma = value.find(',', pos);
+                if (comma == std::string::npos) comma = value.size();
+                opt.sizes.push_back(parse_size(value.substr(pos, comma - pos)));
+                pos = comma + 1;
+            }
+        } else if (arg.compare(0, 11, "--min-time=") == 0) {
+            opt.min_time_ns = atof(value.c_str()) * 1e6;
+        } else if (arg.compare(0, 10, "--divisor=") == 0) {
+            opt.has_divisor = true;
+            opt.divisor = strtoll(value.c_str(), NULL, 0);
+            if (opt.divisor == 0) usage();
+        } else if (arg.compare(0, 7, "--json=") == 0) {
+            opt.json = value;
+        } else if (arg.compare(0, 6, "--csv=") == 0) {
+            opt.csv = value;
+        } else if (arg == "--no-perf") {
+            opt.perf = false;
+        } else if (arg == "--quick") {
+            opt.sizes.assign(1, 16 << 10);
+            opt.min_time_ns = 1e6;
+        } else {
+            usage();
+        }
+    }
+    if (opt.sizes.empty()) {
+        opt.sizes.push_back(16 << 10);
+        opt.sizes.push_back(256 << 10);
+        opt.sizes.push_back(64 << 20);
+    }
+    if (types.empty()) types = {"u16", "s16", "u32", "s32", "u64", "s64"};
+
+    cycle_counter counter(opt.perf);
+    std::vector<result> results;
+    for (const std::string &type : types) {
+        if (type == "u16") type_benchmark<uint16_t>("u16", opt, counter, results).run();
+        if (type == "s16") type_benchmark<int16_t>("s16", opt, counter, results).run();
+        if (type == "u32") type_benchmark<uint32_t>("u32", opt, counter, results).run();
+        if (type == "s32") type_benchmark<int32_t>("s32", opt, counter, results).run();
+        if (type == "u64") type_benchmark<uint64_t>("u64", opt, counter, results).run();
+        if (type == "s64") type_benchmark<int64_t>("s64", opt, counter, results).run();
+    }
+
+    if (!opt.json.empty()) write_json(opt.json, results, counter);
+    if (!opt.csv.empty()) write_csv(opt.csv, results);
+    if (opt.json != "-" && opt.csv != "-") print_table(results, counter);
+    return 0;
+}
@@ -1,7 +1,8 @@
 // Usage: tester [OPTIONS]
 //
 // You can pass the tester program one or more of the following options:
-// u32, s32, u64, s64 or run it without arguments to test all four.
+// u8, s8, u16, s16, u32, s32, u64, s64, u128, s128 or run it without arguments
+// to test all (u128 and s128 require __int128 support).
 // The tester is multithreaded so it can test multiple cases simultaneously.
 // The tester will verify the correctness of libdivide via a set of
 // randomly chosen denominators, by comparing the result of libdivide's
@@ -9,7 +10,11 @@
 // will output as soon as it finds a discrepancy.
 
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <random>
@@ -18,108 +23,1589 @@
 #include <type_traits>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBDIVIDE_MMAP
+#endif
+#define LIBDIVIDE_PARALLEL
+#define LIBDIVIDE_SIMD_TS
+#define LIBDIVIDE_STATS
+// Small enough for test_stream() to use the non-temporal stores
+#define LIBDIVIDE_STREAM_THRESHOLD 128
 #include "libdivide.h"
 
 using namespace libdivide;
 
+// The divisors that a divider using the ALGO algorithm supports:
+// 0 is never a valid divisor, nor is 1 for unsigned branchfree dividers
+template <typename T, Branching ALGO>
+std::vector<T> valid_divisors(const std::vector<T> &divisors) {
+    std::vector<T> valid(divisors);
+    valid.erase(std::remove(valid.begin(), valid.end(), 0), valid.end());
+    if (ALGO == BRANCHFREE && !std::numeric_limits<T>::is_signed)
+        valid.erase(std::remove(valid.begin(), valid.end(), 1u), valid.end());
+    return valid;
+}
+
+// The gen array functions must generate the same dividers as the gen
+// functions and call LIBDIVIDE_GEN_HOOK once per divider
+template <typename T, typename Divider>
+void test_gen_array(const std::string &name, const std::vector<T> &divisors,
+    void (*gen_array)(const T *, Divider *, size_t), Divider (*gen)(T), int type) {
+    std::vector<Divider> dividers(divisors.size());
+    const volatile uint64_t *counters = libdivide_get_stats()->gen[type];
+    uint64_t before = 0;
+    for (int i = 0; i < 8; i++) before += counters[i];
+    gen_array(divisors.data(), dividers.data(), divisors.size());
+    uint64_t after = 0;
+    for (int i = 0; i < 8; i++) after += counters[i];
+    // Other threads may generate dividers at the same time
+    if (after - before < divisors.size()) {
+        std::cerr << "LIBDIVIDE_STATS did not count the gen array of " << name << std::endl;
+        exit(1);
+    }
+    for (size_t i = 0; i < divisors.size(); i++) {
+        Divider expect = gen(divisors[i]);
+        if (memcmp(&expect, &dividers[i], sizeof(Divider)) != 0) {
+            std::cerr << "Gen array failure for " << name << ": " << divisors[i] << std::endl;
+            exit(1);
+        }
+    }
+}
+
+// Only the unsigned 32-bit and 64-bit dividers have gen arrays
+template <typename T>
+void test_gen_arrays(const std::string &, const std::vector<T> &) {}
+
+void test_gen_arrays(const std::string &name, const std::vector<uint32_t> &divisors) {
+    test_gen_array(
+        name, divisors, libdivide_u32_gen_array, libdivide_u32_gen, LIBDIVIDE_TABLE_U32);
+    test_gen_array(name + " (branchfree)", valid_divisors<uint32_t, BRANCHFREE>(divisors),
+        libdivide_u32_branchfree_gen_array, libdivide_u32_branchfree_gen,
+        LIBDIVIDE_TABLE_U32_BRANCHFREE);
+}
+
+void test_gen_arrays(const std::string &name, const std::vector<uint64_t> &divisors) {
+    test_gen_array(
+        name, divisors, libdivide_u64_gen_array, libdivide_u64_gen, LIBDIVIDE_TABLE_U64);
+    test_gen_array(name + " (branchfree)", valid_divisors<uint64_t, BRANCHFREE>(divisors),
+        libdivide_u64_branchfree_gen_array, libdivide_u64_branchfree_gen,
+        LIBDIVIDE_TABLE_U64_BRANCHFREE);
+}
+
+// The branchfull per-lane kernels must match the scalar division
+template <typename T, typename Denom>
+void test_array_lanes(const std::string &name, const std::vector<T> &numers,
+    const std::vector<T> &denoms, Denom (*gen)(T),
+    void (*do_array_lanes)(const T *, T *, size_t, const T *, const uint8_t *)) {
+    std::vector<T> magics(denoms.size());
+    std::vector<uint8_t> mores(denoms.size());
+    for (size_t i = 0; i < denoms.size(); i++) {
+        Denom denom = gen(denoms[i]);
+        magics[i] = denom.magic;
+        mores[i] = denom.more;
+    }
+    std::vector<T> quotients(denoms.size());
+    do_array_lanes(numers.data(), quotients.data(), numers.size(), magics.data(), mores.data());
+    for (size_t i = 0; i < denoms.size(); i++) {
+        if (quotients[i] != numers[i] / denoms[i]) {
+            std::cerr << "Array lanes failure for " << name << ": " << numers[i] << " / "
+                      << denoms[i] << " = " << numers[i] / denoms[i] << ", but got "
+                      << quotients[i] << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void test_array_lanes(const std::string &name, const std::vector<uint32_t> &numers,
+    const std::vector<uint32_t> &denoms) {
+    test_array_lanes(name, numers, denoms, libdivide_u32_gen, libdivide_u32_do_array_lanes);
+}
+void test_array_lanes(const std::string &name, const std::vector<int32_t> &numers,
+    const std::vector<int32_t> &denoms) {
+    test_array_lanes(name, numers, denoms, libdivide_s32_gen, libdivide_s32_do_array_lanes);
+    test_array_lanes(name + " (branchfree)", numers, denoms, libdivide_s32_branchfree_gen,
+        libdivide_s32_branchfree_do_array_lanes);
+}
+void test_array_lanes(const std::string &name, const std::vector<uint64_t> &numers,
+    const std::vector<uint64_t> &denoms) {
+    test_array_lanes(name, numers, denoms, libdivide_u64_gen, libdivide_u64_do_array_lanes);
+}
+void test_array_lanes(const std::string &name, const std::vector<int64_t> &numers,
+    const std::vector<int64_t> &denoms) {
+    test_array_lanes(name, numers, denoms, libdivide_s64_gen, libdivide_s64_do_array_lanes);
+    test_array_lanes(name + " (branchfree)", numers, denoms, libdivide_s64_branchfree_gen,
+        libdivide_s64_branchfree_do_array_lanes);
+}
+
+// Returns whether the bounded divider of d uses the add indicator,
+// false for the types without libdivide_*_gen_bounded()
+template <typename T>
+bool bounded_add_marker(T, T) {
+    return false;
+}
+bool bounded_add_marker(int16_t d, int16_t max_numer) {
+    return (libdivide_s16_gen_bounded(d, max_numer).more & LIBDIVIDE_ADD_MARKER) != 0;
+}
+bool bounded_add_marker(uint16_t d, uint16_t max_numer) {
+    return (libdivide_u16_gen_bounded(d, max_numer).more & LIBDIVIDE_ADD_MARKER) != 0;
+}
+bool bounded_add_marker(int32_t d, int32_t max_numer) {
+    return (libdivide_s32_gen_bounded(d, max_numer).more & LIBDIVIDE_ADD_MARKER) != 0;
+}
+bool bounded_add_marker(uint32_t d, uint32_t max_numer) {
+    return (libdivide_u32_gen_bounded(d, max_numer).more & LIBDIVIDE_ADD_MARKER) != 0;
+}
+bool bounded_add_marker(int64_t d, int64_t max_numer) {
+    return (libdivide_s64_gen_bounded(d, max_numer).more & LIBDIVIDE_ADD_MARKER) != 0;
+}
+bool bounded_add_marker(uint64_t d, uint64_t max_numer) {
+    return (libdivide_u64_gen_bounded(d, max_numer).more & LIBDIVIDE_ADD_MARKER) != 0;
+}
+
+#ifdef LIBDIVIDE_RVV
+// Overloads of the RVV vsetvl, load and store intrinsics by element type
+size_t rvv_vsetvl(const uint16_t *, size_t n) {
+    return __riscv_vsetvl_e16m1(n);
+}
+vuint16m1_t rvv_load(const uint16_t *p, size_t vl) {
+    return __riscv_vle16_v_u16m1(p, vl);
+}
+void rvv_store(uint16_t *p, vuint16m1_t v, size_t vl) {
+    __riscv_vse16_v_u16m1(p, v, vl);
+}
+size_t rvv_vsetvl(const int16_t *, size_t n) {
+    return __riscv_vsetvl_e16m1(n);
+}
+vint16m1_t rvv_load(const int16_t *p, size_t vl) {
+    return __riscv_vle16_v_i16m1(p, vl);
+}
+void rvv_store(int16_t *p, vint16m1_t v, size_t vl) {
+    __riscv_vse16_v_i16m1(p, v, vl);
+}
+size_t rvv_vsetvl(const uint32_t *, size_t n) {
+    return __riscv_vsetvl_e32m1(n);
+}
+vuint32m1_t rvv_load(const uint32_t *p, size_t vl) {
+    return __riscv_vle32_v_u32m1(p, vl);
+}
+void rvv_store(uint32_t *p, vuint32m1_t v, size_t vl) {
+    __riscv_vse32_v_u32m1(p, v, vl);
+}
+size_t rvv_vsetvl(const int32_t *, size_t n) {
+    return __riscv_vsetvl_e32m1(n);
+}
+vint32m1_t rvv_load(const int32_t *p, size_t vl) {
+    return __riscv_vle32_v_i32m1(p, vl);
+}
+void rvv_store(int32_t *p, vint32m1_t v, size_t vl) {
+    __riscv_vse32_v_i32m1(p, v, vl);
+}
+size_t rvv_vsetvl(const uint64_t *, size_t n) {
+    return __riscv_vsetvl_e64m1(n);
+}
+vuint64m1_t rvv_load(const uint64_t *p, size_t vl) {
+    return __riscv_vle64_v_u64m1(p, vl);
+}
+void rvv_store(uint64_t *p, vuint64m1_t v, size_t vl) {
+    __riscv_vse64_v_u64m1(p, v, vl);
+}
+size_t rvv_vsetvl(const int64_t *, size_t n) {
+    return __riscv_vsetvl_e64m1(n);
+}
+vint64m1_t rvv_load(const int64_t *p, size_t vl) {
+    return __riscv_vle64_v_i64m1(p, vl);
+}
+void rvv_store(int64_t *p, vint64m1_t v, size_t vl) {
+    __riscv_vse64_v_i64m1(p, v, vl);
+}
+#endif
+
+#ifdef LIBDIVIDE_AVX512
+// The masked AVX512 kernels of the branchfull dividers,
+// returns false if there is no masked kernel for T.
+template <typename T>
+bool divide_masked_vec512(__m512i, T, __m512i *) {
+    return false;
+}
+bool divide_masked_vec512(__m512i n, uint32_t d, __m512i *q) {
+    struct libdivide_u32_t denom = libdivide_u32_gen(d);
+    *q = libdivide_u32_do_masked_vec512(n, &denom);
+    return true;
+}
+bool divide_masked_vec512(__m512i n, int32_t d, __m512i *q) {
+    struct libdivide_s32_t denom = libdivide_s32_gen(d);
+    *q = libdivide_s32_do_masked_vec512(n, &denom);
+    return true;
+}
+bool divide_masked_vec512(__m512i n, uint64_t d, __m512i *q) {
+    struct libdivide_u64_t denom = libdivide_u64_gen(d);
+    *q = libdivide_u64_do_masked_vec512(n, &denom);
+    return true;
+}
+bool divide_masked_vec512(__m512i n, int64_t d, __m512i *q) {
+    struct libdivide_s64_t denom = libdivide_s64_gen(d);
+    *q = libdivide_s64_do_masked_vec512(n, &denom);
+    return true;
+}
+#endif
+
+// Divides each numerator by its own divisor using a divider_array
+template <typename T>
+void test_divider_array(const std::string &name, const std::vector<T> &divisors) {
+    using limits = std::numeric_limits<T>;
+    std::vector<T> denoms;
+    for (T d : divisors) {
+        denoms.push_back(d);
+        if (limits::is_signed && d != limits::min()) denoms.push_back((T)-d);
+    }
+    denoms.push_back(1);
+    if (limits::is_signed) denoms.push_back(limits::min());
+
+    std::mt19937 engine(12345);
+    std::uniform_int_distribution<int> dist(0, 3);
+    std::vector<T> numers(denoms.size());
+    for (size_t i = 0; i < numers.size(); i++) {
+        // Avoid min / -1, which is undefined behavior
+        T d = denoms[i];
+        T values[] = {(T)engine(), limits::max(), (T)(limits::min() + 1), (T)(d / 2)};
+        numers[i] = values[dist(engine)];
+    }
+
+    test_array_lanes(name, numers, denoms);
+
+    divider_array<T> dividers(denoms.data(), denoms.size());
+    divider_array<T> copy(dividers);
+    std::vector<T> quotients(denoms.size());
+    copy.divide(numers.data(), quotients.data());
+    for (size_t i = 0; i < denoms.size(); i++) {
+        T expect = numers[i] / denoms[i];
+        if (quotients[i] != expect || dividers.divide(numers[i], i) != expect ||
+            dividers.recover(i) != denoms[i]) {
+            std::cerr << "Divider array failure for " << name << ": " << numers[i] << " / "
+                      << denoms[i] << " expected " << expect << " actual " << quotients[i]
+                      << std::endl;
+            exit(1);
+        }
+    }
+}
+
+#if defined(LIBDIVIDE_MMAP)
+// The gathers of libdivide_*_do_array_packed() must only read the 5
+// bytes of each divider: the table ends right before an inaccessible
+// page and the numerators are divided by its last divider.
+template <typename T, typename Denom>
+void test_packed_table_end(const std::string &name, const Denom *denoms, size_t n, T d) {
+    typedef packed_dispatcher<true, std::numeric_limits<T>::is_signed, sizeof(T)> dispatcher_t;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t bytes = n * sizeof(Denom);
+    const size_t size = (bytes + page - 1) / page * page + page;
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED || mprotect((char *)addr + size - page, page, PROT_NONE) != 0) {
+        std::cerr << "Cannot map guard page for " << name << std::endl;
+        exit(1);
+    }
+    Denom *table = (Denom *)((char *)addr + size - page - bytes);
+    std::memcpy(table, denoms, bytes);
+    const size_t count = 37;
+    std::vector<T> numers(count), quotients(count);
+    std::vector<uint32_t> indices(count, (uint32_t)(n - 1));
+    for (size_t i = 0; i < count; i++) numers[i] = (T)(i * 1000003u);
+    dispatcher_t::divide(numers.data(), quotients.data(), count, table, indices.data());
+    munmap(addr, size);
+    for (size_t i = 0; i < count; i++) {
+        if (quotients[i] != numers[i] / d) {
+            std::cerr << "Packed table end failure for " << name << ": " << numers[i] << " / "
+                      << d << std::endl;
+            exit(1);
+        }
+    }
+}
+#endif
+
+// Divides numerators by randomly indexed dividers of a packed_divider_array
+template <typename T>
+void test_packed_divider_array(const std::string &name, const std::vector<T> &divisors) {
+    using limits = std::numeric_limits<T>;
+    std::vector<T> denoms(divisors);
+    denoms.push_back(1);
+    if (limits::is_signed) denoms.push_back(limits::min());
+    denoms = valid_divisors<T, BRANCHFULL>(denoms);
+
+    packed_divider_array<T> dividers(denoms.data(), denoms.size());
+    packed_divider_array<T> copy(dividers);
+    std::mt19937 engine(54321);
+    size_t count = denoms.size() * 3 + 5;
+    std::vector<T> numers(count);
+    std::vector<uint32_t> indices(count);
+    for (size_t i = 0; i < count; i++) {
+        indices[i] = (uint32_t)(engine() % denoms.size());
+        numers[i] = (T)engine();
+        // Avoid min / -1, which is undefined behavior
+        if (numers[i] == limits::min()) numers[i]++;
+    }
+#if defined(LIBDIVIDE_MMAP)
+    test_packed_table_end(name, copy.data(), copy.size(), denoms.back());
+#endif
+    std::vector<T> quotients(count);
+    copy.divide(numers.data(), indices.data(), quotients.data(), count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t j = indices[i];
+        T expect = numers[i] / denoms[j];
+        if (quotients[i] != expect || dividers.divide(numers[i], j) != expect ||
+            dividers.recover(j) != denoms[j]) {
+            std::cerr << "Packed divider array failure for " << name << ": " << numers[i]
+                      << " / " << denoms[j] << " expected " << expect << " actual "
+                      << quotients[i] << std::endl;
+            exit(1);
+        }
+    }
+}
+
+// Only the 32-bit and 64-bit integers have divider arrays,
+// only the 32-bit integers have packed divider arrays
+template <typename T>
+void test_divider_arrays(const std::string &, const std::vector<T> &) {}
+
+void test_divider_arrays(const std::string &name, const std::vector<uint32_t> &divisors) {
+    test_divider_array(name, divisors);
+    test_packed_divider_array(name, divisors);
+}
+void test_divider_arrays(const std::string &name, const std::vector<int32_t> &divisors) {
+    test_divider_array(name, divisors);
+    test_packed_divider_array(name, divisors);
+}
+void test_divider_arrays(const std::string &name, const std::vector<uint64_t> &divisors) {
+    test_divider_array(name, divisors);
+}
+void test_divider_arrays(const std::string &name, const std::vector<int64_t> &divisors) {
+    test_divider_array(name, divisors);
+}
+
+// The cached dividers must be identical to the generated ones
+template <typename T, Branching ALGO>
+void test_divider_cache(const std::string &name, const std::vector<T> &all_divisors) {
+    const std::vector<T> divisors = valid_divisors<T, ALGO>(all_divisors);
+
+    // A small cache, most lookups evict an entry
+    divider_cache<T, 64, ALGO> cache;
+    shared_divider_cache<T, 64, ALGO> shared;
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < divisors.size(); i++) {
+            T d = divisors[(i * 7 + (size_t)round) % divisors.size()];
+            divider<T, ALGO> expect(d);
+            if (cache.get(d) != expect || shared.get(d) != expect ||
+                thread_divider_cache<T, 256, ALGO>().get(d) != expect) {
+                std::cerr << "Divider cache failure for " << name << ": " << d << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    // Concurrent lookups of the same few entries
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < divisors.size() * 4; i++) {
+                T d = divisors[(i * (size_t)(t + 1)) % 256 % divisors.size()];
+                if (shared.get(d) != divider<T, ALGO>(d)) {
+                    std::cerr << "Shared divider cache failure for " << name << ": " << d
+                              << std::endl;
+                    exit(1);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+}
+
+// Readers of a divider_table must never see a torn divider while
+// a writer republishes the entries.
+template <typename T, bool PADDED>
+void test_divider_table(const std::string &name, const std::vector<T> &all_divisors) {
+    const std::vector<T> divisors = valid_divisors<T, BRANCHFREE>(all_divisors);
+
+    const size_t count = 16;
+    std::vector<T> old_divisors(divisors.begin(), divisors.begin() + count);
+    std::vector<T> new_divisors(divisors.end() - count, divisors.end());
+    divider_table<T, BRANCHFREE, PADDED> table(old_divisors.data(), count);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                for (size_t i = 0; i < count; i++) {
+                    branchfree_divider<T> div = table.load(i);
+                    if (div != branchfree_divider<T>(old_divisors[i]) &&
+                        div != branchfree_divider<T>(new_divisors[i])) {
+                        std::cerr << "Divider table failure for " << name << ": " << i
+                                  << std::endl;
+                        exit(1);
+                    }
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 2000; round++) {
+        table.store(round % 2 ? old_divisors.data() : new_divisors.data());
+    }
+    done.store(true);
+    for (auto &reader : readers) reader.join();
+
+    table.store(new_divisors.data());
+    for (size_t i = 0; i < count; i++) {
+        if (table.divide(std::numeric_limits<T>::max(), i) !=
+            std::numeric_limits<T>::max() / new_divisors[i]) {
+            std::cerr << "Divider table failure for " << name << ": " << i << std::endl;
+            exit(1);
+        }
+    }
+}
+
+// A serialized table must read back the same dividers and
+// be rejected if truncated or read as another type.
+template <typename T, Branching ALGO>
+void test_serialized_table(const std::string &name, const std::vector<T> &all_divisors) {
+    const std::vector<T> divisors = valid_divisors<T, ALGO>(all_divisors);
+
+    std::vector<divider<T, ALGO>> dividers(divisors.begin(), divisors.end());
+    std::vector<char> buffer(
+        libdivide_table_size(serialized_table_type<T, ALGO>::value, dividers.size()));
+    size_t size = write_divider_table(buffer.data(), dividers.data(), dividers.size());
+    size_t count = 0;
+    const divider<T, ALGO> *table = read_divider_table<T, ALGO>(buffer.data(), size, &count);
+    if (size != buffer.size() || !table || count != dividers.size() ||
+        read_divider_table<T, ALGO>(buffer.data(), buffer.size() - 1, &count) ||
+        read_divider_table<T, ALGO == BRANCHFULL ? BRANCHFREE : BRANCHFULL>(
+            buffer.data(), size, &count)) {
+        std::cerr << "Serialized table failure for " << name << std::endl;
+        exit(1);
+    }
+    for (size_t i = 0; i < dividers.size(); i++) {
+        if (table[i] != dividers[i] || table[i].recover() != divisors[i]) {
+            std::cerr << "Serialized table failure for " << name << ": " << divisors[i]
+                      << std::endl;
+            exit(1);
+        }
+    }
+}
+
+#if defined(LIBDIVIDE_MMAP)
+// A saved table must map to the same dividers, and be
+// rejected when mapped as another type.
+template <typename T, Branching ALGO>
+void test_mapped_table(const std::string &name, const std::vector<T> &all_divisors) {
+    const std::vector<T> divisors = valid_divisors<T, ALGO>(all_divisors);
+    std::vector<divider<T, ALGO>> dividers(divisors.begin(), divisors.end());
+    char path[] = "/tmp/libdivide_tableXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || ::close(fd) != 0 ||
+        !save_divider_table(path, dividers.data(), dividers.size())) {
+        std::cerr << "Cannot save table for " << name << std::endl;
+        exit(1);
+    }
+    mapped_divider_table<T, ALGO> table(path);
+    mapped_divider_table<T, ALGO == BRANCHFULL ? BRANCHFREE : BRANCHFULL> other(path);
+    std::remove(path);
+    if (!table.is_open() || table.size() != dividers.size() || other.is_open()) {
+        std::cerr << "Mapped table failure for " << name << std::endl;
+        exit(1);
+    }
+    const T numer = std::numeric_limits<T>::max();
+    for (size_t i = 0; i < table.size(); i++) {
+        if (table[i] != dividers[i] || numer / table[i] != numer / divisors[i]) {
+            std::cerr << "Mapped table failure for " << name << ": " << divisors[i]
+                      << std::endl;
+            exit(1);
+        }
+    }
+}
+#endif
+
+// The chunks of parallel::divide() must cover the whole array,
+// whatever the executor and the alignment of the quotients.
+template <typename T, Branching ALGO>
+void test_parallel(const std::string &name, const std::vector<T> &all_divisors) {
+    const std::vector<T> divisors = valid_divisors<T, ALGO>(all_divisors);
+
+    std::mt19937 engine(777);
+    const size_t count = 3 * LIBDIVIDE_PARALLEL_CHUNK_BYTES / sizeof(T) + 13;
+    std::vector<T> numers(count + 1);
+    for (T &n : numers) n = (T)engine();
+    if (std::numeric_limits<T>::is_signed)
+        std::replace(numers.begin(), numers.end(), std::numeric_limits<T>::min(), (T)0);
+    parallel::thread_pool pool(3);
+    auto serial = [](size_t tasks, const std::function<void(size_t)> &task) {
+        for (size_t i = tasks; i-- > 0;) task(i);
+    };
+
+    for (size_t k = 0; k < 4; k++) {
+        T d = divisors[engine() % divisors.size()];
+        divider<T, ALGO> div(d);
+        for (int variant = 0; variant < 4; variant++) {
+            std::vector<T> quotients(count + 1, 0);
+            size_t offset = variant & 1;
+            if (variant == 0) {
+                parallel::divide(numers.data(), quotients.data(), count, div, pool);
+            } else if (variant == 1) {
+                parallel::divide(numers.data() + 1, quotients.data() + 1, count, div, pool);
+            } else if (variant == 2) {
+                parallel::divide(numers.data(), quotients.data(), count, div);
+            } else {
+                parallel::divide(numers.data() + 1, quotients.data() + 1, count, div, serial);
+            }
+            for (size_t i = offset; i < count + offset; i++) {
+                if (quotients[i] != numers[i] / d) {
+                    std::cerr << "Parallel division failure for " << name << ": " << numers[i]
+                              << " / " << d << " at " << i << std::endl;
+                    exit(1);
+                }
+            }
+        }
+#if defined(LIBDIVIDE_EXECUTION_POLICIES)
+        std::vector<T> quotients(count);
+        parallel::divide(numers.data(), quotients.data(), count, div, std::execution::seq);
+        for (size_t i = 0; i < count; i++) {
+            if (quotients[i] != numers[i] / d) {
+                std::cerr << "Parallel division failure for " << name << ": " << numers[i]
+                          << " / " << d << std::endl;
+                exit(1);
+            }
+        }
+#endif
+    }
+}
+
 template <typename T>
 class DivideTest {
    private:
     using UT = typename std::make_unsigned<T>::type;
     using limits = std::numeric_limits<T>;
+    // Number of random numerators per round, enough to fill a __m512i
+    static const size_t numers_count = 64 / sizeof(T) > 16 ? 64 / sizeof(T) : 16;
     std::string name;
     uint32_t seed = 0;
     UT rand_n = 0;
 
-    // This random function slowly increases the random number
-    // until there is an integer overflow, if this happens
-    // the random number is reset to 0 and we restart at the
-    // beginning. We do this to ensure that we get many test
-    // cases (random integers) of varying bit length.
-    T get_random() {
-        // https://en.wikipedia.org/wiki/Linear_congruential_generator
-        seed = seed * 1664525 + 1013904223;
+    // This random function slowly increases the random number
+    // until there is an integer overflow, if this happens
+    // the random number is reset to 0 and we restart at the
+    // beginning. We do this to ensure that we get many test
+    // cases (random integers) of varying bit length.
+    T get_random() {
+        // https://en.wikipedia.org/wiki/Linear_congruential_generator
+        seed = seed * 1664525 + 1013904223;
+
+        UT old = rand_n;
+        rand_n = rand_n * (seed % 2 + 1) + rand_n % 30000001 + 3;
+
+        // Reset upon integer overflow
+        if (rand_n < old) {
+            rand_n = seed % 19;
+        }
+
+        // The algorithm above generates mostly positive numbers.
+        // Hence convert 50% of all values to negative.
+        if (limits::is_signed) {
+            if (seed % 2) return -(T)rand_n;
+        }
+
+        return (T)rand_n;
+    }
+
+    T random_denominator() {
+        T denom = get_random();
+        while (denom == 0) {
+            denom = get_random();
+        }
+        return denom;
+    }
+
+    std::string testcase_name(int algo) const {
+        std::string result = this->name;
+        if (algo == BRANCHFREE) {
+            result += " (branchfree)";
+        }
+        return result;
+    }
+
+    template <Branching ALGO>
+    void test_one(T numer, T denom, const divider<T, ALGO> &the_divider) {
+        // Don't crash with INT_MIN / -1
+        // INT_MIN / -1 is undefined behavior in C/C++
+        if (limits::is_signed && numer == limits::min() && denom == T(-1)) {
+            return;
+        }
+
+        T expect = numer / denom;
+        T result = numer / the_divider;
+
+        if (result != expect) {
+            std::cerr << "Failure for " << testcase_name(ALGO) << ": " << numer << " / " << denom
+                      << " = " << expect << ", but got " << result << std::endl;
+            exit(1);
+        }
+    }
+
+    template <typename VecType, Branching ALGO>
+    void test_vec(const T *numers, T denom, const divider<T, ALGO> &div) {
+        // Align memory to 64 byte boundary for AVX512
+        char mem[numers_count * sizeof(T) + 64];
+        size_t offset = 64 - (size_t)&mem % 64;
+        T *results = (T *)&mem[offset];
+
+        size_t iters = 64 / sizeof(VecType);
+        size_t size = sizeof(VecType) / sizeof(T);
+
+        for (size_t j = 0; j < iters; j++, numers += size) {
+            VecType x;
+            memcpy(&x, numers, sizeof(VecType));
+            VecType resultVector = x / div;
+            memcpy(results, &resultVector, sizeof(VecType));
+
+            for (size_t i = 0; i < size; i++) {
+                T numer = numers[i];
+                T result = results[i];
+                T expect = numer / denom;
+
+                if (result != expect) {
+                    std::cerr << "Vector failure for: " << testcase_name(ALGO) << ": " << numer
+                              << " / " << denom << " = " << expect << ", but got " << result
+                              << std::endl;
+                    exit(1);
+                } else {
+#if 0
+                        std::cout << "vec" << (CHAR_BIT * sizeof(VecType)) << " success for: " << numer << " / " << denom << " = " << result << std::endl;
+#endif
+                }
+            }
+        }
+    }
+
+#ifdef LIBDIVIDE_AVX512
+    void test_masked_vec512(const T *numers, T denom) {
+        __m512i x, q;
+        memcpy(&x, numers, sizeof(x));
+        if (!divide_masked_vec512(x, denom, &q)) return;
+        T results[sizeof(q) / sizeof(T)];
+        memcpy(results, &q, sizeof(q));
+
+        for (size_t i = 0; i < sizeof(q) / sizeof(T); i++) {
+            if (limits::is_signed && numers[i] == limits::min() && denom == T(-1)) continue;
+            T expect = numers[i] / denom;
+            if (results[i] != expect) {
+                std::cerr << "Masked vector failure for: " << name << ": " << numers[i] << " / "
+                          << denom << " = " << expect << ", but got " << results[i] << std::endl;
+                exit(1);
+            }
+        }
+    }
+#endif
+
+#ifdef LIBDIVIDE_SVE
+    // SVE vectors are sizeless, the predicate of the last vector
+    // excludes the lanes beyond numers (for vectors > 64 bytes).
+    template <Branching ALGO>
+    void test_vec_sve(const T *numers, T denom, const divider<T, ALGO> &div) {
+        typedef typename SveVecFor<T>::type VecType;
+        const uint64_t bytes = 64;
+        T results[bytes / sizeof(T)];
+
+        for (uint64_t j = 0; j < bytes; j += svcntb()) {
+            svbool_t pg = svwhilelt_b8_u64(j, bytes);
+            VecType x = svld1(pg, numers + j / sizeof(T));
+            VecType q = x / div;
+            svst1(pg, results + j / sizeof(T), q);
+        }
+        for (size_t i = 0; i < bytes / sizeof(T); i++) {
+            T expect = numers[i] / denom;
+            if (results[i] != expect) {
+                std::cerr << "SVE vector failure for: " << testcase_name(ALGO) << ": "
+                          << numers[i] << " / " << denom << " = " << expect << ", but got "
+                          << results[i] << std::endl;
+                exit(1);
+            }
+        }
+    }
+#endif
+
+#ifdef LIBDIVIDE_RVV
+    // The RVV overloads divide VLMAX lanes, only the first vl
+    // lanes are loaded and stored for the last vector.
+    template <Branching ALGO>
+    void test_vec_rvv(const T *numers, T denom, const divider<T, ALGO> &div) {
+        typedef typename RvvVecFor<T>::type VecType;
+        const size_t count = 64 / sizeof(T);
+        T results[count];
+
+        for (size_t i = 0; i < count;) {
+            size_t vl = rvv_vsetvl(numers, count - i);
+            VecType x = rvv_load(numers + i, vl);
+            VecType q = x / div;
+            rvv_store(results + i, q, vl);
+            i += vl;
+        }
+        for (size_t i = 0; i < count; i++) {
+            T expect = numers[i] / denom;
+            if (results[i] != expect) {
+                std::cerr << "RVV vector failure for: " << testcase_name(ALGO) << ": "
+                          << numers[i] << " / " << denom << " = " << expect << ", but got "
+                          << results[i] << std::endl;
+                exit(1);
+            }
+        }
+    }
+#endif
+
+#ifdef LIBDIVIDE_SIMD_TS
+    // Use an odd lane count so that both the vector
+    // kernels and the scalar tail are exercised.
+    template <Branching ALGO>
+    void test_simd_ts(const T *numers, T denom, const divider<T, ALGO> &div) {
+        typedef std::experimental::fixed_size_simd<T, 7> VecType;
+        T results[VecType::size()];
+        VecType x(numers, std::experimental::element_aligned);
+        VecType q = x / div;
+        q.copy_to(results, std::experimental::element_aligned);
+
+        for (size_t i = 0; i < VecType::size(); i++) {
+            T expect = numers[i] / denom;
+            if (results[i] != expect) {
+                std::cerr << "simd failure for: " << testcase_name(ALGO) << ": " << numers[i]
+                          << " / " << denom << " = " << expect << ", but got " << results[i]
+                          << std::endl;
+                exit(1);
+            }
+        }
+    }
+#endif
+
+    // The portable vector overloads support all integer types
+    // up to 64 bits, including those without vector kernels.
+    template <Branching ALGO>
+    void test_generic_vecs(const T *, T, const divider<T, ALGO> &, std::false_type) {}
+
+    template <Branching ALGO>
+    void test_generic_vecs(
+        const T *numers, T denom, const divider<T, ALGO> &the_divider, std::true_type) {
+        (void)numers;
+        (void)denom;
+        (void)the_divider;
+#ifdef LIBDIVIDE_GNU_VECTORS
+        typedef T VecType __attribute__((vector_size(16)));
+        test_vec<VecType>(numers, denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_SIMD_TS
+        test_simd_ts(numers, denom, the_divider);
+#endif
+    }
+
+    // There are no vector kernels for 8-bit dividers
+    template <Branching ALGO>
+    void test_vecs(const T *, T, const divider<T, ALGO> &, std::false_type) {}
+
+    template <Branching ALGO>
+    void test_vecs(const T *numers, T denom, const divider<T, ALGO> &the_divider, std::true_type) {
+        // Unused if no vector instruction set is enabled
+        (void)numers;
+        (void)denom;
+        (void)the_divider;
+#ifdef LIBDIVIDE_SSE2
+        test_vec<__m128i>(numers, denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_AVX2
+        test_vec<__m256i>(numers, denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_AVX512
+        test_vec<__m512i>(numers, denom, the_divider);
+        if (ALGO == BRANCHFULL) test_masked_vec512(numers, denom);
+#endif
+#ifdef LIBDIVIDE_NEON
+        test_vec<typename NeonVecFor<T>::type>(numers, denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_SVE
+        test_vec_sve(numers, denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_RVV
+        test_vec_rvv(numers, denom, the_divider);
+#endif
+    }
+
+    template <Branching ALGO>
+    void test_array(T denom, const divider<T, ALGO> &div) {
+        // Use an odd count and an unaligned start so that the
+        // vector loops, the single vector loop and the scalar
+        // tail are all exercised.
+        const size_t count = 67;
+        T numers[count + 1];
+        T quotients[count + 1];
+
+        for (size_t i = 0; i < count + 1; i++) {
+            numers[i] = get_random();
+            // Don't crash with INT_MIN / -1
+            if (limits::is_signed && numers[i] == limits::min() && denom == T(-1)) {
+                numers[i] = 0;
+            }
+        }
+
+        div.divide(numers + 1, quotients + 1, count);
+        for (size_t i = 1; i < count + 1; i++) {
+            T expect = numers[i] / denom;
+            if (quotients[i] != expect) {
+                std::cerr << "Array failure for: " << testcase_name(ALGO) << ": " << numers[i]
+                          << " / " << denom << " = " << expect << ", but got " << quotients[i]
+                          << std::endl;
+                exit(1);
+            }
+        }
+
+        // In-place division
+        memcpy(quotients, numers, sizeof(numers));
+        div.divide(quotients, quotients, count + 1);
+        for (size_t i = 0; i < count + 1; i++) {
+            T expect = numers[i] / denom;
+            if (quotients[i] != expect) {
+                std::cerr << "In-place array failure for: " << testcase_name(ALGO) << ": "
+                          << numers[i] << " / " << denom << " = " << expect << ", but got "
+                          << quotients[i] << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    template <Branching ALGO>
+    void test_reductions(T, const divider<T, ALGO> &, std::false_type) {}
+
+    // The fused divide and reduce functions must match the reductions
+    // of the quotients computed by hardware division
+    template <Branching ALGO>
+    void test_reductions(T denom, const divider<T, ALGO> &div, std::true_type) {
+        // Enough numerators for the x4 loop of 16-bit AVX512 kernels,
+        // and an odd count for the single vector loop and the tail.
+        const size_t count = 301;
+        T numers[count];
+        for (size_t i = 0; i < count; i++) {
+            numers[i] = get_random();
+            if (limits::is_signed && numers[i] == limits::min() && denom == T(-1)) {
+                numers[i] = 0;
+            }
+        }
+
+        for (size_t n : {(size_t)1, (size_t)7, count}) {
+            uint64_t sum = 0;
+            T min = (T)(numers[0] / denom), max = min;
+            for (size_t i = 0; i < n; i++) {
+                T q = (T)(numers[i] / denom);
+                sum += (uint64_t)q;
+                min = std::min(min, q);
+                max = std::max(max, q);
+            }
+            T min2, max2;
+            div.min_max_quotients(numers, n, &min2, &max2);
+            if ((uint64_t)div.sum_quotients(numers, n) != sum || min2 != min || max2 != max) {
+                std::cerr << "Divide and reduce failure for: " << testcase_name(ALGO) << ": "
+                          << denom << ", count " << n << std::endl;
+                exit(1);
+            }
+        }
+        test_histogram(denom, div, numers, count, std::is_unsigned<T>());
+    }
+
+    template <Branching ALGO>
+    void test_stream(T, const divider<T, ALGO> &, std::false_type) {}
+
+    // Stream all misalignments of the quotients, and an array
+    // that is smaller than LIBDIVIDE_STREAM_THRESHOLD
+    template <Branching ALGO>
+    void test_stream(T denom, const divider<T, ALGO> &div, std::true_type) {
+        const size_t count = 301;
+        T numers[count];
+        T quotients[count];
+        for (size_t i = 0; i < count; i++) {
+            numers[i] = get_random();
+            if (limits::is_signed && numers[i] == limits::min() && denom == T(-1)) {
+                numers[i] = 0;
+            }
+        }
+        for (size_t offset = 0; offset < 64 / sizeof(T); offset += 3) {
+            size_t n = offset == 0 ? 7 : count - offset;
+            div.divide_stream(numers + offset, quotients + offset, n);
+            for (size_t i = offset; i < offset + n; i++) {
+                if (quotients[i] != (T)(numers[i] / denom)) {
+                    std::cerr << "Stream array failure for: " << testcase_name(ALGO) << ": "
+                              << numers[i] << " / " << denom << ", got " << quotients[i]
+                              << std::endl;
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    template <Branching ALGO>
+    void test_histogram(T, const divider<T, ALGO> &, const T *, size_t, std::false_type) {}
+
+    template <Branching ALGO>
+    void test_histogram(
+        T denom, const divider<T, ALGO> &div, const T *numers, size_t count, std::true_type) {
+        uint32_t bins[9] = {1, 0, 0, 0, 0, 0, 0, 0, 0};
+        uint32_t expect[9] = {1, 0, 0, 0, 0, 0, 0, 0, 0};
+        for (size_t i = 0; i < count; i++) {
+            T q = (T)(numers[i] / denom);
+            expect[q < 8 ? q : 8]++;
+        }
+        div.histogram_quotients(numers, count, bins, 9);
+        if (memcmp(bins, expect, sizeof(bins)) != 0) {
+            std::cerr << "Histogram failure for: " << testcase_name(ALGO) << ": " << denom
+                      << std::endl;
+            exit(1);
+        }
+    }
+
+    void check_divmod(int algo, T numer, T denom, T quotient, T rem, const char *kind) {
+        T expect = numer / denom;
+        T expect_rem = numer % denom;
+        if (quotient != expect || rem != expect_rem) {
+            std::cerr << kind << " divmod failure for: " << testcase_name(algo) << ": " << numer
+                      << " / " << denom << " = " << expect << " rem " << expect_rem
+                      << ", but got " << quotient << " rem " << rem << std::endl;
+            exit(1);
+        }
+    }
+
+    template <typename VecType, Branching ALGO>
+    void test_divmod_vec(const T *numers, T denom, const divmod_divider<T, ALGO> &div) {
+        size_t size = sizeof(VecType) / sizeof(T);
+
+        for (size_t j = 0; j < 16; j += size) {
+            VecType x, rem;
+            memcpy(&x, numers + j, sizeof(VecType));
+            VecType quotient = div.divmod(x, &rem);
+            T quotients[16], rems[16];
+            memcpy(quotients, &quotient, sizeof(VecType));
+            memcpy(rems, &rem, sizeof(VecType));
+            for (size_t i = 0; i < size; i++) {
+                check_divmod(ALGO, numers[j + i], denom, quotients[i], rems[i], "Vector");
+            }
+        }
+    }
+
+    // divmod_divider is only available for 32-bit and 64-bit integers
+    template <Branching ALGO>
+    void test_divmod(const T *, T, std::false_type) {}
+
+    // numers must contain 16 numerators
+    template <Branching ALGO>
+    void test_divmod(const T *numers, T denom, std::true_type) {
+        const divmod_divider<T, ALGO> div(denom);
+        if (div.recover() != denom) {
+            std::cerr << "Failed to store divisor for " << testcase_name(ALGO) << ": " << denom
+                      << std::endl;
+            exit(1);
+        }
+
+        for (size_t i = 0; i < 16; i++) {
+            T rem;
+            T quotient = div.divmod(numers[i], &rem);
+            check_divmod(ALGO, numers[i], denom, quotient, rem, "Scalar");
+        }
+#ifdef LIBDIVIDE_SSE2
+        test_divmod_vec<__m128i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+        test_divmod_vec<__m256i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+        test_divmod_vec<__m512i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_NEON
+        test_divmod_vec<typename NeonVecFor<T>::type>(numers, denom, div);
+#endif
+
+        // Odd count to exercise the scalar tail
+        T quotients[15], rems[15];
+        div.divmod(numers + 1, quotients, rems, 15);
+        for (size_t i = 0; i < 15; i++) {
+            check_divmod(ALGO, numers[i + 1], denom, quotients[i], rems[i], "Array");
+        }
+
+        test_rounding(numers, denom, div, std::integral_constant<bool, limits::is_signed>());
+    }
+
+    // results holds divide_floor(), divide_ceil(), mod_floor() and mod_euclid()
+    void check_rounding(int algo, T numer, T denom, const T results[4], const char *kind) {
+        // INT_MIN / -1 is undefined behavior in C/C++
+        if (numer == limits::min() && denom == T(-1)) {
+            return;
+        }
+        T q = numer / denom;
+        T rem = numer % denom;
+        bool inexact = rem != 0;
+        bool same_sign = (rem < 0) == (denom < 0);
+        UT absD = (UT)(denom < 0 ? (UT)0 - (UT)denom : (UT)denom);
+        T expect[4] = {(T)(inexact && !same_sign ? q - 1 : q),
+            (T)(inexact && same_sign ? q + 1 : q),
+            (T)(inexact && !same_sign ? (UT)rem + (UT)denom : (UT)rem),
+            (T)(rem < 0 ? (UT)rem + absD : (UT)rem)};
+        static const char *names[4] = {"divide_floor", "divide_ceil", "mod_floor", "mod_euclid"};
+
+        for (int k = 0; k < 4; k++) {
+            if (results[k] != expect[k]) {
+                std::cerr << kind << " " << names[k] << " failure for: " << testcase_name(algo)
+                          << ": " << numer << ", " << denom << " = " << expect[k]
+                          << ", but got " << results[k] << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    template <typename VecType, Branching ALGO>
+    void test_rounding_vec(const T *numers, T denom, const divmod_divider<T, ALGO> &div) {
+        size_t size = sizeof(VecType) / sizeof(T);
+
+        for (size_t j = 0; j < 16; j += size) {
+            VecType x;
+            memcpy(&x, numers + j, sizeof(VecType));
+            VecType vecs[4] = {
+                div.divide_floor(x), div.divide_ceil(x), div.mod_floor(x), div.mod_euclid(x)};
+            T lanes[4][16];
+            for (int k = 0; k < 4; k++) {
+                memcpy(lanes[k], &vecs[k], sizeof(VecType));
+            }
+            for (size_t i = 0; i < size; i++) {
+                T results[4] = {lanes[0][i], lanes[1][i], lanes[2][i], lanes[3][i]};
+                check_rounding(ALGO, numers[j + i], denom, results, "Vector");
+            }
+        }
+    }
+
+    // Floor, ceiling and Euclidean division are only available for signed types
+    template <Branching ALGO>
+    void test_rounding(const T *, T, const divmod_divider<T, ALGO> &, std::false_type) {}
+
+    template <Branching ALGO>
+    void test_rounding(
+        const T *numers, T denom, const divmod_divider<T, ALGO> &div, std::true_type) {
+        for (size_t i = 0; i < 16; i++) {
+            T n = numers[i];
+            if (n == limits::min() && denom == T(-1)) continue;
+            T results[4] = {
+                div.divide_floor(n), div.divide_ceil(n), div.mod_floor(n), div.mod_euclid(n)};
+            check_rounding(ALGO, n, denom, results, "Scalar");
+        }
+#ifdef LIBDIVIDE_SSE2
+        test_rounding_vec<__m128i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+        test_rounding_vec<__m256i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+        test_rounding_vec<__m512i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_NEON
+        test_rounding_vec<typename NeonVecFor<T>::type>(numers, denom, div);
+#endif
+    }
+
+    template <typename VecType, typename MaskType>
+    void test_divisibility_vec(const T *numers, T denom, const divisibility<T> &div) {
+        size_t size = sizeof(VecType) / sizeof(T);
+
+        for (size_t j = 0; j < 16; j += size) {
+            VecType x;
+            memcpy(&x, numers + j, sizeof(VecType));
+            MaskType mask = div.is_divisible(x);
+            for (size_t i = 0; i < size; i++) {
+                bool result = get_lane(mask, i);
+                bool expect = numers[j + i] % denom == 0;
+                if (result != expect) {
+                    std::cerr << "Vector divisibility failure for: " << name << ": "
+                              << numers[j + i] << " % " << denom << " == 0 is " << expect
+                              << ", but got " << result << std::endl;
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    template <typename VecType>
+    static bool get_lane(const VecType &mask, size_t i) {
+        T lanes[sizeof(VecType) / sizeof(T)];
+        memcpy(lanes, &mask, sizeof(VecType));
+        return lanes[i] != 0;
+    }
+
+#ifdef LIBDIVIDE_AVX512
+    static bool get_lane(__mmask16 mask, size_t i) { return (mask >> i) & 1; }
+    static bool get_lane(__mmask8 mask, size_t i) { return (mask >> i) & 1; }
+#endif
+
+    void test_divisibility(T, std::false_type) {}
+
+    void test_divisibility(T denom, std::true_type) {
+        const divisibility<T> div(denom);
+        T numers[16];
+
+        for (size_t iter = 0; iter < 100; iter++) {
+            // Mix multiples of denom and their neighbours
+            for (size_t j = 0; j < 16; j++) {
+                T k = get_random();
+                if (denom != 1) k %= max() / denom + 1;
+                T multiple = denom * k;
+                numers[j] = multiple + (T)(j % 3) - 1;
+            }
+            numers[0] = 0;
+            numers[1] = max();
+
+            for (size_t j = 0; j < 16; j++) {
+                bool result = div.is_divisible(numers[j]);
+                bool expect = numers[j] % denom == 0;
+                if (result != expect) {
+                    std::cerr << "Divisibility failure for: " << name << ": " << numers[j]
+                              << " % " << denom << " == 0 is " << expect << ", but got "
+                              << result << std::endl;
+                    exit(1);
+                }
+            }
+#ifdef LIBDIVIDE_SSE2
+            test_divisibility_vec<__m128i, __m128i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_divisibility_vec<__m256i, __m256i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_divisibility_vec<__m512i, decltype(div.is_divisible(__m512i()))>(
+                numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_NEON
+            test_divisibility_vec<typename NeonVecFor<T>::type, typename NeonVecFor<T>::type>(
+                numers, denom, div);
+#endif
+        }
+    }
+
+    static T max() { return limits::max(); }
+
+    template <typename VecType>
+    void test_modulus_vec(const T *numers, T denom, const modulus<T> &mod) {
+        size_t size = sizeof(VecType) / sizeof(T);
+
+        for (size_t j = 0; j < 16; j += size) {
+            VecType x;
+            memcpy(&x, numers + j, sizeof(VecType));
+            VecType rem = x % mod;
+            T rems[16];
+            memcpy(rems, &rem, sizeof(VecType));
+            for (size_t i = 0; i < size; i++) {
+                T expect = numers[j + i] % denom;
+                if (rems[i] != expect) {
+                    std::cerr << "Vector modulus failure for: " << name << ": " << numers[j + i]
+                              << " % " << denom << " = " << expect << ", but got " << rems[i]
+                              << std::endl;
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    void test_modulus(T, std::false_type) {}
+
+    void test_modulus(T denom, std::true_type) {
+        const modulus<T> mod(denom);
+        T numers[16];
+
+        for (size_t iter = 0; iter < 100; iter++) {
+            for (size_t j = 0; j < 16; j++) {
+                numers[j] = get_random();
+            }
+            numers[0] = max();
+            numers[1] = denom - 1;
+            numers[2] = denom;
+
+            for (size_t j = 0; j < 16; j++) {
+                T expect = numers[j] % denom;
+                T result = numers[j] % mod;
+                if (result != expect) {
+                    std::cerr << "Modulus failure for: " << name << ": " << numers[j] << " % "
+                              << denom << " = " << expect << ", but got " << result
+                              << std::endl;
+                    exit(1);
+                }
+            }
+#ifdef LIBDIVIDE_SSE2
+            test_modulus_vec<__m128i>(numers, denom, mod);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_modulus_vec<__m256i>(numers, denom, mod);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_modulus_vec<__m512i>(numers, denom, mod);
+#endif
+#ifdef LIBDIVIDE_NEON
+            test_modulus_vec<typename NeonVecFor<T>::type>(numers, denom, mod);
+#endif
+
+            // Odd count to exercise the scalar tail
+            T rems[15];
+            mod.mod(numers, rems, 15);
+            for (size_t j = 0; j < 15; j++) {
+                if (rems[j] != numers[j] % denom) {
+                    std::cerr << "Array modulus failure for: " << name << ": " << numers[j]
+                              << " % " << denom << ", got " << rems[j] << std::endl;
+                    exit(1);
+                }
+            }
+        }
+    }
 
-        UT old = rand_n;
-        rand_n = rand_n * (seed % 2 + 1) + rand_n % 30000001 + 3;
+    template <typename VecType>
+    void test_divider52_vec(const T *numers, T denom, const divider52<T> &div) {
+        size_t size = sizeof(VecType) / sizeof(T);
 
-        // Reset upon integer overflow
-        if (rand_n < old) {
-            rand_n = seed % 19;
+        for (size_t j = 0; j < 16; j += size) {
+            VecType x;
+            memcpy(&x, numers + j, sizeof(VecType));
+            VecType q = div.divide(x);
+            T quotients[16];
+            memcpy(quotients, &q, sizeof(VecType));
+            for (size_t i = 0; i < size; i++) {
+                T expect = numers[j + i] / denom;
+                if (quotients[i] != expect) {
+                    std::cerr << "Vector divider52 failure for: " << name << ": "
+                              << numers[j + i] << " / " << denom << " = " << expect
+                              << ", but got " << quotients[i] << std::endl;
+                    exit(1);
+                }
+            }
         }
+    }
 
-        // The algorithm above generates mostly positive numbers.
-        // Hence convert 50% of all values to negative.
-        if (limits::is_signed) {
-            if (seed % 2) return -(T)rand_n;
+    void test_divider52(T, std::false_type) {}
+
+    void test_divider52(T denom, std::true_type) {
+        const T limit = T(1) << 52;
+        // Reduce the divisor to the 52-bit range
+        if (denom / limit != 0) {
+            denom /= 4096;
+        }
+        const divider52<T> div(denom);
+        if (div.recover() != denom) {
+            std::cerr << "Failed to recover divider52 for: " << name << ": " << denom
+                      << ", but got " << div.recover() << std::endl;
+            exit(1);
         }
+        T numers[16];
 
-        return (T)rand_n;
+        for (size_t iter = 0; iter < 100; iter++) {
+            for (size_t j = 0; j < 16; j++) {
+                numers[j] = get_random() % limit;
+            }
+            numers[0] = limit - 1;
+            numers[1] = std::is_signed<T>::value ? T(1 - limit) : T(0);
+            numers[2] = denom;
+            numers[3] = T(denom - (denom > 0 ? 1 : -1));
+
+            for (size_t j = 0; j < 16; j++) {
+                T expect = numers[j] / denom;
+                T result = numers[j] / div;
+                if (result != expect) {
+                    std::cerr << "Divider52 failure for: " << name << ": " << numers[j] << " / "
+                              << denom << " = " << expect << ", but got " << result
+                              << std::endl;
+                    exit(1);
+                }
+            }
+#ifdef LIBDIVIDE_SSE2
+            test_divider52_vec<__m128i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_divider52_vec<__m256i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_divider52_vec<__m512i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_NEON
+            test_divider52_vec<typename NeonVecFor<T>::type>(numers, denom, div);
+#endif
+
+            // Odd count to exercise the scalar tail
+            T quotients[15];
+            div.divide(numers, quotients, 15);
+            for (size_t j = 0; j < 15; j++) {
+                if (quotients[j] != numers[j] / denom) {
+                    std::cerr << "Array divider52 failure for: " << name << ": " << numers[j]
+                              << " / " << denom << ", got " << quotients[j] << std::endl;
+                    exit(1);
+                }
+            }
+        }
     }
 
-    T random_denominator() {
-        T denom = get_random();
-        while (denom == 0) {
-            denom = get_random();
+    template <typename VecType>
+    void test_exact_vec(const T *numers, T denom, const divider<T, EXACT> &div) {
+        size_t size = sizeof(VecType) / sizeof(T);
+
+        for (size_t j = 0; j < 16; j += size) {
+            VecType x;
+            memcpy(&x, numers + j, sizeof(VecType));
+            VecType q = x / div;
+            T quotients[16];
+            memcpy(quotients, &q, sizeof(VecType));
+            for (size_t i = 0; i < size; i++) {
+                T expect = numers[j + i] / denom;
+                if (quotients[i] != expect) {
+                    std::cerr << "Vector exact division failure for: " << name << ": "
+                              << numers[j + i] << " / " << denom << " = " << expect
+                              << ", but got " << quotients[i] << std::endl;
+                    exit(1);
+                }
+            }
         }
-        return denom;
     }
 
-    std::string testcase_name(int algo) const {
-        std::string result = this->name;
-        if (algo == BRANCHFREE) {
-            result += " (branchfree)";
+    void test_exact(T, std::false_type) {}
+
+    // Exact division only supports multiples of the divisor
+    void test_exact(T denom, std::true_type) {
+        const divider<T, EXACT> div(denom);
+        if (div.recover() != denom) {
+            std::cerr << "Failed to recover exact divider for: " << name << ": " << denom
+                      << ", but got " << div.recover() << std::endl;
+            exit(1);
+        }
+        UT absD = (UT)(denom < 0 ? (UT)0 - (UT)denom : (UT)denom);
+        UT maxQuotient = (UT)max() / absD;
+        T numers[16];
+
+        for (size_t iter = 0; iter < 100; iter++) {
+            for (size_t j = 0; j < 16; j++) {
+                UT k = (UT)get_random();
+                if (absD != 1) k %= maxQuotient + 1;
+                T multiple = (T)(k * (UT)denom);
+                numers[j] = (limits::is_signed && j % 2) ? (T)-multiple : multiple;
+            }
+            numers[0] = 0;
+            numers[1] = (T)(maxQuotient * (UT)denom);
+            numers[2] = denom;
+
+            for (size_t j = 0; j < 16; j++) {
+                T expect = numers[j] / denom;
+                T result = numers[j] / div;
+                if (result != expect) {
+                    std::cerr << "Exact division failure for: " << name << ": " << numers[j]
+                              << " / " << denom << " = " << expect << ", but got " << result
+                              << std::endl;
+                    exit(1);
+                }
+            }
+#ifdef LIBDIVIDE_SSE2
+            test_exact_vec<__m128i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_exact_vec<__m256i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_exact_vec<__m512i>(numers, denom, div);
+#endif
+#ifdef LIBDIVIDE_NEON
+            test_exact_vec<typename NeonVecFor<T>::type>(numers, denom, div);
+#endif
+
+            // Odd count to exercise the scalar tail
+            T quotients[15];
+            div.divide(numers, quotients, 15);
+            for (size_t j = 0; j < 15; j++) {
+                if (quotients[j] != numers[j] / denom) {
+                    std::cerr << "Array exact division failure for: " << name << ": "
+                              << numers[j] << " / " << denom << ", got " << quotients[j]
+                              << std::endl;
+                    exit(1);
+                }
+            }
         }
-        return result;
     }
 
     template <Branching ALGO>
-    void test_one(T numer, T denom, const divider<T, ALGO> &the_divider) {
-        // Don't crash with INT_MIN / -1
-        // INT_MIN / -1 is undefined behavior in C/C++
-        if (limits::is_signed && numer == limits::min() && denom == T(-1)) {
-            return;
+    void test_quantizer(T, size_t, std::false_type) {}
+
+    // The bins of floating-point values must be the
+    // truncated values divided by the bin width
+    template <Branching ALGO>
+    void test_quantizer(T denom, size_t count, std::true_type) {
+        const quantizer<T, ALGO> quant(denom);
+        if (quant.recover() != denom) {
+            std::cerr << "Failed to recover quantizer for: " << testcase_name(ALGO) << ": "
+                      << denom << ", but got " << quant.recover() << std::endl;
+            exit(1);
+        }
+        // (n / 4) * 1.25 has fractional digits and is representable in T
+        std::vector<float> floats(count);
+        std::vector<double> doubles(count);
+        for (size_t i = 0; i < count; i++) {
+            T n = (T)(get_random() / 4);
+            floats[i] = (float)n * 1.25f;
+            doubles[i] = (double)n * 1.25;
+        }
+        std::vector<T> float_bins(count);
+        std::vector<T> double_bins(count);
+        quant.quantize(floats.data(), float_bins.data(), count);
+        quant.quantize(doubles.data(), double_bins.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            T float_expect = (T)((T)floats[i] / denom);
+            T double_expect = (T)((T)doubles[i] / denom);
+            if (float_bins[i] != float_expect || quant.quantize(floats[i]) != float_expect ||
+                double_bins[i] != double_expect || quant.quantize(doubles[i]) != double_expect) {
+                std::cerr << "Quantizer failure for: " << testcase_name(ALGO) << ": "
+                          << doubles[i] << " / " << denom << " = " << double_expect
+                          << ", but got " << double_bins[i] << std::endl;
+                exit(1);
+            }
         }
+    }
 
-        T expect = numer / denom;
-        T result = numer / the_divider;
+    void test_adaptive(T, std::false_type) {}
 
-        if (result != expect) {
-            std::cerr << "Failure for " << testcase_name(ALGO) << ": " << numer << " / " << denom
-                      << " = " << expect << ", but got " << result << std::endl;
+    // The adaptive divider must compute the same quotients on all paths,
+    // the add indicator path uses the branchfree algorithm
+    void test_adaptive(T denom, std::true_type) {
+        const adaptive_divider<T> div(denom);
+        const int algorithm = divider<T>(denom).algorithm() & ~LIBDIVIDE_ALGORITHM_NEGATED;
+        if (div.recover() != denom || div.path() != algorithm) {
+            std::cerr << "Failed to recover adaptive divider for: " << name << ": " << denom
+                      << ", but got " << div.recover() << " (path " << div.path() << ")"
+                      << std::endl;
             exit(1);
         }
+        const size_t count = 101;
+        T numers[count];
+        T quotients[count];
+        for (size_t i = 0; i < count; i++) {
+            numers[i] = get_random();
+            if (limits::is_signed && numers[i] == limits::min() && denom == T(-1)) {
+                numers[i] = 0;
+            }
+        }
+        div.divide(numers, quotients, count);
+        for (size_t i = 0; i < count; i++) {
+            T expect = (T)(numers[i] / denom);
+            if (quotients[i] != expect || numers[i] / div != expect) {
+                std::cerr << "Adaptive division failure for: " << name << ": " << numers[i]
+                          << " / " << denom << " = " << expect << ", but got " << quotients[i]
+                          << std::endl;
+                exit(1);
+            }
+        }
     }
 
-    template <typename VecType, Branching ALGO>
-    void test_vec(const T *numers, T denom, const divider<T, ALGO> &div) {
-        // Align memory to 64 byte boundary for AVX512
-        char mem[16 * sizeof(T) + 64];
-        size_t offset = 64 - (size_t)&mem % 64;
-        T *results = (T *)&mem[offset];
+    // The shift path is used by (negative) powers of 2,
+    // LIBDIVIDE_ALGORITHM_NEGATED by negative divisors
+    void test_algorithm(T denom) {
+        const divider<T> div(denom);
+        const int algorithm = div.algorithm();
+        T odd = denom;
+        while (odd % 2 == 0) odd /= 2;
+        bool power_of_2 = odd == 1 || (limits::is_signed && odd == (T)-1);
+        bool negated = (algorithm & LIBDIVIDE_ALGORITHM_NEGATED) != 0;
+        bool shift = (algorithm & ~LIBDIVIDE_ALGORITHM_NEGATED) == LIBDIVIDE_ALGORITHM_SHIFT;
+        if (negated != (denom < 0) || shift != power_of_2) {
+            std::cerr << "Wrong algorithm " << algorithm << " for: " << name << ": " << denom
+                      << std::endl;
+            exit(1);
+        }
+        test_stats(denom, algorithm, std::integral_constant<bool, (sizeof(T) <= 8)>());
+    }
 
-        size_t iters = 64 / sizeof(VecType);
-        size_t size = sizeof(VecType) / sizeof(T);
+    void test_stats(T, int, std::false_type) {}
 
-        for (size_t j = 0; j < iters; j++, numers += size) {
-            VecType x = *((const VecType *)numers);
-            VecType resultVector = x / div;
-            results = (T *)&resultVector;
+    // Other threads may generate dividers at the same time,
+    // so the counter must have been incremented at least once
+    void test_stats(T denom, int algorithm, std::true_type) {
+        // LIBDIVIDE_TABLE_U16, S16, U32, ..., 8-bit dividers use the 16-bit gen functions
+        const int type = LIBDIVIDE_TABLE_U16 + 2 * (sizeof(T) <= 2 ? 0 : sizeof(T) == 4 ? 1 : 2) +
+                         (limits::is_signed ? 1 : 0);
+        const volatile uint64_t &counter = libdivide_get_stats()->gen[type][algorithm];
+        const uint64_t before = counter;
+        const divider<T> div(denom);
+        if (counter <= before || div.algorithm() != algorithm) {
+            std::cerr << "LIBDIVIDE_STATS did not count the divider for: " << name << ": "
+                      << denom << std::endl;
+            exit(1);
+        }
+    }
 
-            for (size_t i = 0; i < size; i++) {
-                T numer = numers[i];
-                T result = results[i];
-                T expect = numer / denom;
+    // Tests the dividers generated for numerators within
+    // [-max_numer, max_numer], or [0, max_numer] for unsigned types
+    void test_bounded(T denom) {
+        const T half = (T)((T)1 << (limits::digits / 2));
+        T bounds[4] = {max(), (T)(max() >> 8), (T)(half - 1), (T)(get_random() & max())};
 
-                if (result != expect) {
-                    std::cerr << "Vector failure for: " << testcase_name(ALGO) << ": " << numer
-                              << " / " << denom << " = " << expect << ", but got " << result
+        for (T bound : bounds) {
+            if (bound == 0) bound = 1;
+            const divider<T> div(denom, bound);
+            if (div.recover() != denom) {
+                std::cerr << "Failed to recover bounded divider for: " << name << ": " << denom
+                          << " (max numerator " << bound << "), but got " << div.recover()
+                          << std::endl;
+                exit(1);
+            }
+            // Small dividers never need the add indicator
+            T absD = (T)(denom < 0 ? -denom : denom);
+            if (denom != limits::min() && absD < half && bound < half &&
+                bounded_add_marker(denom, bound)) {
+                std::cerr << "Bounded divider uses the add indicator for: " << name << ": "
+                          << denom << " (max numerator " << bound << ")" << std::endl;
+                exit(1);
+            }
+
+            T numers[64];
+            for (size_t j = 0; j < 64; j++) {
+                T n = get_random();
+                numers[j] = (bound == max()) ? n : (T)(n % (T)(bound + 1));
+            }
+            numers[0] = bound;
+            numers[1] = limits::is_signed ? (T)-bound : 0;
+            numers[2] = (T)(bound / denom * denom - 1);
+            if (limits::is_signed && bound == max() && denom != (T)-1) {
+                numers[3] = limits::min();
+            }
+
+            T quotients[64];
+            div.divide(numers, quotients, 64);
+            for (size_t j = 0; j < 64; j++) {
+                T expect = numers[j] / denom;
+                if (numers[j] / div != expect || quotients[j] != expect) {
+                    std::cerr << "Bounded divider failure for: " << name << ": " << numers[j]
+                              << " / " << denom << " (max numerator " << bound << ") = " << expect
+                              << ", but got " << numers[j] / div << " and " << quotients[j]
                               << std::endl;
                     exit(1);
-                } else {
-#if 0
-                        std::cout << "vec" << (CHAR_BIT * sizeof(VecType)) << " success for: " << numer << " / " << denom << " = " << result << std::endl;
-#endif
+                }
+            }
+        }
+    }
+
+    void test_narrow(T, std::false_type) {}
+
+    // Narrow 64-bit dividers for numerators < 2^32, divisors >= 2^32
+    // yield 0 for all of them
+    void test_narrow(T denom, std::true_type) {
+        const uint64_t bounds[3] = {0xffffffff, 0xffff, (uint64_t)(get_random() & 0xffffffff)};
+        for (uint64_t bound : bounds) {
+            const libdivide_u64_narrow_t div = libdivide_u64_narrow_gen(denom, bound);
+            const size_t count = 67;
+            uint64_t numers[count];
+            uint64_t quotients[count];
+            for (size_t j = 0; j < count; j++) numers[j] = (uint64_t)get_random() % (bound + 1);
+            numers[0] = bound;
+            numers[1] = 0;
+            numers[2] = (bound / denom) * denom;
+            libdivide_u64_narrow_do_array(numers, quotients, count, &div);
+            for (size_t j = 0; j < count; j++) {
+                uint64_t expect = numers[j] / denom;
+                if (libdivide_u64_narrow_do(numers[j], &div) != expect ||
+                    quotients[j] != expect) {
+                    std::cerr << "Narrow divider failure for: " << name << ": " << numers[j]
+                              << " / " << denom << " (max numerator " << bound << ") = " << expect
+                              << ", but got " << quotients[j] << std::endl;
+                    exit(1);
                 }
             }
         }
@@ -143,14 +1629,18 @@ class DivideTest {
         T min = limits::min();
         T max = limits::max();
 
+        // The casts truncate the larger edge cases for 8-bit and 16-bit types
         static const T edgeCases[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
             18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
-            40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 123, 1232, 36847, 506838, 3000003, 70000007,
-            max, max - 1, max - 2, max - 3, max - 4, max - 5, max - 3213, max - 2453242,
-            max - 432234231, min, min + 1, min + 2, min + 3, min + 4, min + 5, min + 3213,
-            min + 2453242, min + 432234231, max / 2, max / 2 + 1, max / 2 - 1, max / 3, max / 3 + 1,
-            max / 3 - 1, max / 4, max / 4 + 1, max / 4 - 1, min / 2, min / 2 + 1, min / 2 - 1,
-            min / 3, min / 3 + 1, min / 3 - 1, min / 4, max / 4 + 1, min / 4 - 1};
+            40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 123, (T)1232, (T)36847, (T)506838,
+            (T)3000003, (T)70000007, max, (T)(max - 1), (T)(max - 2), (T)(max - 3), (T)(max - 4),
+            (T)(max - 5), (T)(max - 3213), (T)(max - 2453242), (T)(max - 432234231), min,
+            (T)(min + 1), (T)(min + 2), (T)(min + 3), (T)(min + 4), (T)(min + 5), (T)(min + 3213),
+            (T)(min + 2453242), (T)(min + 432234231), (T)(max / 2), (T)(max / 2 + 1),
+            (T)(max / 2 - 1), (T)(max / 3), (T)(max / 3 + 1), (T)(max / 3 - 1), (T)(max / 4),
+            (T)(max / 4 + 1), (T)(max / 4 - 1), (T)(min / 2), (T)(min / 2 + 1), (T)(min / 2 - 1),
+            (T)(min / 3), (T)(min / 3 + 1), (T)(min / 3 - 1), (T)(min / 4), (T)(max / 4 + 1),
+            (T)(min / 4 - 1)};
 
         for (T numerator : edgeCases) {
             test_one(numerator, denom, the_divider);
@@ -187,31 +1677,75 @@ class DivideTest {
         }
 
         // Align memory to 64 byte boundary for AVX512
-        char mem[16 * sizeof(T) + 64];
+        char mem[numers_count * sizeof(T) + 64];
         size_t offset = 64 - (size_t)&mem % 64;
         T *numers = (T *)&mem[offset];
 
         // test random numerators
-        for (size_t i = 0; i < 10000; i += 16) {
-            for (size_t j = 0; j < 16; j++) {
+        for (size_t i = 0; i < 10000; i += numers_count) {
+            for (size_t j = 0; j < numers_count; j++) {
                 numers[j] = get_random();
             }
-            for (size_t j = 0; j < 16; j++) {
+            for (size_t j = 0; j < numers_count; j++) {
                 test_one(numers[j], denom, the_divider);
             }
-#ifdef LIBDIVIDE_SSE2
-            test_vec<__m128i>(numers, denom, the_divider);
-#endif
-#ifdef LIBDIVIDE_AVX2
-            test_vec<__m256i>(numers, denom, the_divider);
-#endif
-#ifdef LIBDIVIDE_AVX512
-            test_vec<__m512i>(numers, denom, the_divider);
-#endif
-#ifdef LIBDIVIDE_NEON
-            test_vec<typename NeonVecFor<T>::type>(numers, denom, the_divider);
-#endif
+            test_vecs(numers, denom, the_divider, std::integral_constant<bool, (sizeof(T) > 1)>());
+            test_generic_vecs(
+                numers, denom, the_divider, std::integral_constant<bool, (sizeof(T) <= 8)>());
+            test_divmod<ALGO>(numers, denom, std::integral_constant<bool, (sizeof(T) >= 4)>());
+        }
+
+        test_array(denom, the_divider);
+        test_reductions(
+            denom, the_divider, std::integral_constant<bool, (sizeof(T) > 1 && sizeof(T) <= 8)>());
+        test_stream(
+            denom, the_divider, std::integral_constant<bool, (sizeof(T) > 1 && sizeof(T) <= 8)>());
+        test_quantizer<ALGO>(denom, 101, std::integral_constant<bool, (sizeof(T) <= 8)>());
+
+        if (ALGO == BRANCHFULL) {
+            test_divisibility(denom,
+                std::integral_constant<bool, std::is_unsigned<T>::value && sizeof(T) >= 4>());
+            test_modulus(denom, std::integral_constant<bool, std::is_same<T, uint32_t>::value>());
+            test_divider52(denom, std::integral_constant<bool, sizeof(T) == 8>());
+            test_exact(denom, std::integral_constant<bool, sizeof(T) == 4 || sizeof(T) == 8>());
+            test_bounded(denom);
+            test_narrow(denom, std::integral_constant<bool, std::is_same<T, uint64_t>::value>());
+            test_algorithm(denom);
+            test_adaptive(
+                denom, std::integral_constant<bool, (sizeof(T) > 1 && sizeof(T) <= 8)>());
+        }
+    }
+
+    // The dividers generated in constant expressions must
+    // be identical to the ones generated at runtime
+    template <Branching ALGO, T denom>
+    void test_constexpr() {
+#if defined(LIBDIVIDE_HAS_CONSTEXPR_DIVIDER)
+        static constexpr divider<T, ALGO> constexpr_divider(denom);
+        if (constexpr_divider != divider<T, ALGO>(denom)) {
+            std::cerr << "constexpr divider failure for " << testcase_name(ALGO) << ": " << denom
+                      << std::endl;
+            exit(1);
         }
+#endif
+    }
+
+    template <T denom>
+    void test_constexpr_both() {
+        test_constexpr<BRANCHFULL, denom>();
+        test_constexpr<BRANCHFREE, denom>();
+    }
+
+    void test_constexpr_dividers() {
+        test_constexpr_both<2>();
+        test_constexpr_both<3>();
+        test_constexpr_both<7>();
+        test_constexpr_both<10>();
+        test_constexpr_both<(T)1000>();
+        test_constexpr_both<(T)-3>();
+        test_constexpr_both<(T)-64>();
+        test_constexpr_both<limits::max()>();
+        test_constexpr_both<limits::min() == 0 ? (T)(limits::max() / 3) : limits::min()>();
     }
 
    public:
@@ -224,8 +1758,11 @@ class DivideTest {
     }
 
     void run() {
+        test_constexpr_dividers();
+
         // Test small values
-        for (int denom = 1; denom < 1024; denom++) {
+        const int small_denoms = limits::digits < 10 ? (int)limits::max() : 1024;
+        for (int denom = 1; denom < small_denoms; denom++) {
             test_many<BRANCHFULL>(denom);
             test_many<BRANCHFREE>(denom);
 
@@ -243,6 +1780,14 @@ class DivideTest {
         test_many<BRANCHFULL>(limits::max());
         test_many<BRANCHFREE>(limits::max());
 
+        // Quantize several blocks of values
+        for (T denom : {(T)3, (T)7, (T)10, limits::max()}) {
+            test_quantizer<BRANCHFULL>(
+                denom, 5000, std::integral_constant<bool, (sizeof(T) <= 8)>());
+            test_quantizer<BRANCHFREE>(
+                denom, 5000, std::integral_constant<bool, (sizeof(T) <= 8)>());
+        }
+
         // test power of 2 denoms: 2^i-1, 2^i, 2^i+1
         for (int i = 1; i < limits::digits; i++) {
             for (int j = -1; j <= 1; j++) {
@@ -265,19 +1810,153 @@ class DivideTest {
         }
 
         // Test random denominators
+        std::vector<T> gen_divisors;
         for (int i = 0; i < 10000; i++) {
             T denom = random_denominator();
             test_many<BRANCHFULL>(denom);
             test_many<BRANCHFREE>(denom);
+            gen_divisors.push_back(denom);
+        }
+
+        for (int i = 1; i < 1024; i++) {
+            gen_divisors.push_back((T)i);
+        }
+        for (int i = 0; i < limits::digits; i++) {
+            gen_divisors.push_back((T)((T)1 << i));
+        }
+        gen_divisors.push_back(limits::max());
+        test_divider_arrays(name, gen_divisors);
+        test_divider_cache<T, BRANCHFULL>(name, gen_divisors);
+        test_divider_cache<T, BRANCHFREE>(name + " (branchfree)", gen_divisors);
+        test_divider_table<T, true>(name, gen_divisors);
+        test_divider_table<T, false>(name + " (packed)", gen_divisors);
+        test_serialized_table<T, BRANCHFULL>(name, gen_divisors);
+        test_serialized_table<T, BRANCHFREE>(name + " (branchfree)", gen_divisors);
+#if defined(LIBDIVIDE_MMAP)
+        test_mapped_table<T, BRANCHFULL>(name, gen_divisors);
+        test_mapped_table<T, BRANCHFREE>(name + " (branchfree)", gen_divisors);
+#endif
+        test_parallel<T, BRANCHFULL>(name, gen_divisors);
+        test_parallel<T, BRANCHFREE>(name + " (branchfree)", gen_divisors);
+        test_gen_arrays(name, gen_divisors);
+    }
+};
+
+#if defined(HAS_INT128_T)
+// std::numeric_limits and std::ostream do not support the 128-bit
+// integers, so they are tested separately against hardware division
+// using the values that are most likely to break libdivide's algorithms.
+template <typename T>
+class Int128Test {
+   private:
+    using UT = __uint128_t;
+    static const bool is_signed = std::is_same<T, __int128_t>::value;
+    std::string name;
+    std::mt19937_64 engine;
+
+    static std::string to_string(T value) {
+        UT u = (UT)value;
+        char buf[64];
+        snprintf(buf, sizeof(buf), "0x%016llx%016llx", (unsigned long long)(u >> 64),
+            (unsigned long long)u);
+        return buf;
+    }
+
+    // Random value with a random number of significant bits
+    UT random_bits() {
+        UT r = ((UT)engine() << 64) | engine();
+        return r >> (engine() % 128);
+    }
+
+    template <Branching ALGO>
+    void test_one(T numer, T denom, const divider<T, ALGO> &the_divider) {
+        if (is_signed && denom == (T)-1 && numer == (T)((UT)1 << 127)) return;
+        T expect = numer / denom;
+        T result = numer / the_divider;
+        if (result != expect) {
+            std::cerr << "Failure for " << name << ": " << to_string(numer) << " / "
+                      << to_string(denom) << " = " << to_string(expect) << ", but got "
+                      << to_string(result) << std::endl;
+            exit(1);
+        }
+    }
+
+    template <Branching ALGO>
+    void test_many(T denom) {
+        // Don't try dividing by 1 with unsigned branchfree
+        if (ALGO == BRANCHFREE && !is_signed && denom == 1) return;
+
+        const divider<T, ALGO> the_divider = divider<T, ALGO>(denom);
+        T recovered = the_divider.recover();
+        if (recovered != denom) {
+            std::cerr << "Failed to recover divisor for " << name << ": " << to_string(denom)
+                      << ", but got " << to_string(recovered) << std::endl;
+            exit(1);
+        }
+
+        const UT edges[] = {0, 1, 2, (UT)-1, (UT)-2, (UT)1 << 127, ((UT)1 << 127) - 1};
+        for (UT edge : edges) {
+            test_one((T)edge, denom, the_divider);
+        }
+        // Numerators just below and above multiples of denom
+        for (int i = 0; i < 8; i++) {
+            UT multiple = (UT)denom * (UT)(engine() % 1024);
+            test_one((T)(multiple - 1), denom, the_divider);
+            test_one((T)multiple, denom, the_divider);
+        }
+        for (int i = 0; i < 64; i++) {
+            test_one((T)random_bits(), denom, the_divider);
+        }
+    }
+
+    void test_both(T denom) {
+        test_many<BRANCHFULL>(denom);
+        test_many<BRANCHFREE>(denom);
+        if (is_signed) {
+            test_many<BRANCHFULL>((T)-(UT)denom);
+            test_many<BRANCHFREE>((T)-(UT)denom);
+        }
+    }
+
+   public:
+    Int128Test(const std::string &n) : name(n), engine(42) {}
+
+    void run() {
+        for (int denom = 1; denom < 1024; denom++) {
+            test_both((T)denom);
+        }
+        // test power of 2 denoms: 2^i-1, 2^i, 2^i+1
+        for (int i = 1; i < 128; i++) {
+            for (int j = -1; j <= 1; j++) {
+                test_both((T)(((UT)1 << i) + j));
+            }
+        }
+        // Test random denominators
+        for (int i = 0; i < 10000; i++) {
+            T denom = (T)random_bits();
+            if (denom != 0) test_both(denom);
         }
     }
 };
 
+template <typename T>
+void run_test_128(const char *name) {
+    Int128Test<T> dt(name);
+    dt.run();
+}
+#endif
+
 enum TestType {
+    type_s8,
+    type_u8,
+    type_s16,
+    type_u16,
     type_s32,
     type_u32,
     type_s64,
     type_u64,
+    type_s128,
+    type_u128,
 };
 
 template <typename T>
@@ -288,11 +1967,19 @@ void run_test(const char *name) {
 
 int main(int argc, char *argv[]) {
     bool default_do_test = (argc <= 1);
-    std::vector<bool> do_tests(4, default_do_test);
+    std::vector<bool> do_tests(10, default_do_test);
 
     for (int i = 1; i < argc; i++) {
         const std::string arg(argv[i]);
-        if (arg == "s32")
+        if (arg == "s8")
+            do_tests[type_s8] = true;
+        else if (arg == "u8")
+            do_tests[type_u8] = true;
+        else if (arg == "s16")
+            do_tests[type_s16] = true;
+        else if (arg == "u16")
+            do_tests[type_u16] = true;
+        else if (arg == "s32")
             do_tests[type_s32] = true;
         else if (arg == "u32")
             do_tests[type_u32] = true;
@@ -300,12 +1987,17 @@ int main(int argc, char *argv[]) {
             do_tests[type_s64] = true;
         else if (arg == "u64")
             do_tests[type_u64] = true;
+        else if (arg == "s128")
+            do_tests[type_s128] = true;
+        else if (arg == "u128")
+            do_tests[type_u128] = true;
         else {
             std::cout
                 << "Usage: tester [OPTIONS]\n"
                    "\n"
                    "You can pass the tester program one or more of the following options:\n"
-                   "u32, s32, u64, s64 or run it without arguments to test all four.\n"
+                   "u8, s8, u16, s16, u32, s32, u64, s64, u128, s128 or run it without arguments\n"
+                   "to test all (u128 and s128 require __int128 support).\n"
                    "The tester is multithreaded so it can test multiple cases simultaneously.\n"
                    "The tester will verify the correctness of libdivide via a set of\n"
                    "randomly chosen denominators, by comparing the result of libdivide's\n"
@@ -328,15 +2020,41 @@ int main(int argc, char *argv[]) {
 #endif
 #if defined(LIBDIVIDE_NEON)
     vecTypes += "neon ";
+#endif
+#if defined(LIBDIVIDE_SVE)
+    vecTypes += "sve ";
+#endif
+#if defined(LIBDIVIDE_RVV)
+    vecTypes += "rvv ";
 #endif
     if (vecTypes.empty()) {
         vecTypes = "none ";
     }
     vecTypes.back() = '\n';  // trailing space
     std::cout << "Testing with SIMD ISAs: " << vecTypes;
+#if defined(LIBDIVIDE_DISPATCH_X86)
+    static const char *const isaNames[] = {"none", "sse2", "avx2", "avx512"};
+    std::cout << "Testing array dispatch with: " << isaNames[libdivide_cpu_isa()] << std::endl;
+#endif
 
     // Run tests in threads.
     std::vector<std::thread> test_threads;
+    if (do_tests[type_s8]) {
+        std::cout << "Testing int8_t\n";
+        test_threads.emplace_back(run_test<int8_t>, "s8");
+    }
+    if (do_tests[type_u8]) {
+        std::cout << "Testing uint8_t\n";
+        test_threads.emplace_back(run_test<uint8_t>, "u8");
+    }
+    if (do_tests[type_s16]) {
+        std::cout << "Testing int16_t\n";
+        test_threads.emplace_back(run_test<int16_t>, "s16");
+    }
+    if (do_tests[type_u16]) {
+        std::cout << "Testing uint16_t\n";
+        test_threads.emplace_back(run_test<uint16_t>, "u16");
+    }
     if (do_tests[type_s32]) {
         std::cout << "Testing int32_t\n";
         test_threads.emplace_back(run_test<int32_t>, "s32");
@@ -353,6 +2071,16 @@ int main(int argc, char *argv[]) {
         std::cout << "Testing uint64_t\n";
         test_threads.emplace_back(run_test<uint64_t>, "u64");
     }
+#if defined(HAS_INT128_T)
+    if (do_tests[type_s128]) {
+        std::cout << "Testing __int128_t\n";
+        test_threads.emplace_back(run_test_128<__int128_t>, "s128");
+    }
+    if (do_tests[type_u128]) {
+        std::cout << "Testing __uint128_t\n";
+        test_threads.emplace_back(run_test_128<__uint128_t>, "u128");
+    }
+#endif
     for (auto &t : test_threads) {
         t.join();
     }